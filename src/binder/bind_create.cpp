@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -112,7 +113,49 @@ auto Binder::BindCreate(duckdb_libpgquery::PGCreateStmt *pg_stmt) -> std::unique
     throw bustub::Exception("should have at least 1 column");
   }
 
-  return std::make_unique<CreateStatement>(std::move(table), std::move(columns));
+  // The storage of the table is given as table options: CREATE TABLE ... WITH (format = 'pax'), and
+  // WITH (dictionary = 'col1, col2') for the VARCHAR columns to store as dictionary codes
+  std::string format = "row";
+  std::vector<std::string> dictionary_columns;
+  if (pg_stmt->options != nullptr) {
+    for (auto cell = pg_stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto def_elem = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      auto option = StringUtil::Lower(def_elem->defname);
+      if (option != "format" && option != "dictionary") {
+        throw NotImplementedException(fmt::format("table option {} is not supported", def_elem->defname));
+      }
+      std::string arg;
+      if (def_elem->arg != nullptr && def_elem->arg->type == duckdb_libpgquery::T_PGString) {
+        arg = StringUtil::Lower(reinterpret_cast<duckdb_libpgquery::PGValue *>(def_elem->arg)->val.str);
+      } else if (def_elem->arg != nullptr && def_elem->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        // an unquoted name is parsed as a type name
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(def_elem->arg);
+        arg = StringUtil::Lower(
+            reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str);
+      } else {
+        throw NotImplementedException(fmt::format("table option {} expects a name", option));
+      }
+      if (option == "format") {
+        format = std::move(arg);
+        continue;
+      }
+      for (const auto &name : StringUtil::Split(arg, ',')) {
+        auto column_name = StringUtil::Strip(name, ' ');
+        auto column = std::find_if(columns.begin(), columns.end(),
+                                   [&](const Column &col) { return col.GetName() == column_name; });
+        if (column == columns.end()) {
+          throw bustub::Exception(fmt::format("dictionary column {} does not exist", column_name));
+        }
+        if (column->GetType() != TypeId::VARCHAR) {
+          throw bustub::Exception(fmt::format("dictionary column {} is not a VARCHAR column", column_name));
+        }
+        dictionary_columns.push_back(std::move(column_name));
+      }
+    }
+  }
+
+  return std::make_unique<CreateStatement>(std::move(table), std::move(columns), std::move(format),
+                                           std::move(dictionary_columns));
 }
 
 auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<IndexStatement> {
@@ -129,7 +172,53 @@ auto Binder::BindIndex(duckdb_libpgquery::PGIndexStmt *stmt) -> std::unique_ptr<
     }
   }
 
-  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols));
+  // The parser fills in its DEFAULT_INDEX_TYPE ("art") when USING is omitted, so look for the keyword among the
+  // tokens of the statement; BusTub builds a B+ tree by default.
+  std::string index_type = "btree";
+  for (const auto &token : query_tokens_) {
+    auto start = static_cast<size_t>(token.start_);
+    if (start >= statement_begin_ && start < statement_end_ &&
+        token.type_ == SimplifiedTokenType::SIMPLIFIED_TOKEN_KEYWORD &&
+        StringUtil::Lower(query_.substr(start, 5)) == "using") {
+      index_type = StringUtil::Lower(stmt->accessMethod);
+      break;
+    }
+  }
+
+  // The parser has no INCLUDE clause, covering columns are given as an index option instead:
+  // CREATE INDEX ... WITH (include = 'v2, v3')
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols;
+  if (stmt->options != nullptr) {
+    for (auto cell = stmt->options->head; cell != nullptr; cell = cell->next) {
+      auto def_elem = reinterpret_cast<duckdb_libpgquery::PGDefElem *>(cell->data.ptr_value);
+      if (StringUtil::Lower(def_elem->defname) != "include") {
+        throw NotImplementedException(fmt::format("index option {} is not supported", def_elem->defname));
+      }
+
+      std::vector<std::string> col_names;
+      if (def_elem->arg != nullptr && def_elem->arg->type == duckdb_libpgquery::T_PGString) {
+        auto names = StringUtil::Split(reinterpret_cast<duckdb_libpgquery::PGValue *>(def_elem->arg)->val.str, ',');
+        for (const auto &name : names) {
+          col_names.push_back(StringUtil::Lower(StringUtil::Strip(name, ' ')));
+        }
+      } else if (def_elem->arg != nullptr && def_elem->arg->type == duckdb_libpgquery::T_PGTypeName) {
+        // a single unquoted column name is parsed as a type name
+        auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(def_elem->arg);
+        col_names.emplace_back(
+            reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str);
+      } else {
+        throw NotImplementedException("index option include expects a list of column names");
+      }
+
+      for (const auto &col_name : col_names) {
+        auto column_ref = ResolveColumn(*table, std::vector{col_name});
+        include_cols.emplace_back(std::make_unique<BoundColumnRef>(dynamic_cast<const BoundColumnRef &>(*column_ref)));
+      }
+    }
+  }
+
+  return std::make_unique<IndexStatement>(stmt->idxname, std::move(table), std::move(cols), std::move(index_type),
+                                          std::move(include_cols), stmt->unique);
 }
 
 }  // namespace bustub
@@ -43,6 +43,12 @@ namespace bustub {
 Binder::Binder(const Catalog &catalog) : catalog_(catalog) {}
 
 void Binder::ParseAndSave(const std::string &query) {
+  query_ = query;
+  // Tokenize cleans up the memory of the parser, so it has to run before the parse tree is built
+  query_tokens_.clear();
+  if (StringUtil::Contains(StringUtil::Lower(query), "index")) {
+    query_tokens_ = Tokenize(query);
+  }
   parser_.Parse(query);
   if (!parser_.success) {
     LOG_INFO("Query failed to parse!");
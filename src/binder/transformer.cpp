@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <memory>
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -51,8 +52,13 @@ void Binder::SaveParseTree(duckdb_libpgquery::PGList *tree) {
 
 auto Binder::BindStatement(duckdb_libpgquery::PGNode *stmt) -> std::unique_ptr<BoundStatement> {
   switch (stmt->type) {
-    case duckdb_libpgquery::T_PGRawStmt:
-      return BindStatement(reinterpret_cast<duckdb_libpgquery::PGRawStmt *>(stmt)->stmt);
+    case duckdb_libpgquery::T_PGRawStmt: {
+      auto raw_stmt = reinterpret_cast<duckdb_libpgquery::PGRawStmt *>(stmt);
+      // a length of 0 means the statement runs to the end of the query
+      statement_begin_ = std::max(raw_stmt->stmt_location, 0);
+      statement_end_ = raw_stmt->stmt_len == 0 ? query_.size() : statement_begin_ + raw_stmt->stmt_len;
+      return BindStatement(raw_stmt->stmt);
+    }
     case duckdb_libpgquery::T_PGCreateStmt:
       return BindCreate(reinterpret_cast<duckdb_libpgquery::PGCreateStmt *>(stmt));
     case duckdb_libpgquery::T_PGInsertStmt:
@@ -406,6 +406,56 @@ auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
   return {this, page};
 }
 
+void BufferPoolManager::PrefetchPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (page_table_.find(page_id) != page_table_.end()) {
+      return;
+    }
+  }
+  thread_pool_->Enqueue([this, page_id]() { LoadPageUnpinned(page_id); });
+}
+
+void BufferPoolManager::LoadPageUnpinned(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // the page may have been fetched by someone else in the meantime
+  if (page_table_.find(page_id) != page_table_.end()) {
+    return;
+  }
+
+  frame_id_t frame_id;
+  if (!free_list_.empty()) {
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+  } else {
+    if (!replacer_->Evict(&frame_id)) {
+      return;
+    }
+    Page &replaced_page = pages_[frame_id];
+    if (replaced_page.IsDirty()) {
+      DiskRequest r(true, replaced_page.GetPageId(), replaced_page.GetData());
+      disk_proxy_->WriteToDisk(r);
+      replaced_page.is_dirty_ = false;
+    }
+    page_table_.erase(replaced_page.GetPageId());
+  }
+
+  page_table_.emplace(page_id, frame_id);
+  Page &page = pages_[frame_id];
+  page.ResetMemory();
+  page.page_id_ = page_id;
+  page.pin_count_ = 0;
+
+  disk_proxy_->ReadFromDisk(page_id, page.GetData());
+
+  // the frame is tracked by the replacer but stays evictable until someone pins it
+  replacer_->RecordAccess(frame_id, AccessType::Unknown);
+  replacer_->SetEvictable(frame_id, true);
+}
+
 auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard {
   auto page = this->NewPage(page_id);
   return {this, page};
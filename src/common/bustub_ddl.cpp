@@ -1,6 +1,7 @@
 // DDL (Data Definition Language) statement handling in BusTub, including create table, create index, and set/show
 // variable.
 
+#include <algorithm>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -36,13 +37,33 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/index/var_key.h"
+#include "storage/page/table_pax_page.h"
+#include "storage/table/table_heap.h"
 #include "type/value_factory.h"
 
 namespace bustub {
 
 void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStatement &stmt, ResultWriter &writer) {
+  TableFormat format;
+  if (stmt.format_ == "row") {
+    format = TableFormat::ROW;
+  } else if (stmt.format_ == "pax") {
+    format = TableFormat::PAX;
+  } else {
+    throw NotImplementedException(fmt::format("unsupported table format: {}", stmt.format_));
+  }
+  Schema schema(stmt.columns_);
+  if (format == TableFormat::PAX && !TablePaxPage::IsSupported(schema)) {
+    throw NotImplementedException("a tuple of the table does not fit into a PAX page");
+  }
+  std::vector<uint32_t> dictionary_columns;
+  for (const auto &name : stmt.dictionary_columns_) {
+    dictionary_columns.push_back(schema.GetColIdx(name));
+  }
+
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateTable(txn, stmt.table_, Schema(stmt.columns_));
+  auto info = catalog_->CreateTable(txn, stmt.table_, schema, true, format, dictionary_columns);
   l.unlock();
 
   if (info == nullptr) {
@@ -52,13 +73,44 @@ void BustubInstance::HandleCreateStatement(Transaction *txn, const CreateStateme
 }
 
 void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement &stmt, ResultWriter &writer) {
+  IndexType index_type;
+  if (stmt.index_type_ == "btree") {
+    index_type = IndexType::BPlusTreeIndex;
+  } else if (stmt.index_type_ == "art") {
+    index_type = IndexType::ARTIndex;
+  } else if (stmt.index_type_ == "bwtree") {
+    index_type = IndexType::BwTreeIndex;
+  } else {
+    throw NotImplementedException(fmt::format("unsupported index type: {}", stmt.index_type_));
+  }
+  // Included columns are compared as part of the key, a UNIQUE index would only keep (key, included columns) unique
+  if (stmt.unique_ && !stmt.include_cols_.empty()) {
+    throw NotImplementedException("a UNIQUE index cannot include columns");
+  }
+  // ART and Bw-tree keep one RID per key, the rows sharing a key need the posting lists of a B+ tree
+  if (index_type != IndexType::BPlusTreeIndex && !stmt.unique_) {
+    throw NotImplementedException(fmt::format("index type {} only supports UNIQUE indexes", stmt.index_type_));
+  }
+
+  // Included columns are stored after the key columns, so they follow the key in the index order
   std::vector<uint32_t> col_ids;
-  for (const auto &col : stmt.cols_) {
-    auto idx = stmt.table_->schema_.GetColIdx(col->col_name_.back());
+  auto add_column = [&](const BoundColumnRef &col) {
+    auto idx = stmt.table_->schema_.GetColIdx(col.col_name_.back());
+    if (std::find(col_ids.begin(), col_ids.end(), idx) != col_ids.end()) {
+      throw NotImplementedException("a column can only appear once in an index");
+    }
     col_ids.push_back(idx);
-    if (stmt.table_->schema_.GetColumn(idx).GetType() != TypeId::INTEGER) {
-      throw NotImplementedException("only support creating index on integer column");
+    // ART and Bw-tree encode keys of any type, the B+ tree index is instantiated for integer and varchar keys
+    auto type = stmt.table_->schema_.GetColumn(idx).GetType();
+    if (index_type == IndexType::BPlusTreeIndex && type != TypeId::INTEGER && type != TypeId::VARCHAR) {
+      throw NotImplementedException("only support creating index on integer or varchar column");
     }
+  };
+  for (const auto &col : stmt.cols_) {
+    add_column(*col);
+  }
+  for (const auto &col : stmt.include_cols_) {
+    add_column(*col);
   }
   auto key_schema = Schema::CopySchema(&stmt.table_->schema_, col_ids);
 
@@ -67,14 +119,56 @@ void BustubInstance::HandleIndexStatement(Transaction *txn, const IndexStatement
   //
   // You can also create clustered index that directly stores value inside the index by modifying the value type.
 
-  if (col_ids.empty() || col_ids.size() > 2) {
+  if (stmt.cols_.empty() || (index_type == IndexType::BPlusTreeIndex && col_ids.size() > 2)) {
     throw NotImplementedException("only support creating index with exactly one or two columns");
   }
 
+  // Integer keys are stored as tuple bytes in a GenericKey. Keys with a VARCHAR column are stored in the
+  // memcomparable encoding of VarKey, whose size is picked from the declared lengths of the columns: a null
+  // byte before each value, and a VARCHAR ends with two more bytes.
+  bool has_varchar = false;
+  size_t var_key_size = 0;
+  for (const auto &column : key_schema.GetColumns()) {
+    has_varchar |= column.GetType() == TypeId::VARCHAR;
+    var_key_size += 1 + (column.GetType() == TypeId::VARCHAR ? column.GetLength() + 2 : column.GetFixedLength());
+  }
+  if (index_type == IndexType::BPlusTreeIndex && has_varchar && var_key_size > 64) {
+    throw NotImplementedException("only support creating index on varchar keys of at most 64 bytes");
+  }
+
+  // A B+ tree that is not unique keeps one entry per distinct key with the RIDs of all its rows in a
+  // posting list, instead of failing on (and dropping) the rows whose key is in the index already.
   std::unique_lock<std::shared_mutex> l(catalog_lock_);
-  auto info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
-      txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
-      IntegerHashFunctionType{});
+  IndexInfo *info;
+  if (index_type == IndexType::BPlusTreeIndex && has_varchar && var_key_size <= 32) {
+    if (stmt.unique_) {
+      info = catalog_->CreateIndex<VarKey<32>, RID, VarKeyComparator<32>>(
+          txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, 32,
+          HashFunction<VarKey<32>>{}, index_type, stmt.include_cols_.size());
+    } else {
+      info = catalog_->CreateIndex<VarKey<32>, PostingList, VarKeyComparator<32>>(
+          txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, 32,
+          HashFunction<VarKey<32>>{}, index_type, stmt.include_cols_.size());
+    }
+  } else if (index_type == IndexType::BPlusTreeIndex && has_varchar) {
+    if (stmt.unique_) {
+      info = catalog_->CreateIndex<VarKey<64>, RID, VarKeyComparator<64>>(
+          txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, 64,
+          HashFunction<VarKey<64>>{}, index_type, stmt.include_cols_.size());
+    } else {
+      info = catalog_->CreateIndex<VarKey<64>, PostingList, VarKeyComparator<64>>(
+          txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, 64,
+          HashFunction<VarKey<64>>{}, index_type, stmt.include_cols_.size());
+    }
+  } else if (index_type == IndexType::BPlusTreeIndex && !stmt.unique_) {
+    info = catalog_->CreateIndex<IntegerKeyType, PostingList, IntegerComparatorType>(
+        txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
+        IntegerHashFunctionType{}, index_type, stmt.include_cols_.size());
+  } else {
+    info = catalog_->CreateIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>(
+        txn, stmt.index_name_, stmt.table_->table_, stmt.table_->schema_, key_schema, col_ids, TWO_INTEGER_SIZE,
+        IntegerHashFunctionType{}, index_type, stmt.include_cols_.size());
+  }
   l.unlock();
 
   if (info == nullptr) {
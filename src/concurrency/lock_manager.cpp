@@ -26,6 +26,16 @@ auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_
   return true;
 }
 
+auto LockManager::LockRows(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const std::vector<RID> &rids)
+    -> bool {
+  for (const auto &rid : rids) {
+    if (!LockRow(txn, lock_mode, oid, rid)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid, bool force) -> bool {
   return true;
 }
@@ -10,13 +10,17 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "container/disk/hash/disk_extendible_hash_table.h"
 
@@ -26,7 +30,26 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::DiskExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                          const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
     : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+  // header页和目录页一直pin在缓冲池里，查找时只需要读桶页
+  header_guard_ = buffer_pool_manager_->NewPageGuarded(&header_page_id_);
+  BUSTUB_ENSURE(header_page_id_ != INVALID_PAGE_ID, "cannot allocate header page");
+  auto *header_page = header_guard_.AsMut<HashTableDirectoryHeaderPage>();
+  header_page->Init();
+
+  // 初始时global depth为0，目录只有一个槽，指向唯一的桶
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  directory_guards_.emplace_back(buffer_pool_manager_->NewPageGuarded(&directory_page_id));
+  BUSTUB_ENSURE(directory_page_id != INVALID_PAGE_ID, "cannot allocate directory page");
+  auto *dir_page = directory_guards_.back().AsMut<HashTableDirectoryPage>();
+  dir_page->SetPageId(directory_page_id);
+  directory_pages_.push_back(dir_page);
+  header_page->SetDirectoryPageId(0, directory_page_id);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_guard = buffer_pool_manager_->NewPageGuarded(&bucket_page_id);
+  BUSTUB_ENSURE(bucket_page_id != INVALID_PAGE_ID, "cannot allocate bucket page");
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
 }
 
 /*****************************************************************************
@@ -45,23 +68,49 @@ auto HASH_TABLE_TYPE::Hash(KeyType key) -> uint32_t {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t {
-  return 0;
+inline auto HASH_TABLE_TYPE::Fingerprint(KeyType key) -> uint8_t {
+  // 目录只用低32位，fingerprint取最高的8位
+  return static_cast<uint8_t>(hash_fn_.GetHash(key) >> 56);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+inline auto HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key) -> uint32_t {
+  return Hash(key) & (DirectorySize() - 1);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t {
-  return 0;
+inline auto HASH_TABLE_TYPE::KeyToPageId(KeyType key) -> page_id_t {
+  uint32_t bucket_idx = KeyToDirectoryIndex(key);
+  return DirectoryPageOf(bucket_idx)->GetBucketPageId(bucket_idx % DIRECTORY_ARRAY_SIZE);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchDirectoryPage() -> HashTableDirectoryPage * {
-  return nullptr;
+auto HASH_TABLE_TYPE::FetchBucketRead(const KeyType &key) -> ReadPageGuard {
+  uint32_t bucket_idx = KeyToDirectoryIndex(key);
+  const auto *dir_page = DirectoryPageOf(bucket_idx);
+  uint32_t slot = bucket_idx % DIRECTORY_ARRAY_SIZE;
+  while (true) {
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(slot);
+    auto bucket_guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+    // 等锁期间桶可能被分裂，key已经属于新桶了，按目录重新找
+    if (dir_page->GetBucketPageId(slot) == bucket_page_id) {
+      return bucket_guard;
+    }
+  }
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE * {
-  return nullptr;
+auto HASH_TABLE_TYPE::FetchBucketWrite(const KeyType &key, uint32_t *bucket_idx) -> WritePageGuard {
+  *bucket_idx = KeyToDirectoryIndex(key);
+  const auto *dir_page = DirectoryPageOf(*bucket_idx);
+  uint32_t slot = *bucket_idx % DIRECTORY_ARRAY_SIZE;
+  while (true) {
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(slot);
+    auto bucket_guard = buffer_pool_manager_->FetchPageWrite(bucket_page_id);
+    if (dir_page->GetBucketPageId(slot) == bucket_page_id) {
+      return bucket_guard;
+    }
+  }
 }
 
 /*****************************************************************************
@@ -69,7 +118,10 @@ auto HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BU
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  auto header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  auto bucket_guard = FetchBucketRead(key);
+  header_guard.Drop();
+  return bucket_guard.template As<HASH_TABLE_BUCKET_TYPE>()->GetValue(key, comparator_, result, Fingerprint(key));
 }
 
 /*****************************************************************************
@@ -77,12 +129,132 @@ auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  {
+    auto header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+    uint32_t bucket_idx;
+    auto bucket_guard = FetchBucketWrite(key, &bucket_idx);
+    header_guard.Drop();
+    auto *bucket = bucket_guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+    if (!bucket->IsFull()) {
+      return bucket->Insert(key, value, comparator_, Fingerprint(key));
+    }
+  }
+  return SplitInsert(transaction, key, value);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  while (true) {
+    {
+      auto header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+      uint32_t bucket_idx;
+      auto bucket_guard = FetchBucketWrite(key, &bucket_idx);
+      auto *bucket = bucket_guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+      if (!bucket->IsFull()) {
+        header_guard.Drop();
+        return bucket->Insert(key, value, comparator_, Fingerprint(key));
+      }
+      std::vector<ValueType> values;
+      bucket->GetValue(key, comparator_, &values, Fingerprint(key));
+      if (std::find(values.begin(), values.end(), value) != values.end()) {
+        return false;
+      }
+
+      // 只改写本桶的槽位，header持有共享锁即可
+      if (DirectoryPageOf(bucket_idx)->GetLocalDepth(bucket_idx % DIRECTORY_ARRAY_SIZE) < DirectoryGlobalDepth()) {
+        SplitBucket(bucket_idx, &bucket_guard);
+        continue;
+      }
+    }
+
+    // 桶的local depth已经等于global depth，需要排他地把目录翻倍，下一轮再分裂桶
+    auto header_guard = buffer_pool_manager_->FetchPageWrite(header_page_id_);
+    uint32_t bucket_idx = KeyToDirectoryIndex(key);
+    if (DirectoryPageOf(bucket_idx)->GetLocalDepth(bucket_idx % DIRECTORY_ARRAY_SIZE) == DirectoryGlobalDepth() &&
+        !GrowDirectory()) {
+      return false;
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::SplitBucket(uint32_t bucket_idx, WritePageGuard *bucket_guard) {
+  auto *bucket = bucket_guard->AsMut<HASH_TABLE_BUCKET_TYPE>();
+  uint32_t local_depth = DirectoryPageOf(bucket_idx)->GetLocalDepth(bucket_idx % DIRECTORY_ARRAY_SIZE);
+  uint32_t high_bit = 1U << local_depth;
+
+  page_id_t image_page_id = INVALID_PAGE_ID;
+  auto image_guard = buffer_pool_manager_->NewPageGuarded(&image_page_id);
+  BUSTUB_ENSURE(image_page_id != INVALID_PAGE_ID, "cannot allocate bucket page");
+  auto *image = image_guard.AsMut<HASH_TABLE_BUCKET_TYPE>();
+  for (uint32_t idx = 0; idx < BUCKET_ARRAY_SIZE && bucket->IsOccupied(idx); idx++) {
+    if (bucket->IsReadable(idx) && (Hash(bucket->KeyAt(idx)) & high_bit) != 0) {
+      image->Insert(bucket->KeyAt(idx), bucket->ValueAt(idx), comparator_, bucket->FingerprintAt(idx));
+      bucket->RemoveAt(idx);
+    }
+  }
+
+  // 新桶填好之后才发布到目录里，其他线程从目录找到它时内容已经完整。桶的槽位可能分布在多个目录页上
+  for (uint32_t idx = bucket_idx & (high_bit - 1); idx < DirectorySize(); idx += high_bit) {
+    auto *dir_page = DirectoryPageOf(idx);
+    dir_page->SetLocalDepth(idx % DIRECTORY_ARRAY_SIZE, local_depth + 1);
+    if ((idx & high_bit) != 0) {
+      dir_page->SetBucketPageId(idx % DIRECTORY_ARRAY_SIZE, image_page_id);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GrowDirectory() -> bool {
+  uint32_t num_pages = directory_pages_.size();
+  if (directory_pages_[0]->Size() < DIRECTORY_ARRAY_SIZE) {
+    directory_pages_[0]->IncrGlobalDepth();
+    return true;
+  }
+  if (num_pages * 2 > DIRECTORY_HEADER_ARRAY_SIZE) {
+    return false;
+  }
+
+  // 目录跨页之后，翻倍就是给每个目录页复制一份
+  auto *header_page = header_guard_.AsMut<HashTableDirectoryHeaderPage>();
+  for (uint32_t i = 0; i < num_pages; i++) {
+    page_id_t directory_page_id = INVALID_PAGE_ID;
+    directory_guards_.emplace_back(buffer_pool_manager_->NewPageGuarded(&directory_page_id));
+    BUSTUB_ENSURE(directory_page_id != INVALID_PAGE_ID, "cannot allocate directory page");
+    auto *dir_page = directory_guards_.back().AsMut<HashTableDirectoryPage>();
+    memcpy(reinterpret_cast<char *>(dir_page), reinterpret_cast<const char *>(directory_pages_[i]), BUSTUB_PAGE_SIZE);
+    dir_page->SetPageId(directory_page_id);
+    directory_pages_.push_back(dir_page);
+    header_page->SetDirectoryPageId(num_pages + i, directory_page_id);
+  }
+  for (auto *dir_page : directory_pages_) {
+    dir_page->IncrGlobalDepth();
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ShrinkDirectory() {
+  auto *header_page = header_guard_.AsMut<HashTableDirectoryHeaderPage>();
+  while (DirectoryGlobalDepth() > 0 &&
+         std::all_of(directory_pages_.begin(), directory_pages_.end(),
+                     [](const HashTableDirectoryPage *dir_page) { return dir_page->CanShrink(); })) {
+    // 后一半目录页和前一半一样，直接丢掉
+    uint32_t num_pages = directory_pages_.size();
+    for (uint32_t i = num_pages / 2; num_pages > 1 && i < num_pages; i++) {
+      page_id_t directory_page_id = directory_pages_[i]->GetPageId();
+      header_page->SetDirectoryPageId(i, INVALID_PAGE_ID);
+      directory_guards_[i].Drop();
+      buffer_pool_manager_->DeletePage(directory_page_id);
+    }
+    if (num_pages > 1) {
+      directory_guards_.resize(num_pages / 2);
+      directory_pages_.resize(num_pages / 2);
+    }
+    for (auto *dir_page : directory_pages_) {
+      dir_page->DecrGlobalDepth();
+    }
+  }
 }
 
 /*****************************************************************************
@@ -90,38 +262,104 @@ auto HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  bool is_empty;
+  {
+    auto header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+    uint32_t bucket_idx;
+    auto bucket_guard = FetchBucketWrite(key, &bucket_idx);
+    header_guard.Drop();
+    auto *bucket = bucket_guard.template AsMut<HASH_TABLE_BUCKET_TYPE>();
+    if (!bucket->Remove(key, value, comparator_, Fingerprint(key))) {
+      return false;
+    }
+    is_empty = bucket->IsEmpty();
+  }
+  if (is_empty) {
+    Merge(transaction, key, value);
+  }
+  return true;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  auto header_guard = buffer_pool_manager_->FetchPageWrite(header_page_id_);
+  // 合并后的桶也可能是空的，继续和它的split image合并
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(key);
+    auto *dir_page = DirectoryPageOf(bucket_idx);
+    uint32_t local_depth = dir_page->GetLocalDepth(bucket_idx % DIRECTORY_ARRAY_SIZE);
+    if (local_depth == 0) {
+      break;
+    }
+    uint32_t image_idx = bucket_idx ^ (1U << (local_depth - 1));
+    auto *image_dir_page = DirectoryPageOf(image_idx);
+    if (image_dir_page->GetLocalDepth(image_idx % DIRECTORY_ARRAY_SIZE) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(bucket_idx % DIRECTORY_ARRAY_SIZE);
+    page_id_t image_page_id = image_dir_page->GetBucketPageId(image_idx % DIRECTORY_ARRAY_SIZE);
+    {
+      // 拿到header排他锁之前进入桶的线程可能还持有桶锁，等它们做完再检查
+      auto bucket_guard = buffer_pool_manager_->FetchPageRead(bucket_page_id);
+      if (!bucket_guard.template As<HASH_TABLE_BUCKET_TYPE>()->IsEmpty()) {
+        break;
+      }
+    }
+
+    // 两个桶的槽位在低local_depth - 1位上相同
+    uint32_t stride = 1U << (local_depth - 1);
+    for (uint32_t idx = bucket_idx & (stride - 1); idx < DirectorySize(); idx += stride) {
+      auto *page = DirectoryPageOf(idx);
+      page->SetBucketPageId(idx % DIRECTORY_ARRAY_SIZE, image_page_id);
+      page->DecrLocalDepth(idx % DIRECTORY_ARRAY_SIZE);
+    }
+    // 没有其他线程能再从目录找到这个桶
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+  }
+  ShrinkDirectory();
+}
 
 /*****************************************************************************
- * GETGLOBALDEPTH - DO NOT TOUCH
+ * GETGLOBALDEPTH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetGlobalDepth() -> uint32_t {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false));
-  table_latch_.RUnlock();
-  return global_depth;
+  auto header_guard = buffer_pool_manager_->FetchPageRead(header_page_id_);
+  return DirectoryGlobalDepth();
 }
 
 /*****************************************************************************
- * VERIFY INTEGRITY - DO NOT TOUCH
+ * VERIFY INTEGRITY
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
-  table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false));
-  table_latch_.RUnlock();
+  // 分裂会在header的共享锁下修改local depth，这里要排他
+  auto header_guard = buffer_pool_manager_->FetchPageWrite(header_page_id_);
+  if (directory_pages_.size() == 1) {
+    directory_pages_[0]->VerifyIntegrity();
+    return;
+  }
+
+  // 跨页的目录：与HashTableDirectoryPage::VerifyIntegrity检查相同的不变式
+  uint32_t global_depth = DirectoryGlobalDepth();
+  std::unordered_map<page_id_t, uint32_t> page_id_to_count;
+  std::unordered_map<page_id_t, uint32_t> page_id_to_ld;
+  for (uint32_t idx = 0; idx < DirectorySize(); idx++) {
+    const auto *dir_page = DirectoryPageOf(idx);
+    BUSTUB_ENSURE(dir_page->GetGlobalDepth() == global_depth, "directory pages disagree on the global depth");
+    page_id_t page_id = dir_page->GetBucketPageId(idx % DIRECTORY_ARRAY_SIZE);
+    uint32_t local_depth = dir_page->GetLocalDepth(idx % DIRECTORY_ARRAY_SIZE);
+    BUSTUB_ENSURE(local_depth <= global_depth, "local depth exceeds global depth");
+    auto [iter, inserted] = page_id_to_ld.emplace(page_id, local_depth);
+    BUSTUB_ENSURE(inserted || iter->second == local_depth, "slots of a bucket disagree on its local depth");
+    ++page_id_to_count[page_id];
+  }
+  for (const auto &[page_id, count] : page_id_to_count) {
+    BUSTUB_ENSURE(count == 1U << (global_depth - page_id_to_ld[page_id]), "wrong number of slots for a bucket");
+  }
 }
 
 /*****************************************************************************
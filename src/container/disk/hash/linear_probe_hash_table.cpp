@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -17,6 +18,7 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "container/disk/hash/linear_probe_hash_table.h"
 
@@ -26,21 +28,138 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  // header页一直pin在缓冲池里；NewPage把页面清零，size和block数都从0开始
+  header_guard_ = buffer_pool_manager_->NewPageGuarded(&header_page_id_);
+  BUSTUB_ENSURE(header_page_id_ != INVALID_PAGE_ID, "cannot allocate header page");
+  header_page_ = header_guard_.AsMut<HashTableHeaderPage>();
+  header_page_->SetPageId(header_page_id_);
+
+  size_t num_blocks = std::clamp<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1,
+                                         HashTableHeaderPage::MAX_BLOCKS);
+  header_page_->SetInitialBlocks(num_blocks);
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t block_page_id = INVALID_PAGE_ID;
+    auto block_guard = buffer_pool_manager_->NewPageGuarded(&block_page_id);
+    BUSTUB_ENSURE(block_page_id != INVALID_PAGE_ID, "cannot allocate block page");
+    block_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>()->Init();
+    header_page_->AddBlockPageId(block_page_id);
+  }
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::HashToBucket(uint64_t hash) const -> size_t {
+  // base = N * 2^L，分裂指针是base之后已经追加的桶数
+  size_t num_blocks = header_page_->NumBlocks();
+  size_t base = header_page_->GetInitialBlocks();
+  while (base * 2 <= num_blocks) {
+    base *= 2;
+  }
+  size_t bucket = hash % base;
+  if (bucket < num_blocks - base) {
+    bucket = hash % (base * 2);
+  }
+  return bucket;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::NeedsSplit() const -> bool {
+  size_t num_blocks = header_page_->NumBlocks();
+  return num_blocks < HashTableHeaderPage::MAX_BLOCKS &&
+         header_page_->GetSize() * 4 > num_blocks * BLOCK_ARRAY_SIZE * 3;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::BucketGetValue(const HASH_TABLE_BLOCK_TYPE *head, const KeyType &key, slot_offset_t start,
+                                     std::vector<ValueType> *result) -> bool {
+  bool found = head->GetValue(key, comparator_, start, result);
+  for (page_id_t page_id = head->GetNextPageId(); page_id != INVALID_PAGE_ID;) {
+    auto guard = buffer_pool_manager_->FetchPageRead(page_id);
+    const auto *block = guard.template As<HASH_TABLE_BLOCK_TYPE>();
+    found = block->GetValue(key, comparator_, start, result) || found;
+    page_id = block->GetNextPageId();
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::BucketInsert(HASH_TABLE_BLOCK_TYPE *head, const KeyType &key, const ValueType &value,
+                                   slot_offset_t start) {
+  auto *block = head;
+  WritePageGuard guard;
+  while (!block->Insert(key, value, start)) {
+    page_id_t next_page_id = block->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      // 所有block都满了，在链尾追加一个溢出页
+      page_id_t new_page_id = INVALID_PAGE_ID;
+      auto new_guard = buffer_pool_manager_->NewPageGuarded(&new_page_id);
+      BUSTUB_ENSURE(new_page_id != INVALID_PAGE_ID, "cannot allocate block page");
+      auto *new_block = new_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+      new_block->Init();
+      new_block->Insert(key, value, start);
+      block->SetNextPageId(new_page_id);
+      return;
+    }
+    guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+    block = guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+  }
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  bool found;
+  table_latch_.RLock();
+  {
+    auto guard = buffer_pool_manager_->FetchPageRead(header_page_->GetBlockPageId(HashToBucket(hash)));
+    found = BucketGetValue(guard.template As<HASH_TABLE_BLOCK_TYPE>(), key, StartSlot(hash), result);
+  }
+  table_latch_.RUnlock();
+  return found;
 }
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  slot_offset_t start = StartSlot(hash);
+  bool inserted = false;
+  bool needs_split = false;
+  table_latch_.RLock();
+  {
+    // 桶的第一个block的锁就是整个桶的锁
+    auto guard = buffer_pool_manager_->FetchPageWrite(header_page_->GetBlockPageId(HashToBucket(hash)));
+    auto *head = guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+    std::vector<ValueType> values;
+    BucketGetValue(head, key, start, &values);
+    if (std::find(values.begin(), values.end(), value) == values.end()) {
+      BucketInsert(head, key, value, start);
+      inserted = true;
+    }
+  }
+  if (inserted) {
+    header_page_->IncrSize(1);
+    needs_split = NeedsSplit();
+  }
+  table_latch_.RUnlock();
+
+  if (needs_split) {
+    // 每次插入最多分裂一个桶，扩容的代价分摊到各次插入上
+    table_latch_.WLock();
+    if (NeedsSplit()) {
+      SplitBucket();
+    }
+    table_latch_.WUnlock();
+  }
+  return inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +167,114 @@ auto HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  uint64_t hash = hash_fn_.GetHash(key);
+  slot_offset_t start = StartSlot(hash);
+  bool removed = false;
+  table_latch_.RLock();
+  {
+    auto head_guard = buffer_pool_manager_->FetchPageWrite(header_page_->GetBlockPageId(HashToBucket(hash)));
+    auto *block = head_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+    WritePageGuard guard;
+    while (true) {
+      removed = block->Remove(key, value, comparator_, start);
+      page_id_t next_page_id = block->GetNextPageId();
+      if (removed || next_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+      block = guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+    }
+  }
+  if (removed) {
+    header_page_->IncrSize(-1);
+  }
+  table_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+auto HASH_TABLE_TYPE::SplitBucket() -> bool {
+  size_t num_blocks = header_page_->NumBlocks();
+  if (num_blocks == HashTableHeaderPage::MAX_BLOCKS) {
+    return false;
+  }
+  size_t base = header_page_->GetInitialBlocks();
+  while (base * 2 <= num_blocks) {
+    base *= 2;
+  }
+  size_t split = num_blocks - base;
+
+  page_id_t image_page_id = INVALID_PAGE_ID;
+  auto image_guard = buffer_pool_manager_->NewPageGuarded(&image_page_id);
+  BUSTUB_ENSURE(image_page_id != INVALID_PAGE_ID, "cannot allocate block page");
+  auto *image = image_guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+  image->Init();
+
+  // 把整条链读出来，清空后按hash % (2 * base)重新分到两个桶里，顺便清掉墓碑
+  auto guard = buffer_pool_manager_->FetchPageWrite(header_page_->GetBlockPageId(split));
+  auto *head = guard.template AsMut<HASH_TABLE_BLOCK_TYPE>();
+  std::vector<MappingType> entries;
+  std::vector<page_id_t> overflow_page_ids;
+  ReadPageGuard overflow_guard;
+  for (const HASH_TABLE_BLOCK_TYPE *block = head;;) {
+    for (slot_offset_t idx = 0; idx < BLOCK_ARRAY_SIZE; idx++) {
+      if (block->IsReadable(idx)) {
+        entries.emplace_back(block->KeyAt(idx), block->ValueAt(idx));
+      }
+    }
+    page_id_t next_page_id = block->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    overflow_page_ids.push_back(next_page_id);
+    overflow_guard = buffer_pool_manager_->FetchPageRead(next_page_id);
+    block = overflow_guard.template As<HASH_TABLE_BLOCK_TYPE>();
+  }
+  overflow_guard.Drop();
+
+  head->Init();
+  for (const auto &[key, value] : entries) {
+    uint64_t hash = hash_fn_.GetHash(key);
+    BucketInsert(hash % (base * 2) == split ? head : image, key, value, StartSlot(hash));
+  }
+  for (page_id_t page_id : overflow_page_ids) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  // 新桶填好之后才加到header里
+  header_page_->AddBlockPageId(image_page_id);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  // 一次只分裂一个桶，两次分裂之间放开表锁让其他操作进来
+  while (true) {
+    table_latch_.WLock();
+    bool done = header_page_->NumBlocks() * BLOCK_ARRAY_SIZE >= 2 * initial_size || !SplitBucket();
+    table_latch_.WUnlock();
+    if (done) {
+      return;
+    }
+  }
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_TYPE::GetSize() -> size_t {
-  return 0;
+  return header_page_->GetSize();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_TYPE::GetNumBuckets() -> size_t {
+  table_latch_.RLock();
+  size_t num_blocks = header_page_->NumBlocks();
+  table_latch_.RUnlock();
+  return num_blocks;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
@@ -11,12 +11,124 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <type_traits>
+#include <vector>
+
+#include "storage/index/var_key.h"
+#include "type/value_factory.h"
+
 namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class IndexScanExecutor::TreeCursor : public IndexScanExecutor::KeyCursor {
+ public:
+  TreeCursor(BPlusTreeIndex<KeyType, ValueType, KeyComparator> *tree, bool reverse)
+      : tree_(tree), iter_(reverse ? tree->GetReverseBeginIterator() : tree->GetBeginIterator()) {}
+
+  auto NextKey(std::vector<RID> *rids, Transaction *txn) -> bool override {
+    while (!iter_.IsEnd()) {
+      const auto &[key, value] = *iter_;
+      key_ = key;
+      if constexpr (std::is_same_v<ValueType, PostingList>) {
+        ++iter_;
+        // 迭代器拷贝出的posting list可能还有溢出页，要在叶子的latch下重新读取整个列表
+        tree_->GetRIDs(key_, rids, txn);
+        if (!rids->empty()) {
+          return true;
+        }
+      } else {
+        rids->push_back(value);
+        ++iter_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  auto KeyValue(Schema *key_schema, uint32_t key_idx) const -> Value override {
+    return key_.ToValue(key_schema, key_idx);
+  }
+
+ private:
+  BPlusTreeIndex<KeyType, ValueType, KeyComparator> *tree_;
+  IndexIterator<KeyType, ValueType, KeyComparator> iter_;
+  KeyType key_;
+};
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto IndexScanExecutor::MakeCursor(Index *index, bool reverse) -> std::unique_ptr<KeyCursor> {
+  auto *tree = dynamic_cast<BPlusTreeIndex<KeyType, ValueType, KeyComparator> *>(index);
+  if (tree == nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<TreeCursor<KeyType, ValueType, KeyComparator>>(tree, reverse);
+}
+
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void IndexScanExecutor::Init() {
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto *index_info = catalog->GetIndex(plan_->GetIndexOid());
+  table_info_ = catalog->GetTable(index_info->table_name_);
+  index_info_ = index_info;
+  rids_.clear();
+  rid_cursor_ = 0;
+  // the B+ tree instantiations CREATE INDEX picks from, see BustubInstance::HandleIndexStatement
+  using MakeCursorFn = std::unique_ptr<KeyCursor> (*)(Index *, bool);
+  const MakeCursorFn make_cursors[] = {
+      MakeCursor<IntegerKeyType, IntegerValueType, IntegerComparatorType>,
+      MakeCursor<IntegerKeyType, PostingList, IntegerComparatorType>,
+      MakeCursor<VarKey<32>, RID, VarKeyComparator<32>>,
+      MakeCursor<VarKey<32>, PostingList, VarKeyComparator<32>>,
+      MakeCursor<VarKey<64>, RID, VarKeyComparator<64>>,
+      MakeCursor<VarKey<64>, PostingList, VarKeyComparator<64>>,
+  };
+  cursor_.reset();
+  for (auto make_cursor : make_cursors) {
+    cursor_ = make_cursor(index_info->index_.get(), plan_->IsReverse());
+    if (cursor_ != nullptr) {
+      break;
+    }
+  }
+  BUSTUB_ENSURE(cursor_ != nullptr, "index scan is only supported on B+ tree indexes");
+}
+
+auto IndexScanExecutor::NextKey() -> bool {
+  rids_.clear();
+  rid_cursor_ = 0;
+  return cursor_->NextKey(&rids_, exec_ctx_->GetTransaction());
+}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (rid_cursor_ < rids_.size() || NextKey()) {
+    RID curr_rid = rids_[rid_cursor_++];
+    if (plan_->IsIndexOnly()) {
+      // every column read above is stored in the index entry, the rest is left NULL
+      const auto &table_schema = GetOutputSchema();
+      std::vector<Value> values;
+      values.reserve(table_schema.GetColumnCount());
+      for (uint32_t col_idx = 0; col_idx < table_schema.GetColumnCount(); col_idx++) {
+        values.push_back(ValueFactory::GetNullValueByType(table_schema.GetColumn(col_idx).GetType()));
+      }
+      const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+      for (uint32_t key_idx = 0; key_idx < key_attrs.size(); key_idx++) {
+        values[key_attrs[key_idx]] = cursor_->KeyValue(index_info_->index_->GetKeySchema(), key_idx);
+      }
+      *tuple = Tuple{values, &table_schema};
+      *rid = curr_rid;
+      return true;
+    }
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+    auto [meta, curr_tuple] = table_info_->table_->GetTuple(curr_rid);
+    if (meta.is_deleted_) {
+      continue;
+    }
+    *tuple = std::move(curr_tuple);
+    *rid = curr_rid;
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
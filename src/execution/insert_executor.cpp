@@ -1,27 +1,113 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// insert_executor.cpp
-//
-// Identification: src/execution/insert_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include <memory>
-
-#include "execution/executors/insert_executor.h"
-
-namespace bustub {
-
-InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
-                               std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
-
-void InsertExecutor::Init() { throw NotImplementedException("InsertExecutor is not implemented"); }
-
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// insert_executor.cpp
+//
+// Identification: src/execution/insert_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/executors/insert_executor.h"
+#include "fmt/format.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
+                               std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void InsertExecutor::Init() {
+  child_executor_->Init();
+  done_ = false;
+}
+
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  done_ = true;
+
+  auto *catalog = exec_ctx_->GetCatalog();
+  auto *txn = exec_ctx_->GetTransaction();
+  auto *table_info = catalog->GetTable(plan_->TableOid());
+  auto indexes = catalog->GetTableIndexes(table_info->name_);
+
+  std::vector<Tuple> rows;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    rows.push_back(child_tuple);
+  }
+
+  // A key of a unique index may neither be in the index nor appear twice among the rows. The rows are checked before
+  // any of them goes to the table heap, so that a failing statement leaves the table and its indexes as they were.
+  for (const auto *index_info : indexes) {
+    if (!index_info->is_unique_) {
+      continue;
+    }
+    const auto &key_attrs = index_info->index_->GetKeyAttrs();
+    std::unordered_set<std::string> keys;
+    std::vector<RID> rids;
+    for (auto &row : rows) {
+      auto key = row.KeyFromTuple(table_info->schema_, index_info->key_schema_, key_attrs);
+      rids.clear();
+      index_info->index_->ScanKey(key, &rids, txn);
+      if (!rids.empty() || !keys.emplace(key.GetData(), key.GetLength()).second) {
+        throw ExecutionException(fmt::format("duplicate key {} in unique index {}",
+                                             key.ToString(&index_info->key_schema_), index_info->name_));
+      }
+    }
+  }
+
+  // Rows go to the table heap in batches, so that a page is filled under one latch, and index keys
+  // are collected and pushed to each index as one batch, so that an index can share its traversals
+  // among the keys of the statement.
+  std::vector<std::vector<std::pair<Tuple, RID>>> index_entries(indexes.size());
+  std::vector<std::pair<TupleMeta, Tuple>> batch;
+  int32_t inserted = 0;
+  auto flush = [&]() {
+    auto rids = table_info->table_->InsertTuples(batch, exec_ctx_->GetLockManager(), txn, table_info->oid_);
+    for (size_t i = 0; i < rids.size(); i++) {
+      auto &child_tuple = batch[i].second;
+      for (size_t idx = 0; idx < indexes.size(); idx++) {
+        const auto *index_info = indexes[idx];
+        index_entries[idx].emplace_back(
+            child_tuple.KeyFromTuple(table_info->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs()),
+            rids[i]);
+      }
+    }
+    inserted += rids.size();
+    batch.clear();
+  };
+
+  for (auto &row : rows) {
+    batch.emplace_back(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, std::move(row));
+    if (batch.size() == INSERT_BATCH_SIZE) {
+      flush();
+    }
+  }
+  flush();
+
+  for (size_t idx = 0; idx < indexes.size(); idx++) {
+    // only a concurrent insert of the same key gets here after the check above
+    if (indexes[idx]->index_->InsertEntries(index_entries[idx], txn) != index_entries[idx].size()) {
+      throw ExecutionException(fmt::format("duplicate key in unique index {}", indexes[idx]->name_));
+    }
+  }
+
+  *tuple = Tuple{{ValueFactory::GetIntegerValue(inserted)}, &GetOutputSchema()};
+  return true;
+}
+
+}  // namespace bustub
@@ -1,23 +1,125 @@
-//===----------------------------------------------------------------------===//
-//
-//                         BusTub
-//
-// seq_scan_executor.cpp
-//
-// Identification: src/execution/seq_scan_executor.cpp
-//
-// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
-//
-//===----------------------------------------------------------------------===//
-
-#include "execution/executors/seq_scan_executor.h"
-
-namespace bustub {
-
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
-
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
-
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
-
-}  // namespace bustub
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// seq_scan_executor.cpp
+//
+// Identification: src/execution/seq_scan_executor.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/seq_scan_executor.h"
+
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+
+namespace bustub {
+
+namespace {
+
+auto IsNumeric(TypeId type) -> bool {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT ||
+         type == TypeId::DECIMAL;
+}
+
+}  // namespace
+
+void SeqScanExecutor::CollectZonePredicates(const AbstractExpressionRef &expr,
+                                            std::vector<ZonePredicate> *predicates) const {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr.get()); logic != nullptr) {
+    if (logic->logic_type_ == LogicType::And) {
+      CollectZonePredicates(logic->GetChildAt(0), predicates);
+      CollectZonePredicates(logic->GetChildAt(1), predicates);
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr.get());
+  if (comparison == nullptr) {
+    return;
+  }
+  // 只认`列 op 常量`和`常量 op 列`，后者把比较反过来
+  bool flipped = false;
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0).get());
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1).get());
+  if (column == nullptr || constant == nullptr) {
+    flipped = true;
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1).get());
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0).get());
+  }
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0) {
+    return;
+  }
+  // 需要类型转换才能比较的常量不用
+  const Value &value = constant->val_;
+  TypeId column_type = GetOutputSchema().GetColumn(column->GetColIdx()).GetType();
+  bool comparable = value.GetTypeId() == column_type || (IsNumeric(value.GetTypeId()) && IsNumeric(column_type));
+  if (value.IsNull() || !comparable) {
+    return;
+  }
+
+  ZoneOp op;
+  switch (comparison->comp_type_) {
+    case ComparisonType::Equal:
+      op = ZoneOp::Equal;
+      break;
+    case ComparisonType::LessThan:
+      op = flipped ? ZoneOp::GreaterThan : ZoneOp::LessThan;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      op = flipped ? ZoneOp::GreaterThanOrEqual : ZoneOp::LessThanOrEqual;
+      break;
+    case ComparisonType::GreaterThan:
+      op = flipped ? ZoneOp::LessThan : ZoneOp::GreaterThan;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      op = flipped ? ZoneOp::LessThanOrEqual : ZoneOp::GreaterThanOrEqual;
+      break;
+    default:
+      return;
+  }
+  predicates->push_back(ZonePredicate{column->GetColIdx(), op, value});
+}
+
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void SeqScanExecutor::Init() {
+  auto *table_info = exec_ctx_->GetCatalog()->GetTable(plan_->GetTableOid());
+  // 先销毁旧的迭代器，结束它登记的扫描
+  iter_.reset();
+  std::vector<ZonePredicate> zone_predicates;
+  if (plan_->filter_predicate_ != nullptr) {
+    CollectZonePredicates(plan_->filter_predicate_, &zone_predicates);
+  }
+  iter_.emplace(table_info->table_->MakeIterator(
+      [this](const TupleMeta &meta, const TupleView &tuple) {
+        if (meta.is_deleted_) {
+          return false;
+        }
+        if (plan_->filter_predicate_ == nullptr) {
+          return true;
+        }
+        auto value = plan_->filter_predicate_->EvaluateView(tuple, GetOutputSchema());
+        return !value.IsNull() && value.GetAs<bool>();
+      },
+      std::move(zone_predicates)));
+}
+
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (iter_->IsEnd()) {
+    return false;
+  }
+  auto [meta, next_tuple] = iter_->GetTuple();
+  *rid = iter_->GetRID();
+  *tuple = std::move(next_tuple);
+  ++*iter_;
+  return true;
+}
+
+}  // namespace bustub
@@ -252,6 +252,13 @@ class Binder {
   /** Sometimes we will need to assign a name to some unnamed items. This variable gives them a universal ID. */
   size_t universal_id_{0};
 
+  /** The query given to `ParseAndSave` and its tokens, with the range of the statement being bound, for the clauses
+   * that the parse tree does not tell apart from their defaults. Only queries that mention an index are tokenized. */
+  std::string query_;
+  std::vector<SimplifiedToken> query_tokens_;
+  size_t statement_begin_{0};
+  size_t statement_end_{0};
+
   duckdb::PostgresParser parser_;
 };
 
@@ -21,11 +21,18 @@ namespace bustub {
 
 class CreateStatement : public BoundStatement {
  public:
-  explicit CreateStatement(std::string table, std::vector<Column> columns);
+  explicit CreateStatement(std::string table, std::vector<Column> columns, std::string format = "row",
+                           std::vector<std::string> dictionary_columns = {});
 
   std::string table_;
   std::vector<Column> columns_;
 
+  /** Storage format given with WITH (format = ...), in lower case ("row" if not specified) */
+  std::string format_;
+
+  /** VARCHAR columns given with WITH (dictionary = ...), whose values are stored as dictionary codes */
+  std::vector<std::string> dictionary_columns_;
+
   auto ToString() const -> std::string override;
 };
 
@@ -21,7 +21,8 @@ namespace bustub {
 class IndexStatement : public BoundStatement {
  public:
   explicit IndexStatement(std::string index_name, std::unique_ptr<BoundBaseTableRef> table,
-                          std::vector<std::unique_ptr<BoundColumnRef>> cols);
+                          std::vector<std::unique_ptr<BoundColumnRef>> cols, std::string index_type,
+                          std::vector<std::unique_ptr<BoundColumnRef>> include_cols = {}, bool unique = false);
 
   /** Name of the index */
   std::string index_name_;
@@ -32,6 +33,15 @@ class IndexStatement : public BoundStatement {
   /** Name of the columns */
   std::vector<std::unique_ptr<BoundColumnRef>> cols_;
 
+  /** Access method given with USING, in lower case ("btree" if not specified) */
+  std::string index_type_;
+
+  /** Non-key columns stored in the index entries, given with WITH (include = 'col, ...') */
+  std::vector<std::unique_ptr<BoundColumnRef>> include_cols_;
+
+  /** CREATE UNIQUE INDEX: at most one row per key; otherwise a key may map to many rows */
+  bool unique_;
+
   auto ToString() const -> std::string override;
 };
 
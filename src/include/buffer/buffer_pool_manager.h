@@ -295,6 +295,14 @@ class BufferPoolManager {
   auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
   auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
 
+  /**
+   * @brief Hint that `page_id` will be fetched soon. If the page is not resident, it is read into a free (or
+   * evicted) frame in the background and left unpinned and evictable, so that a later FetchPage does not have to
+   * wait for the disk. Prefetching never evicts a pinned page and is a no-op if no frame is available.
+   * @param page_id id of the page to prefetch
+   */
+  void PrefetchPage(page_id_t page_id);
+
   /**
    * TODO(P1): Add implementation
    *
@@ -376,6 +384,12 @@ class BufferPoolManager {
    */
   auto AllocatePage() -> page_id_t;
 
+  /**
+   * @brief Load a non-resident page into an unpinned frame, used by PrefetchPage.
+   * @param page_id id of the page to load
+   */
+  void LoadPageUnpinned(page_id_t page_id);
+
   /**
    * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -21,7 +22,9 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/art_index.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/bw_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -35,6 +38,16 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/** The data structures an index can be built on, chosen with CREATE INDEX ... USING */
+enum class IndexType {
+  /** Disk-based B+ tree (USING btree, the default) */
+  BPlusTreeIndex,
+  /** In-memory adaptive radix tree (USING art) */
+  ARTIndex,
+  /** In-memory latch-free Bw-tree (USING bwtree) */
+  BwTreeIndex
+};
+
 /**
  * The TableInfo class maintains metadata about a table.
  */
@@ -70,16 +83,27 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param index_type The data structure of the index
+   * @param include_column_count The number of trailing columns of the key schema that are only stored, not searched
+   * @param is_unique Whether the index keeps one row per key
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, IndexType index_type = IndexType::BPlusTreeIndex,
+            size_t include_column_count = 0, bool is_unique = true)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
-  /** The schema for the index key */
+        key_size_{key_size},
+        index_type_{index_type},
+        include_column_count_{include_column_count},
+        is_unique_{is_unique} {}
+
+  /** @return the number of leading key columns the index is ordered and searched by */
+  auto KeyColumnCount() const -> size_t { return key_schema_.GetColumnCount() - include_column_count_; }
+
+  /** The schema for the index key, followed by the included columns */
   Schema key_schema_;
   /** The name of the index */
   std::string name_;
@@ -91,6 +115,12 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The data structure of the index */
+  const IndexType index_type_;
+  /** The number of columns stored after the key so that scans can skip the table heap */
+  const size_t include_column_count_;
+  /** Whether the index keeps one row per key, inserting a key that is in the index already fails then */
+  const bool is_unique_;
 };
 
 /**
@@ -121,9 +151,12 @@ class Catalog {
    * @param table_name The name of the new table, note that all tables beginning with `__` are reserved for the system.
    * @param schema The schema of the new table
    * @param create_table_heap whether to create a table heap for the new table
+   * @param format how the table heap of the new table stores its tuples
+   * @param dictionary_columns the VARCHAR columns whose values the table heap stores as dictionary codes
    * @return A (non-owning) pointer to the metadata for the table
    */
-  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true)
+  auto CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema, bool create_table_heap = true,
+                   TableFormat format = TableFormat::ROW, const std::vector<uint32_t> &dictionary_columns = {})
       -> TableInfo * {
     if (table_names_.count(table_name) != 0) {
       return NULL_TABLE_INFO;
@@ -136,7 +169,7 @@ class Catalog {
     // When create_table_heap == false, it means that we're running binder tests (where no txn will be provided) or
     // we are running shell without buffer pool. We don't need to create TableHeap in this case.
     if (create_table_heap) {
-      table = std::make_unique<TableHeap>(bpm_);
+      table = std::make_unique<TableHeap>(bpm_, format, schema, dictionary_columns);
     }
 
     // Fetch the table OID for the new table
@@ -196,12 +229,15 @@ class Catalog {
    * @param key_attrs Key attributes
    * @param keysize Size of the key
    * @param hash_function The hash function for the index
+   * @param index_type The data structure of the index; KeyType, ValueType and KeyComparator only apply to B+ trees
+   * @param include_column_count The number of trailing key attributes that are included columns
    * @return A (non-owning) pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   auto CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name, const Schema &schema,
                    const Schema &key_schema, const std::vector<uint32_t> &key_attrs, std::size_t keysize,
-                   HashFunction<KeyType> hash_function) -> IndexInfo * {
+                   HashFunction<KeyType> hash_function, IndexType index_type = IndexType::BPlusTreeIndex,
+                   std::size_t include_column_count = 0) -> IndexInfo * {
     // Reject the creation request for nonexistent table
     if (table_names_.find(table_name) == table_names_.end()) {
       return NULL_INDEX_INFO;
@@ -221,12 +257,18 @@ class Catalog {
     auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs);
 
     // Construct the index, take ownership of metadata
-    // TODO(Kyle): We should update the API for CreateIndex
-    // to allow specification of the index type itself, not
-    // just the key, value, and comparator types
-
-    // TODO(chi): support both hash index and btree index
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    std::unique_ptr<Index> index;
+    switch (index_type) {
+      case IndexType::BPlusTreeIndex:
+        index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+        break;
+      case IndexType::ARTIndex:
+        index = std::make_unique<ARTIndex>(std::move(meta));
+        break;
+      case IndexType::BwTreeIndex:
+        index = std::make_unique<BwTreeIndex>(std::move(meta));
+        break;
+    }
 
     // Populate the index with all tuples in table heap
     auto *table_meta = GetTable(table_name);
@@ -238,9 +280,11 @@ class Catalog {
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
 
-    // Construct index information; IndexInfo takes ownership of the Index itself
+    // Construct index information; IndexInfo takes ownership of the Index itself. Only B+ trees with posting lists
+    // keep several rows per key.
     auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize,
+                                    index_type, include_column_count, !std::is_same_v<ValueType, PostingList>);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -298,7 +342,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -258,6 +258,19 @@ class LockManager {
    */
   auto LockRow(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid) -> bool;
 
+  /**
+   * Acquire locks on a batch of rows of the same table in the given lock_mode, as LockRow does for each of them.
+   * Used by batch inserts, which lock all the new rows of a page at once, so that the table lock can be checked
+   * and row_lock_map_ latched once per batch rather than once per row.
+   *
+   * @param txn the transaction requesting the locks
+   * @param lock_mode the lock mode for the requested locks
+   * @param oid the table_oid_t of the table the rows belong to
+   * @param rids the RIDs of the rows to be locked
+   * @return true if all rows are locked, false otherwise
+   */
+  auto LockRows(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const std::vector<RID> &rids) -> bool;
+
   /**
    * Release the lock held on a row by the transaction.
    *
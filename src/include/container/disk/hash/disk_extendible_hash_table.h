@@ -20,7 +20,9 @@
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_header_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -30,6 +32,19 @@ namespace bustub {
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * The directory grows past a single page: a header page lists the directory pages,
+ * which hold DIRECTORY_ARRAY_SIZE slots each. The header and the directory pages stay
+ * pinned while the table exists, so a lookup only fetches its bucket page. The buffer
+ * pool must outlive the table.
+ *
+ * Latching: the latch of the header page is the latch of the whole directory. Every
+ * operation read latches it, finds its bucket, latches the bucket page and releases
+ * the header, so operations on different buckets run in parallel. A bucket split also
+ * runs under the shared latch: it only rewrites the directory slots of the bucket it
+ * holds write latched, and a thread that looked up a slot before the split re-checks
+ * it once it has the bucket latch. Only doubling the directory and merging buckets
+ * (which may shrink it) take the header latch exclusively.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class DiskExtendibleHashTable {
@@ -94,6 +109,15 @@ class DiskExtendibleHashTable {
    */
   inline auto Hash(KeyType key) -> uint32_t;
 
+  /**
+   * Fingerprint - the 1-byte fingerprint of a key that bucket pages filter slots with.
+   * It comes from the high bits of the 64-bit hash, which the directory never uses.
+   *
+   * @param key the key to hash
+   * @return the fingerprint of the key
+   */
+  inline auto Fingerprint(KeyType key) -> uint8_t;
+
   /**
    * KeyToDirectoryIndex - maps a key to a directory index
    *
@@ -107,34 +131,46 @@ class DiskExtendibleHashTable {
    * representation.
    *
    * @param key the key to use for lookup
-   * @param dir_page to use for lookup of global depth
    * @return the directory index
    */
-  auto KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) -> uint32_t;
+  auto KeyToDirectoryIndex(KeyType key) -> uint32_t;
 
   /**
    * Get the bucket page_id corresponding to a key.
    *
    * @param key the key for lookup
-   * @param dir_page a pointer to the hash table's directory page
    * @return the bucket page_id corresponding to the input key
    */
-  auto KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) -> page_id_t;
+  auto KeyToPageId(KeyType key) -> page_id_t;
+
+  /** @return the global depth of the directory; the caller holds the header latch */
+  auto DirectoryGlobalDepth() -> uint32_t { return directory_pages_[0]->GetGlobalDepth(); }
+
+  /** @return the number of slots of the directory, across all its pages */
+  auto DirectorySize() -> uint32_t { return 1U << DirectoryGlobalDepth(); }
+
+  /** @return the directory page holding slot `bucket_idx` */
+  auto DirectoryPageOf(uint32_t bucket_idx) -> HashTableDirectoryPage * {
+    return directory_pages_[bucket_idx / DIRECTORY_ARRAY_SIZE];
+  }
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * Fetches and read latches the bucket page of a key. The caller holds the header latch
+   * and may release it once the bucket is latched.
    *
-   * @return a pointer to the directory page
+   * @param key the key for lookup
+   * @return a read guard on the bucket page
    */
-  auto FetchDirectoryPage() -> HashTableDirectoryPage *;
+  auto FetchBucketRead(const KeyType &key) -> ReadPageGuard;
 
   /**
-   * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
+   * Fetches and write latches the bucket page of a key, see FetchBucketRead.
    *
-   * @param bucket_page_id the page_id to fetch
-   * @return a pointer to a bucket page
+   * @param key the key for lookup
+   * @param[out] bucket_idx the directory index the bucket was found at
+   * @return a write guard on the bucket page
    */
-  auto FetchBucketPage(page_id_t bucket_page_id) -> HASH_TABLE_BUCKET_TYPE *;
+  auto FetchBucketWrite(const KeyType &key, uint32_t *bucket_idx) -> WritePageGuard;
 
   /**
    * Performs insertion with an optional bucket splitting.
@@ -146,6 +182,27 @@ class DiskExtendibleHashTable {
    */
   auto SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) -> bool;
 
+  /**
+   * Splits a full bucket whose local depth is below the global depth: the entries whose
+   * next hash bit is set move to a new bucket, which takes over half of the directory
+   * slots of the old one. The header only needs to be read latched.
+   *
+   * @param bucket_idx a directory index of the bucket
+   * @param bucket_guard write guard on the bucket
+   */
+  void SplitBucket(uint32_t bucket_idx, WritePageGuard *bucket_guard);
+
+  /**
+   * Doubles the directory. Within a page the new half of the slots copies the old half; past
+   * a single page every directory page gets a copy. The header must be write latched.
+   *
+   * @return false if the directory is at its maximum size
+   */
+  auto GrowDirectory() -> bool;
+
+  /** Halves the directory while no bucket has a local depth equal to the global depth */
+  void ShrinkDirectory();
+
   /**
    * Optionally merges an empty bucket into it's pair.  This is called by Remove,
    * if Remove makes a bucket empty.
@@ -155,6 +212,9 @@ class DiskExtendibleHashTable {
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
    *
+   * A merged bucket that is empty as well is merged again, and the directory shrinks
+   * as far as it can. Runs under the exclusive directory latch.
+   *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
    * @param value the value that was removed
@@ -162,13 +222,16 @@ class DiskExtendibleHashTable {
   void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
 
   // member variables
-  page_id_t directory_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
-
-  // Readers includes inserts and removes, writers are splits and merges
-  ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
+
+  page_id_t header_page_id_;
+  /** Pins of the header page and of the directory pages, in directory order */
+  BasicPageGuard header_guard_;
+  std::vector<BasicPageGuard> directory_guards_;
+  /** The pinned directory pages, in directory order; changes only under the header write latch */
+  std::vector<HashTableDirectoryPage *> directory_pages_;
 };
 
 }  // namespace bustub
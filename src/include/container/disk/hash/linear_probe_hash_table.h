@@ -21,6 +21,7 @@
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -30,6 +31,17 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The table grows by linear hashing instead of rehashing everything at once. A bucket is
+ * a chain of block pages that keys linear probe within; the header lists the buckets.
+ * With N initial buckets, level L and split pointer S, a key goes to bucket
+ * hash % (N * 2^L), or to hash % (N * 2^(L+1)) if that is below S. Once the table is more
+ * than 3/4 full, an insert splits bucket S: it appends bucket S + N * 2^L and moves the
+ * entries of bucket S that hash there. Every split only touches one bucket, so growing a
+ * large table never stalls inserts for longer than rehashing a single bucket. When the
+ * header has no room for more buckets the chains just grow longer.
+ *
+ * The header stays pinned while the table exists. The buffer pool must outlive the table.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable {
@@ -39,7 +51,7 @@ class LinearProbeHashTable {
    *
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
-   * @param num_buckets initial number of buckets contained by this hash table
+   * @param num_buckets initial number of slots contained by this hash table, rounded up to whole blocks
    * @param hash_fn the hash function
    */
   explicit LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
@@ -73,35 +85,66 @@ class LinearProbeHashTable {
   auto GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Grows the table until it has room for at least twice `initial_size` key/value pairs.
+   * Buckets are split one at a time and other operations run between the splits.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
 
   /**
    * Gets the size of the hash table
-   * @return current size of the hash table
+   * @return the number of key/value pairs in the hash table
    */
   auto GetSize() -> size_t;
 
+  /**
+   * @return the number of buckets, i.e. the number of splits so far plus the initial buckets
+   */
+  auto GetNumBuckets() -> size_t;
+
  private:
-  auto GetHeaderPage() -> HashTableHeaderPage *;
-  auto GetBlockPage(page_id_t block_page_id) -> HASH_TABLE_BLOCK_TYPE *;
-  void ResizeInsert(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value);
-  void DeleteBlockPages(HashTableHeaderPage *old_header_page);
-  void CreateNewBlockPages(HashTableHeaderPage *header_page, size_t num_blocks);
-  auto GetValueLatchFree(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) -> bool;
+  /** @return the slot where probing for a key with `hash` starts in each block of its bucket */
+  static auto StartSlot(uint64_t hash) -> slot_offset_t { return (hash >> 32) % BLOCK_ARRAY_SIZE; }
+
+  /** @return the bucket of a key with `hash`; the caller holds the table latch */
+  auto HashToBucket(uint64_t hash) const -> size_t;
+
+  /** @return whether the table is full enough to split a bucket; the caller holds the table latch */
+  auto NeedsSplit() const -> bool;
+
+  /**
+   * Collect the values of `key` from the bucket that starts with `head`.
+   * The caller holds the latch of the head block, which covers the whole chain.
+   */
+  auto BucketGetValue(const HASH_TABLE_BLOCK_TYPE *head, const KeyType &key, slot_offset_t start,
+                      std::vector<ValueType> *result) -> bool;
+
+  /**
+   * Insert into the bucket that starts with `head`, appending an overflow block if every block
+   * is full. The caller holds the write latch of the head block and checked for duplicates.
+   */
+  void BucketInsert(HASH_TABLE_BLOCK_TYPE *head, const KeyType &key, const ValueType &value, slot_offset_t start);
+
+  /**
+   * Split the bucket at the split pointer and advance it.
+   * The caller holds the table latch exclusively.
+   * @return false if the header has no room for another bucket
+   */
+  auto SplitBucket() -> bool;
 
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // Readers includes inserts and removes, writer is only a bucket split
   ReaderWriterLatch table_latch_;
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  BasicPageGuard header_guard_;
+  HashTableHeaderPage *header_page_;
 };
 
 }  // namespace bustub
@@ -12,12 +12,14 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -42,7 +44,48 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** A position in a B+ tree index, hiding which key and value types the index is instantiated with */
+  class KeyCursor {
+   public:
+    virtual ~KeyCursor() = default;
+
+    /**
+     * Move to the next key of the index and append the RIDs of its rows to `rids`.
+     * @return false if the index is exhausted
+     */
+    virtual auto NextKey(std::vector<RID> *rids, Transaction *txn) -> bool = 0;
+
+    /** @return the column `key_idx` of the current key */
+    virtual auto KeyValue(Schema *key_schema, uint32_t key_idx) const -> Value = 0;
+  };
+
+  template <typename KeyType, typename ValueType, typename KeyComparator>
+  class TreeCursor;
+
+  /** @return a cursor at the first (or last) key of `index`, nullptr if it is not a B+ tree of these types */
+  template <typename KeyType, typename ValueType, typename KeyComparator>
+  static auto MakeCursor(Index *index, bool reverse) -> std::unique_ptr<KeyCursor>;
+
+  /**
+   * Move to the next key of the index and collect its RIDs in rids_.
+   * @return false if the index is exhausted
+   */
+  auto NextKey() -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+
+  /** The table the index is built on */
+  TableInfo *table_info_{nullptr};
+
+  /** The index being scanned, whose entries build the output of an index-only scan */
+  const IndexInfo *index_info_{nullptr};
+
+  /** Current position in the index, created in Init() */
+  std::unique_ptr<KeyCursor> cursor_;
+
+  /** The RIDs of the rows of the current key that are not returned yet */
+  std::vector<RID> rids_;
+  size_t rid_cursor_{0};
 };
 }  // namespace bustub
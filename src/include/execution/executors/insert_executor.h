@@ -55,8 +55,15 @@ class InsertExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
+  /** Number of rows handed to the table heap at once */
+  static constexpr size_t INSERT_BATCH_SIZE = 128;
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /** The child executor from which inserted tuples are pulled */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** Whether the number of inserted rows has been produced */
+  bool done_{false};
 };
 
 }  // namespace bustub
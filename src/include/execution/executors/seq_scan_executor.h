@@ -12,17 +12,24 @@
 
 #pragma once
 
+#include <optional>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * Deleted tuples and tuples that fail the filter predicate of the plan are rejected by the filter
+ * of the table iterator, which reads them in the page without copying them. The comparisons of a
+ * column with a constant that the predicate is a conjunction of are also given to the iterator as
+ * zone predicates, so that it skips the pages whose zone map rules them out.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -48,7 +55,13 @@ class SeqScanExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** Add the comparisons of a column with a constant that `expr` is a conjunction of to `predicates` */
+  void CollectZonePredicates(const AbstractExpressionRef &expr, std::vector<ZonePredicate> *predicates) const;
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+
+  /** Current position in the table, created in Init() */
+  std::optional<TableIterator> iter_;
 };
 }  // namespace bustub
@@ -54,6 +54,15 @@ class AbstractExpression {
   /** @return The value obtained by evaluating the tuple with the given schema */
   virtual auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value = 0;
 
+  /**
+   * Evaluate the expression on a tuple that is not copied out of its page. The built-in expressions read the view
+   * directly; the default copies it into a Tuple and calls Evaluate.
+   */
+  virtual auto EvaluateView(const TupleView &tuple, const Schema &schema) const -> Value {
+    auto copy = tuple.ToTuple();
+    return Evaluate(&copy, schema);
+  }
+
   /**
    * Returns the value obtained by evaluating a JOIN.
    * @param left_tuple The left tuple
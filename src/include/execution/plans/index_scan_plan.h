@@ -29,9 +29,11 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param reverse whether to scan in descending key order
+   * @param index_only whether to build the output tuples from the index entries without reading the table heap
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, bool reverse = false, bool index_only = false)
+      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid), reverse_(reverse), index_only_(index_only) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
@@ -40,14 +42,27 @@ class IndexScanPlanNode : public AbstractPlanNode {
 
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
+  /** @return whether the index should be scanned in descending key order */
+  auto IsReverse() const -> bool { return reverse_; }
+
+  /** @return whether the scan reads only the index; columns not stored in the index come out as NULL */
+  auto IsIndexOnly() const -> bool { return index_only_; }
+
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
+  /** Scan the index backwards, used to serve ORDER BY ... DESC */
+  bool reverse_;
+
+  /** Every column the plan above reads is stored in the index, set by the index-only scan rule */
+  bool index_only_;
+
   // Add anything you want here for index lookup
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    return fmt::format("IndexScan {{ index_oid={}{}{} }}", index_oid_, reverse_ ? ", reverse=true" : "",
+                       index_only_ ? ", index_only=true" : "");
   }
 };
 
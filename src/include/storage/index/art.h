@@ -0,0 +1,174 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art.h
+//
+// Identification: src/include/storage/index/art.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "common/rid.h"
+#include "storage/index/epoch_manager.h"
+
+namespace bustub {
+
+/**
+ * AdaptiveRadixTree is an in-memory radix tree over byte-string keys (Leis et al., "The Adaptive
+ * Radix Tree: ARTful Indexing for Main-Memory Databases"). It never goes through the buffer pool.
+ *
+ * Inner nodes pick one of four layouts depending on their fan-out and grow into the next one
+ * when they fill up:
+ *  - Node4 / Node16: sorted arrays of key bytes and child pointers
+ *  - Node48: a 256-entry byte index into 48 child pointers
+ *  - Node256: 256 child pointers
+ * Every inner node stores the bytes shared by all keys below it (path compression). Leaves
+ * store the full key and the value, and are told apart from inner nodes by a tag bit in the
+ * child pointer.
+ *
+ * Keys must be prefix-free: no key may be a proper prefix of another one. The memcomparable
+ * encoding used by VarKey has this property, and it also makes the byte order of the tree the
+ * order of the key values, so range scans return keys in order.
+ *
+ * Synchronization uses optimistic lock coupling (Leis et al., "The ART of Practical
+ * Synchronization"): every inner node has a version word with a lock bit and an obsolete bit.
+ * Readers never write to shared memory; they read a node, then check that its version did not
+ * change and restart from the root otherwise. Writers lock only the nodes they modify (the
+ * node, and its parent when the node is replaced). Replaced nodes are marked obsolete, and they
+ * and removed leaves are handed to an EpochManager, which frees them once no operation that
+ * could still be looking at them is running.
+ */
+class AdaptiveRadixTree {
+ public:
+  /** Keys longer than this are rejected; compressed paths are stored inline up to this size */
+  static constexpr size_t MAX_KEY_SIZE = 64;
+
+  AdaptiveRadixTree();
+  ~AdaptiveRadixTree();
+
+  AdaptiveRadixTree(const AdaptiveRadixTree &) = delete;
+  auto operator=(const AdaptiveRadixTree &) -> AdaptiveRadixTree & = delete;
+
+  /**
+   * Insert a key/value pair.
+   * @return false if the key already exists
+   * @throw Exception if the key is longer than MAX_KEY_SIZE
+   */
+  auto Insert(std::string_view key, const RID &value) -> bool;
+
+  /**
+   * Remove a key.
+   * @return false if the key does not exist
+   */
+  auto Remove(std::string_view key) -> bool;
+
+  /**
+   * Look up a key.
+   * @param[out] value the value associated with `key`, if found
+   * @return true if the key exists
+   */
+  auto GetValue(std::string_view key, RID *value) const -> bool;
+
+  /**
+   * Collect the values of every key in [low, high], in key order.
+   */
+  void ScanRange(std::string_view low, std::string_view high, std::vector<RID> *result) const;
+
+ private:
+  enum class NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256 };
+
+  struct Leaf {
+    std::string key_;
+    RID value_;
+  };
+
+  /** Header shared by the four inner node layouts */
+  struct Node {
+    explicit Node(NodeType type) : type_(type) {}
+
+    /** bit 0: obsolete, bit 1: locked, the rest counts the modifications */
+    std::atomic<uint64_t> version_{0};
+    NodeType type_;
+    uint16_t count_{0};
+    /** Length of the compressed path; readers may see a torn value and clamp it before validating */
+    uint32_t prefix_size_{0};
+    uint8_t prefix_[MAX_KEY_SIZE];
+
+    auto Prefix() const -> std::string_view {
+      return {reinterpret_cast<const char *>(prefix_), std::min<size_t>(prefix_size_, MAX_KEY_SIZE)};
+    }
+    void SetPrefix(std::string_view prefix);
+  };
+
+  struct Node4;
+  struct Node16;
+  struct Node48;
+  struct Node256;
+
+  /** A child is either an inner node or a leaf with the lowest pointer bit set */
+  using Child = uintptr_t;
+
+  static auto IsLeaf(Child child) -> bool { return (child & 1) != 0; }
+  static auto AsLeaf(Child child) -> Leaf * { return reinterpret_cast<Leaf *>(child & ~static_cast<Child>(1)); }
+  static auto AsNode(Child child) -> Node * { return reinterpret_cast<Node *>(child); }
+  static auto FromLeaf(Leaf *leaf) -> Child { return reinterpret_cast<Child>(leaf) | 1; }
+  static auto FromNode(Node *node) -> Child { return reinterpret_cast<Child>(node); }
+
+  // optimistic lock coupling primitives, `restart` is set when the caller must restart from the root
+  static auto ReadLockOrRestart(const Node *node, bool *restart) -> uint64_t;
+  static void CheckOrRestart(const Node *node, uint64_t version, bool *restart);
+  static void UpgradeToWriteLockOrRestart(Node *node, uint64_t version, bool *restart);
+  static void WriteUnlock(Node *node);
+  static void WriteUnlockObsolete(Node *node);
+
+  // node layout helpers, the caller synchronizes
+  static auto FindChild(const Node *node, uint8_t byte) -> Child;
+  static auto IsFull(const Node *node) -> bool;
+  static void AddChild(Node *node, uint8_t byte, Child child);
+  static void ReplaceChild(Node *node, uint8_t byte, Child child);
+  static void RemoveChild(Node *node, uint8_t byte);
+  /** @return the children of `node` in key byte order */
+  static auto Children(const Node *node) -> std::vector<std::pair<uint8_t, Child>>;
+  /** @return a copy of `node` in the next larger layout */
+  static auto Grow(const Node *node) -> Node *;
+  static auto NewNode4(std::string_view prefix) -> Node *;
+  static void FreeNode(Node *node);
+  static void FreeSubtree(Child child);
+  /** Deleters for EpochManager::Retire */
+  static void DeleteNode(void *node);
+  static void DeleteLeaf(void *leaf);
+
+  // one optimistic attempt of the public operations, `restart` is set if it has to be retried
+  auto InsertOnce(std::string_view key, const RID &value, bool *restart) -> bool;
+  auto RemoveOnce(std::string_view key, bool *restart) -> bool;
+  auto GetValueOnce(std::string_view key, RID *value, bool *restart) const -> bool;
+
+  /**
+   * Scan the subtree of `child`, whose keys all start with `path`, for keys in [low, high].
+   * @return false if a concurrent modification was detected and the scan must restart
+   */
+  auto ScanSubtree(Child child, std::string *path, std::string_view low, std::string_view high,
+                   std::vector<RID> *result) const -> bool;
+
+  /** Free a node (or leaf) that was unlinked from the tree once no reader can reach it any more */
+  void Retire(Node *node);
+  void Retire(Leaf *leaf);
+
+  /** The root is a Node256 with an empty prefix that is never replaced */
+  Node *root_;
+
+  /** Every public operation runs inside an epoch so that retired memory outlives its readers */
+  mutable EpochManager epoch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/index/art.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * ARTIndex keeps its entries in an in-memory adaptive radix tree, so lookups never go through
+ * the buffer pool. The tree is not persisted: the catalog fills it from the table heap when the
+ * index is created, like every other index.
+ *
+ * Index keys are stored in the memcomparable encoding of VarKey, which keeps them in key order
+ * and supports keys of any column type up to AdaptiveRadixTree::MAX_KEY_SIZE encoded bytes.
+ * Only unique keys are supported.
+ */
+class ARTIndex : public Index {
+ public:
+  explicit ARTIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  ~ARTIndex() override = default;
+
+  auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Search the index for every key in [low_key, high_key].
+   * @param result The collection of RIDs that is populated with results of the search, in key order
+   */
+  void ScanRange(const Tuple &low_key, const Tuple &high_key, std::vector<RID> *result, Transaction *transaction);
+
+ private:
+  auto EncodeKey(const Tuple &key) const -> std::string;
+
+  AdaptiveRadixTree tree_;
+};
+
+}  // namespace bustub
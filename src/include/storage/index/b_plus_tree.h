@@ -3,7 +3,7 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the values are posting lists (see PostingList)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
@@ -11,21 +11,30 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <deque>
 #include <iostream>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
+#include "storage/index/posting_list.h"
 #include "storage/page/b_plus_tree_header_page.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_var_internal_page.h"
+#include "storage/page/b_plus_tree_var_leaf_page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
@@ -56,6 +65,56 @@ class Context {
   auto IsRootPage(page_id_t page_id) -> bool { return page_id == root_page_id_; }
 };
 
+/**
+ * How readers (GetValue and iterator construction) synchronize with concurrent writers.
+ * Writers always descend with latch crabbing and keep high keys and right links up to date,
+ * so the mode can be chosen per tree instance without changing the on-disk format.
+ */
+enum class BPlusTreeLatchMode {
+  /** Readers couple read latches from the header page down to the leaf. */
+  CRABBING,
+  /**
+   * B-link traversal: readers hold a single latch at a time and never latch a parent while
+   * latching its child. A reader that arrives at a page after a concurrent split moves right
+   * through the sibling link until the page's high key covers the search key.
+   */
+  BLINK
+};
+
+/**
+ * What Remove does to the structure of the tree.
+ */
+enum class BPlusTreeDeleteMode {
+  /**
+   * A page that falls below half full is merged with a sibling right away, while Remove still holds the
+   * latches of the ancestors the merge changes.
+   */
+  EAGER,
+  /**
+   * Remove only takes the entry out of its leaf, latching one page at a time on the way down, and leaves
+   * underfull pages alone. Compact, run by hand or by the compaction thread, merges them later.
+   */
+  LAZY
+};
+
+/**
+ * Shape of a B+ tree, as reported by GetStats. The pages are read one at a time, so under concurrent
+ * changes the numbers are an approximation.
+ */
+struct BPlusTreeStats {
+  int height_{0};
+  size_t leaf_pages_{0};
+  size_t internal_pages_{0};
+  size_t entries_{0};
+  /** Average fraction of the max size in use, over the leaf and the internal pages respectively */
+  double leaf_fill_factor_{0};
+  double internal_fill_factor_{0};
+  /** Pages retired by merges and root collapses since the tree was created */
+  size_t retired_pages_{0};
+  /** Retired pages given back to the buffer pool through DeletePage */
+  size_t reclaimed_pages_{0};
+};
+
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
 // Main class providing the API for the Interactive B+ Tree.
@@ -66,24 +125,60 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                     const KeyComparator &comparator, int leaf_max_size = LEAF_PAGE_SIZE,
-                     int internal_max_size = INTERNAL_PAGE_SIZE);
+                     const KeyComparator &comparator, int leaf_max_size = LeafPage::DEFAULT_MAX_SIZE,
+                     int internal_max_size = InternalPage::DEFAULT_MAX_SIZE,
+                     BPlusTreeLatchMode latch_mode = BPlusTreeLatchMode::CRABBING,
+                     BPlusTreeDeleteMode delete_mode = BPlusTreeDeleteMode::EAGER);
+
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
 
-  // Insert a key-value pair into this B+ tree.
+  // Insert a key-value pair into this B+ tree. If the values are posting lists, inserting an existing
+  // key merges the RIDs of `value` into the list of the key instead of failing.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
 
-  // Remove a key and its value from this B+ tree.
+  // Insert a batch of key-value pairs, sorted internally so that keys sharing a leaf are inserted
+  // under one traversal. Returns the number of pairs inserted; duplicate keys are skipped.
+  auto InsertBatch(std::vector<std::pair<KeyType, ValueType>> entries, Transaction *txn = nullptr) -> size_t;
+
+  // Remove a key and its value from this B+ tree. Whether underfull pages are merged right away depends
+  // on the delete mode of the tree.
   void Remove(const KeyType &key, Transaction *txn);
 
+  // Remove one RID of a key; the key itself goes once no RID is left. For unique trees this
+  // removes the key if its value is `rid`. Pages are merged as in Remove. Returns false if the
+  // pair was not found.
+  auto RemoveRID(const KeyType &key, const RID &rid, Transaction *txn = nullptr) -> bool;
+
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
 
+  // Return the RIDs associated with a given key, reading the whole posting list (overflow pages
+  // included) under the leaf latch if the values are posting lists
+  auto GetRIDs(const KeyType &key, std::vector<RID> *result, Transaction *txn = nullptr) -> bool;
+
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  /**
+   * @brief Merge underfull sibling pages bottom-up, shrink the tree while the root has a single child, and
+   * give the retired pages back to the buffer pool. Runs concurrently with readers and writers; each merge
+   * only latches a parent and the two children it merges.
+   *
+   * @return the number of pages retired
+   */
+  auto Compact() -> size_t;
+
+  // Run Compact in a background thread every `interval`, until StopCompaction or the tree is destroyed
+  void StartCompaction(std::chrono::milliseconds interval);
+
+  void StopCompaction();
+
+  // Walk the tree level by level and report its height, page counts and fill factors
+  auto GetStats() -> BPlusTreeStats;
+
   // Index iterator
   auto Begin() -> INDEXITERATOR_TYPE;
 
@@ -91,6 +186,18 @@ class BPlusTree {
 
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  // Iterate over [key, end_key] in ascending order
+  auto Begin(const KeyType &key, const KeyType &end_key) -> INDEXITERATOR_TYPE;
+
+  // Reverse index iterator, starting from the largest key
+  auto RBegin() -> INDEXITERATOR_TYPE;
+
+  // Reverse index iterator, starting from the largest key that is not greater than `key`
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
+
+  // Iterate over [end_key, key] in descending order
+  auto RBegin(const KeyType &key, const KeyType &end_key) -> INDEXITERATOR_TYPE;
+
   // Print the B+ tree
   void Print(BufferPoolManager *bpm);
 
@@ -117,22 +224,141 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *txn = nullptr);
 
  private:
-  enum FindLeafRetType { EmptyTree = 0, NotExist, Success };
+  /**
+   * @brief Descend from the root to the leaf that may contain `key`, coupling read latches
+   * on the way down.
+   *
+   * @return read guard of the leaf, std::nullopt if the tree is empty
+   */
+  auto FindLeafRead(const KeyType &key) -> std::optional<ReadPageGuard>;
+
+  /**
+   * @brief B-link version of FindLeafRead: only one page is latched at any time, and the
+   * search moves right whenever `key` is at or beyond the high key of the current page.
+   */
+  auto FindLeafReadBLink(const KeyType &key) -> std::optional<ReadPageGuard>;
+
+  /**
+   * @brief Descend to the left-most or right-most leaf of the tree.
+   *
+   * @return read guard of the leaf, std::nullopt if the tree is empty
+   */
+  auto FindEdgeLeafRead(bool rightmost) -> std::optional<ReadPageGuard>;
+
+  /**
+   * @brief Read-latch the current root without touching the header page. The cached root id is
+   * checked again after the root is latched; since changing the root requires a write latch on
+   * the old root, an unchanged cache means the latched page is still the root.
+   *
+   * @return read guard of the root, std::nullopt if the tree is empty
+   */
+  auto FetchRootRead() -> std::optional<ReadPageGuard>;
+
+  /**
+   * @brief Install a new root: write it to the header page, whose write latch must be held in
+   * `ctx`, and publish it in the cached root state with a new version.
+   */
+  void SetRootPageId(page_id_t root_page_id, Context &ctx);
+
+  auto MakeIterator(const KeyType *key, std::optional<KeyType> stop_key, bool reverse) -> INDEXITERATOR_TYPE;
 
   /**
-   * @brief Insert a key into a leaf page and do spliting
+   * @brief Fast path for append-style inserts: insert straight into the cached right-most leaf,
+   * skipping the traversal from the root. The hint is trusted only if the page is still a leaf with
+   * the version it had when cached, still has no right sibling, its first key is not greater than
+   * `key`, and the insert cannot split it.
    *
-   * @param leaf_page_id
-   * @param ctx context of inserting
-   * @return successful
+   * @return std::nullopt if the hint cannot be used, otherwise the result of the insert
    */
-  auto InsertAndSplitLeaf(const page_id_t leaf_page_id, const KeyType &key, const ValueType &value, Context &ctx)
-      -> bool;
+  auto InsertIntoLastLeaf(const KeyType &key, const ValueType &value) -> std::optional<bool>;
 
-  auto InsertAndSplitInternal(const page_id_t internal_page_id, const page_id_t lower_range_id, const KeyType &key,
-                              const page_id_t upper_range_id, Context &ctx) -> bool;
+  /**
+   * @brief Descend to the leaf of `entries[0]` and insert the longest prefix of the sorted `entries`
+   * that belongs to that leaf, splitting the leaf at most once.
+   *
+   * @param[out] inserted incremented by the number of entries inserted
+   * @return the number of entries consumed, at least one
+   */
+  auto InsertRun(const MappingType *entries, size_t count, size_t *inserted) -> size_t;
 
-  auto FindLeafPageWithKey(const KeyType &key, page_id_t &leaf_page_id, Context &ctx) const -> FindLeafRetType;
+  /**
+   * @brief Insert into a leaf that has room for one more entry. A duplicate key is rejected by unique
+   * trees, and merged into the existing entry when the values are posting lists.
+   *
+   * @return true if the leaf changed
+   */
+  auto InsertIntoLeaf(LeafPage *leaf_page, const KeyType &key, const ValueType &value) -> bool;
+
+  // Split the full leaf at the back of `ctx.write_set_`; `key` is the key whose insertion filled it
+  void SplitLeaf(const KeyType &key, Context &ctx);
+
+  // Remember the leaf at `page_id` as the right-most leaf of the tree
+  void SetLastLeafHint(page_id_t page_id, const LeafPage *leaf_page);
+
+  /**
+   * @brief Insert the separator of a split into the parent of `left_page_id`, splitting the parent
+   * (and its ancestors) as needed. The write guard of the split page must be at the back of
+   * `ctx.write_set_`, preceded by the guards of its still latched ancestors.
+   */
+  void InsertIntoParent(page_id_t left_page_id, const KeyType &key, page_id_t right_page_id, Context &ctx);
+
+  // A page is safe when the pending operation cannot propagate a split above it
+  auto IsSafeForInsert(const BPlusTreePage *page) const -> bool;
+
+  // Release every latch held above the page at the back of the write set
+  void ReleaseAncestors(Context &ctx);
+
+  /**
+   * @brief Write-latch the leaf of `key` for a change that never splits or merges it: every latch above
+   * the leaf is released as soon as the child is latched.
+   *
+   * @return write guard of the leaf, std::nullopt if the tree is empty
+   */
+  auto FindLeafWrite(const KeyType &key) -> std::optional<WritePageGuard>;
+
+  /**
+   * @brief Shared body of Remove and RemoveRID. With `rid` set only that RID is taken out of the value of
+   * `key`, and the entry goes once no RID is left; without it the whole entry goes. Dropping an entry
+   * merges underfull pages right away in EAGER mode.
+   *
+   * @return false if the key (or the RID) was not found
+   */
+  auto RemoveEntry(const KeyType &key, const RID *rid) -> bool;
+
+  // A page is safe when removing one entry cannot make it underfull, so it will not be merged
+  auto IsSafeForRemove(const BPlusTreePage *page, bool is_root) const -> bool;
+
+  auto IsUnderfull(const BPlusTreePage *page) const -> bool;
+
+  /**
+   * @brief Merge the child at `index + 1` of the write latched parent into the child at `index`, if one of
+   * them is underfull and together they fit into one page. The right child is retired: it forwards to the
+   * left one and goes to the reclaim list.
+   *
+   * @return true if the children were merged
+   */
+  auto MergeChildren(WritePageGuard &parent_guard, int index) -> bool;
+
+  // Compact the subtree under the internal page `page_id`, returning the number of pages retired
+  auto CompactSubtree(page_id_t page_id) -> size_t;
+
+  /**
+   * @brief Make the only child of an internal root the new root, repeatedly. The header page's write latch
+   * must be held in `ctx`, and no page of the tree.
+   *
+   * @return the number of roots retired
+   */
+  auto CollapseRoot(Context &ctx) -> size_t;
+
+  // Put a retired page on the reclaim list
+  void RetirePage(page_id_t page_id);
+
+  /**
+   * @brief Delete the retired pages from the buffer pool. A page is flushed first, since page ids are never
+   * reused: a reader still holding the id fetches the dead page from disk and is forwarded from there.
+   * Pages that are pinned right now stay on the list for the next call.
+   */
+  void ReclaimPages();
 
   /* Debug Routines for FREE!! */
   void ToGraph(page_id_t page_id, const BPlusTreePage *page, std::ofstream &out);
@@ -154,7 +380,40 @@ class BPlusTree {
   std::vector<std::string> log;  // NOLINT
   int leaf_max_size_;
   int internal_max_size_;
+  BPlusTreeLatchMode latch_mode_;
+  BPlusTreeDeleteMode delete_mode_;
   page_id_t header_page_id_;  // 存放root_page_id的page
+
+  /**
+   * Cached copy of the root page id in the low 32 bits, and a version bumped on every root change
+   * in the high 32 bits. Only written while holding the header page's write latch, so that readers
+   * and writers that do not change the root never latch the header page.
+   */
+  std::atomic<uint64_t> root_state_;
+
+  /** Cached location of the right-most leaf, see InsertIntoLastLeaf */
+  struct LastLeafHint {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    // 缓存时的页面版本
+    uint32_t version_{0};
+    // 缓存时叶子结点的第一个key，更小的key不用锁页面就可以放弃快速路径
+    KeyType low_key_;
+  };
+  std::mutex hint_latch_;
+  LastLeafHint last_leaf_hint_;
+
+  /** Retired pages waiting to be deleted from the buffer pool, see ReclaimPages */
+  std::mutex reclaim_latch_;
+  std::vector<page_id_t> pending_reclaim_;
+  std::atomic<size_t> retired_pages_{0};
+  std::atomic<size_t> reclaimed_pages_{0};
+
+  /** Only one Compact pass runs at a time */
+  std::mutex compact_latch_;
+  std::mutex compaction_thread_latch_;
+  std::condition_variable compaction_cv_;
+  bool stop_compaction_{false};
+  std::thread compaction_thread_;
 };
 
 /**
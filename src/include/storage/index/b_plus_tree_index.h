@@ -14,11 +14,13 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/index/posting_list.h"
 
 namespace bustub {
 
@@ -31,14 +33,25 @@ class BPlusTreeIndex : public Index {
 
   auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
 
+  auto InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) -> size_t override;
+
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /** Append all RIDs of `key` to `result`; with posting list values this reads the whole list under the leaf latch */
+  void GetRIDs(const KeyType &key, std::vector<RID> *result, Transaction *transaction = nullptr);
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
 
+  auto GetBeginIterator(const KeyType &key, const KeyType &end_key) -> INDEXITERATOR_TYPE;
+
+  auto GetReverseBeginIterator() -> INDEXITERATOR_TYPE;
+
+  auto GetReverseBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
+
   auto GetEndIterator() -> INDEXITERATOR_TYPE;
 
  protected:
@@ -57,6 +70,10 @@ using IntegerComparatorType = GenericComparator<TWO_INTEGER_SIZE>;
 using BPlusTreeIndexForTwoIntegerColumn = BPlusTreeIndex<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
 using BPlusTreeIndexIteratorForTwoIntegerColumn =
     IndexIterator<IntegerKeyType, IntegerValueType, IntegerComparatorType>;
+/** The index CREATE INDEX builds when it is not UNIQUE: one entry per distinct key with the RIDs in a posting list */
+using NonUniqueBPlusTreeIndexForTwoIntegerColumn = BPlusTreeIndex<IntegerKeyType, PostingList, IntegerComparatorType>;
+using NonUniqueBPlusTreeIndexIteratorForTwoIntegerColumn =
+    IndexIterator<IntegerKeyType, PostingList, IntegerComparatorType>;
 using IntegerHashFunctionType = HashFunction<IntegerKeyType>;
 
 }  // namespace bustub
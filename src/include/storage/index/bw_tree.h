@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree.h
+//
+// Identification: src/include/storage/index/bw_tree.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "common/rid.h"
+#include "storage/index/epoch_manager.h"
+
+namespace bustub {
+
+/**
+ * BwTree is a latch-free in-memory B+ tree over byte-string keys (Levandoski et al., "The Bw-Tree:
+ * A B-tree for New Hardware Platforms"). Like AdaptiveRadixTree it never goes through the buffer
+ * pool, and keys compare bytewise, so the memcomparable VarKey encoding keeps them in key order.
+ *
+ * Nodes are never modified in place. Every node has a logical id, and the mapping table maps the
+ * id to the newest record of the node. A modification prepends a delta record (insert, delete,
+ * split, index entry) to the chain of the node and installs it with a single compare-and-swap on
+ * the mapping table entry; a thread that loses the race retries. So writers on a hot node never
+ * block each other or the readers, which is the point compared to the latched BPlusTree.
+ *
+ * Long delta chains are consolidated into a new base node. Nodes that grow too large are split
+ * in two steps, B-link style: a split delta on the node redirects keys above the separator to the
+ * new right sibling, then an index entry delta is posted to the parent. Replaced chains are
+ * retired to an EpochManager and freed once no thread can still be reading them.
+ *
+ * Only unique keys are supported. Nodes are not merged when they become sparse.
+ */
+class BwTree {
+ public:
+  /** Logical node id, an index into the mapping table */
+  using NodeId = uint32_t;
+
+  static constexpr size_t DEFAULT_LEAF_MAX_SIZE = 128;
+  static constexpr size_t DEFAULT_INNER_MAX_SIZE = 128;
+  static constexpr size_t DEFAULT_MAX_CHAIN_LENGTH = 8;
+  static constexpr size_t DEFAULT_MAPPING_TABLE_SIZE = 1 << 20;
+
+  /**
+   * @param leaf_max_size a leaf is split when it holds more entries than this
+   * @param inner_max_size an inner node is split when it has more children than this
+   * @param max_chain_length a delta chain is consolidated when it gets this long
+   * @param mapping_table_size the maximal number of nodes; node ids are not reused
+   */
+  explicit BwTree(size_t leaf_max_size = DEFAULT_LEAF_MAX_SIZE, size_t inner_max_size = DEFAULT_INNER_MAX_SIZE,
+                  size_t max_chain_length = DEFAULT_MAX_CHAIN_LENGTH,
+                  size_t mapping_table_size = DEFAULT_MAPPING_TABLE_SIZE);
+  ~BwTree();
+
+  BwTree(const BwTree &) = delete;
+  auto operator=(const BwTree &) -> BwTree & = delete;
+
+  /**
+   * Insert a key/value pair.
+   * @return false if the key already exists
+   * @throw Exception if the mapping table is full
+   */
+  auto Insert(std::string_view key, const RID &value) -> bool;
+
+  /**
+   * Remove a key.
+   * @return false if the key does not exist
+   */
+  auto Remove(std::string_view key) -> bool;
+
+  /**
+   * Look up a key.
+   * @param[out] value the value associated with `key`, if found
+   * @return true if the key exists
+   */
+  auto GetValue(std::string_view key, RID *value) const -> bool;
+
+ private:
+  enum class NodeType : uint8_t { LEAF, INNER, INSERT, DELETE, SPLIT, INDEX_ENTRY };
+  enum class LookupResult : uint8_t { FOUND, NOT_FOUND, MOVE_RIGHT };
+
+  struct Node;
+  struct LeafNode;
+  struct InnerNode;
+  struct InsertDelta;
+  struct DeleteDelta;
+  struct SplitDelta;
+  struct IndexEntryDelta;
+
+  static constexpr NodeId INVALID_NODE_ID = UINT32_MAX;
+
+  auto GetNode(NodeId id) const -> Node * { return mapping_table_[id].load(); }
+  /** Allocate an id for `node` and publish it in the mapping table */
+  auto NewNodeId(Node *node) -> NodeId;
+
+  /** @return the node at `level` whose range may contain `key`; the caller still has to move right */
+  auto FindNode(std::string_view key, uint32_t level) const -> NodeId;
+  /** @return the child (or the right sibling) of an inner node to go to for `key` */
+  static auto InnerLookup(const Node *head, std::string_view key) -> NodeId;
+  static auto LeafLookup(const Node *head, std::string_view key, RID *value, NodeId *right) -> LookupResult;
+  /** @return true if `key` was split off to the right sibling `right` of the node */
+  static auto NeedMoveRight(const Node *head, std::string_view key, NodeId *right) -> bool;
+
+  /** Merge a delta chain into a new base node that the caller owns */
+  static auto BuildLeaf(const Node *head) -> LeafNode *;
+  static auto BuildInner(const Node *head) -> InnerNode *;
+  static void DeleteChain(void *head);
+
+  /** Consolidate or split the node `id` after `head` was installed, as needed */
+  void Restructure(NodeId id, Node *head);
+  void Consolidate(NodeId id, Node *head);
+  void Split(NodeId id, Node *head);
+  /** Post the index entry of a completed split to the parent, or grow a new root */
+  void PostSplit(NodeId left_id, const std::string &separator, bool has_high_key, const std::string &high_key,
+                 NodeId right_id, uint32_t level);
+
+  size_t leaf_max_size_;
+  size_t inner_max_size_;
+  size_t max_chain_length_;
+  size_t mapping_table_size_;
+
+  std::unique_ptr<std::atomic<Node *>[]> mapping_table_;
+  std::atomic<NodeId> next_node_id_{0};
+  std::atomic<NodeId> root_id_;
+
+  mutable EpochManager epoch_;
+};
+
+}  // namespace bustub
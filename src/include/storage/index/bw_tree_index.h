@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree_index.h
+//
+// Identification: src/include/storage/index/bw_tree_index.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/index/bw_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * BwTreeIndex keeps its entries in an in-memory latch-free Bw-tree. It is meant for indexes on
+ * small sets of hot keys that are updated by many threads at once, where the page latches of
+ * BPlusTreeIndex serialize the writers. Like ARTIndex it is not persisted, and the catalog fills
+ * it from the table heap when the index is created.
+ *
+ * Index keys are stored in the memcomparable encoding of VarKey. Only unique keys are supported.
+ */
+class BwTreeIndex : public Index {
+ public:
+  /** Keys that encode to more bytes than this are rejected */
+  static constexpr size_t MAX_KEY_SIZE = 64;
+
+  explicit BwTreeIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  ~BwTreeIndex() override = default;
+
+  auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+ private:
+  auto EncodeKey(const Tuple &key) const -> std::string;
+
+  BwTree tree_;
+};
+
+}  // namespace bustub
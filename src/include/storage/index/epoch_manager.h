@@ -0,0 +1,88 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/storage/index/epoch_manager.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+/**
+ * EpochManager defers freeing memory that latch-free readers may still be looking at.
+ *
+ * A thread enters an epoch before it touches shared nodes and leaves it when it is done; while
+ * inside, it announces the global epoch it entered in one of a fixed number of slots. Memory
+ * unlinked from the data structure is retired together with the current global epoch, and is
+ * freed once every announced epoch is newer than that, i.e. once no thread that could have seen
+ * the memory is still inside.
+ */
+class EpochManager {
+ public:
+  /** Free the retired memory once this many objects are waiting */
+  static constexpr size_t RECLAIM_THRESHOLD = 64;
+
+  /** @param num_slots how many threads may be inside an epoch at the same time; more have to wait */
+  explicit EpochManager(size_t num_slots = 128);
+
+  /** Frees all retired memory; no thread may be inside an epoch */
+  ~EpochManager();
+
+  EpochManager(const EpochManager &) = delete;
+  auto operator=(const EpochManager &) -> EpochManager & = delete;
+
+  /**
+   * Enter the current epoch.
+   * @return the slot to pass to Leave
+   */
+  auto Enter() -> size_t;
+
+  void Leave(size_t slot);
+
+  /**
+   * Free `ptr` with `deleter` once no thread can be referencing it any more.
+   */
+  void Retire(void *ptr, void (*deleter)(void *));
+
+  /** RAII helper that stays inside an epoch for its lifetime */
+  class Guard {
+   public:
+    explicit Guard(EpochManager *manager) : manager_(manager), slot_(manager->Enter()) {}
+    ~Guard() { manager_->Leave(slot_); }
+
+    Guard(const Guard &) = delete;
+    auto operator=(const Guard &) -> Guard & = delete;
+
+   private:
+    EpochManager *manager_;
+    size_t slot_;
+  };
+
+ private:
+  static constexpr uint64_t INACTIVE = UINT64_MAX;
+
+  struct Garbage {
+    void *ptr_;
+    void (*deleter_)(void *);
+    uint64_t epoch_;
+  };
+
+  std::atomic<uint64_t> global_epoch_{0};
+  size_t num_slots_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+
+  std::mutex garbage_latch_;
+  std::vector<Garbage> garbage_;
+};
+
+}  // namespace bustub
@@ -35,6 +35,9 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  // the raw tuple bytes are the key, the key schema is only needed by the comparator
+  inline void SetFromKey(const Tuple &tuple, [[maybe_unused]] const Schema &key_schema) { SetFromKey(tuple); }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -160,6 +160,22 @@ class Index {
    */
   virtual auto InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool = 0;
 
+  /**
+   * Insert a batch of entries into the index, e.g. all the rows of one INSERT statement.
+   * Indexes that can amortize their traversal over several keys override this; the
+   * default implementation inserts the entries one by one.
+   * @param entries The index keys and the RIDs associated with them
+   * @param transaction The transaction context
+   * @returns the number of entries inserted
+   */
+  virtual auto InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) -> size_t {
+    size_t inserted = 0;
+    for (const auto &[key, rid] : entries) {
+      inserted += InsertEntry(key, rid, transaction) ? 1 : 0;
+    }
+    return inserted;
+  }
+
   /**
    * Delete an index entry by key.
    * @param key The index key
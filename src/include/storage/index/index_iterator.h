@@ -13,17 +13,55 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <optional>
+#include <utility>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_var_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * IndexIterator walks the leaf level of a B+ tree in key order, either forwards
+ * (through next page ids) or backwards (through prev page ids).
+ *
+ * The iterator never keeps a leaf latched between calls: when it enters a leaf it
+ * copies every entry it is going to return out of the page (a "batch") while holding
+ * the read guard, then drops the guard and serves the batch from memory. At the same
+ * time it asks the buffer pool to prefetch the sibling it will visit next.
+ *
+ * Moving to the next leaf re-latches the current leaf to read its up-to-date sibling
+ * pointer, so entries that moved to a new page by a concurrent split are not skipped;
+ * entries already returned are filtered out by comparing with the last returned key.
+ * A leaf that was merged away in the meantime is dead and links to the leaf that took
+ * its entries, so the iterator continues there the same way.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Construct an end iterator. */
   IndexIterator();
+
+  /**
+   * Construct an iterator positioned at `index` of the leaf held by `guard`.
+   * @param bpm the buffer pool manager of the tree
+   * @param guard read guard of the leaf to start from, dropped once the first batch is copied
+   * @param index position of the first entry to return in that leaf
+   * @param comparator the comparator of the tree, must outlive the iterator
+   * @param stop_key optional inclusive bound; upper bound for forward scans, lower bound for reverse scans
+   * @param reverse whether to iterate in descending key order
+   */
+  IndexIterator(BufferPoolManager *bpm, ReadPageGuard guard, int index, const KeyComparator *comparator,
+                std::optional<KeyType> stop_key = std::nullopt, bool reverse = false);
+
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
+
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
@@ -32,12 +70,49 @@ class IndexIterator {
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    if (IsEndInternal() || itr.IsEndInternal()) {
+      return IsEndInternal() && itr.IsEndInternal();
+    }
+    return page_id_ == itr.page_id_ && slot_ == itr.slot_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { throw std::runtime_error("unimplemented"); }
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  auto IsEndInternal() const -> bool { return cursor_ >= batch_.size(); }
+
+  /**
+   * Copy the entries to return from the leaf held by `guard`, starting at slot `start`
+   * and skipping entries that are not past `last_key_` in iteration direction.
+   */
+  void LoadBatch(ReadPageGuard &guard, int start);
+
+  /** Move to the sibling leaf in the iteration direction and load its batch. */
+  void AdvanceLeaf();
+
+  /** @return true if `key` lies beyond the stop key in iteration direction */
+  auto PastStopKey(const KeyType &key) const -> bool;
+
+  BufferPoolManager *bpm_{nullptr};
+  const KeyComparator *comparator_{nullptr};
+  std::optional<KeyType> stop_key_{std::nullopt};
+  bool reverse_{false};
+
+  /** Entries copied from the current leaf, in iteration order */
+  std::vector<MappingType> batch_;
+  size_t cursor_{0};
+  /** Slot of batch_[0] in the current leaf, used for iterator equality */
+  int first_slot_{0};
+  int slot_{0};
+  /** The last key handed out before the current batch was loaded */
+  std::optional<KeyType> last_key_{std::nullopt};
+
+  page_id_t page_id_{INVALID_PAGE_ID};
+  /** Sibling to visit next, as seen when the batch was copied */
+  page_id_t sibling_page_id_{INVALID_PAGE_ID};
+  /** Set once the stop key is reached, so that no more leaves are visited */
+  bool exhausted_{false};
 };
 
 }  // namespace bustub
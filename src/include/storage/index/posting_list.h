@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.h
+//
+// Identification: src/include/storage/index/posting_list.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+/**
+ * PostingList is the value type of a non-unique B+ tree: all RIDs of one key, sorted and
+ * delta-compressed (see EncodePostings), stored in the leaf entry of the key. A tree over
+ * PostingList values keeps one entry per distinct key, and inserting a key that exists merges
+ * the RIDs into its list, so a low-cardinality index is mostly RIDs at a byte or two each.
+ *
+ * A list that outgrows the INLINE_SIZE bytes of the entry moves to a chain of
+ * BPlusTreePostingPage overflow pages, and moves back once it fits again. The entry then only
+ * keeps the head of the chain and the RID count.
+ *
+ * The methods that take the buffer pool may follow the overflow chain. The caller must hold the
+ * latch of the leaf that contains the entry: a write latch to modify it, a read latch to read it.
+ */
+class PostingList {
+ public:
+  static constexpr size_t INLINE_SIZE = 30;
+
+  PostingList() = default;
+
+  /** A list of a single RID, the value to insert a key/RID pair into a non-unique tree with */
+  explicit PostingList(const RID &rid);
+
+  /** @return the number of RIDs in the list */
+  auto Size() const -> uint32_t { return count_; }
+
+  auto IsEmpty() const -> bool { return count_ == 0; }
+
+  /** @return the first overflow page of the list, INVALID_PAGE_ID if the list is inline */
+  auto GetOverflowPageId() const -> page_id_t { return overflow_page_id_; }
+
+  /**
+   * Add a RID to the list.
+   * @return false if it is in the list already
+   */
+  auto Add(const RID &rid, BufferPoolManager *bpm) -> bool;
+
+  /**
+   * Add the RIDs of `other`, which must be inline (a list built to be merged, not one read from a tree).
+   * @return the number of RIDs that were not in the list yet
+   */
+  auto Merge(const PostingList &other, BufferPoolManager *bpm) -> size_t;
+
+  /**
+   * Remove a RID from the list. Overflow pages that become empty are deleted.
+   * @return false if it is not in the list
+   */
+  auto Erase(const RID &rid, BufferPoolManager *bpm) -> bool;
+
+  /** Remove every RID, deleting the overflow pages; used when the whole entry is removed */
+  void Clear(BufferPoolManager *bpm);
+
+  /** Append the RIDs of the list to `result`, in RID order */
+  void GetRIDs(BufferPoolManager *bpm, std::vector<RID> *result) const;
+
+ private:
+  /** Move the list from the overflow chain back into the entry if it is a single page that fits */
+  void TryInline(BufferPoolManager *bpm);
+
+  uint32_t count_{0};
+  page_id_t overflow_page_id_{INVALID_PAGE_ID};
+  uint16_t size_{0};
+  char data_[INLINE_SIZE]{};
+};
+
+static_assert(sizeof(PostingList) == 40);
+
+}  // namespace bustub
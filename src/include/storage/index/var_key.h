@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// var_key.h
+//
+// Identification: src/include/storage/index/var_key.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/**
+ * VarKey is a variable-length index key of at most KeySize bytes.
+ *
+ * Unlike GenericKey, which keeps the raw tuple bytes and needs the key schema to compare
+ * them, VarKey stores the key columns in a memcomparable encoding: comparing two keys byte
+ * by byte (shorter key first on a tie) gives the same order as comparing their values column
+ * by column. This is what lets B+ tree pages store keys with a common prefix cut off and use
+ * shortened separator keys, see BPlusTreeLeafPage<VarKey<KeySize>, ...>.
+ *
+ * Encoding of each column: one byte for null (0x00) / not null (0x01), followed by
+ *  - integers: big-endian, sign bit flipped
+ *  - decimals: IEEE 754 bits, all bits flipped for negative numbers, sign bit flipped otherwise
+ *  - varchars: the bytes with 0x00 escaped as 0x00 0xFF, terminated by 0x00 0x00
+ */
+template <size_t KeySize>
+class VarKey {
+  static_assert(KeySize <= UINT16_MAX, "key size must fit in 16 bits");
+
+ public:
+  /**
+   * Encode the columns of a key tuple.
+   * @throw Exception if the encoded key is longer than KeySize bytes
+   */
+  inline void SetFromKey(const Tuple &tuple, const Schema &key_schema) {
+    size_ = 0;
+    for (uint32_t i = 0; i < key_schema.GetColumnCount(); i++) {
+      AppendValue(tuple.GetValue(&key_schema, i));
+    }
+  }
+
+  // NOTE: for test purpose only, encoded as a single BIGINT column
+  inline void SetFromInteger(int64_t key) {
+    size_ = 0;
+    AppendValue(Value(TypeId::BIGINT, key));
+  }
+
+  inline void SetFromBytes(const char *data, size_t size) {
+    if (size > KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long");
+    }
+    memcpy(data_, data, size);
+    size_ = static_cast<uint16_t>(size);
+  }
+
+  /** Decode the column `column_idx` of the key, the inverse of SetFromKey */
+  inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
+    size_t pos = 0;
+    for (uint32_t i = 0; i < column_idx; i++) {
+      ReadValue(schema->GetColumn(i).GetType(), &pos);
+    }
+    return ReadValue(schema->GetColumn(column_idx).GetType(), &pos);
+  }
+
+  inline auto Data() const -> const char * { return data_; }
+
+  inline auto Size() const -> size_t { return size_; }
+
+  // NOTE: for debug purpose only, non-printable bytes are escaped
+  inline auto ToString() const -> std::string {
+    std::string str;
+    for (size_t i = 0; i < size_; i++) {
+      auto byte = static_cast<unsigned char>(data_[i]);
+      if (std::isprint(byte) != 0) {
+        str.push_back(static_cast<char>(byte));
+      } else {
+        str.append(fmt::format("\\x{:02x}", byte));
+      }
+    }
+    return str;
+  }
+
+  friend auto operator<<(std::ostream &os, const VarKey &key) -> std::ostream & {
+    os << key.ToString();
+    return os;
+  }
+
+  /** @return <0, 0 or >0 as `lhs` sorts before, equal to or after `rhs` */
+  static inline auto Compare(const char *lhs, size_t lhs_size, const char *rhs, size_t rhs_size) -> int {
+    int cmp = memcmp(lhs, rhs, std::min(lhs_size, rhs_size));
+    if (cmp != 0) {
+      return cmp;
+    }
+    return lhs_size < rhs_size ? -1 : (lhs_size > rhs_size ? 1 : 0);
+  }
+
+  uint16_t size_{0};
+  char data_[KeySize];
+
+ private:
+  inline void AppendByte(uint8_t byte) {
+    if (size_ >= KeySize) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long");
+    }
+    data_[size_++] = static_cast<char>(byte);
+  }
+
+  inline void AppendBigEndian(uint64_t bits, size_t width) {
+    for (size_t i = width; i > 0; i--) {
+      AppendByte(static_cast<uint8_t>(bits >> ((i - 1) * 8)));
+    }
+  }
+
+  inline auto ReadBigEndian(size_t width, size_t *pos) const -> uint64_t {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < width; i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data_[(*pos)++]);
+    }
+    return bits;
+  }
+
+  inline auto ReadValue(TypeId type, size_t *pos) const -> Value {
+    if (data_[(*pos)++] == 0x00) {
+      return ValueFactory::GetNullValueByType(type);
+    }
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return {type, static_cast<int8_t>(ReadBigEndian(1, pos) ^ 0x80U)};
+      case TypeId::SMALLINT:
+        return {type, static_cast<int16_t>(ReadBigEndian(2, pos) ^ 0x8000U)};
+      case TypeId::INTEGER:
+        return {type, static_cast<int32_t>(ReadBigEndian(4, pos) ^ 0x80000000U)};
+      case TypeId::BIGINT:
+        return {type, static_cast<int64_t>(ReadBigEndian(8, pos) ^ (1ULL << 63))};
+      case TypeId::TIMESTAMP:
+        return {type, ReadBigEndian(8, pos)};
+      case TypeId::DECIMAL: {
+        uint64_t bits = ReadBigEndian(8, pos);
+        bits = (bits & (1ULL << 63)) != 0 ? bits ^ (1ULL << 63) : ~bits;
+        double decimal;
+        memcpy(&decimal, &bits, sizeof(decimal));
+        return {type, decimal};
+      }
+      case TypeId::VARCHAR: {
+        std::string str;
+        // 0x00 0xFF is an escaped 0x00, 0x00 0x00 ends the string
+        while (!(data_[*pos] == '\0' && data_[*pos + 1] == '\0')) {
+          str.push_back(data_[*pos]);
+          *pos += data_[*pos] == '\0' ? 2 : 1;
+        }
+        *pos += 2;
+        return {type, str};
+      }
+      default:
+        throw Exception(ExceptionType::MISMATCH_TYPE, "unsupported index key type");
+    }
+  }
+
+  inline void AppendValue(const Value &value) {
+    if (value.IsNull()) {
+      AppendByte(0x00);
+      return;
+    }
+    AppendByte(0x01);
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        AppendBigEndian(static_cast<uint8_t>(value.GetAs<int8_t>()) ^ 0x80U, 1);
+        break;
+      case TypeId::SMALLINT:
+        AppendBigEndian(static_cast<uint16_t>(value.GetAs<int16_t>()) ^ 0x8000U, 2);
+        break;
+      case TypeId::INTEGER:
+        AppendBigEndian(static_cast<uint32_t>(value.GetAs<int32_t>()) ^ 0x80000000U, 4);
+        break;
+      case TypeId::BIGINT:
+        AppendBigEndian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (1ULL << 63), 8);
+        break;
+      case TypeId::TIMESTAMP:
+        AppendBigEndian(value.GetAs<uint64_t>(), 8);
+        break;
+      case TypeId::DECIMAL: {
+        auto decimal = value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &decimal, sizeof(bits));
+        bits = (bits & (1ULL << 63)) != 0 ? ~bits : bits ^ (1ULL << 63);
+        AppendBigEndian(bits, 8);
+        break;
+      }
+      case TypeId::VARCHAR: {
+        const char *str = value.GetData();
+        uint32_t len = value.GetLength() - 1;
+        for (uint32_t i = 0; i < len; i++) {
+          AppendByte(static_cast<uint8_t>(str[i]));
+          if (str[i] == '\0') {
+            AppendByte(0xFF);
+          }
+        }
+        AppendByte(0x00);
+        AppendByte(0x00);
+        break;
+      }
+      default:
+        throw Exception(ExceptionType::MISMATCH_TYPE, "unsupported index key type");
+    }
+  }
+};
+
+/**
+ * Function object comparing two VarKeys byte by byte, used for trees. The key schema is
+ * not needed since the keys are memcomparable; it is accepted so that the comparator can
+ * be constructed the same way as GenericComparator.
+ */
+template <size_t KeySize>
+class VarKeyComparator {
+ public:
+  inline auto operator()(const VarKey<KeySize> &lhs, const VarKey<KeySize> &rhs) const -> int {
+    return VarKey<KeySize>::Compare(lhs.Data(), lhs.Size(), rhs.Data(), rhs.Size());
+  }
+
+  VarKeyComparator(const VarKeyComparator &other) = default;
+
+  // constructor
+  explicit VarKeyComparator([[maybe_unused]] Schema *key_schema) {}
+};
+
+}  // namespace bustub
@@ -19,8 +19,9 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 12
+#define INTERNAL_PAGE_HEADER_SIZE (16 + sizeof(KeyType))
 #define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -33,11 +34,22 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Header format (size in byte, 16 + sizeof(KeyType) bytes in total):
+ *  --------------------------------------------------------------------------
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | RightPageId (4) | HighKey |
+ *  --------------------------------------------------------------------------
+ *
+ * RightPageId links every internal page to its right sibling on the same level and
+ * HighKey is the exclusive upper bound of the keys routed through this page (only
+ * meaningful when RightPageId is valid). Together they make the tree a B-link tree:
+ * a reader that reaches a page after it was split can still find its key by moving right.
  */
 INDEX_TEMPLATE_ARGUMENTS
-/// @brief 
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
+  static constexpr int DEFAULT_MAX_SIZE = INTERNAL_PAGE_SIZE;
+
   // Deleted to disallow initialization
   BPlusTreeInternalPage() = delete;
   BPlusTreeInternalPage(const BPlusTreeInternalPage &other) = delete;
@@ -47,7 +59,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    * the creation of a new page to make a valid BPlusTreeInternalPage
    * @param max_size Maximal size of the page
    */
-  void Init(int max_size = INTERNAL_PAGE_SIZE);
+  void Init(int max_size = DEFAULT_MAX_SIZE);
 
   /**
    * @param index The index of the key to get. Index must be non-zero.
@@ -84,13 +96,65 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   auto ValueAt(int index) const -> ValueType;
 
+  auto GetRightPageId() const -> page_id_t;
+  void SetRightPageId(page_id_t right_page_id);
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &high_key);
+
+  /**
+   * @return true if `key` is not covered by this page because it was split off to the right sibling,
+   * or because the page is dead and its right page id leads to the page that took over its range
+   */
+  auto NeedMoveRight(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
+  /** @return the number of children the page can hold without splitting */
+  auto GetCapacity() const -> int;
+
   void InsertVal(const KeyType &key, const ValueType& value, const KeyComparator &comparator);
 
   // 二分查找第一个大于等于key的位置，可以用来查询
-  int FindKeyIndexLowerBound(const KeyType &key, const KeyComparator &comparator);
+  auto FindKeyIndexLowerBound(const KeyType &key, const KeyComparator &comparator) const -> int;
 
   // 二分查找第一个大于key的位置
-  int FindKeyIndexUpperBound(const KeyType &key, const KeyComparator &comparator);
+  auto FindKeyIndexUpperBound(const KeyType &key, const KeyComparator &comparator) const -> int;
+
+  /**
+   * @param key the key to search for
+   * @return the child pointer whose subtree may contain `key`
+   */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+
+  /**
+   * Turn this (freshly initialized) page into a root with exactly two children.
+   */
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  /**
+   * Insert `new_key`/`new_value` right after the pointer `old_value`.
+   * @return the size of the page after insertion
+   */
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+
+  /**
+   * Rewrite this page and the (freshly initialized) `recipient` page, its right sibling, from
+   * `entries`: this page keeps entries [0, split_idx), the recipient gets the rest. The key at
+   * `split_idx` separates the two pages and becomes this page's high key.
+   */
+  void SplitEntries(const std::vector<MappingType> &entries, int split_idx, BPlusTreeInternalPage *recipient,
+                    page_id_t recipient_page_id);
+
+  /** Remove the key and child pointer at `index` (> 0) */
+  void RemoveAt(int index);
+
+  /**
+   * Append every child to `recipient`, the left sibling of this page; `middle_key` is the key that
+   * separated the two pages in their parent. The recipient takes over this page's high key and right
+   * page id, and this page is retired in favour of `recipient_page_id`.
+   */
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, page_id_t recipient_page_id);
+
+  /** Mark this page dead, readers that still arrive here move on to `page_id` */
+  void Retire(page_id_t page_id);
 
   /**
    * @brief For test only, return a string representing all keys in
@@ -119,6 +183,8 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
+  page_id_t right_page_id_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -19,7 +19,7 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
+#define LEAF_PAGE_HEADER_SIZE (24 + sizeof(KeyType))
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
@@ -32,17 +32,31 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 24 + sizeof(KeyType) bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
- * |  NextPageId (4)
+ * |  NextPageId (4) | PrevPageId (4) | Version (4) | HighKey (sizeof(KeyType))
  *  -----------------------------------------------
+ *
+ * Leaves form a doubly-linked list so that range scans can run in both
+ * directions without going back to the parent level.
+ *
+ * HighKey is an exclusive upper bound of the keys that belong to this leaf; it is
+ * only meaningful when NextPageId is valid (the right-most leaf is unbounded). It
+ * lets a B-link reader that arrives after a concurrent split notice that its key
+ * moved to the right sibling.
+ *
+ * Version is bumped every time entries leave the page through a split, so that a
+ * cached pointer to the page (the right-most leaf hint of the tree) can tell whether
+ * the key range it remembered is still accurate.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
+  static constexpr int DEFAULT_MAX_SIZE = LEAF_PAGE_SIZE;
+
   // Delete all constructor / destructor to ensure memory safety
   BPlusTreeLeafPage() = delete;
   BPlusTreeLeafPage(const BPlusTreeLeafPage &other) = delete;
@@ -52,17 +66,74 @@ class BPlusTreeLeafPage : public BPlusTreePage {
    * method to set default values
    * @param max_size Max size of the leaf node
    */
-  void Init(int max_size = LEAF_PAGE_SIZE);
+  void Init(int max_size = DEFAULT_MAX_SIZE);
 
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
+  auto GetVersion() const -> uint32_t;
+  auto GetHighKey() const -> const KeyType &;
+  void SetHighKey(const KeyType &high_key);
+
+  /**
+   * @return true if `key` is not covered by this leaf because it was split off to the right sibling,
+   * or because the leaf is dead and its next page id leads to the leaf it was merged into
+   */
+  auto NeedMoveRight(const KeyType &key, const KeyComparator &comp) const -> bool;
+
+  /** @return the number of entries the leaf can hold without splitting */
+  auto GetCapacity() const -> int;
+
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
+  auto ItemAt(int index) const -> const MappingType &;
+
+  /**
+   * @return index of the first key that is not less than `key`, GetSize() if there is none
+   */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comp) const -> int;
+
+  /**
+   * Look up `key` in this leaf.
+   * @param[out] value the value associated with `key`, if found
+   * @return true if the key exists in this leaf
+   */
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comp) const -> bool;
 
   void PushBack(const KeyType &key, const ValueType &value);
+
+  /**
+   * Insert a key/value pair in key order. The page may be filled up to its max size;
+   * the caller is responsible for splitting it afterwards.
+   * @return false if the key already exists
+   */
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp) -> bool;
 
+  /** Replace the value of the entry at `index`, e.g. after its posting list changed */
+  void SetValueAt(int index, const ValueType &value);
+
+  /** Remove the entry at `index`. The page is not rebalanced, it may even become empty */
+  void RemoveAt(int index);
+
+  /**
+   * Move the upper half of the entries to the (empty) `recipient` page.
+   */
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+
+  /**
+   * Keep the first `keep` entries and move the rest to the (empty) `recipient` page. The recipient
+   * inherits this page's high key, and this page's high key becomes the recipient's first key.
+   */
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int keep);
+
+  /**
+   * Append every entry to `recipient`, the left sibling of this page, which takes over this page's high
+   * key and next page id. This page is left dead and forwards to `recipient_page_id`.
+   */
+  void MoveAllTo(BPlusTreeLeafPage *recipient, page_id_t recipient_page_id);
+
   /**
    * @brief for test only return a string representing all keys in
    * this leaf page formatted as "(key1,key2,key3,...)"
@@ -90,10 +161,11 @@ class BPlusTreeLeafPage : public BPlusTreePage {
 
  private:
   auto InsertBefore(const KeyType &key, const ValueType &value, int idx) -> bool;
-  auto InsertAfter(const KeyType &key, const ValueType &value, int idx) -> bool;
 
- private:
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  uint32_t version_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -80,6 +80,14 @@ class BPlusTreePage {
   void SetMaxSize(int max_size);
   auto GetMinSize() const -> int;
 
+  /**
+   * A page is dead once a merge moved its entries into a sibling, or once it stopped being the root of a
+   * tree that shrank. It keeps its type, has no entries and a max size of 0, and its sibling link points
+   * to the page that took over its key range, so that readers still holding its page id can move on.
+   */
+  auto IsDead() const -> bool;
+  void MarkDead();
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
@@ -0,0 +1,82 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_posting_page.h
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+/** @return true if `lhs` sorts before `rhs` in a posting list, i.e. by page id, then slot */
+auto PostingLess(const RID &lhs, const RID &rhs) -> bool;
+
+/**
+ * Encode sorted, distinct RIDs into `buf`: each RID is the varint of its distance to the
+ * previous one, taking RIDs as (page id << 32 | slot). RIDs of the same page are usually a few
+ * slots apart, so most of them take one or two bytes.
+ * @param[out] size number of bytes written
+ * @return false if the encoding does not fit into `capacity` bytes
+ */
+auto EncodePostings(const std::vector<RID> &rids, char *buf, size_t capacity, uint32_t *size) -> bool;
+
+/** Append the RIDs encoded in the first `size` bytes of `buf` to `result` */
+void DecodePostings(const char *buf, uint32_t size, std::vector<RID> *result);
+
+/**
+ * Overflow page of a posting list that outgrew its leaf entry. A long posting list is a chain
+ * of these pages, each holding a sorted run of RIDs in the encoding of EncodePostings; every RID
+ * of a page is smaller than the first RID of the next page, and no page in a chain is empty.
+ *
+ *  Format (size in byte):
+ *  ----------------------------------------------------------------------------------
+ * | NextPageId (4) | Count (4) | Size (4) | FirstRID (8) | Data (up to page end) ...
+ *  ----------------------------------------------------------------------------------
+ *
+ * Overflow pages are only modified while the leaf entry that owns the chain is write latched,
+ * and only read while it is latched.
+ */
+class BPlusTreePostingPage {
+ public:
+  static constexpr size_t HEADER_SIZE = 20;
+  static constexpr size_t DATA_SIZE = BUSTUB_PAGE_SIZE - HEADER_SIZE;
+
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreePostingPage() = delete;
+  BPlusTreePostingPage(const BPlusTreePostingPage &other) = delete;
+
+  void Init();
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  auto GetCount() const -> uint32_t { return count_; }
+  auto GetFirstRID() const -> RID { return first_rid_; }
+
+  void GetRIDs(std::vector<RID> *result) const { DecodePostings(data_, size_, result); }
+
+  /**
+   * Replace the content of the page with `rids`, which must be sorted and not empty.
+   * @return false (leaving the page unchanged) if they do not fit
+   */
+  auto Store(const std::vector<RID> &rids) -> bool;
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  uint32_t size_;
+  RID first_rid_;
+  char data_[0];
+};
+
+static_assert(sizeof(BPlusTreePostingPage) == BPlusTreePostingPage::HEADER_SIZE);
+
+}  // namespace bustub
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_var_internal_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_var_internal_page.h
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_internal_page.h"
+#include "storage/page/b_plus_tree_var_leaf_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>>
+
+/**
+ * Internal page for variable-length keys, with the same slotted layout and prefix truncation
+ * as the variable-length leaf page (see b_plus_tree_var_leaf_page.h):
+ *
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | SLOT(0) | SLOT(1) | ... | SLOT(n) | FREE SPACE | ENTRY(n) | ... | ENTRY(0) |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 28 + 2 * (KeySize + 2) bytes in total):
+ *  ---------------------------------------------------------------------------------
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | RightPageId (4) | MaxEntries (4) |
+ * | HeapOffset (2) | PrefixSize (2) | HasHighKey (4) | LowKey (KeySize + 2) | HighKey (KeySize + 2) |
+ *  ---------------------------------------------------------------------------------
+ *
+ * As in the generic internal page the first key is invalid; the first entry only holds
+ * the child pointer. The separators it stores are the truncated keys chosen by leaf splits.
+ */
+VAR_INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeInternalPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>> : public BPlusTreePage {
+  using KeyType = VarKey<KeySize>;
+  using KeyComparator = VarKeyComparator<KeySize>;
+
+ public:
+  /** Entries are only bounded by free space unless a smaller max size is given to Init */
+  static constexpr int DEFAULT_MAX_SIZE = INT_MAX;
+
+  // Deleted to disallow initialization
+  BPlusTreeInternalPage() = delete;
+  BPlusTreeInternalPage(const BPlusTreeInternalPage &other) = delete;
+
+  /**
+   * Writes the necessary header information to a newly created page, must be called after
+   * the creation of a new page to make a valid BPlusTreeInternalPage
+   * @param max_size Maximal size of the page
+   */
+  void Init(int max_size = DEFAULT_MAX_SIZE);
+
+  /**
+   * @param index The index of the key to get. Index must be non-zero.
+   * @return Key at index
+   */
+  auto KeyAt(int index) const -> KeyType;
+
+  auto ValueIndex(const ValueType &value) const -> int;
+
+  auto ValueAt(int index) const -> ValueType;
+
+  auto GetRightPageId() const -> page_id_t;
+  auto GetHighKey() const -> const KeyType &;
+  auto GetPrefixSize() const -> int;
+
+  /**
+   * @return true if `key` is not covered by this page because it was split off to the right sibling,
+   * or because the page is dead and its right page id leads to the page that took over its range
+   */
+  auto NeedMoveRight(const KeyType &key, const KeyComparator &comparator) const -> bool;
+
+  /** @return the number of children an empty page holds without splitting, even if every key has the maximal size */
+  auto GetCapacity() const -> int;
+
+  /**
+   * @param key the key to search for
+   * @return the child pointer whose subtree may contain `key`
+   */
+  auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+
+  /**
+   * Turn this (freshly initialized) page into a root with exactly two children.
+   */
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+
+  /**
+   * Insert `new_key`/`new_value` right after the pointer `old_value`; the page must have room for it.
+   * @return the size of the page after insertion
+   */
+  auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
+
+  /**
+   * Rewrite this page and the (freshly initialized) `recipient` page, its right sibling, from
+   * `entries`: this page keeps entries [0, split_idx), the recipient gets the rest. The key at
+   * `split_idx` separates the two pages; it becomes this page's high key and the recipient's low key.
+   */
+  void SplitEntries(const std::vector<MappingType> &entries, int split_idx, BPlusTreeInternalPage *recipient,
+                    page_id_t recipient_page_id);
+
+  /** Remove the key and child pointer at `index` (> 0); the page is rewritten */
+  void RemoveAt(int index);
+
+  /**
+   * Append every child to `recipient`, the left sibling of this page; `middle_key` is the key that
+   * separated the two pages in their parent. The recipient takes over this page's high key and right
+   * page id and is rewritten, so the children of both must fit in GetCapacity(). This page is retired
+   * in favour of `recipient_page_id`.
+   */
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, page_id_t recipient_page_id);
+
+  /** Mark this page dead, readers that still arrive here move on to `page_id` */
+  void Retire(page_id_t page_id);
+
+  /**
+   * @brief For test only, return a string representing all keys in
+   * this internal page, formatted as "(key1,key2,key3,...)"
+   */
+  auto ToString() const -> std::string {
+    std::string kstr = "(";
+    // first key of internal page is always invalid
+    for (int i = 1; i < GetSize(); i++) {
+      if (i > 1) {
+        kstr.append(",");
+      }
+      kstr.append(KeyAt(i).ToString());
+    }
+    kstr.append(")");
+    return kstr;
+  }
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t size_;
+  };
+
+  auto SuffixAt(int index) const -> const char *;
+  auto FreeSpace() const -> size_t;
+  void UpdateMaxSize();
+
+  /** Write `entries` (within the fences, first key ignored) into the page from scratch */
+  void Rebuild(const MappingType *first, const MappingType *last);
+  void WriteEntry(int index, const KeyType &key, const ValueType &value);
+
+  page_id_t right_page_id_;
+  int32_t max_entries_;
+  uint16_t heap_offset_;
+  uint16_t prefix_size_;
+  uint32_t has_high_key_;
+  KeyType low_key_;
+  KeyType high_key_;
+  // Flexible array member for the slots.
+  Slot slots_[0];
+};
+
+}  // namespace bustub
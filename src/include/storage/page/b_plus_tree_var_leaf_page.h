@@ -0,0 +1,197 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_var_leaf_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_var_leaf_page.h
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/index/var_key.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+namespace bustub {
+
+#define VAR_INDEX_TEMPLATE_ARGUMENTS template <size_t KeySize, typename ValueType>
+#define B_PLUS_TREE_VAR_LEAF_PAGE_TYPE BPlusTreeLeafPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>>
+
+/**
+ * Leaf page for variable-length keys. It offers the same interface as the generic leaf
+ * page, so BPlusTree works with either, but stores its entries in a slotted layout:
+ *
+ *  ---------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | FREE SPACE | ENTRY(n) | ... | ENTRY(1) |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  Header format (size in byte, 36 + 2 * (KeySize + 2) bytes in total):
+ *  ---------------------------------------------------------------------------------
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | NextPageId (4) | PrevPageId (4) |
+ * | Version (4) | MaxEntries (4) | HeapOffset (2) | PrefixSize (2) | HasHighKey (4) |
+ * | LowKey (KeySize + 2) | HighKey (KeySize + 2) |
+ *  ---------------------------------------------------------------------------------
+ *
+ * A slot is Offset (2) | SuffixSize (2); the entry it points to is the key without the
+ * page prefix, followed by the value. Slots are kept in key order, entries are appended
+ * to the heap growing down from the end of the page.
+ *
+ * LowKey and HighKey are the fence keys of the page: every key in the page lies in
+ * [LowKey, HighKey). Hence every key starts with their common prefix, which is stored only
+ * once (as the first PrefixSize bytes of LowKey). The fences only change on splits, where
+ * they get closer to each other, and on merges, which rewrite the whole page anyway; so an
+ * insert never has to re-encode the page. The page with no high key (the right-most leaf)
+ * has no prefix.
+ *
+ * Splits choose the shortest separator between the two halves (suffix truncation), which
+ * becomes the high key of the left page and the low key of the right one.
+ *
+ * MaxSize is derived from the free space: it is the current size plus the number of
+ * worst-case entries that still fit, capped by the MaxEntries given to Init. So "the leaf
+ * splits when its size reaches MaxSize" keeps working for the tree.
+ */
+VAR_INDEX_TEMPLATE_ARGUMENTS
+class BPlusTreeLeafPage<VarKey<KeySize>, ValueType, VarKeyComparator<KeySize>> : public BPlusTreePage {
+  using KeyType = VarKey<KeySize>;
+  using KeyComparator = VarKeyComparator<KeySize>;
+
+ public:
+  /** Entries are only bounded by free space unless a smaller max size is given to Init */
+  static constexpr int DEFAULT_MAX_SIZE = INT_MAX;
+
+  // Delete all constructor / destructor to ensure memory safety
+  BPlusTreeLeafPage() = delete;
+  BPlusTreeLeafPage(const BPlusTreeLeafPage &other) = delete;
+
+  /**
+   * After creating a new leaf page from buffer pool, must call initialize
+   * method to set default values
+   * @param max_size Max number of entries of the leaf node
+   */
+  void Init(int max_size = DEFAULT_MAX_SIZE);
+
+  // helper methods
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
+  auto GetVersion() const -> uint32_t;
+  auto GetHighKey() const -> const KeyType &;
+  auto GetPrefixSize() const -> int;
+
+  /**
+   * @return true if `key` is not covered by this leaf because it was split off to the right sibling,
+   * or because the leaf is dead and its next page id leads to the leaf it was merged into
+   */
+  auto NeedMoveRight(const KeyType &key, const KeyComparator &comp) const -> bool;
+
+  /** @return the number of entries an empty leaf holds without splitting, even if every key has the maximal size */
+  auto GetCapacity() const -> int;
+
+  auto KeyAt(int index) const -> KeyType;
+  auto ValueAt(int index) const -> ValueType;
+  auto ItemAt(int index) const -> MappingType;
+
+  /**
+   * @return index of the first key that is not less than `key`, GetSize() if there is none
+   */
+  auto KeyIndex(const KeyType &key, const KeyComparator &comp) const -> int;
+
+  auto Lookup(const KeyType &key, ValueType *value, const KeyComparator &comp) const -> bool;
+
+  /**
+   * Insert a key/value pair in key order; the page must have room for it (size < max size).
+   * @return false if the key already exists
+   */
+  auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp) -> bool;
+
+  void SetValueAt(int index, const ValueType &value);
+
+  /** Remove the entry at `index`; the page is rewritten so that the space of the entry can be reused */
+  void RemoveAt(int index);
+
+  void MoveHalfTo(BPlusTreeLeafPage *recipient);
+
+  /**
+   * Keep the first `keep` entries and move the rest to the (empty) `recipient` page. The shortest
+   * key separating the two halves becomes the high key of this page and the low key of the recipient.
+   */
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int keep);
+
+  /**
+   * Append every entry to `recipient`, the left sibling of this page, which takes over this page's high
+   * key and next page id; the recipient is rewritten with the (shorter) prefix of the merged range, so
+   * the entries of both must fit in GetCapacity(). This page is left dead and forwards to `recipient_page_id`.
+   */
+  void MoveAllTo(BPlusTreeLeafPage *recipient, page_id_t recipient_page_id);
+
+  /**
+   * @brief for test only return a string representing all keys in
+   * this leaf page formatted as "(key1,key2,key3,...)"
+   */
+  auto ToString() const -> std::string {
+    std::string kstr = "(";
+    for (int i = 0; i < GetSize(); i++) {
+      if (i > 0) {
+        kstr.append(",");
+      }
+      kstr.append(KeyAt(i).ToString());
+    }
+    kstr.append(")");
+    return kstr;
+  }
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t size_;
+  };
+
+  auto SuffixAt(int index) const -> const char *;
+  auto FreeSpace() const -> size_t;
+  void UpdateMaxSize();
+
+  /** Write `entries` (sorted, within the fences) into the page from scratch */
+  void Rebuild(const MappingType *first, const MappingType *last);
+  void AppendEntry(const KeyType &key, const ValueType &value);
+
+  page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  uint32_t version_;
+  int32_t max_entries_;
+  uint16_t heap_offset_;
+  uint16_t prefix_size_;
+  uint32_t has_high_key_;
+  KeyType low_key_;
+  KeyType high_key_;
+  // Flexible array member for the slots.
+  Slot slots_[0];
+};
+
+/** @return the shortest key `sep` such that `left` < `sep` <= `right`, requires `left` < `right` */
+template <size_t KeySize>
+auto ShortestSeparator(const VarKey<KeySize> &left, const VarKey<KeySize> &right) -> VarKey<KeySize> {
+  size_t common = 0;
+  while (common < left.Size() && common < right.Size() && left.data_[common] == right.data_[common]) {
+    common++;
+  }
+  VarKey<KeySize> separator;
+  separator.SetFromBytes(right.Data(), std::min(common + 1, right.Size()));
+  return separator;
+}
+
+/** @return the length of the common prefix of two keys */
+template <size_t KeySize>
+auto CommonPrefixSize(const VarKey<KeySize> &lhs, const VarKey<KeySize> &rhs) -> size_t {
+  size_t common = 0;
+  while (common < lhs.Size() && common < rhs.Size() && lhs.data_[common] == rhs.data_[common]) {
+    common++;
+  }
+  return common;
+}
+
+}  // namespace bustub
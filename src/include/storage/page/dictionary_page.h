@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dictionary_page.h
+//
+// Identification: src/include/storage/page/dictionary_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "common/config.h"
+
+namespace bustub {
+
+static constexpr uint64_t DICTIONARY_PAGE_HEADER_SIZE = 8;
+
+/**
+ * A page of the dictionary of a table heap (see Dictionary). Every entry is a value of one of the
+ * dictionary-encoded columns of the table. The entries of a column get the codes 0, 1, 2, ... in
+ * the order they have along the chain, so the codes are not stored.
+ *
+ *  Format (size in byte):
+ *  ---------------------------------------------------
+ * | NextPageId (4) | Size (4) | Entry 0 | Entry 1 | ... |
+ *  ---------------------------------------------------
+ *  Entry: | ColumnIdx (2) | Length (2) | Data (Length) |
+ */
+class DictionaryPage {
+ public:
+  static constexpr uint32_t ENTRY_HEADER_SIZE = 4;
+  static constexpr uint32_t CAPACITY = BUSTUB_PAGE_SIZE - DICTIONARY_PAGE_HEADER_SIZE;
+
+  // Delete all constructor / destructor to ensure memory safety
+  DictionaryPage() = delete;
+  DictionaryPage(const DictionaryPage &other) = delete;
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    size_ = 0;
+  }
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /**
+   * Append an entry for a value of column `column_idx`.
+   * @return false if the page has no room for it
+   */
+  auto Append(uint16_t column_idx, const char *data, uint16_t len) -> bool {
+    if (size_ + ENTRY_HEADER_SIZE + len > CAPACITY) {
+      return false;
+    }
+    char *entry = data_ + size_;
+    memcpy(entry, &column_idx, sizeof(uint16_t));
+    memcpy(entry + sizeof(uint16_t), &len, sizeof(uint16_t));
+    memcpy(entry + ENTRY_HEADER_SIZE, data, len);
+    size_ += ENTRY_HEADER_SIZE + len;
+    return true;
+  }
+
+  /** Call `f(column_idx, data, len)` for every entry of the page, in order */
+  template <typename F>
+  void ForEachEntry(F &&f) const {
+    for (uint32_t offset = 0; offset < size_;) {
+      uint16_t column_idx;
+      uint16_t len;
+      memcpy(&column_idx, data_ + offset, sizeof(uint16_t));
+      memcpy(&len, data_ + offset + sizeof(uint16_t), sizeof(uint16_t));
+      f(column_idx, data_ + offset + ENTRY_HEADER_SIZE, len);
+      offset += ENTRY_HEADER_SIZE + len;
+    }
+  }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t size_;
+  char data_[0];
+};
+
+static_assert(sizeof(DictionaryPage) == DICTIONARY_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A page of the free space map of a table heap. It keeps, for a run of table pages, how much
+ * free space each of them has, as a one byte category: the free bytes divided by
+ * CATEGORY_BYTES, rounded down. IN_USE marks a page that an inserter is filling, whose free
+ * space the map does not track. The pages of a map are linked through their next page ids.
+ *
+ *  Format (size in byte):
+ *  ------------------------------------------------------------------------------------------
+ * | NextPageId (4) | NumEntries (4) | PageId (4) x CAPACITY | Category (1) x CAPACITY |
+ *  ------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  static constexpr size_t HEADER_SIZE = 8;
+  static constexpr size_t CAPACITY = (BUSTUB_PAGE_SIZE - HEADER_SIZE) / (sizeof(page_id_t) + 1);
+  static constexpr uint32_t CATEGORY_BYTES = 16;
+  static constexpr uint8_t MAX_CATEGORY = 254;
+  static constexpr uint8_t IN_USE = 255;
+
+  // Delete all constructor / destructor to ensure memory safety
+  FreeSpaceMapPage() = delete;
+  FreeSpaceMapPage(const FreeSpaceMapPage &other) = delete;
+
+  void Init();
+
+  /** @return the category of a table page with `free_bytes` free bytes */
+  static auto ToCategory(uint32_t free_bytes) -> uint8_t;
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+  auto GetNumEntries() const -> uint32_t { return num_entries_; }
+  auto IsFull() const -> bool { return num_entries_ == CAPACITY; }
+
+  auto PageIdAt(uint32_t index) const -> page_id_t { return page_ids_[index]; }
+  auto CategoryAt(uint32_t index) const -> uint8_t { return Categories()[index]; }
+  void SetCategoryAt(uint32_t index, uint8_t category) { Categories()[index] = category; }
+
+  /**
+   * Append an entry for a table page.
+   * @return the index of the entry
+   */
+  auto Append(page_id_t page_id, uint8_t category) -> uint32_t;
+
+  /** @return the index of the first entry whose category is at least `category` but not IN_USE, or -1 */
+  auto Find(uint8_t category) const -> int;
+
+  /** @return the largest category in the page, not counting IN_USE entries */
+  auto MaxCategory() const -> uint8_t;
+
+ private:
+  auto Categories() const -> const uint8_t * { return reinterpret_cast<const uint8_t *>(page_ids_ + CAPACITY); }
+  auto Categories() -> uint8_t * { return reinterpret_cast<uint8_t *>(page_ids_ + CAPACITY); }
+
+  page_id_t next_page_id_;
+  uint32_t num_entries_;
+  page_id_t page_ids_[0];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) == FreeSpaceMapPage::HEADER_SIZE);
+static_assert(FreeSpaceMapPage::HEADER_SIZE + FreeSpaceMapPage::CAPACITY * (sizeof(page_id_t) + 1) <=
+              BUSTUB_PAGE_SIZE);
+
+}  // namespace bustub
@@ -25,10 +25,15 @@ namespace bustub {
  * Store indexed key and and value together within block page. Supports
  * non-unique keys.
  *
+ * A block page is one page of a bucket of LinearProbeHashTable. A key starts probing at
+ * a slot derived from its hash and walks forward (wrapping around) until it reaches a
+ * slot that was never occupied. A bucket whose block is full continues in an overflow
+ * block, linked through NextPageId.
+ *
  * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------
+ * | NextPageId (4) | OCCUPIED | READABLE | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n)
+ *  ----------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
@@ -39,6 +44,21 @@ class HashTableBlockPage {
   // Delete all constructor / destructor to ensure memory safety
   HashTableBlockPage() = delete;
 
+  /**
+   * Clears the block: no slot is occupied and there is no overflow block.
+   */
+  void Init();
+
+  /**
+   * @return the page id of the overflow block, INVALID_PAGE_ID if this is the last block of the bucket
+   */
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+  /**
+   * @param next_page_id the page id of the overflow block
+   */
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
   /**
    * Gets the key at an index in the block.
    *
@@ -94,51 +114,43 @@ class HashTableBlockPage {
   auto IsReadable(slot_offset_t bucket_ind) const -> bool;
 
   /**
-   * Scan the bucket and collect values that have the matching key
+   * Probe the block from `start` and collect values that have the matching key
    *
    * @return true if at least one key matched
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto GetValue(KeyType key, KeyComparator cmp, slot_offset_t start, std::vector<ValueType> *result) const -> bool;
 
   /**
-   * Attempts to insert a key and value in the bucket.
-   * The insert is thread safe. It uses compare and swap to claim the index,
-   * and then writes the key and value into the index, and then marks the
-   * index as readable.
+   * Insert a key and value into the first free slot (tombstone or never occupied) probing
+   * from `start`. It does not look for duplicates, the caller checks the whole bucket.
    *
-   * @param key key to insert
-   * @param value value to insert
-   * @return true if inserted, false if duplicate KV pair or bucket is full
+   * @return true if inserted, false if no slot is free
    */
-  auto Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Insert(const KeyType &key, const ValueType &value, slot_offset_t start) -> bool;
 
   /**
-   * Removes a key and value.
+   * Removes a key and value, probing from `start`.
    * @return true if removed, false if not found
    */
-  auto Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Remove(KeyType key, ValueType value, KeyComparator cmp, slot_offset_t start) -> bool;
 
   /**
    * @return the number of readable elements, i.e. current size
    */
-  auto NumReadable() -> uint32_t;
-
-  /**
-   * @return whether the bucket is full
-   */
-  auto IsFull() -> bool;
+  auto NumReadable() const -> uint32_t;
 
   /**
-   * @return whether the bucket is empty
+   * @return whether the block is empty
    */
-  auto IsEmpty() -> bool;
+  auto IsEmpty() const -> bool;
 
   /**
-   * Prints the bucket's occupancy information
+   * Prints the block's occupancy information
    */
-  void PrintBucket();
+  void PrintBucket() const;
 
  private:
+  page_id_t next_page_id_;
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
@@ -31,7 +31,14 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  readable_ arrays and the fingerprints. More information is in
+ *  storage/page/hash_table_page_defs.h.
+ *
+ * Every slot also keeps a 1-byte fingerprint of its key, taken from hash bits the
+ * directory does not use. Lookups compare the fingerprints of 16 slots at once and only
+ * compare the full keys of the slots that match, so a full bucket usually costs one or two
+ * key comparisons. The table must pass the same fingerprint for a key to every method;
+ * callers that pass none get fingerprint 0 for all keys, which is correct but filters nothing.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -45,7 +52,8 @@ class HashTableBucketPage {
    *
    * @return true if at least one key matched
    */
-  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool;
+  auto GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result, uint8_t fingerprint = 0) const
+      -> bool;
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -53,16 +61,17 @@ class HashTableBucketPage {
    *
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint fingerprint of the key
    * @return true if inserted, false if duplicate KV pair or bucket is full
    */
-  auto Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint = 0) -> bool;
 
   /**
    * Removes a key and value.
    *
    * @return true if removed, false if not found
    */
-  auto Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool;
+  auto Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint = 0) -> bool;
 
   /**
    * Gets the key at an index in the bucket.
@@ -80,6 +89,11 @@ class HashTableBucketPage {
    */
   auto ValueAt(uint32_t bucket_idx) const -> ValueType;
 
+  /**
+   * Gets the fingerprint of the key at an index in the bucket, to move the entry to another bucket.
+   */
+  auto FingerprintAt(uint32_t bucket_idx) const -> uint8_t { return fingerprints_[bucket_idx]; }
+
   /**
    * Remove the KV pair at bucket_idx
    */
@@ -120,17 +134,17 @@ class HashTableBucketPage {
   /**
    * @return the number of readable elements, i.e. current size
    */
-  auto NumReadable() -> uint32_t;
+  auto NumReadable() const -> uint32_t;
 
   /**
    * @return whether the bucket is full
    */
-  auto IsFull() -> bool;
+  auto IsFull() const -> bool;
 
   /**
    * @return whether the bucket is empty
    */
-  auto IsEmpty() -> bool;
+  auto IsEmpty() const -> bool;
 
   /**
    * Prints the bucket's occupancy information
@@ -138,10 +152,23 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /** Number of slots whose fingerprints are compared at once */
+  static constexpr uint32_t GROUP_SIZE = 16;
+
+  /** @return bit i set if slot base + i is readable and its fingerprint is `fingerprint` */
+  auto MatchGroup(uint32_t base, uint8_t fingerprint) const -> uint32_t;
+
+  /** @return the bits of `bitmap` for the slots [base, base + GROUP_SIZE) */
+  static auto GroupBits(const char *bitmap, uint32_t base) -> uint32_t;
+
+  /** @return the first slot that is not readable, BUCKET_ARRAY_SIZE if the bucket is full */
+  auto FirstFreeSlot() const -> uint32_t;
+
   //  For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   // Flexible array member for page data.
   MappingType array_[1];
 };
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_header_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_header_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ * Header page of an extendible hash table whose directory spans several pages.
+ *
+ * The directory is one array of 2^GlobalDepth bucket slots, cut into directory pages of
+ * DIRECTORY_ARRAY_SIZE slots each; slot i lives in directory page i / DIRECTORY_ARRAY_SIZE.
+ * The header lists the page ids of these pages. A directory of at most DIRECTORY_ARRAY_SIZE
+ * slots is a single page, and every directory page records the global depth.
+ *
+ * Header format (size in byte):
+ * ----------------------------------------------
+ * | DirectoryPageIds(4 * DIRECTORY_HEADER_ARRAY_SIZE)
+ * ----------------------------------------------
+ */
+class HashTableDirectoryHeaderPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableDirectoryHeaderPage() = delete;
+  HashTableDirectoryHeaderPage(const HashTableDirectoryHeaderPage &other) = delete;
+
+  /** Clear the list of directory pages */
+  void Init();
+
+  /**
+   * @param directory_idx index of the directory page, i.e. of its first slot divided by DIRECTORY_ARRAY_SIZE
+   * @return the page id of the directory page, INVALID_PAGE_ID if the directory is not that large
+   */
+  auto GetDirectoryPageId(uint32_t directory_idx) const -> page_id_t;
+
+  void SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id);
+
+ private:
+  page_id_t directory_page_ids_[DIRECTORY_HEADER_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryHeaderPage) <= BUSTUB_PAGE_SIZE);
+
+}  // namespace bustub
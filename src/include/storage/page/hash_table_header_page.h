@@ -26,15 +26,27 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * The hash table grows by linear hashing: it starts with InitialBlocks buckets, each a
+ * chain of block pages, and appends one bucket at a time. The header lists the first block
+ * page of every bucket, so the split pointer and the level follow from NumBlocks and
+ * InitialBlocks.
+ *
+ * Header format (size in byte, 40 bytes in total):
+ * ----------------------------------------------------------------------------------------
+ * | LSN (4) | (4) | Size (8) | PageId(4) | (4) | NextBlockIndex(8) | InitialBlocks(8) | ...
+ * ----------------------------------------------------------------------------------------
  */
 class HashTableHeaderPage {
  public:
+  static constexpr size_t HEADER_SIZE = 40;
+  /** The maximum number of buckets whose page ids fit into the header */
+  static constexpr size_t MAX_BLOCKS = (BUSTUB_PAGE_SIZE - HEADER_SIZE) / sizeof(page_id_t);
+
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableHeaderPage() = delete;
+
   /**
-   * @return the number of buckets in the hash table;
+   * @return the number of key/value pairs in the hash table
    */
   auto GetSize() const -> size_t;
 
@@ -45,6 +57,14 @@ class HashTableHeaderPage {
    */
   void SetSize(size_t size);
 
+  /**
+   * Atomically adds `delta` to the size field, so that operations that only share the
+   * table latch can count their inserts and removes.
+   *
+   * @return the size after the update
+   */
+  auto IncrSize(int64_t delta) -> size_t;
+
   /**
    * @return the page ID of this page
    */
@@ -82,20 +102,35 @@ class HashTableHeaderPage {
    * @param index the index of the block
    * @return the page_id for the block.
    */
-  auto GetBlockPageId(size_t index) -> page_id_t;
+  auto GetBlockPageId(size_t index) const -> page_id_t;
 
   /**
    * @return the number of blocks currently stored in the header page
    */
-  auto NumBlocks() -> size_t;
+  auto NumBlocks() const -> size_t;
+
+  /**
+   * @return the number of buckets the table started with, the base of linear hashing
+   */
+  auto GetInitialBlocks() const -> size_t;
+
+  /**
+   * Sets the number of buckets the table started with
+   *
+   * @param initial_blocks the number of initial buckets, at least 1
+   */
+  void SetInitialBlocks(size_t initial_blocks);
 
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
+  size_t initial_blocks_;
   // Flexible array member for page data.
-  __attribute__((unused)) page_id_t block_page_ids_[1];
+  page_id_t block_page_ids_[0];
 };
 
+static_assert(sizeof(HashTableHeaderPage) == HashTableHeaderPage::HEADER_SIZE);
+
 }  // namespace bustub
@@ -24,9 +24,10 @@
  * approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each
  * key/value pair, we need two additional bits for occupied_ and readable_. 4 * BUSTUB_PAGE_SIZE / (4 * sizeof
  * (MappingType) + 1) = BUSTUB_PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * to maintain the occupied and readable flags for a key value pair. The first 4 bytes of a block hold the page id of its
+ * overflow block.
  */
-#define BLOCK_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BLOCK_ARRAY_SIZE (4 * (BUSTUB_PAGE_SIZE - sizeof(page_id_t)) / (4 * sizeof(MappingType) + 1))
 
 /**
  * Extendible Hashing Definitions
@@ -35,16 +36,21 @@
 
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hash index bucket page.
- * The computation is the same as the above BLOCK_ARRAY_SIZE, but blocks and buckets have different implementations
- * of search, insertion, removal, and helper methods.
+ * The computation is similar to the above BLOCK_ARRAY_SIZE, but every slot of a bucket also has a 1-byte fingerprint
+ * of its key: BUSTUB_PAGE_SIZE / (sizeof (MappingType) + 1.25).
  */
-#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * BUSTUB_PAGE_SIZE / (4 * sizeof(MappingType) + 5))
 
 /**
  * DIRECTORY_ARRAY_SIZE is the number of page_ids that can fit in the directory page of an extendible hash index.
  * This is 512 because the directory array must grow in powers of 2, and 1024 page_ids leaves zero room for
  * storage of the other member variables: page_id_, lsn_, global_depth_, and the array local_depths_.
- * Extending the directory implementation to span multiple pages would be a meaningful improvement to the
- * implementation.
+ * A larger directory spans several directory pages, listed in the header page of the table.
  */
-#define DIRECTORY_ARRAY_SIZE 512
+#define DIRECTORY_ARRAY_SIZE 512U
+
+/**
+ * DIRECTORY_HEADER_ARRAY_SIZE is the number of directory pages the header page of an extendible hash index can list,
+ * which makes for at most DIRECTORY_ARRAY_SIZE * DIRECTORY_HEADER_ARRAY_SIZE (2^19) buckets.
+ */
+#define DIRECTORY_HEADER_ARRAY_SIZE (BUSTUB_PAGE_SIZE / sizeof(page_id_t))
@@ -27,7 +27,11 @@
 
 namespace bustub {
 
-static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
+static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 16;
+
+/** Pages written before the header had a version tag read 0 there */
+static constexpr uint8_t TABLE_PAGE_VERSION_1 = 0;
+static constexpr uint8_t TABLE_PAGE_VERSION_2 = 2;
 
 /**
  * Slotted page format:
@@ -38,23 +42,67 @@ static constexpr uint64_t TABLE_PAGE_HEADER_SIZE = 8;
  *                                free space pointer
  *
  *  Header format (size in bytes):
- *  ----------------------------------------------------------------------------
- *  | NextPageId (4)| NumTuples(2) | NumDeletedTuples(2) |
- *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | Tuple_1 offset+size (4) | Tuple_2 offset+size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ----------------------------------------------------------------------------------------------------------
+ *  | NextPageId (4)| NumTuples(2) | NumDeletedTuples(2) | NumDeadTuples(2) | FreeSpacePointer(2) | DeadBytes(2) |
+ *  ----------------------------------------------------------------------------------------------------------
+ *  --------------------------------------
+ *  | Version (1) | NullBitmapSize (1) |
+ *  --------------------------------------
+ *
+ * The version tag in the header selects the format of the slots that follow it. Version 1 pages read 0 in both
+ * bytes, so they have no null bitmap.
+ *
+ * Version 1 slots (16 bytes) hold the tuple meta in full:
+ *  -----------------------------------------------------------------------
+ *  | Tuple_1 offset (2) | Tuple_1 size (2) | Tuple_1 meta (12) | ... |
+ *  -----------------------------------------------------------------------
+ *
+ * Version 2 keeps the ids of the transactions that have tuples of the page in flight in a table after the header,
+ * and a slot (4 bytes) refers to them by their index in the table, 0 meaning INVALID_TXN_ID:
+ *  -------------------------------------------------------------------------
+ *  | TxnId_1 (4) | ... | TxnId_6 (4) | Tuple_1 slot (4) | Tuple_2 slot (4) | ... |
+ *  -------------------------------------------------------------------------
+ *  Slot bits, from the lowest:
+ *  -----------------------------------------------------------------------------------
+ *  | Offset (13) | Size (12) | InsertTxnIndex (3) | DeleteTxnIndex (3) | IsDeleted (1) |
+ *  -----------------------------------------------------------------------------------
+ * An entry of the table is free once no slot refers to it. When the table has no room for the ids of a meta update,
+ * the tuple is moved and the two ids are written in front of its data, and its slot has SPILLED_TXN_INDEX as both
+ * indexes:
+ *  ----------------------------------------
+ *  | InsertTxnId (4) | DeleteTxnId (4) | data |
+ *  ----------------------------------------
+ * The page keeps 8 bytes per slot free for this, so a meta update never fails. An insert whose ids do not fit into
+ * the table finds the page full instead.
  *
  * Tuple format:
- * | meta | data |
+ * | data | NullBitmap (NullBitmapSize) |
+ *
+ * The data is a Tuple as is. A version 2 page made with a NullBitmapSize stores the null bitmap of every tuple after
+ * its data, see Tuple: the tuples read from the page carry it, and their IsNull reads the bit of the column instead of
+ * deserializing the value. The table heap sets the size from the column count of its schema and appends the bitmap
+ * to the tuples it inserts.
+ *
+ * A tuple is dead once its deletion completed, i.e. it is deleted and its delete_txn_id_ is INVALID_TXN_ID. Its body
+ * is garbage: Compact moves the bodies of the other tuples together and gives the space back to the free space, and
+ * InsertTuple compacts the page when the free space alone is too small. The slot of a dead tuple stays, so the RIDs
+ * of the other tuples never change, and InsertTuple may give it to a new tuple if asked to.
  */
 
 class TablePage {
  public:
   /**
    * Initialize the TablePage header.
+   * @param version the format of the slots, TABLE_PAGE_VERSION_2 for new pages
+   * @param null_bitmap_size the size of the null bitmap after the data of a tuple, 0 for none; version 2 only
    */
-  void Init();
+  void Init(uint8_t version = TABLE_PAGE_VERSION_2, uint8_t null_bitmap_size = 0);
+
+  /** @return the format version of the page */
+  auto GetVersion() const -> uint8_t { return version_; }
+
+  /** @return the size of the null bitmap that follows the data of every tuple, which the tuples to insert must have */
+  auto GetNullBitmapSize() const -> uint8_t { return null_bitmap_size_; }
 
   /** @return number of tuples in this page */
   auto GetNumTuples() const -> uint32_t { return num_tuples_; }
@@ -65,18 +113,36 @@ class TablePage {
   /** Set the page id of the next page in the table. */
   void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
-  /** Get the next offset to insert, return nullopt if this tuple cannot fit in this page */
+  /** @return number of dead tuples, whose slots can be reused */
+  auto GetNumDeadTuples() const -> uint32_t { return num_dead_tuples_; }
+
+  /**
+   * @return the number of bytes an insert can use, counting the bodies of dead tuples that Compact would reclaim,
+   * less the part of a new slot and, on a version 2 page, the space kept to spill transaction ids that SpaceFor does
+   * not count
+   */
+  auto GetFreeSpace() const -> uint32_t;
+
+  /** @return the space a tuple takes in a page, including its slot and null bitmap */
+  static auto SpaceFor(const Tuple &tuple) -> uint32_t { return SLOT_SIZE + tuple.data_.size(); }
+
+  /** Get the next offset to insert, return nullopt if this tuple cannot fit in this page without compaction */
   auto GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t>;
 
   /**
-   * Insert a tuple into the table.
+   * Insert a tuple into the table, compacting the page first if only the space of dead tuples makes it fit.
    * @param tuple tuple to insert
-   * @return true if the insert is successful (i.e. there is enough space)
+   * @param reuse_slot whether the tuple may take the slot of a dead tuple instead of a new slot at the end
+   * @return the slot of the tuple, nullopt if there is not enough space or no room for the transaction ids of `meta`
    */
-  auto InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::optional<uint16_t>;
+  auto InsertTuple(const TupleMeta &meta, const Tuple &tuple, bool reuse_slot = false) -> std::optional<uint16_t>;
+
+  /** Move the bodies of the tuples that are not dead to the end of the page, merging the free space. */
+  void Compact();
 
   /**
-   * Update a tuple.
+   * Update a tuple meta. On a version 2 page whose transaction table has no room for the ids of `meta`, the ids are
+   * spilled in front of the tuple data.
    */
   void UpdateTupleMeta(const TupleMeta &meta, const RID &rid);
 
@@ -85,6 +151,11 @@ class TablePage {
    */
   auto GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple>;
 
+  /**
+   * Read a tuple from a table without copying it. The view is valid while the page is latched.
+   */
+  auto GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView>;
+
   /**
    * Read a tuple meta from a table.
    */
@@ -99,14 +170,102 @@ class TablePage {
 
  private:
   using TupleInfo = std::tuple<uint16_t, uint16_t, TupleMeta>;
+
+  /** @return the size of the header and, on a version 2 page, of the transaction table */
+  auto HeaderSize() const -> size_t {
+    return version_ == TABLE_PAGE_VERSION_2 ? TABLE_PAGE_HEADER_SIZE + sizeof(txn_id_t) * TXN_TABLE_SIZE
+                                            : TABLE_PAGE_HEADER_SIZE;
+  }
+
+  /** @return the size of a slot */
+  auto SlotSize() const -> size_t { return version_ == TABLE_PAGE_VERSION_2 ? SLOT_SIZE : TUPLE_INFO_SIZE; }
+
+  /** @return the space kept free per slot to spill transaction ids */
+  auto SpillReserve() const -> size_t { return version_ == TABLE_PAGE_VERSION_2 ? SPILL_SIZE : 0; }
+
+  /** @return offset, size and meta of the tuple in slot `tuple_id` */
+  auto GetSlot(uint16_t tuple_id) const -> TupleInfo;
+
+  /**
+   * Write slot `tuple_id`. On a version 2 page, transaction ids of `meta` that are not in the transaction table are
+   * written to the SPILL_SIZE bytes in front of `offset`, which must belong to the tuple.
+   */
+  void SetSlot(uint16_t tuple_id, uint16_t offset, uint16_t size, const TupleMeta &meta);
+
+  /**
+   * Make sure the transaction table has entries for the transaction ids of `meta`, freeing the entries no slot
+   * refers to if needed. Does nothing on a version 1 page.
+   * @return false if the table has no room, the table is not changed then
+   */
+  auto ReserveTxnIds(const TupleMeta &meta) -> bool;
+
+  /** @return whether the slot refers to the transaction table for the ids of `meta`, always true on version 1 */
+  auto InTxnTable(const TupleMeta &meta) const -> bool;
+
+  /** @return whether the transaction ids of slot `tuple_id` are spilled in front of its data */
+  auto IsSpilled(uint16_t tuple_id) const -> bool;
+
+  /**
+   * Move tuple `tuple_id` to the free space, leaving SPILL_SIZE bytes in front of it for the ids of `meta`. The data
+   * of a tuple that is or becomes dead is dropped.
+   * @param[in,out] size the size of the tuple, 0 if its data was dropped
+   * @return the new offset of the tuple
+   */
+  auto SpillTuple(uint16_t tuple_id, uint16_t offset, uint16_t *size, const TupleMeta &old_meta,
+                  const TupleMeta &meta) -> uint16_t;
+
+  /**
+   * Make room for the transaction ids of `meta` before slot `tuple_id` is set to it, spilling them if the transaction
+   * table is full.
+   * @param[in,out] size the size of the tuple, 0 if its data was dropped
+   * @return the offset of the tuple to pass to SetSlot
+   */
+  auto PrepareMetaUpdate(uint16_t tuple_id, uint16_t offset, uint16_t *size, const TupleMeta &old_meta,
+                         const TupleMeta &meta) -> uint16_t;
+
+  /** @return the index of `txn_id` in the transaction table, 0 for INVALID_TXN_ID */
+  auto TxnIndex(txn_id_t txn_id) const -> uint32_t;
+
+  auto TxnTable() const -> const txn_id_t * {
+    return reinterpret_cast<const txn_id_t *>(page_start_ + TABLE_PAGE_HEADER_SIZE);
+  }
+  auto TxnTable() -> txn_id_t * { return reinterpret_cast<txn_id_t *>(page_start_ + TABLE_PAGE_HEADER_SIZE); }
+  auto Slots() const -> const uint32_t * { return reinterpret_cast<const uint32_t *>(page_start_ + HeaderSize()); }
+  auto Slots() -> uint32_t * { return reinterpret_cast<uint32_t *>(page_start_ + HeaderSize()); }
+
+  /** Account for a tuple whose meta changes from `old_meta` to `meta` */
+  void OnMetaChange(const TupleMeta &old_meta, const TupleMeta &meta, uint16_t size);
+
+  static auto IsDead(const TupleMeta &meta) -> bool {
+    return meta.is_deleted_ && meta.delete_txn_id_ == INVALID_TXN_ID;
+  }
+
   char page_start_[0];
   page_id_t next_page_id_;
   uint16_t num_tuples_;
   uint16_t num_deleted_tuples_;
+  uint16_t num_dead_tuples_;
+  uint16_t free_space_pointer_;
+  uint16_t dead_bytes_;
+  uint8_t version_;
+  uint8_t null_bitmap_size_;
   TupleInfo tuple_info_[0];
 
   static constexpr size_t TUPLE_INFO_SIZE = 16;
   static_assert(sizeof(TupleInfo) == TUPLE_INFO_SIZE);
+
+  static constexpr size_t SLOT_SIZE = 4;
+  static constexpr size_t SPILL_SIZE = 2 * sizeof(txn_id_t);
+  static constexpr uint32_t TXN_TABLE_SIZE = 6;
+  static constexpr uint32_t OFFSET_BITS = 13;
+  static constexpr uint32_t SIZE_BITS = 12;
+  static constexpr uint32_t TXN_INDEX_BITS = 3;
+  static constexpr uint32_t SPILLED_TXN_INDEX = (1 << TXN_INDEX_BITS) - 1;
+  static_assert(BUSTUB_PAGE_SIZE < (1 << OFFSET_BITS));
+  /** The largest tuple a version 2 page holds, alone with its slot and spill reserve, has to fit into a slot */
+  static_assert(BUSTUB_PAGE_SIZE - TABLE_PAGE_HEADER_SIZE - sizeof(txn_id_t) * TXN_TABLE_SIZE - SLOT_SIZE - SPILL_SIZE <
+                (1 << SIZE_BITS));
+  static_assert(TXN_TABLE_SIZE < SPILLED_TXN_INDEX);
 };
 
 static_assert(sizeof(TablePage) == TABLE_PAGE_HEADER_SIZE);
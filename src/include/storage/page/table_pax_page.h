@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_pax_page.h
+//
+// Identification: src/include/storage/page/table_pax_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+static constexpr uint64_t TABLE_PAX_PAGE_HEADER_SIZE = 16;
+
+/**
+ * PAX page format: the page holds the same tuples as a TablePage, split by column. After the
+ * minipage of the tuple metas, every column of the table has a minipage with the value of that
+ * column for each tuple of the page:
+ *  -------------------------------------------------------------------------------------------
+ *  | HEADER | METAS | COLUMN 0 | COLUMN 1 | ... | ... FREE SPACE ... | ... VARCHAR VALUES ... |
+ *  -------------------------------------------------------------------------------------------
+ *                                                                   ^
+ *                                                                   heap pointer
+ *
+ *  Header format (size in bytes):
+ *  -----------------------------------------------------------------------------------------------------
+ *  | NextPageId (4) | NumTuples (2) | Capacity (2) | NumColumns (2) | HeapPointer (2) | FixedLength (2) |
+ *  -----------------------------------------------------------------------------------------------------
+ *  -------------------------------------------------------------
+ *  | MetaOffset (2) | Column_1 info (8) | Column_2 info (8) | ... |
+ *  -------------------------------------------------------------
+ *  Column info: | TupleOffset (2) | Width (2) | MinipageOffset (2) | IsVarchar (2) |
+ *
+ * Capacity is the number of tuples the minipages have room for, fixed by Init from the schema,
+ * so the page knows its layout without the schema. An inlined column stores the bytes of its
+ * value, a VARCHAR column the offset of its value (size + data) in the page. A TupleView of the
+ * page reads each value straight from its minipage, so a filter on a few columns of a wide table
+ * only touches those minipages; GetTuple puts a tuple back together in the format of Tuple.
+ *
+ * A PAX page is for append-mostly tables: deleted tuples keep their space and InsertTuple always
+ * appends, so a PAX page has no dead tuples to reuse.
+ */
+class TablePaxPage {
+ public:
+  /** Initialize the page for the tuples of `schema`. */
+  void Init(const Schema &schema);
+
+  /** @return whether at least one tuple of `schema` fits into a PAX page */
+  static auto IsSupported(const Schema &schema) -> bool { return ComputeCapacity(schema) > 0; }
+
+  /** @return number of tuples in this page */
+  auto GetNumTuples() const -> uint32_t { return num_tuples_; }
+
+  /** @return number of tuples the minipages have room for */
+  auto GetCapacity() const -> uint32_t { return capacity_; }
+
+  /** @return the page ID of the next table page */
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+  /** Set the page id of the next page in the table. */
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  /** @return the number of bytes left for VARCHAR values, 0 once the minipages are full */
+  auto GetFreeSpace() const -> uint32_t { return num_tuples_ < capacity_ ? heap_pointer_ - HeapStart() : 0; }
+
+  /**
+   * Insert a tuple at the end of the minipages.
+   * @param reuse_slot unused, a PAX page has no slots to reuse
+   * @return the slot of the tuple, nullopt if there is not enough space
+   */
+  auto InsertTuple(const TupleMeta &meta, const Tuple &tuple, bool reuse_slot = false) -> std::optional<uint16_t>;
+
+  /**
+   * Update a tuple.
+   */
+  void UpdateTupleMeta(const TupleMeta &meta, const RID &rid);
+
+  /**
+   * Read a tuple from a table.
+   */
+  auto GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple>;
+
+  /**
+   * Read a tuple from a table without copying it. The view is valid while the page is latched.
+   */
+  auto GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView>;
+
+  /**
+   * Read a tuple meta from a table.
+   */
+  auto GetTupleMeta(const RID &rid) const -> TupleMeta;
+
+  /**
+   * Update a tuple in place. Every VARCHAR value must keep its size.
+   */
+  void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
+
+  /**
+   * @return the bytes of column `column_idx` of the tuple in slot `slot`, only touching the minipage of that
+   * column; for a VARCHAR column, the payload of its value
+   */
+  auto GetColumnData(uint16_t slot, uint32_t column_idx) const -> const char *;
+
+  static_assert(sizeof(page_id_t) == 4);
+
+ private:
+  struct ColumnInfo {
+    uint16_t tuple_offset_;
+    uint16_t width_;
+    uint16_t minipage_offset_;
+    uint16_t is_varchar_;
+  };
+
+  /** VARCHAR bytes per tuple that Init keeps room for, at most */
+  static constexpr uint32_t VARCHAR_RESERVE = 64;
+
+  /** Minipages start at multiples of this, so that values are aligned */
+  static constexpr uint32_t MINIPAGE_ALIGN = 8;
+
+  /** @return the number of tuples of `schema` the minipages of a page have room for, 0 if none fits */
+  static auto ComputeCapacity(const Schema &schema) -> uint32_t;
+
+  static auto AlignUp(uint32_t offset) -> uint32_t {
+    return (offset + MINIPAGE_ALIGN - 1) / MINIPAGE_ALIGN * MINIPAGE_ALIGN;
+  }
+
+  /** @return where the minipages end and the free space starts */
+  auto HeapStart() const -> uint32_t {
+    const auto &last = columns_[num_columns_ - 1];
+    return last.minipage_offset_ + last.width_ * capacity_;
+  }
+
+  /** @return the VARCHAR value of column `col` in the tuple at `tuple_data`, which is in the format of Tuple */
+  static auto VarcharInTuple(const char *tuple_data, const ColumnInfo &col) -> const char *;
+
+  auto Metas() const -> const TupleMeta * { return reinterpret_cast<const TupleMeta *>(page_start_ + meta_offset_); }
+  auto Metas() -> TupleMeta * { return reinterpret_cast<TupleMeta *>(page_start_ + meta_offset_); }
+
+  char page_start_[0];
+  page_id_t next_page_id_;
+  uint16_t num_tuples_;
+  uint16_t capacity_;
+  uint16_t num_columns_;
+  uint16_t heap_pointer_;
+  uint16_t fixed_length_;
+  uint16_t meta_offset_;
+  ColumnInfo columns_[0];
+};
+
+static_assert(sizeof(TablePaxPage) == TABLE_PAX_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
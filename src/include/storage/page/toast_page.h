@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast_page.h
+//
+// Identification: src/include/storage/page/toast_page.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+static constexpr uint64_t TOAST_PAGE_HEADER_SIZE = 8;
+
+/**
+ * A page of the overflow chain of a VARCHAR value stored out of line (see ToastStore). The bytes
+ * of the value are split over the pages of the chain in order, and the last page of the chain
+ * has no next page.
+ *
+ *  Format (size in byte):
+ *  ---------------------------------------------
+ * | NextPageId (4) | Size (4) | Data (Size) ... |
+ *  ---------------------------------------------
+ */
+class ToastPage {
+ public:
+  static constexpr uint32_t CAPACITY = BUSTUB_PAGE_SIZE - TOAST_PAGE_HEADER_SIZE;
+
+  // Delete all constructor / destructor to ensure memory safety
+  ToastPage() = delete;
+  ToastPage(const ToastPage &other) = delete;
+
+  /** Initialize the page with `size` bytes of data, followed by `next_page_id` */
+  void Init(page_id_t next_page_id, uint32_t size) {
+    next_page_id_ = next_page_id;
+    size_ = size;
+  }
+
+  auto GetNextPageId() const -> page_id_t { return next_page_id_; }
+  auto GetSize() const -> uint32_t { return size_; }
+  auto GetData() const -> const char * { return data_; }
+  auto GetData() -> char * { return data_; }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t size_;
+  char data_[0];
+};
+
+static_assert(sizeof(ToastPage) == TOAST_PAGE_HEADER_SIZE);
+
+}  // namespace bustub
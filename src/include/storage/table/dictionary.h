@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dictionary.h
+//
+// Identification: src/include/storage/table/dictionary.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/dictionary_page.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Dictionary maps the values of the dictionary-encoded VARCHAR columns of a table heap to integer
+ * codes, so that a tuple stores a 4-byte code instead of a repeated string (see Tuple). Every
+ * column has its own codes, given out in the order its values are first stored.
+ *
+ * Entries are appended to a chain of DictionaryPages and never removed; the dictionary keeps them
+ * in memory too, so encoding and decoding do not read pages. A column gets at most MAX_CODES
+ * codes, and values longer than MAX_VALUE_LENGTH get none: such values are stored as they are.
+ * Two tuples with codes in the same column have equal values exactly when their codes are equal.
+ */
+class Dictionary {
+ public:
+  /** Most codes a column gets */
+  static constexpr uint32_t MAX_CODES = 1U << 16;
+
+  /** Longest value, in bytes of its payload, that gets a code */
+  static constexpr uint32_t MAX_VALUE_LENGTH = 256;
+
+  /**
+   * @param num_columns the number of columns of the table
+   * @param columns the dictionary-encoded columns, all VARCHAR
+   */
+  Dictionary(BufferPoolManager *bpm, uint32_t num_columns, const std::vector<uint32_t> &columns);
+
+  /** @return whether column `column_idx` is dictionary-encoded */
+  auto IsEncoded(uint32_t column_idx) const -> bool {
+    return column_idx < columns_.size() && columns_[column_idx].has_value();
+  }
+
+  /**
+   * @return the code of the `len` bytes at `data` in column `column_idx`, which get a new code if they have none,
+   * nullopt if they cannot get one
+   */
+  auto Encode(uint32_t column_idx, const char *data, uint32_t len) -> std::optional<uint32_t>;
+
+  /** @return the code of `value` in column `column_idx`, nullopt if it has none */
+  auto Lookup(uint32_t column_idx, const Value &value) const -> std::optional<uint32_t>;
+
+  /** @return the value with code `code` in column `column_idx` */
+  auto Decode(uint32_t column_idx, uint32_t code) const -> Value;
+
+  /** @return the first page of the chain of entries, INVALID_PAGE_ID if there is no entry yet */
+  auto GetFirstPageId() const -> page_id_t;
+
+ private:
+  struct ColumnDictionary {
+    std::unordered_map<std::string, uint32_t> codes_;
+    std::vector<std::string> values_;
+  };
+
+  /** Append an entry to the chain; the caller holds latch_ */
+  void AppendEntry(uint32_t column_idx, const std::string &value);
+
+  BufferPoolManager *bpm_;
+  mutable std::shared_mutex latch_;
+  /** The dictionary of every column, nullopt for columns that are not encoded; protected by latch_ */
+  std::vector<std::optional<ColumnDictionary>> columns_;
+  page_id_t first_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  page_id_t last_page_id_{INVALID_PAGE_ID};  /* protected by latch_ */
+};
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap tracks how much free space every page of a table heap has, so that inserts can
+ * go back to pages that deletes made room in instead of always appending new pages.
+ *
+ * The map is stored in a chain of FreeSpaceMapPages, one category byte per table page, in the
+ * order the pages were added. Every table page is either in use, i.e. an inserter is filling it
+ * and owns its free space, or free for Claim to hand out. In memory the map only keeps where
+ * the entry of each page is, and per map page an upper bound of its largest category, so that
+ * Claim skips map pages without a page that is large enough.
+ *
+ * The map has its own latch and does not latch table pages, so it can be called with any table
+ * page latch dropped.
+ */
+class FreeSpaceMap {
+ public:
+  explicit FreeSpaceMap(BufferPoolManager *bpm);
+
+  /** @return the first page of the map */
+  auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
+
+  /** Add a table page to the map, either in use or free with `free_bytes` free bytes */
+  void AddPage(page_id_t page_id, uint32_t free_bytes, bool in_use);
+
+  /** Record the free space of a table page; ignored while the page is in use */
+  void Update(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Find a page that is not in use with at least `free_bytes` free bytes, and mark it in use.
+   * @return the page, INVALID_PAGE_ID if there is none
+   */
+  auto Claim(uint32_t free_bytes) -> page_id_t;
+
+  /** Give back a page that was in use, with the free space it has left */
+  void Release(page_id_t page_id, uint32_t free_bytes);
+
+ private:
+  /** Set the category of the entry of `page_id`; `force` also overwrites IN_USE */
+  void SetCategory(page_id_t page_id, uint8_t category, bool force);
+
+  BufferPoolManager *bpm_;
+  page_id_t first_page_id_{INVALID_PAGE_ID};
+
+  std::mutex latch_;
+  /** Pages of the map, in chain order */
+  std::vector<page_id_t> map_page_ids_;
+  /** For every page of the map, no entry has a larger category than this, not counting IN_USE */
+  std::vector<uint8_t> max_categories_;
+  /** Table page id -> index of its entry over the whole chain */
+  std::unordered_map<page_id_t, uint32_t> entries_;
+};
+
+}  // namespace bustub
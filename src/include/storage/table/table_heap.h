@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <mutex>  // NOLINT
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/config.h"
@@ -22,14 +25,64 @@
 #include "concurrency/transaction.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
+#include "storage/page/table_pax_page.h"
+#include "storage/table/dictionary.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
+#include "storage/table/toast_store.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
+class TablePage;
+
+/** How the pages of a table heap store their tuples */
+enum class TableFormat : uint8_t {
+  /** Whole tuples in slotted TablePages */
+  ROW,
+  /** Tuples split by column into the minipages of TablePaxPages */
+  PAX,
+};
+
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * Inserts go through NUM_INSERT_TARGETS insert targets. Each thread always uses the same
+ * target, and every target fills its own page, so writers on different targets append to
+ * different pages in parallel. A target whose page is full gives it back to the free space
+ * map and claims a page with enough free space from it, or appends a new page to the end of
+ * the list. New pages are allocated under latch_, so page ids increase along the list. A batch
+ * insert appends the pages it needs in one run, and its target keeps the pages it did not fill
+ * as spare pages for its next inserts.
+ *
+ * Deleted tuples become dead once the deletion completes (see TablePage). Their space goes
+ * back to the free space map, and a page that takes inserts again compacts itself and reuses
+ * their slots, so a table under insert/delete churn keeps its size.
+ *
+ * Since inserts no longer only go to the last page, MakeIterator records how many tuples
+ * every page that the targets are filling or keep as spare pages had when the iterator was made. While such an
+ * iterator is alive, inserts neither reuse slots nor claim pages from the free space map,
+ * so the tuples they insert are always past the limits of the iterator.
+ *
+ * A table heap of format PAX uses TablePaxPages instead of TablePages, behind the same interface.
+ * Every method reaches its pages through VisitPage, which hands the page to code written for both
+ * formats. PAX pages never have dead tuples, so deletes give no space back to the free space map.
+ *
+ * A row table heap made with a schema stores a null bitmap after the data of every tuple (see TablePage), which
+ * inserts and in-place updates build from the values, so that tuples and views read from the heap tell null
+ * values apart without deserializing them.
+ *
+ * A table heap made with a schema keeps a zone map of its pages. Inserts and in-place updates widen
+ * the zone of a page before the tuple can be seen by an iterator that is limited to it, and an
+ * iterator made with zone predicates does not read the pages the zone map rules out.
+ *
+ * A table heap made with a schema stores VARCHAR values longer than ToastStore::THRESHOLD out of
+ * line: inserts and in-place updates put them into its toast store and keep a toast pointer in the
+ * page. The values of its dictionary-encoded columns are stored as codes of its dictionary. Tuples
+ * and views read from the heap fetch or decode such a value only when the column is read, and an
+ * iterator compares the codes of a column with an equality zone predicate before filtering.
  */
 class TableHeap {
   friend class TableIterator;
@@ -45,7 +98,25 @@ class TableHeap {
   explicit TableHeap(BufferPoolManager *bpm);
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return std::nullopt.
+   * Create a table heap of the given format.
+   * @param schema the schema of the tuples, which the zone map tracks and the pages of a PAX table heap are laid
+   * out for
+   * @param dictionary_columns the VARCHAR columns whose values are stored as dictionary codes
+   */
+  TableHeap(BufferPoolManager *bpm, TableFormat format, const Schema &schema,
+            const std::vector<uint32_t> &dictionary_columns = {});
+
+  /** @return how the pages of this table store their tuples */
+  inline auto GetFormat() const -> TableFormat { return format_; }
+
+  /** @return the zone map of the pages of this table */
+  inline auto GetZoneMap() const -> const ZoneMap & { return zone_map_; }
+
+  /** @return the dictionary of the dictionary-encoded columns of this table */
+  inline auto GetDictionary() const -> const Dictionary & { return dictionary_; }
+
+  /**
+   * Insert a tuple into the table. Long VARCHAR values are stored out of line, so that the tuple fits into a page.
    * @param meta tuple meta
    * @param tuple tuple to insert
    * @return rid of the inserted tuple
@@ -53,6 +124,15 @@ class TableHeap {
   auto InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr = nullptr,
                    Transaction *txn = nullptr, table_oid_t oid = 0) -> std::optional<RID>;
 
+  /**
+   * Insert a batch of tuples into the table. Each page is filled under a single write guard, the rows of a page are
+   * locked with one LockRows call, and pages the batch needs are appended in runs.
+   * @param tuples the tuples to insert with their metas
+   * @return the rids of the inserted tuples, in the order of `tuples`
+   */
+  auto InsertTuples(const std::vector<std::pair<TupleMeta, Tuple>> &tuples, LockManager *lock_mgr = nullptr,
+                    Transaction *txn = nullptr, table_oid_t oid = 0) -> std::vector<RID>;
+
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
    * @param meta new tuple meta
@@ -75,8 +155,14 @@ class TableHeap {
    */
   auto GetTupleMeta(RID rid) -> TupleMeta;
 
-  /** @return the iterator of this table, use this for project 3 */
-  auto MakeIterator() -> TableIterator;
+  /**
+   * @param filter if set, the iterator only returns the tuples it accepts, and copies no other tuple
+   * @param zone_predicates conditions that every tuple the filter accepts meets; the iterator skips the pages
+   * whose zones rule them out
+   * @return the iterator of this table, use this for project 3
+   */
+  auto MakeIterator(TableIterator::Filter filter = nullptr, std::vector<ZonePredicate> zone_predicates = {})
+      -> TableIterator;
 
   /** @return the iterator of this table, use this for project 4 except updates */
   auto MakeEagerIterator() -> TableIterator;
@@ -93,11 +179,98 @@ class TableHeap {
   void UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid);
 
  private:
+  static constexpr size_t NUM_INSERT_TARGETS = 8;
+
+  /** Most pages a batch insert appends at once */
+  static constexpr size_t MAX_PAGE_RUN = 16;
+
+  /** The page that a group of inserting threads fills */
+  struct InsertTarget {
+    std::mutex latch_;
+    page_id_t page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+    /** Empty pages appended for the target in a run and not filled yet, last one first; protected by latch_ */
+    std::vector<page_id_t> spare_pages_;
+  };
+
+  /** Call `f` with the page held by `guard`, as a `const TablePage *` or a `const TablePaxPage *` */
+  template <typename F>
+  auto VisitPage(ReadPageGuard &guard, F &&f) const {
+    if (format_ == TableFormat::PAX) {
+      return f(guard.As<TablePaxPage>());
+    }
+    return f(guard.As<TablePage>());
+  }
+
+  /** Call `f` with the page held by `guard`, as a `TablePage *` or a `TablePaxPage *` */
+  template <typename F>
+  auto VisitPage(WritePageGuard &guard, F &&f) const {
+    if (format_ == TableFormat::PAX) {
+      return f(guard.AsMut<TablePaxPage>());
+    }
+    return f(guard.AsMut<TablePage>());
+  }
+
+  /**
+   * Encode the values of `tuple` that are not stored as they are: values of dictionary-encoded columns get their
+   * code, and long VARCHAR values go to the toast store. Toast pointers and codes of a tuple read from another
+   * heap only mean something in that heap, their values are fetched and encoded again for this heap.
+   * The tuple also gets the null bitmap of the pages of this heap in place of the one it has.
+   * @return the tuple with codes and toast pointers in place of those values, nullopt if it has none to encode and
+   * already has the null bitmap of this heap
+   */
+  auto EncodeValues(const Tuple &tuple) -> std::optional<Tuple>;
+
+  /** @return the tuple with codes and toast pointers in place of the values encoded by EncodeValues */
+  auto EncodeVarcharValues(const Tuple &tuple) -> std::optional<Tuple>;
+
+  /**
+   * Initialize a new page of the table.
+   * @return the free space of the page
+   */
+  auto InitPage(BasicPageGuard *guard) -> uint32_t;
+
+  /** @return the insert target of the calling thread */
+  auto GetInsertTarget() -> InsertTarget &;
+
+  /**
+   * Move an insert target to the next page to fill, giving its current page back to the free space map. The next
+   * page is a spare page of the target, a page from the free space map with at least `free_bytes` free bytes, or
+   * the first of `run_length` new pages appended to the list. The caller holds the latch of the target, and
+   * `page_guard` is the guard of its current page, replaced by the guard of the next one.
+   */
+  void SwitchPage(InsertTarget *target, WritePageGuard *page_guard, uint32_t free_bytes, size_t run_length);
+
+  /** Append `n` new pages to the end of the list, in use. */
+  auto AppendPages(size_t n) -> std::vector<page_id_t>;
+
+  /** Tell the free space map about the space a completed delete left in a page, once it is worth reusing */
+  void RecordFreeSpace(page_id_t page_id, uint32_t free_bytes);
+
+  /** Called by an iterator from MakeIterator when it reaches the end or is destroyed */
+  void EndScan() { active_scans_--; }
+
+  /** Pages with less free space are not handed out again, so that a target does not switch pages on every insert */
+  static constexpr uint32_t MIN_REUSE_BYTES = BUSTUB_PAGE_SIZE / 8;
+
   BufferPoolManager *bpm_;
+  TableFormat format_{TableFormat::ROW};
+  /** The schema of the tuples, without columns if the table heap was made without one */
+  Schema schema_;
+  /** The size of the null bitmap after the data of a tuple in the pages, 0 for a PAX heap or a heap without schema */
+  uint8_t null_bitmap_size_{0};
+  ZoneMap zone_map_{&schema_};
+  ToastStore toast_store_;
+  Dictionary dictionary_;
   page_id_t first_page_id_{INVALID_PAGE_ID};
 
   std::mutex latch_;
   page_id_t last_page_id_{INVALID_PAGE_ID}; /* protected by latch_ */
+  FreeSpaceMap free_space_map_;
+  /** Number of iterators from MakeIterator that have not reached their end */
+  std::atomic<int> active_scans_{0};
+
+  /** Lock order: the latch of a target, then latch_, then page latches */
+  std::array<InsertTarget, NUM_INSERT_TARGETS> insert_targets_;
 };
 
 }  // namespace bustub
@@ -13,13 +13,16 @@
 #pragma once
 
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "common/macros.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
@@ -27,17 +30,43 @@ class TableHeap;
 
 /**
  * TableIterator enables the sequential scan of a TableHeap.
+ *
+ * The iterator does not fetch a page per tuple: when it enters a page it copies every tuple it
+ * is going to return from that page (a "batch") while holding one read guard, then drops the
+ * guard and serves the batch from memory, so GetTuple returns the tuple as it was when its page
+ * was read. The guard is not kept between calls, as the caller may write to the same table while
+ * it scans it. Once the batch is used up, the page is read again, so that tuples appended to it
+ * in the meantime are still returned if the limits of the iterator allow.
+ *
+ * An iterator may have a filter, which looks at every tuple through a TupleView while the page
+ * is latched. Tuples the filter rejects are skipped without being copied. Zone predicates that
+ * every accepted tuple meets let the iterator go from page to page through the zone map of the
+ * table heap, which only gives it the pages that may hold such tuples; the others are not read.
+ * An equality zone predicate on a dictionary-encoded column is checked on the codes of the tuples
+ * first, and the filter only sees the tuples whose code matches.
  */
 class TableIterator {
   friend class Cursor;
 
  public:
+  /** Decides whether the iterator returns a tuple; called while the page of the tuple is latched */
+  using Filter = std::function<bool(const TupleMeta &, const TupleView &)>;
+
   DISALLOW_COPY(TableIterator);
 
-  TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid);
-  TableIterator(TableIterator &&) = default;
+  /**
+   * @param rid the first RID to visit
+   * @param stop_at_rid the end of the scan, {INVALID_PAGE_ID, 0} to scan until the last page
+   * @param page_limits for pages other than the stop page, (page id, number of tuples to scan in that page)
+   * @param in_scan whether the iterator holds a scan of the table heap, which it ends when it reaches the end
+   * @param filter if set, only the tuples it accepts are returned
+   * @param zone_predicates conditions met by every tuple the filter accepts, used to skip pages
+   */
+  TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid, std::vector<RID> page_limits = {},
+                bool in_scan = false, Filter filter = nullptr, std::vector<ZonePredicate> zone_predicates = {});
+  TableIterator(TableIterator &&that) noexcept;
 
-  ~TableIterator() = default;
+  ~TableIterator();
 
   auto GetTuple() -> std::pair<TupleMeta, Tuple>;
 
@@ -48,6 +77,25 @@ class TableIterator {
   auto operator++() -> TableIterator &;
 
  private:
+  /**
+   * Move rid_ forward to the first tuple to scan, skipping pages that have none left, and copy the tuples to scan
+   * from its page into the batch.
+   */
+  void SeekVisible();
+
+  /**
+   * Copy the tuples to scan from `page`, the page of rid_, into the batch, starting at rid_.
+   * @return false if the page has no tuple left to return
+   */
+  template <typename Page>
+  auto LoadBatch(const Page *page, bool is_stop_page) -> bool;
+
+  /** @return false if the code of a column of `view` rules out an equality zone predicate */
+  auto MatchesCodes(const TupleView &view) const -> bool;
+
+  /** End the scan held by the iterator, if any */
+  void EndScan();
+
   TableHeap *table_heap_;
   RID rid_;
 
@@ -55,6 +103,24 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  // Inserts do not only go to the last page, so pages that could still take inserts when the iterator was created
+  // also have a limit, stored as RIDs whose slot is the number of tuples to scan.
+  std::vector<RID> page_limits_;
+
+  Filter filter_;
+  std::vector<ZonePredicate> zone_predicates_;
+  // (column, code) of the equality zone predicates whose value has a code in the dictionary of the table heap
+  std::vector<std::pair<uint32_t, uint32_t>> code_predicates_;
+
+  // Tuples copied from the current page; batch_[cursor_] is the tuple at rid_. The batch covers the slots of the
+  // page up to batch_end_, which is where the next batch of the page starts.
+  std::vector<std::pair<TupleMeta, Tuple>> batch_;
+  size_t cursor_{0};
+  uint32_t batch_end_{0};
+
+  // While the scan is held, inserts do not reuse space that the iterator has not reached yet.
+  bool in_scan_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast_store.h
+//
+// Identification: src/include/storage/table/toast_store.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "storage/page/toast_page.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ToastStore keeps the VARCHAR values of a table heap that are too long to be stored inline. The
+ * bytes of such a value go to a chain of ToastPages, and the tuple only keeps a toast pointer to
+ * the chain (see Tuple), so a tuple with long values stays small and a page holds as many tuples
+ * as if the values were short. A value is read from its chain only when it is read from the tuple;
+ * a scan that does not read the column never touches the chain.
+ *
+ * Chains are written once and never changed, so reading them needs no latch of the store. They are
+ * not reclaimed when the tuple that points to them is deleted or updated.
+ */
+class ToastStore {
+ public:
+  /** Values longer than this, in bytes, are stored out of line */
+  static constexpr uint32_t THRESHOLD = BUSTUB_PAGE_SIZE / 16;
+
+  explicit ToastStore(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  /**
+   * Write the `len` bytes at `data` to a new chain.
+   * @return the first page of the chain
+   */
+  auto Store(const char *data, uint32_t len) const -> page_id_t;
+
+  /** @return the VARCHAR value that the toast pointer at `pointer` points to */
+  auto Fetch(const char *pointer) const -> Value;
+
+ private:
+  BufferPoolManager *bpm_;
+};
+
+}  // namespace bustub
@@ -12,15 +12,22 @@
 
 #pragma once
 
+#include <cassert>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "catalog/schema.h"
 #include "common/rid.h"
+#include "type/limits.h"
 #include "type/value.h"
 
 namespace bustub {
 
+class TablePaxPage;
+class ToastStore;
+class Dictionary;
+
 static constexpr size_t TUPLE_META_SIZE = 12;
 
 struct TupleMeta {
@@ -47,11 +54,61 @@ static_assert(sizeof(TupleMeta) == TUPLE_META_SIZE);
  * ---------------------------------------------------------------------
  * | FIXED-SIZE or VARIED-SIZED OFFSET | PAYLOAD OF VARIED-SIZED FIELD |
  * ---------------------------------------------------------------------
+ *
+ * The payload of a VARCHAR value is its size and its bytes. A table heap stores long values out
+ * of line (see ToastStore); the payload of such a value is a toast pointer instead:
+ * ---------------------------------------------------
+ * | SIZE with TOAST_FLAG set (4) | FIRST PAGE ID (4) |
+ * ---------------------------------------------------
+ * The values of a dictionary-encoded column are stored as their code in the dictionary of the
+ * heap (see Dictionary):
+ * ------------------------------------
+ * | CODE with DICTIONARY_FLAG set (4) |
+ * ------------------------------------
+ * A tuple read from a table heap knows the toast store and the dictionary of the heap, and
+ * fetches or decodes such a value when the value is read.
+ *
+ * A tuple stored by a table heap with a schema is followed by a null bitmap, bit i set if column i
+ * is null (see TablePage). GetData and GetLength leave it out, and IsNull reads it instead of the
+ * value. A null value is still serialized as its sentinel, so GetValue does not need the bitmap.
+ * ------------------------------------------
+ * | data | NULL BITMAP ((column count + 7) / 8) |
+ * ------------------------------------------
  */
+static constexpr uint32_t TOAST_FLAG = 1U << 31;
+static constexpr uint32_t TOAST_POINTER_SIZE = 8;
+static constexpr uint32_t DICTIONARY_FLAG = 1U << 30;
+
+/** @return whether the VARCHAR payload at `data` is a toast pointer */
+inline auto IsToastPointer(const char *data) -> bool {
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data);
+  return len != BUSTUB_VALUE_NULL && (len & TOAST_FLAG) != 0;
+}
+
+/** @return whether the VARCHAR payload at `data` is a dictionary code */
+inline auto IsDictionaryCode(const char *data) -> bool {
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data);
+  return len != BUSTUB_VALUE_NULL && (len & (TOAST_FLAG | DICTIONARY_FLAG)) == DICTIONARY_FLAG;
+}
+
+/** @return the size of the VARCHAR payload at `data` */
+inline auto VarcharPayloadSize(const char *data) -> uint32_t {
+  uint32_t len = *reinterpret_cast<const uint32_t *>(data);
+  if (IsToastPointer(data)) {
+    return TOAST_POINTER_SIZE;
+  }
+  if (IsDictionaryCode(data) || len == BUSTUB_VALUE_NULL) {
+    return sizeof(uint32_t);
+  }
+  return sizeof(uint32_t) + len;
+}
+
 class Tuple {
   friend class TablePage;
+  friend class TablePaxPage;
   friend class TableHeap;
   friend class TableIterator;
+  friend class TupleView;
 
  public:
   // Default constructor (to create a dummy tuple)
@@ -87,7 +144,7 @@ class Tuple {
   inline auto GetData() const -> const char * { return data_.data(); }
 
   // Get length of the tuple, including varchar legth
-  inline auto GetLength() const -> uint32_t { return data_.size(); }
+  inline auto GetLength() const -> uint32_t { return data_.size() - null_bitmap_size_; }
 
   // Get the value of a specified column (const)
   // checks the schema to see how to return the Value.
@@ -96,11 +153,8 @@ class Tuple {
   // Generates a key tuple given schemas and attributes
   auto KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) -> Tuple;
 
-  // Is the column value null ?
-  inline auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
-    Value value = GetValue(schema, column_idx);
-    return value.IsNull();
-  }
+  // Is the column value null ? A value behind a toast pointer or a code is not read.
+  auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool;
 
   auto ToString(const Schema *schema) const -> std::string;
 
@@ -109,7 +163,82 @@ class Tuple {
   auto GetDataPtr(const Schema *schema, uint32_t column_idx) const -> const char *;
 
   RID rid_{};  // if pointing to the table heap, the rid is valid
+  // the data, followed by the null bitmap if the tuple has one
   std::vector<char> data_;
+  uint8_t null_bitmap_size_{0};
+  // where the values behind toast pointers and codes are, if read from a table heap
+  const ToastStore *toast_store_{nullptr};
+  const Dictionary *dictionary_{nullptr};
+};
+
+/**
+ * TupleView reads a tuple in the format of Tuple without owning its bytes. A view returned by
+ * TablePage::GetTupleView points into the page and is only valid while the guard of the page is
+ * held; a view of a Tuple is valid while the tuple is alive and unchanged. Reading values from a
+ * view costs no copy of the tuple, so scans look at rows through views and copy only the rows
+ * they return (see ToTuple).
+ *
+ * A view of a tuple in a TablePaxPage has no bytes in the format of Tuple: it reads every value
+ * from the minipage of its column, and GetData/GetLength must not be called on it.
+ */
+class TupleView {
+ public:
+  /** A view of the `size` bytes at `data`, followed by a null bitmap of `null_bitmap_size` bytes */
+  TupleView(const char *data, uint32_t size, RID rid, uint8_t null_bitmap_size = 0)
+      : data_(data), size_(size), null_bitmap_size_(null_bitmap_size), rid_(rid) {}
+
+  explicit TupleView(const Tuple &tuple)
+      : data_(tuple.data_.data()),
+        size_(tuple.GetLength()),
+        null_bitmap_size_(tuple.null_bitmap_size_),
+        toast_store_(tuple.toast_store_),
+        dictionary_(tuple.dictionary_),
+        rid_(tuple.rid_) {}
+
+  /** A view of the tuple in slot `slot` of a PAX page */
+  TupleView(const TablePaxPage *pax_page, uint16_t slot, RID rid) : pax_page_(pax_page), slot_(slot), rid_(rid) {}
+
+  inline auto GetRid() const -> RID { return rid_; }
+
+  inline auto GetData() const -> const char * {
+    assert(pax_page_ == nullptr);
+    return data_;
+  }
+
+  inline auto GetLength() const -> uint32_t {
+    assert(pax_page_ == nullptr);
+    return size_;
+  }
+
+  // Get the value of a specified column, as Tuple::GetValue
+  auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value;
+
+  auto IsNull(const Schema *schema, uint32_t column_idx) const -> bool;
+
+  // Get the dictionary code of a VARCHAR column, nullopt if the value is not stored as a code
+  auto GetCode(const Schema *schema, uint32_t column_idx) const -> std::optional<uint32_t>;
+
+  // Set where the values behind toast pointers and codes are
+  inline void SetValueStores(const ToastStore *toast_store, const Dictionary *dictionary) {
+    toast_store_ = toast_store;
+    dictionary_ = dictionary;
+  }
+
+  // Copy the viewed bytes into a tuple that owns them
+  auto ToTuple() const -> Tuple;
+
+ private:
+  // Get the starting storage address of specific column
+  auto ColumnData(const Schema *schema, uint32_t column_idx) const -> const char *;
+
+  const char *data_{nullptr};
+  uint32_t size_{0};
+  uint8_t null_bitmap_size_{0};
+  const TablePaxPage *pax_page_{nullptr};
+  uint16_t slot_{0};
+  const ToastStore *toast_store_{nullptr};
+  const Dictionary *dictionary_{nullptr};
+  RID rid_;
 };
 
 }  // namespace bustub
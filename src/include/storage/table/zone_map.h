@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <map>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+enum class ZoneOp { Equal, LessThan, LessThanOrEqual, GreaterThan, GreaterThanOrEqual };
+
+/** A condition `column op value` that every tuple a scan returns meets */
+struct ZonePredicate {
+  uint32_t col_idx_;
+  ZoneOp op_;
+  Value value_;
+};
+
+/**
+ * ZoneMap keeps, for every page of a table heap, the min and max value and the number of nulls of
+ * each column over the tuples stored in the page, so that a scan can skip the pages that cannot
+ * hold a tuple it returns.
+ *
+ * Zones only grow: inserts and in-place updates widen them, deletes leave them as they are, so a
+ * zone may be wider than the tuples left in its page but never misses one of them. The map is kept
+ * in memory, ordered by page id; since page ids increase along the list of a table heap, the
+ * order of the map is the order of a scan, and NextCandidate finds the next page to read without
+ * reading the pages in between.
+ *
+ * A map for a schema without columns tracks nothing and skips no page. The map has its own latch
+ * and takes no other latch while holding it.
+ */
+class ZoneMap {
+ public:
+  /** Min, max and null count of one column of a page; min and max are unset until a non-null value is stored */
+  struct ColumnZone {
+    std::optional<Value> min_;
+    std::optional<Value> max_;
+    uint32_t null_count_{0};
+  };
+
+  /** @param schema the schema of the tuples, must outlive the map */
+  explicit ZoneMap(const Schema *schema) : schema_(schema) {}
+
+  /** Start tracking a new, empty page */
+  void AddPage(page_id_t page_id);
+
+  /** Widen the zones of a page to cover `tuple`, which is stored in it */
+  void Update(page_id_t page_id, const Tuple &tuple);
+
+  /** @return the zones of the columns of a page, empty if the page is not tracked */
+  auto GetZones(page_id_t page_id) const -> std::vector<ColumnZone>;
+
+  /**
+   * @return the first page from `page_id` on, in page id order, whose zones allow a tuple that meets all of
+   * `predicates`, INVALID_PAGE_ID if there is none
+   */
+  auto NextCandidate(page_id_t page_id, const std::vector<ZonePredicate> &predicates) const -> page_id_t;
+
+ private:
+  /** @return whether a column with zone `zone` may have a value that meets `predicate` */
+  static auto MayMatch(const ColumnZone &zone, const ZonePredicate &predicate) -> bool;
+
+  const Schema *schema_;
+  mutable std::mutex latch_;
+  std::map<page_id_t, std::vector<ColumnZone>> zones_; /* protected by latch_ */
+};
+
+}  // namespace bustub
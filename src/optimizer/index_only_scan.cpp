@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** Collect the columns of the child tuple that `expr` reads */
+void CollectColumns(const AbstractExpressionRef &expr, std::vector<uint32_t> *column_ids) {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    column_ids->push_back(column_value_expr->GetColIdx());
+  }
+  for (const auto &child : expr->GetChildren()) {
+    CollectColumns(child, column_ids);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeIndexOnlyScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeIndexOnlyScan(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() == PlanType::Projection) {
+    const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*optimized_plan);
+    const auto &child_plan = projection.GetChildPlan();
+    if (child_plan->GetType() != PlanType::IndexScan) {
+      return optimized_plan;
+    }
+    const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+    if (index_scan.IsIndexOnly()) {
+      return optimized_plan;
+    }
+
+    std::vector<uint32_t> column_ids;
+    for (const auto &expr : projection.GetExpressions()) {
+      CollectColumns(expr, &column_ids);
+    }
+
+    // Every column the projection reads must be a key or included column of the index
+    const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+    const auto &key_attrs = index_info->index_->GetKeyAttrs();
+    bool covered = std::all_of(column_ids.begin(), column_ids.end(), [&](uint32_t column_id) {
+      return std::find(key_attrs.begin(), key_attrs.end(), column_id) != key_attrs.end();
+    });
+    if (covered) {
+      auto index_only_scan = std::make_shared<IndexScanPlanNode>(index_scan.output_schema_, index_scan.GetIndexOid(),
+                                                                 index_scan.IsReverse(), true);
+      return optimized_plan->CloneWithChildren({index_only_scan});
+    }
+  }
+
+  return optimized_plan;
+}
+
+}  // namespace bustub
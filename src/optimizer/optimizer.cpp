@@ -12,6 +12,7 @@ auto Optimizer::Optimize(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef
     p = OptimizeMergeProjection(p);
     p = OptimizeMergeFilterNLJ(p);
     p = OptimizeOrderByAsIndexScan(p);
+    p = OptimizeIndexOnlyScan(p);
     p = OptimizeSortLimitAsTopN(p);
     return p;
   }
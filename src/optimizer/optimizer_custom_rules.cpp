@@ -13,7 +13,10 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   p = OptimizeMergeFilterNLJ(p);
   p = OptimizeNLJAsHashJoin(p);
   p = OptimizeOrderByAsIndexScan(p);
+  p = OptimizeIndexOnlyScan(p);
   p = OptimizeSortLimitAsTopN(p);
+  // 放在最后：前面的规则只认不带过滤条件的SeqScan
+  p = OptimizeMergeFilterScan(p);
   return p;
 }
 
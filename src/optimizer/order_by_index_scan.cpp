@@ -33,9 +33,14 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     const auto &order_bys = sort_plan.GetOrderBy();
 
     std::vector<uint32_t> order_by_column_ids;
+    // All order bys must go in the same direction; a descending order is served by a reverse index scan
+    bool reverse = !order_bys.empty() && order_bys[0].first == OrderByType::DESC;
     for (const auto &[order_type, expr] : order_bys) {
-      // Order type is asc or default
-      if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+      bool is_desc = order_type == OrderByType::DESC;
+      if (!is_desc && !(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+        return optimized_plan;
+      }
+      if (is_desc != reverse) {
         return optimized_plan;
       }
 
@@ -52,25 +57,43 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
     BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "Sort with multiple children?? Impossible!");
     const auto &child_plan = optimized_plan->children_[0];
 
-    if (child_plan->GetType() == PlanType::SeqScan) {
-      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
+    // A projection between the sort and the scan stays on top of the index scan, as long as the
+    // order by columns are plain columns of the table
+    const ProjectionPlanNode *projection = nullptr;
+    AbstractPlanNodeRef scan_plan = child_plan;
+    if (child_plan->GetType() == PlanType::Projection) {
+      projection = dynamic_cast<const ProjectionPlanNode *>(child_plan.get());
+      for (auto &column_id : order_by_column_ids) {
+        const auto *column_value_expr =
+            dynamic_cast<const ColumnValueExpression *>(projection->GetExpressions()[column_id].get());
+        if (column_value_expr == nullptr) {
+          return optimized_plan;
+        }
+        column_id = column_value_expr->GetColIdx();
+      }
+      scan_plan = projection->GetChildPlan();
+    }
+
+    if (scan_plan->GetType() == PlanType::SeqScan &&
+        dynamic_cast<const SeqScanPlanNode &>(*scan_plan).filter_predicate_ == nullptr) {
+      const auto &seq_scan = dynamic_cast<const SeqScanPlanNode &>(*scan_plan);
       const auto *table_info = catalog_.GetTable(seq_scan.GetTableOid());
       const auto indices = catalog_.GetTableIndexes(table_info->name_);
 
       for (const auto *index : indices) {
-        const auto &columns = index->key_schema_.GetColumns();
-        // check index key schema == order by columns
-        bool valid = true;
-        if (columns.size() == order_by_column_ids.size()) {
-          for (size_t i = 0; i < columns.size(); i++) {
-            if (columns[i].GetName() != table_info->schema_.GetColumn(order_by_column_ids[i]).GetName()) {
-              valid = false;
-              break;
-            }
-          }
-          if (valid) {
-            return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+        // only the B+ tree index scan can produce tuples in key order
+        if (index->index_type_ != IndexType::BPlusTreeIndex) {
+          continue;
+        }
+        // check index key columns == order by columns; included columns don't take part in the order
+        const auto &key_attrs = index->index_->GetKeyAttrs();
+        if (index->KeyColumnCount() == order_by_column_ids.size() &&
+            std::equal(order_by_column_ids.begin(), order_by_column_ids.end(), key_attrs.begin())) {
+          auto index_scan = std::make_shared<IndexScanPlanNode>(seq_scan.output_schema_, index->index_oid_, reverse);
+          if (projection == nullptr) {
+            return index_scan;
           }
+          return projection->CloneWithChildren({index_scan});
         }
       }
     }
@@ -0,0 +1,668 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art.cpp
+//
+// Identification: src/storage/index/art.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art.h"
+
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr uint64_t OBSOLETE_BIT = 0b01;
+constexpr uint64_t LOCKED_BIT = 0b10;
+/** Marks an unused byte in the index of a Node48 */
+constexpr uint8_t EMPTY_INDEX = 0xFF;
+
+}  // namespace
+
+struct AdaptiveRadixTree::Node4 : public Node {
+  Node4() : Node(NodeType::NODE4) {}
+  uint8_t keys_[4]{};
+  Child children_[4]{};
+};
+
+struct AdaptiveRadixTree::Node16 : public Node {
+  Node16() : Node(NodeType::NODE16) {}
+  uint8_t keys_[16]{};
+  Child children_[16]{};
+};
+
+struct AdaptiveRadixTree::Node48 : public Node {
+  Node48() : Node(NodeType::NODE48) { memset(child_index_, EMPTY_INDEX, sizeof(child_index_)); }
+  uint8_t child_index_[256];
+  Child children_[48]{};
+};
+
+struct AdaptiveRadixTree::Node256 : public Node {
+  Node256() : Node(NodeType::NODE256) {}
+  Child children_[256]{};
+};
+
+void AdaptiveRadixTree::Node::SetPrefix(std::string_view prefix) {
+  BUSTUB_ASSERT(prefix.size() <= MAX_KEY_SIZE, "prefix is too long");
+  // the new prefix may be a suffix of the current one
+  memmove(prefix_, prefix.data(), prefix.size());
+  prefix_size_ = prefix.size();
+}
+
+AdaptiveRadixTree::AdaptiveRadixTree() : root_(new Node256()) {}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() {
+  // 已经retire的结点由epoch_析构时释放
+  FreeSubtree(FromNode(root_));
+}
+
+/*****************************************************************************
+ * OPTIMISTIC LOCK COUPLING
+ *****************************************************************************/
+
+auto AdaptiveRadixTree::ReadLockOrRestart(const Node *node, bool *restart) -> uint64_t {
+  uint64_t version = node->version_.load(std::memory_order_acquire);
+  if ((version & (LOCKED_BIT | OBSOLETE_BIT)) != 0) {
+    *restart = true;
+  }
+  return version;
+}
+
+void AdaptiveRadixTree::CheckOrRestart(const Node *node, uint64_t version, bool *restart) {
+  if (node->version_.load(std::memory_order_acquire) != version) {
+    *restart = true;
+  }
+}
+
+void AdaptiveRadixTree::UpgradeToWriteLockOrRestart(Node *node, uint64_t version, bool *restart) {
+  if (!node->version_.compare_exchange_strong(version, version + LOCKED_BIT, std::memory_order_acquire)) {
+    *restart = true;
+  }
+}
+
+void AdaptiveRadixTree::WriteUnlock(Node *node) {
+  // 清除锁标记并进位，版本号随之变化
+  node->version_.fetch_add(LOCKED_BIT, std::memory_order_release);
+}
+
+void AdaptiveRadixTree::WriteUnlockObsolete(Node *node) {
+  node->version_.fetch_add(LOCKED_BIT | OBSOLETE_BIT, std::memory_order_release);
+}
+
+/*****************************************************************************
+ * NODE LAYOUTS
+ *****************************************************************************/
+
+auto AdaptiveRadixTree::FindChild(const Node *node, uint8_t byte) -> Child {
+  // 乐观读可能看到不一致的count，只用来限制循环的范围，结果由版本号校验
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      const auto *node4 = static_cast<const Node4 *>(node);
+      for (int i = 0; i < std::min<int>(node->count_, 4); i++) {
+        if (node4->keys_[i] == byte) {
+          return node4->children_[i];
+        }
+      }
+      return 0;
+    }
+    case NodeType::NODE16: {
+      const auto *node16 = static_cast<const Node16 *>(node);
+      for (int i = 0; i < std::min<int>(node->count_, 16); i++) {
+        if (node16->keys_[i] == byte) {
+          return node16->children_[i];
+        }
+      }
+      return 0;
+    }
+    case NodeType::NODE48: {
+      const auto *node48 = static_cast<const Node48 *>(node);
+      uint8_t index = node48->child_index_[byte];
+      return index < 48 ? node48->children_[index] : 0;
+    }
+    case NodeType::NODE256:
+      return static_cast<const Node256 *>(node)->children_[byte];
+  }
+  UNREACHABLE("unknown node type");
+}
+
+auto AdaptiveRadixTree::IsFull(const Node *node) -> bool {
+  switch (node->type_) {
+    case NodeType::NODE4:
+      return node->count_ == 4;
+    case NodeType::NODE16:
+      return node->count_ == 16;
+    case NodeType::NODE48:
+      return node->count_ == 48;
+    case NodeType::NODE256:
+      return false;
+  }
+  UNREACHABLE("unknown node type");
+}
+
+namespace {
+
+/** Insert into the sorted key/child arrays of a Node4 or Node16 */
+template <typename ChildType>
+void InsertSorted(uint8_t *keys, ChildType *children, uint16_t *count, uint8_t byte, ChildType child) {
+  int pos = 0;
+  while (pos < *count && keys[pos] < byte) {
+    pos++;
+  }
+  memmove(keys + pos + 1, keys + pos, *count - pos);
+  memmove(children + pos + 1, children + pos, (*count - pos) * sizeof(ChildType));
+  keys[pos] = byte;
+  children[pos] = child;
+  (*count)++;
+}
+
+template <typename ChildType>
+void RemoveSorted(uint8_t *keys, ChildType *children, uint16_t *count, uint8_t byte) {
+  for (int pos = 0; pos < *count; pos++) {
+    if (keys[pos] == byte) {
+      memmove(keys + pos, keys + pos + 1, *count - pos - 1);
+      memmove(children + pos, children + pos + 1, (*count - pos - 1) * sizeof(ChildType));
+      (*count)--;
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+void AdaptiveRadixTree::AddChild(Node *node, uint8_t byte, Child child) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      InsertSorted(node4->keys_, node4->children_, &node->count_, byte, child);
+      return;
+    }
+    case NodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      InsertSorted(node16->keys_, node16->children_, &node->count_, byte, child);
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      uint8_t slot = 0;
+      while (node48->children_[slot] != 0) {
+        slot++;
+      }
+      node48->children_[slot] = child;
+      node48->child_index_[byte] = slot;
+      node->count_++;
+      return;
+    }
+    case NodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+      node->count_++;
+      return;
+  }
+}
+
+void AdaptiveRadixTree::ReplaceChild(Node *node, uint8_t byte, Child child) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      for (int i = 0; i < node->count_; i++) {
+        if (node4->keys_[i] == byte) {
+          node4->children_[i] = child;
+        }
+      }
+      return;
+    }
+    case NodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      for (int i = 0; i < node->count_; i++) {
+        if (node16->keys_[i] == byte) {
+          node16->children_[i] = child;
+        }
+      }
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte]] = child;
+      return;
+    }
+    case NodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte] = child;
+      return;
+  }
+}
+
+void AdaptiveRadixTree::RemoveChild(Node *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      RemoveSorted(node4->keys_, node4->children_, &node->count_, byte);
+      return;
+    }
+    case NodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      RemoveSorted(node16->keys_, node16->children_, &node->count_, byte);
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte]] = 0;
+      node48->child_index_[byte] = EMPTY_INDEX;
+      node->count_--;
+      return;
+    }
+    case NodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte] = 0;
+      node->count_--;
+      return;
+  }
+}
+
+auto AdaptiveRadixTree::Children(const Node *node) -> std::vector<std::pair<uint8_t, Child>> {
+  std::vector<std::pair<uint8_t, Child>> children;
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      const auto *node4 = static_cast<const Node4 *>(node);
+      for (int i = 0; i < std::min<int>(node->count_, 4); i++) {
+        children.emplace_back(node4->keys_[i], node4->children_[i]);
+      }
+      break;
+    }
+    case NodeType::NODE16: {
+      const auto *node16 = static_cast<const Node16 *>(node);
+      for (int i = 0; i < std::min<int>(node->count_, 16); i++) {
+        children.emplace_back(node16->keys_[i], node16->children_[i]);
+      }
+      break;
+    }
+    case NodeType::NODE48: {
+      const auto *node48 = static_cast<const Node48 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        uint8_t index = node48->child_index_[byte];
+        if (index < 48 && node48->children_[index] != 0) {
+          children.emplace_back(byte, node48->children_[index]);
+        }
+      }
+      break;
+    }
+    case NodeType::NODE256: {
+      const auto *node256 = static_cast<const Node256 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        if (node256->children_[byte] != 0) {
+          children.emplace_back(byte, node256->children_[byte]);
+        }
+      }
+      break;
+    }
+  }
+  return children;
+}
+
+auto AdaptiveRadixTree::Grow(const Node *node) -> Node * {
+  Node *bigger;
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      const auto *node4 = static_cast<const Node4 *>(node);
+      auto *node16 = new Node16();
+      memcpy(node16->keys_, node4->keys_, sizeof(node4->keys_));
+      memcpy(node16->children_, node4->children_, sizeof(node4->children_));
+      bigger = node16;
+      break;
+    }
+    case NodeType::NODE16: {
+      const auto *node16 = static_cast<const Node16 *>(node);
+      auto *node48 = new Node48();
+      for (uint8_t i = 0; i < 16; i++) {
+        node48->child_index_[node16->keys_[i]] = i;
+        node48->children_[i] = node16->children_[i];
+      }
+      bigger = node48;
+      break;
+    }
+    case NodeType::NODE48: {
+      const auto *node48 = static_cast<const Node48 *>(node);
+      auto *node256 = new Node256();
+      for (int byte = 0; byte < 256; byte++) {
+        if (node48->child_index_[byte] != EMPTY_INDEX) {
+          node256->children_[byte] = node48->children_[node48->child_index_[byte]];
+        }
+      }
+      bigger = node256;
+      break;
+    }
+    default:
+      UNREACHABLE("a Node256 never grows");
+  }
+  bigger->count_ = node->count_;
+  bigger->SetPrefix(node->Prefix());
+  return bigger;
+}
+
+auto AdaptiveRadixTree::NewNode4(std::string_view prefix) -> Node * {
+  auto *node = new Node4();
+  node->SetPrefix(prefix);
+  return node;
+}
+
+void AdaptiveRadixTree::FreeNode(Node *node) {
+  switch (node->type_) {
+    case NodeType::NODE4:
+      delete static_cast<Node4 *>(node);
+      return;
+    case NodeType::NODE16:
+      delete static_cast<Node16 *>(node);
+      return;
+    case NodeType::NODE48:
+      delete static_cast<Node48 *>(node);
+      return;
+    case NodeType::NODE256:
+      delete static_cast<Node256 *>(node);
+      return;
+  }
+}
+
+void AdaptiveRadixTree::FreeSubtree(Child child) {
+  if (IsLeaf(child)) {
+    delete AsLeaf(child);
+    return;
+  }
+  for (const auto &[byte, grandchild] : Children(AsNode(child))) {
+    FreeSubtree(grandchild);
+  }
+  FreeNode(AsNode(child));
+}
+
+void AdaptiveRadixTree::DeleteNode(void *node) { FreeNode(static_cast<Node *>(node)); }
+
+void AdaptiveRadixTree::DeleteLeaf(void *leaf) { delete static_cast<Leaf *>(leaf); }
+
+void AdaptiveRadixTree::Retire(Node *node) { epoch_.Retire(node, &AdaptiveRadixTree::DeleteNode); }
+
+void AdaptiveRadixTree::Retire(Leaf *leaf) { epoch_.Retire(leaf, &AdaptiveRadixTree::DeleteLeaf); }
+
+/*****************************************************************************
+ * OPERATIONS
+ *****************************************************************************/
+
+auto AdaptiveRadixTree::Insert(std::string_view key, const RID &value) -> bool {
+  if (key.size() > MAX_KEY_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "index key is too long");
+  }
+  EpochManager::Guard guard(&epoch_);
+  while (true) {
+    bool restart = false;
+    bool inserted = InsertOnce(key, value, &restart);
+    if (!restart) {
+      return inserted;
+    }
+  }
+}
+
+auto AdaptiveRadixTree::InsertOnce(std::string_view key, const RID &value, bool *restart) -> bool {
+  Node *node = nullptr;
+  Node *next = root_;
+  Node *parent = nullptr;
+  uint8_t parent_byte = 0;
+  uint8_t node_byte = 0;
+  uint64_t parent_version = 0;
+  size_t depth = 0;
+
+  while (true) {
+    parent = node;
+    parent_byte = node_byte;
+    node = next;
+    uint64_t version = ReadLockOrRestart(node, restart);
+    if (*restart) {
+      return false;
+    }
+
+    std::string_view prefix = node->Prefix();
+    size_t match = 0;
+    while (match < prefix.size() && depth + match < key.size() && prefix[match] == key[depth + match]) {
+      match++;
+    }
+    if (match < prefix.size()) {
+      // key在压缩路径中间分叉：在node之上插入一个新的Node4，root的前缀为空所以parent一定存在
+      UpgradeToWriteLockOrRestart(parent, parent_version, restart);
+      if (*restart) {
+        return false;
+      }
+      UpgradeToWriteLockOrRestart(node, version, restart);
+      if (*restart) {
+        WriteUnlock(parent);
+        return false;
+      }
+      BUSTUB_ASSERT(depth + match < key.size(), "index keys must be prefix-free");
+      Node *new_node = NewNode4(prefix.substr(0, match));
+      AddChild(new_node, key[depth + match], FromLeaf(new Leaf{std::string(key), value}));
+      AddChild(new_node, prefix[match], FromNode(node));
+      node->SetPrefix(prefix.substr(match + 1));
+      ReplaceChild(parent, parent_byte, FromNode(new_node));
+      WriteUnlock(node);
+      WriteUnlock(parent);
+      return true;
+    }
+    depth += prefix.size();
+
+    BUSTUB_ASSERT(depth < key.size(), "index keys must be prefix-free");
+    node_byte = key[depth];
+    Child child = FindChild(node, node_byte);
+    CheckOrRestart(node, version, restart);
+    if (*restart) {
+      return false;
+    }
+
+    if (child == 0) {
+      if (!IsFull(node)) {
+        UpgradeToWriteLockOrRestart(node, version, restart);
+        if (*restart) {
+          return false;
+        }
+        AddChild(node, node_byte, FromLeaf(new Leaf{std::string(key), value}));
+        WriteUnlock(node);
+        return true;
+      }
+      // node已满，换成更大的布局，需要同时锁住parent来替换指针；root是Node256，不会走到这里
+      UpgradeToWriteLockOrRestart(parent, parent_version, restart);
+      if (*restart) {
+        return false;
+      }
+      UpgradeToWriteLockOrRestart(node, version, restart);
+      if (*restart) {
+        WriteUnlock(parent);
+        return false;
+      }
+      Node *bigger = Grow(node);
+      AddChild(bigger, node_byte, FromLeaf(new Leaf{std::string(key), value}));
+      ReplaceChild(parent, parent_byte, FromNode(bigger));
+      WriteUnlockObsolete(node);
+      WriteUnlock(parent);
+      Retire(node);
+      return true;
+    }
+
+    if (IsLeaf(child)) {
+      UpgradeToWriteLockOrRestart(node, version, restart);
+      if (*restart) {
+        return false;
+      }
+      const std::string &existing_key = AsLeaf(child)->key_;
+      if (existing_key == key) {
+        WriteUnlock(node);
+        return false;
+      }
+      // 两个key在depth之后的公共部分成为新Node4的压缩路径
+      size_t start = depth + 1;
+      size_t common = 0;
+      while (start + common < key.size() && start + common < existing_key.size() &&
+             key[start + common] == existing_key[start + common]) {
+        common++;
+      }
+      BUSTUB_ASSERT(start + common < key.size() && start + common < existing_key.size(),
+                    "index keys must be prefix-free");
+      Node *new_node = NewNode4(key.substr(start, common));
+      AddChild(new_node, key[start + common], FromLeaf(new Leaf{std::string(key), value}));
+      AddChild(new_node, existing_key[start + common], child);
+      ReplaceChild(node, node_byte, FromNode(new_node));
+      WriteUnlock(node);
+      return true;
+    }
+
+    depth += 1;
+    parent_version = version;
+    next = AsNode(child);
+  }
+}
+
+auto AdaptiveRadixTree::Remove(std::string_view key) -> bool {
+  EpochManager::Guard guard(&epoch_);
+  while (true) {
+    bool restart = false;
+    bool removed = RemoveOnce(key, &restart);
+    if (!restart) {
+      return removed;
+    }
+  }
+}
+
+auto AdaptiveRadixTree::RemoveOnce(std::string_view key, bool *restart) -> bool {
+  Node *node = root_;
+  size_t depth = 0;
+  while (true) {
+    uint64_t version = ReadLockOrRestart(node, restart);
+    if (*restart) {
+      return false;
+    }
+    std::string_view prefix = node->Prefix();
+    bool prefix_matches = depth + prefix.size() < key.size() && key.substr(depth, prefix.size()) == prefix;
+    depth += prefix.size();
+    Child child = prefix_matches ? FindChild(node, key[depth]) : 0;
+    CheckOrRestart(node, version, restart);
+    if (*restart || child == 0) {
+      return false;
+    }
+
+    if (IsLeaf(child)) {
+      // 叶子结点创建之后不再修改，可以直接比较
+      if (AsLeaf(child)->key_ != key) {
+        return false;
+      }
+      UpgradeToWriteLockOrRestart(node, version, restart);
+      if (*restart) {
+        return false;
+      }
+      // 结点不会缩小成更小的布局，空的内部结点留在树中
+      RemoveChild(node, key[depth]);
+      WriteUnlock(node);
+      Retire(AsLeaf(child));
+      return true;
+    }
+    depth += 1;
+    node = AsNode(child);
+  }
+}
+
+auto AdaptiveRadixTree::GetValue(std::string_view key, RID *value) const -> bool {
+  EpochManager::Guard guard(&epoch_);
+  while (true) {
+    bool restart = false;
+    bool found = GetValueOnce(key, value, &restart);
+    if (!restart) {
+      return found;
+    }
+  }
+}
+
+auto AdaptiveRadixTree::GetValueOnce(std::string_view key, RID *value, bool *restart) const -> bool {
+  const Node *node = root_;
+  size_t depth = 0;
+  while (true) {
+    uint64_t version = ReadLockOrRestart(node, restart);
+    if (*restart) {
+      return false;
+    }
+    std::string_view prefix = node->Prefix();
+    bool prefix_matches = depth + prefix.size() < key.size() && key.substr(depth, prefix.size()) == prefix;
+    depth += prefix.size();
+    Child child = prefix_matches ? FindChild(node, key[depth]) : 0;
+    CheckOrRestart(node, version, restart);
+    if (*restart || child == 0) {
+      return false;
+    }
+
+    if (IsLeaf(child)) {
+      const Leaf *leaf = AsLeaf(child);
+      if (leaf->key_ != key) {
+        return false;
+      }
+      *value = leaf->value_;
+      return true;
+    }
+    depth += 1;
+    node = AsNode(child);
+  }
+}
+
+void AdaptiveRadixTree::ScanRange(std::string_view low, std::string_view high, std::vector<RID> *result) const {
+  EpochManager::Guard guard(&epoch_);
+  std::vector<RID> values;
+  std::string path;
+  while (true) {
+    values.clear();
+    path.clear();
+    if (ScanSubtree(FromNode(root_), &path, low, high, &values)) {
+      break;
+    }
+  }
+  result->insert(result->end(), values.begin(), values.end());
+}
+
+auto AdaptiveRadixTree::ScanSubtree(Child child, std::string *path, std::string_view low, std::string_view high,
+                                    std::vector<RID> *result) const -> bool {
+  if (IsLeaf(child)) {
+    const Leaf *leaf = AsLeaf(child);
+    if (leaf->key_ >= low && leaf->key_ <= high) {
+      result->push_back(leaf->value_);
+    }
+    return true;
+  }
+
+  const Node *node = AsNode(child);
+  bool restart = false;
+  uint64_t version = ReadLockOrRestart(node, &restart);
+  if (restart) {
+    return false;
+  }
+  std::string prefix(node->Prefix());
+  auto children = Children(node);
+  CheckOrRestart(node, version, &restart);
+  if (restart) {
+    return false;
+  }
+
+  // 子树中的key都以path开头：path小于low的同长度前缀或大于high的同长度前缀时可以跳过
+  auto outside = [&](const std::string &p) {
+    std::string_view path_view(p);
+    return path_view < low.substr(0, p.size()) || path_view > high.substr(0, p.size());
+  };
+  size_t path_size = path->size();
+  path->append(prefix);
+  if (!outside(*path)) {
+    for (const auto &[byte, grandchild] : children) {
+      path->push_back(static_cast<char>(byte));
+      if (!outside(*path) && !ScanSubtree(grandchild, path, low, high, result)) {
+        return false;
+      }
+      path->pop_back();
+    }
+  }
+  path->resize(path_size);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.cpp
+//
+// Identification: src/storage/index/art_index.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art_index.h"
+
+#include "storage/index/var_key.h"
+
+namespace bustub {
+
+ARTIndex::ARTIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+auto ARTIndex::EncodeKey(const Tuple &key) const -> std::string {
+  VarKey<AdaptiveRadixTree::MAX_KEY_SIZE> index_key;
+  index_key.SetFromKey(key, *GetKeySchema());
+  return {index_key.Data(), index_key.Size()};
+}
+
+auto ARTIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
+  return tree_.Insert(EncodeKey(key), rid);
+}
+
+void ARTIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) { tree_.Remove(EncodeKey(key)); }
+
+void ARTIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  RID rid;
+  if (tree_.GetValue(EncodeKey(key), &rid)) {
+    result->push_back(rid);
+  }
+}
+
+void ARTIndex::ScanRange(const Tuple &low_key, const Tuple &high_key, std::vector<RID> *result,
+                         Transaction *transaction) {
+  tree_.ScanRange(EncodeKey(low_key), EncodeKey(high_key), result);
+}
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -10,71 +11,207 @@
 
 namespace bustub {
 
+namespace {
+
+auto PackRootState(page_id_t root_page_id, uint32_t version) -> uint64_t {
+  return (static_cast<uint64_t>(version) << 32) | static_cast<uint32_t>(root_page_id);
+}
+
+auto RootPageIdOf(uint64_t root_state) -> page_id_t { return static_cast<page_id_t>(root_state & 0xFFFFFFFF); }
+
+auto RootVersionOf(uint64_t root_state) -> uint32_t { return static_cast<uint32_t>(root_state >> 32); }
+
+// 唯一索引的value不能合并，重复的key直接拒绝
+auto MergeValue(RID * /*value*/, const RID & /*other*/, BufferPoolManager * /*bpm*/) -> bool { return false; }
+
+auto MergeValue(PostingList *value, const PostingList &other, BufferPoolManager *bpm) -> bool {
+  return value->Merge(other, bpm) > 0;
+}
+
+void AppendRIDs(const RID &value, BufferPoolManager * /*bpm*/, std::vector<RID> *result) { result->push_back(value); }
+
+void AppendRIDs(const PostingList &value, BufferPoolManager *bpm, std::vector<RID> *result) {
+  value.GetRIDs(bpm, result);
+}
+
+// @param[out] drop whether the whole entry has to be removed
+auto EraseRID(RID *value, const RID &rid, BufferPoolManager * /*bpm*/, bool *drop) -> bool {
+  *drop = true;
+  return *value == rid;
+}
+
+auto EraseRID(PostingList *value, const RID &rid, BufferPoolManager *bpm, bool *drop) -> bool {
+  bool erased = value->Erase(rid, bpm);
+  *drop = value->IsEmpty();
+  return erased;
+}
+
+// 整个entry被删掉时释放value占用的溢出页
+void ReleaseValue(RID * /*value*/, BufferPoolManager * /*bpm*/) {}
+
+void ReleaseValue(PostingList *value, BufferPoolManager *bpm) { value->Clear(bpm); }
+
+/*
+ * Take `rid` (or, without it, the whole entry) out of the entry of `key` in a write latched leaf.
+ * @param[out] drop whether the entry was removed, so that the leaf has one entry less
+ * @return false if the key (or the RID) was not found
+ */
+template <typename LeafPage, typename KeyType, typename KeyComparator>
+auto RemoveFromLeaf(LeafPage *leaf_page, const KeyType &key, const RID *rid, const KeyComparator &comparator,
+                    BufferPoolManager *bpm, bool *drop) -> bool {
+  *drop = false;
+  int idx = leaf_page->KeyIndex(key, comparator);
+  if (idx == leaf_page->GetSize() || comparator(leaf_page->KeyAt(idx), key) != 0) {
+    return false;
+  }
+  auto value = leaf_page->ValueAt(idx);
+  if (rid == nullptr) {
+    ReleaseValue(&value, bpm);
+    *drop = true;
+  } else if (!EraseRID(&value, *rid, bpm, drop)) {
+    return false;
+  }
+  if (*drop) {
+    leaf_page->RemoveAt(idx);
+  } else {
+    leaf_page->SetValueAt(idx, value);
+  }
+  return true;
+}
+
+}  // namespace
+
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, page_id_t header_page_id, BufferPoolManager *buffer_pool_manager,
-                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size)
+                          const KeyComparator &comparator, int leaf_max_size, int internal_max_size,
+                          BPlusTreeLatchMode latch_mode, BPlusTreeDeleteMode delete_mode)
     : index_name_(std::move(name)),
       bpm_(buffer_pool_manager),
       comparator_(std::move(comparator)),
       leaf_max_size_(leaf_max_size),
       internal_max_size_(internal_max_size),
-      header_page_id_(header_page_id) {
+      latch_mode_(latch_mode),
+      delete_mode_(delete_mode),
+      header_page_id_(header_page_id),
+      root_state_(PackRootState(INVALID_PAGE_ID, 0)) {
   WritePageGuard guard = bpm_->FetchPageWrite(header_page_id_);
   auto root_page = guard.AsMut<BPlusTreeHeaderPage>();
   root_page->root_page_id_ = INVALID_PAGE_ID;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() { StopCompaction(); }
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return true; }
+auto BPLUSTREE_TYPE::IsEmpty() const -> bool {
+  return RootPageIdOf(root_state_.load(std::memory_order_acquire)) == INVALID_PAGE_ID;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::FindLeafPageWithKey(const KeyType &key, page_id_t &leaf_page_id, Context &ctx) const
-    -> FindLeafRetType {
-  // 先从header_page_id中读取page_id
-  page_id_t root_page_id = INVALID_PAGE_ID;
-  {
-    ReadPageGuard guard = bpm_->FetchPageRead(header_page_id_);
-    const BPlusTreeHeaderPage *header_page = guard.As<BPlusTreeHeaderPage>();
-    root_page_id = header_page->root_page_id_;
+auto BPLUSTREE_TYPE::FetchRootRead() -> std::optional<ReadPageGuard> {
+  while (true) {
+    uint64_t root_state = root_state_.load(std::memory_order_acquire);
+    page_id_t root_page_id = RootPageIdOf(root_state);
+    if (root_page_id == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    auto root_guard = bpm_->FetchPageRead(root_page_id);
+    // 换root的写者一定先锁住了旧root，加锁之后缓存没有变化说明锁住的仍然是root
+    if (root_state_.load(std::memory_order_acquire) == root_state) {
+      return root_guard;
+    }
   }
-  // 保存root_page_id到context
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetRootPageId(page_id_t root_page_id, Context &ctx) {
+  BUSTUB_ASSERT(ctx.header_page_.has_value(), "root change without header latch");
+  ctx.header_page_->AsMut<BPlusTreeHeaderPage>()->root_page_id_ = root_page_id;
   ctx.root_page_id_ = root_page_id;
-  if (root_page_id == INVALID_PAGE_ID) {
-    return FindLeafRetType::EmptyTree;
-  }
-
-  auto curr_guard = bpm_->FetchPageRead(root_page_id);
-  auto curr_page = curr_guard.As<BPlusTreePage>();
-  auto curr_page_id = root_page_id;
-
-  while (!curr_page->IsLeafPage()) {
-    const InternalPage *internal_page = curr_guard.As<InternalPage>();
-    BUSTUB_ASSERT(internal_page != nullptr, "Page should be internal");
-    // 寻找key落在的区间，由于存储的结构，需要从index=1开始遍历
-    // 左闭右开
-    int key_idx = 1;
-    for (key_idx = 1; key_idx < internal_page->GetSize(); ++key_idx) {
-      KeyType curr_key = internal_page->KeyAt(key_idx);
-      if (comparator_(key, curr_key) < 0) {
-        break;
+  uint32_t version = RootVersionOf(root_state_.load(std::memory_order_relaxed)) + 1;
+  root_state_.store(PackRootState(root_page_id, version), std::memory_order_release);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType &key) -> std::optional<ReadPageGuard> {
+  if (latch_mode_ == BPlusTreeLatchMode::BLINK) {
+    return FindLeafReadBLink(key);
+  }
+  auto root_guard = FetchRootRead();
+  if (!root_guard.has_value()) {
+    return std::nullopt;
+  }
+
+  ReadPageGuard curr_guard = std::move(*root_guard);
+  while (!curr_guard.As<BPlusTreePage>()->IsLeafPage()) {
+    const auto *internal_page = curr_guard.As<InternalPage>();
+    // 左闭右开，K(i) <= key < K(i+1)
+    curr_guard = bpm_->FetchPageRead(internal_page->Lookup(key, comparator_));
+  }
+  return curr_guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafReadBLink(const KeyType &key) -> std::optional<ReadPageGuard> {
+  // root可能在读到root_page_id之后被分裂，旧root的右链接保证仍然能找到key
+  page_id_t page_id = GetRootPageId();
+  if (page_id == INVALID_PAGE_ID) {
+    return std::nullopt;
+  }
+
+  auto curr_guard = bpm_->FetchPageRead(page_id);
+  while (true) {
+    if (curr_guard.As<BPlusTreePage>()->IsLeafPage()) {
+      const auto *leaf_page = curr_guard.As<LeafPage>();
+      if (!leaf_page->NeedMoveRight(key, comparator_)) {
+        return curr_guard;
       }
+      page_id = leaf_page->GetNextPageId();
+    } else {
+      const auto *internal_page = curr_guard.As<InternalPage>();
+      page_id = internal_page->NeedMoveRight(key, comparator_) ? internal_page->GetRightPageId()
+                                                               : internal_page->Lookup(key, comparator_);
     }
-    int val_idx = key_idx;
-    if (key_idx != internal_page->GetSize()) {
-      val_idx = key_idx - 1;
-    }
-    ctx.read_set_.push_back(std::move(curr_guard));
-    curr_page_id = internal_page->ValueAt(val_idx);
-    curr_guard = bpm_->FetchPageRead(curr_page_id);
-    curr_page = curr_guard.As<BPlusTreePage>();
+    // 先释放当前结点再获取下一个结点，任何时刻只持有一个读锁
+    curr_guard.Drop();
+    curr_guard = bpm_->FetchPageRead(page_id);
   }
+}
 
-  leaf_page_id = curr_page_id;
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindEdgeLeafRead(bool rightmost) -> std::optional<ReadPageGuard> {
+  bool blink = latch_mode_ == BPlusTreeLatchMode::BLINK;
+  auto root_guard = FetchRootRead();
+  if (!root_guard.has_value()) {
+    return std::nullopt;
+  }
 
-  return FindLeafRetType::Success;
+  ReadPageGuard curr_guard = std::move(*root_guard);
+  while (true) {
+    page_id_t next_page_id;
+    if (curr_guard.As<BPlusTreePage>()->IsLeafPage()) {
+      // 最左的叶子不会因为分裂而移动，最右的叶子在B-link模式下需要继续向右找
+      const auto *leaf_page = curr_guard.As<LeafPage>();
+      if (!blink || !rightmost || leaf_page->GetNextPageId() == INVALID_PAGE_ID) {
+        return curr_guard;
+      }
+      next_page_id = leaf_page->GetNextPageId();
+    } else {
+      const auto *internal_page = curr_guard.As<InternalPage>();
+      if (blink && rightmost && internal_page->GetRightPageId() != INVALID_PAGE_ID) {
+        next_page_id = internal_page->GetRightPageId();
+      } else {
+        next_page_id = internal_page->ValueAt(rightmost ? internal_page->GetSize() - 1 : 0);
+      }
+    }
+    if (blink) {
+      curr_guard.Drop();
+    }
+    curr_guard = bpm_->FetchPageRead(next_page_id);
+  }
 }
 
 /*****************************************************************************
@@ -87,212 +224,724 @@ auto BPLUSTREE_TYPE::FindLeafPageWithKey(const KeyType &key, page_id_t &leaf_pag
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
-  // Declaration of context instance.
-  Context ctx;
-  (void)ctx;
-
-  page_id_t leaf_page_id;
-  // 先找到key所在的leaf page
-  auto flag = FindLeafPageWithKey(key, leaf_page_id, ctx);
-  if (flag != FindLeafRetType::Success) {
+  auto leaf_guard = FindLeafRead(key);
+  if (!leaf_guard.has_value()) {
     return false;
   }
 
-  // 寻找到了对应的叶子结点，遍历匹配即可
-  auto guard = bpm_->FetchPageRead(leaf_page_id);
-  const LeafPage *leaf = guard.As<LeafPage>();
-  bool found = false;
-  for (int idx = 0; idx < leaf->GetSize(); ++idx) {
-    auto curr_key = leaf->KeyAt(idx);
-    if (comparator_(curr_key, key) == 0) {
-      result->emplace_back(leaf->ValueAt(idx));
-      found = true;
-    }
+  ValueType value;
+  if (!leaf_guard->template As<LeafPage>()->Lookup(key, &value, comparator_)) {
+    return false;
   }
+  result->emplace_back(value);
+  return true;
+}
 
-  if (!found) {
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetRIDs(const KeyType &key, std::vector<RID> *result, Transaction *txn) -> bool {
+  auto leaf_guard = FindLeafRead(key);
+  if (!leaf_guard.has_value()) {
     return false;
   }
 
+  ValueType value;
+  if (!leaf_guard->template As<LeafPage>()->Lookup(key, &value, comparator_)) {
+    return false;
+  }
+  // 溢出页只在持有叶子结点的锁时读写
+  AppendRIDs(value, bpm_, result);
   return true;
 }
 
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InsertAndSplitLeaf(const page_id_t leaf_page_id, const KeyType &key, const ValueType &value,
-                                        Context &ctx) -> bool {
-  // 拿到原始的leaf node
-  auto old_leaf_guard = bpm_->FetchPageWrite(leaf_page_id);
-  LeafPage *old_leaf_node = old_leaf_guard.AsMut<LeafPage>();
+auto BPLUSTREE_TYPE::IsSafeForInsert(const BPlusTreePage *page) const -> bool {
+  // 叶子结点在size达到max_size时分裂，内部结点在孩子数超过max_size时分裂
+  if (page->IsLeafPage()) {
+    return page->GetSize() + 1 < page->GetMaxSize();
+  }
+  return page->GetSize() < page->GetMaxSize();
+}
 
-  int leaf_node_size = old_leaf_node->GetSize();
-  int leaf_node_max_size = old_leaf_node->GetMaxSize();
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseAncestors(Context &ctx) {
+  ctx.header_page_ = std::nullopt;
+  while (ctx.write_set_.size() > 1) {
+    ctx.write_set_.pop_front();
+  }
+}
 
-  BUSTUB_ENSURE(leaf_node_size == leaf_node_max_size - 1, "When doing split,leaf node must have n-1 values");
+/*
+ * Insert constant key & value pair into b+ tree
+ * if current tree is empty, start new tree, update root page id and insert
+ * entry, otherwise insert into leaf page.
+ * @return: since we only support unique key, if user try to insert duplicate
+ * keys return false, otherwise return true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
+  if (auto inserted = InsertIntoLastLeaf(key, value); inserted.has_value()) {
+    return *inserted;
+  }
 
-  // 临时变量存储 leaf node中的kv对，后续可以优化
-  // TODO： 减少此处的拷贝
-  std::vector<MappingType> temp;
-  {
-    temp.reserve(leaf_node_size + 1);
-    for (int idx = 0; idx < leaf_node_size; ++idx) {
-      temp.emplace_back(old_leaf_node->KeyAt(idx), old_leaf_node->ValueAt(idx));
+  MappingType entry{key, value};
+  size_t inserted = 0;
+  InsertRun(&entry, 1, &inserted);
+  return inserted == 1;
+}
+
+/*
+ * Insert a batch of key & value pairs. The batch is sorted first, so that each
+ * traversal can insert every following key that falls into the same leaf.
+ * Duplicate keys are skipped; within the batch the first occurrence wins.
+ * @return: the number of pairs inserted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertBatch(std::vector<std::pair<KeyType, ValueType>> entries, Transaction *txn) -> size_t {
+  std::stable_sort(entries.begin(), entries.end(),
+                   [this](const auto &lhs, const auto &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+  size_t inserted = 0;
+  for (size_t idx = 0; idx < entries.size();) {
+    idx += InsertRun(entries.data() + idx, entries.size() - idx, &inserted);
+  }
+  return inserted;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertRun(const MappingType *entries, size_t count, size_t *inserted) -> size_t {
+  const KeyType &first_key = entries[0].first;
+
+  // Declaration of context instance.
+  Context ctx;
+  // 先乐观地只锁住缓存的root：root不会分裂时不需要header page
+  uint64_t root_state = root_state_.load(std::memory_order_acquire);
+  ctx.root_page_id_ = RootPageIdOf(root_state);
+  if (ctx.root_page_id_ != INVALID_PAGE_ID) {
+    ctx.write_set_.push_back(bpm_->FetchPageWrite(ctx.root_page_id_));
+    if (root_state_.load(std::memory_order_acquire) != root_state ||
+        !IsSafeForInsert(ctx.write_set_.back().As<BPlusTreePage>())) {
+      ctx.write_set_.clear();
     }
-    Insert2SorrtedList(temp, {key, value}, comparator_);
   }
 
-  page_id_t new_leaf_page_id;
-  auto new_leaf_guard = bpm_->NewPageGuarded(&new_leaf_page_id);
-  LeafPage *new_leaf_node = new_leaf_guard.AsMut<LeafPage>();
+  if (ctx.write_set_.empty()) {
+    // root可能发生变化，先持有header的写锁
+    ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
+    ctx.root_page_id_ = ctx.header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (ctx.root_page_id_ == INVALID_PAGE_ID) {
+      // 空树，新建一个叶子结点作为root
+      page_id_t root_page_id = INVALID_PAGE_ID;
+      auto root_guard = bpm_->NewPageGuarded(&root_page_id);
+      BUSTUB_ENSURE(root_page_id != INVALID_PAGE_ID, "cannot allocate root page");
+      auto *root_page = root_guard.AsMut<LeafPage>();
+      root_page->Init(leaf_max_size_);
+      root_page->Insert(first_key, entries[0].second, comparator_);
+      SetLastLeafHint(root_page_id, root_page);
+      SetRootPageId(root_page_id, ctx);
+      *inserted += 1;
+      return 1;
+    }
 
-  // 新创建一个叶子结点，并将原来的叶子结点与新创建的结点相连
-  new_leaf_node->SetNextPageId(old_leaf_node->GetNextPageId());
-  old_leaf_node->SetNextPageId(new_leaf_page_id);
+    // 自顶向下加写锁，若子结点是安全的则释放所有祖先结点的锁
+    ctx.write_set_.push_back(bpm_->FetchPageWrite(ctx.root_page_id_));
+    if (IsSafeForInsert(ctx.write_set_.back().As<BPlusTreePage>())) {
+      ReleaseAncestors(ctx);
+    }
+  }
+  while (!ctx.write_set_.back().As<BPlusTreePage>()->IsLeafPage()) {
+    const auto *internal_page = ctx.write_set_.back().As<InternalPage>();
+    ctx.write_set_.push_back(bpm_->FetchPageWrite(internal_page->Lookup(first_key, comparator_)));
+    if (IsSafeForInsert(ctx.write_set_.back().As<BPlusTreePage>())) {
+      ReleaseAncestors(ctx);
+    }
+  }
 
-  // 将temp中存储的kv对分配到两个leaf node中
-  {
-    size_t half_size = (size_t)std::ceil(leaf_node_max_size / 2);
-    old_leaf_node->SetSize(0);  // clear old node
-    for (size_t idx = 0; idx <= half_size; ++idx) {
-      old_leaf_node->PushBack(temp[idx].first, temp[idx].second);
+  // 持有父结点（或header）的锁时才允许分裂叶子结点
+  bool can_split = ctx.write_set_.size() > 1 || ctx.header_page_.has_value();
+  auto &leaf_guard = ctx.write_set_.back();
+  auto *leaf_page = leaf_guard.AsMut<LeafPage>();
+  bool is_last_leaf = leaf_page->GetNextPageId() == INVALID_PAGE_ID;
+  size_t consumed = 0;
+  while (consumed < count) {
+    const auto &[key, value] = entries[consumed];
+    // 后续的key超出了这个叶子结点的范围，或者会触发一次无法完成的分裂，留给下一次遍历
+    if (consumed > 0 && (leaf_page->NeedMoveRight(key, comparator_) ||
+                         (!can_split && leaf_page->GetSize() + 1 >= leaf_page->GetMaxSize()))) {
+      break;
+    }
+    consumed++;
+    if (!InsertIntoLeaf(leaf_page, key, value)) {
+      continue;
     }
-    for (size_t idx = half_size + 1; idx < temp.size(); ++idx) {
-      new_leaf_node->PushBack(temp[idx].first, temp[idx].second);
+    *inserted += 1;
+    if (leaf_page->GetSize() >= leaf_page->GetMaxSize()) {
+      // 一次遍历最多分裂一次，祖先结点的锁只够完成一次分裂
+      SplitLeaf(key, ctx);
+      return consumed;
     }
   }
 
-  KeyType new_key = new_leaf_node->KeyAt(0);
-  page_id_t left_leaf_node = leaf_page_id;
-  page_id_t right_leaf_node = new_leaf_page_id;
-  page_id_t parent_leaf_page_id = ctx.read_set_.back().PageId();
-  ctx.read_set_.pop_back();  // 退回到父节点处理
-  return InsertAndSplitInternal(parent_leaf_page_id, left_leaf_node, new_key, right_leaf_node, ctx);
+  if (is_last_leaf) {
+    SetLastLeafHint(leaf_guard.PageId(), leaf_page);
+  }
+  return consumed;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::InsertAndSplitInternal(const page_id_t internal_page_id, const page_id_t lower_range_id,
-                                            const KeyType &key, const page_id_t upper_range_id, Context &ctx) -> bool {
-  if (internal_page_id == ctx.root_page_id_) {
-    // 如果是root page 也要分裂，则新建一个节点
-    page_id_t new_root_page_id;
-    auto new_root_guard = bpm_->NewPageGuarded(&new_root_page_id);
-    InternalPage* new_root_node = new_root_guard.AsMut<InternalPage>();
-    new_root_node->Init();
-    new_root_node->SetKeyValueAt(0,key,upper_range_id);
-    ctx.root_page_id_ = new_root_page_id;
+void BPLUSTREE_TYPE::SplitLeaf(const KeyType &key, Context &ctx) {
+  auto &leaf_guard = ctx.write_set_.back();
+  auto *leaf_page = leaf_guard.AsMut<LeafPage>();
+  bool is_last_leaf = leaf_page->GetNextPageId() == INVALID_PAGE_ID;
+
+  // 叶子结点已满，分裂出新的右兄弟
+  page_id_t new_leaf_page_id = INVALID_PAGE_ID;
+  auto new_leaf_guard = bpm_->NewPageGuarded(&new_leaf_page_id);
+  BUSTUB_ENSURE(new_leaf_page_id != INVALID_PAGE_ID, "cannot allocate leaf page");
+  auto *new_leaf_page = new_leaf_guard.AsMut<LeafPage>();
+  new_leaf_page->Init(leaf_max_size_);
+  if (is_last_leaf && comparator_(leaf_page->KeyAt(leaf_page->GetSize() - 1), key) == 0) {
+    // 在最右边追加导致的分裂：左边保持满，新叶子只放新插入的key，递增插入时不会留下半空的页
+    leaf_page->MoveTailTo(new_leaf_page, leaf_page->GetSize() - 1);
+  } else {
+    leaf_page->MoveHalfTo(new_leaf_page);
+  }
+
+  // 维护双向链表：old <-> new <-> old.next，从左到右加锁，与迭代器的顺序一致
+  page_id_t old_next_page_id = leaf_page->GetNextPageId();
+  if (old_next_page_id != INVALID_PAGE_ID) {
+    auto next_guard = bpm_->FetchPageWrite(old_next_page_id);
+    next_guard.AsMut<LeafPage>()->SetPrevPageId(new_leaf_page_id);
+  }
+  new_leaf_page->SetNextPageId(old_next_page_id);
+  new_leaf_page->SetPrevPageId(leaf_guard.PageId());
+  leaf_page->SetNextPageId(new_leaf_page_id);
+
+  if (is_last_leaf) {
+    SetLastLeafHint(new_leaf_page_id, new_leaf_page);
+  }
+
+  // 分隔key取分裂时选出的high key，变长key的叶子会选出最短的分隔key
+  KeyType separator = leaf_page->GetHighKey();
+  new_leaf_guard.Drop();
+  InsertIntoParent(leaf_guard.PageId(), separator, new_leaf_page_id, ctx);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertIntoLastLeaf(const KeyType &key, const ValueType &value) -> std::optional<bool> {
+  LastLeafHint hint;
+  {
+    std::scoped_lock lock(hint_latch_);
+    hint = last_leaf_hint_;
+  }
+  if (hint.page_id_ == INVALID_PAGE_ID || comparator_(key, hint.low_key_) < 0) {
+    return std::nullopt;
+  }
+
+  // 只锁住这一个叶子结点：没有右兄弟说明key的上界没有变化，插入不分裂说明不会影响父结点
+  WritePageGuard guard = bpm_->FetchPageWrite(hint.page_id_);
+  const auto *leaf_page = guard.As<LeafPage>();
+  if (!leaf_page->IsLeafPage() || leaf_page->GetVersion() != hint.version_ ||
+      leaf_page->GetNextPageId() != INVALID_PAGE_ID || leaf_page->GetSize() == 0 ||
+      leaf_page->GetSize() + 1 >= leaf_page->GetMaxSize() || comparator_(key, leaf_page->KeyAt(0)) < 0) {
+    return std::nullopt;
+  }
+  return InsertIntoLeaf(guard.AsMut<LeafPage>(), key, value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::InsertIntoLeaf(LeafPage *leaf_page, const KeyType &key, const ValueType &value) -> bool {
+  if (leaf_page->Insert(key, value, comparator_)) {
     return true;
   }
+  // key已经存在，posting list合并到已有的entry中，entry个数不变
+  int idx = leaf_page->KeyIndex(key, comparator_);
+  if (idx == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(idx), key) != 0) {
+    return false;
+  }
+  ValueType existing = leaf_page->ValueAt(idx);
+  if (!MergeValue(&existing, value, bpm_)) {
+    return false;
+  }
+  leaf_page->SetValueAt(idx, existing);
+  return true;
+}
 
-  auto internal_guard = bpm_->FetchPageWrite(internal_page_id);
-  InternalPage *internal_node = internal_guard.AsMut<InternalPage>();
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetLastLeafHint(page_id_t page_id, const LeafPage *leaf_page) {
+  std::scoped_lock lock(hint_latch_);
+  last_leaf_hint_.page_id_ = page_id;
+  last_leaf_hint_.version_ = leaf_page->GetVersion();
+  last_leaf_hint_.low_key_ = leaf_page->KeyAt(0);
+}
 
-  int internal_node_size = internal_node->GetSize();
-  int internal_node_max_size = internal_node->GetMaxSize();
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParent(page_id_t left_page_id, const KeyType &key, page_id_t right_page_id,
+                                      Context &ctx) {
+  // 退回到父节点处理
+  ctx.write_set_.pop_back();
+
+  if (ctx.write_set_.empty()) {
+    // 分裂的是root，新建一个root。此时header的写锁一定还持有
+    BUSTUB_ASSERT(ctx.header_page_.has_value() && ctx.IsRootPage(left_page_id), "root split without header latch");
+    page_id_t new_root_page_id = INVALID_PAGE_ID;
+    auto new_root_guard = bpm_->NewPageGuarded(&new_root_page_id);
+    BUSTUB_ENSURE(new_root_page_id != INVALID_PAGE_ID, "cannot allocate root page");
+    auto *new_root_page = new_root_guard.AsMut<InternalPage>();
+    new_root_page->Init(internal_max_size_);
+    new_root_page->PopulateNewRoot(left_page_id, key, right_page_id);
+    SetRootPageId(new_root_page_id, ctx);
+    return;
+  }
 
-  if (internal_node_size < internal_node_max_size) {
+  auto &parent_guard = ctx.write_set_.back();
+  auto *parent_page = parent_guard.AsMut<InternalPage>();
+  if (parent_page->GetSize() < parent_page->GetMaxSize()) {
     // 不需要split的时候，直接插入
-    internal_node->InsertVal(key, upper_range_id, comparator_);
-    return true;
+    parent_page->InsertNodeAfter(left_page_id, key, right_page_id);
+    return;
   }
+
+  // 父节点也满了，借助临时数组完成分裂。临时数组的第0个key是无效的
   std::vector<std::pair<KeyType, page_id_t>> temp;
-  temp.reserve(internal_node_size + 1);
-  for (int idx = 0; idx < internal_node_size; ++idx) {
-    temp.emplace_back(internal_node->KeyAt(idx), internal_node->ValueAt(idx));
+  temp.reserve(parent_page->GetSize() + 1);
+  int insert_idx = parent_page->ValueIndex(left_page_id) + 1;
+  for (int idx = 0; idx < parent_page->GetSize(); ++idx) {
+    if (idx == insert_idx) {
+      temp.emplace_back(key, right_page_id);
+    }
+    temp.emplace_back(parent_page->KeyAt(idx), parent_page->ValueAt(idx));
+  }
+  if (insert_idx == parent_page->GetSize()) {
+    temp.emplace_back(key, right_page_id);
   }
-  Insert2SorrtedList(temp, {key, upper_range_id}, comparator_);
-  internal_node->SetSize(0);
-  page_id_t new_internal_page_id;
+
+  page_id_t new_internal_page_id = INVALID_PAGE_ID;
   auto new_internal_guard = bpm_->NewPageGuarded(&new_internal_page_id);
-  InternalPage *new_internal_node = new_internal_guard.AsMut<InternalPage>();
+  BUSTUB_ENSURE(new_internal_page_id != INVALID_PAGE_ID, "cannot allocate internal page");
+  auto *new_internal_page = new_internal_guard.AsMut<InternalPage>();
+  new_internal_page->Init(internal_max_size_);
+
+  // 左边保留前一半的孩子，右边第0个key即为上推的分隔key。
+  // 最右侧结点在末尾追加时左边保持满，右边只保留新的孩子
+  bool append_on_right_edge =
+      parent_page->GetRightPageId() == INVALID_PAGE_ID && insert_idx == parent_page->GetSize();
+  int split_idx = append_on_right_edge ? static_cast<int>(temp.size()) - 1 : static_cast<int>(temp.size() + 1) / 2;
+  parent_page->SplitEntries(temp, split_idx, new_internal_page, new_internal_page_id);
+  KeyType new_key = temp[split_idx].first;
+  new_internal_guard.Drop();
+  InsertIntoParent(parent_guard.PageId(), new_key, new_internal_page_id, ctx);
+}
 
-  size_t split_size = std::ceil((internal_node_max_size + 1) / 2.f);
-  for (size_t idx = 0; idx <= split_size; ++idx) {
-    internal_node->InsertVal(temp[idx].first, temp[idx].second, comparator_);
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsUnderfull(const BPlusTreePage *page) const -> bool {
+  return page->GetSize() < page->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::IsSafeForRemove(const BPlusTreePage *page, bool is_root) const -> bool {
+  // root不会被合并：叶子root总是安全的，内部root在只剩一个孩子时要换root
+  if (is_root) {
+    return page->IsLeafPage() || page->GetSize() > 2;
   }
-  for (size_t idx = split_size + 1; idx < (size_t)internal_node_max_size + 1; ++idx) {
-    new_internal_node->InsertVal(temp[idx].first, temp[idx].second, comparator_);
+  // 变长key的页删掉entry后max size可能变大，多留一个entry的余量
+  return page->GetSize() - 1 > page->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FindLeafWrite(const KeyType &key) -> std::optional<WritePageGuard> {
+  std::optional<WritePageGuard> curr_guard;
+  while (!curr_guard.has_value()) {
+    uint64_t root_state = root_state_.load(std::memory_order_acquire);
+    page_id_t root_page_id = RootPageIdOf(root_state);
+    if (root_page_id == INVALID_PAGE_ID) {
+      return std::nullopt;
+    }
+    curr_guard = bpm_->FetchPageWrite(root_page_id);
+    if (root_state_.load(std::memory_order_acquire) != root_state) {
+      curr_guard = std::nullopt;
+    }
+  }
+  while (!curr_guard->As<BPlusTreePage>()->IsLeafPage()) {
+    const auto *internal_page = curr_guard->As<InternalPage>();
+    curr_guard = bpm_->FetchPageWrite(internal_page->Lookup(key, comparator_));
   }
+  return curr_guard;
+}
 
-  KeyType new_key = temp[split_size].first;
+/*
+ * Delete key & value pair associated with input key
+ * If current tree is empty, return immediately.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) { RemoveEntry(key, nullptr); }
 
-  page_id_t parent_internal_page_id = ctx.read_set_.back().PageId();
-  ctx.read_set_.pop_back();
-  return InsertAndSplitInternal(parent_internal_page_id, internal_page_id, new_key, new_internal_page_id, ctx);
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RemoveRID(const KeyType &key, const RID &rid, Transaction *txn) -> bool {
+  return RemoveEntry(key, &rid);
 }
 
-/*****************************************************************************
- * INSERTION
- *****************************************************************************/
 /*
- * Insert constant key & value pair into b+ tree
- * if current tree is empty, start new tree, update root page id and insert
- * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * In EAGER mode, descend with latch crabbing, keeping the latches of the
+ * ancestors that may become underfull, and merge bottom-up after the delete.
+ * In LAZY mode, only the entry is removed; Compact merges the pages later.
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
+auto BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const RID *rid) -> bool {
+  bool drop;
+  if (delete_mode_ == BPlusTreeDeleteMode::LAZY) {
+    auto leaf_guard = FindLeafWrite(key);
+    if (!leaf_guard.has_value()) {
+      return false;
+    }
+    return RemoveFromLeaf(leaf_guard->template AsMut<LeafPage>(), key, rid, comparator_, bpm_, &drop);
+  }
+
   // Declaration of context instance.
   Context ctx;
-  (void)ctx;
-
-  page_id_t leaf_page_id;
-  // 找到Key应该处于的leaf_page，ctx中记录节点
-  auto flag = FindLeafPageWithKey(key, leaf_page_id, ctx);
-
-  if (flag == FindLeafRetType::EmptyTree) {
-    auto guard = bpm_->NewPageGuarded(&leaf_page_id);
-    LeafPage *root_page = guard.AsMut<LeafPage>();
-    root_page->Init(this->leaf_max_size_);
-    // 将新的root_page_id记录到header_page_id中
-    auto header_page_guard = bpm_->FetchPageWrite(header_page_id_);
-    auto head_page = header_page_guard.AsMut<BPlusTreeHeaderPage>();
-    head_page->root_page_id_ = leaf_page_id;
-    // 将新的root_page_id记录到ctx中
-    BUSTUB_ASSERT(ctx.root_page_id_ == INVALID_PAGE_ID, "Root page id should be invalid in empty tree");
-    ctx.root_page_id_ = leaf_page_id;
-  } else {
-    BUSTUB_ASSERT(flag == FindLeafRetType::Success, "Should always find the leaf page of the key");
+  // 和插入一样，先乐观地只锁住缓存的root，root不会换时不需要header page
+  uint64_t root_state = root_state_.load(std::memory_order_acquire);
+  ctx.root_page_id_ = RootPageIdOf(root_state);
+  if (ctx.root_page_id_ != INVALID_PAGE_ID) {
+    ctx.write_set_.push_back(bpm_->FetchPageWrite(ctx.root_page_id_));
+    if (root_state_.load(std::memory_order_acquire) != root_state ||
+        !IsSafeForRemove(ctx.write_set_.back().As<BPlusTreePage>(), true)) {
+      ctx.write_set_.clear();
+    }
+  }
+  if (ctx.write_set_.empty()) {
+    ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
+    ctx.root_page_id_ = ctx.header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (ctx.root_page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    ctx.write_set_.push_back(bpm_->FetchPageWrite(ctx.root_page_id_));
+    if (IsSafeForRemove(ctx.write_set_.back().As<BPlusTreePage>(), true)) {
+      ReleaseAncestors(ctx);
+    }
+  }
+  while (!ctx.write_set_.back().As<BPlusTreePage>()->IsLeafPage()) {
+    const auto *internal_page = ctx.write_set_.back().As<InternalPage>();
+    ctx.write_set_.push_back(bpm_->FetchPageWrite(internal_page->Lookup(key, comparator_)));
+    if (IsSafeForRemove(ctx.write_set_.back().As<BPlusTreePage>(), false)) {
+      ReleaseAncestors(ctx);
+    }
   }
 
-  auto guard = bpm_->FetchPageWrite(leaf_page_id);
-  LeafPage *leaf_page = guard.AsMut<LeafPage>();
+  if (!RemoveFromLeaf(ctx.write_set_.back().AsMut<LeafPage>(), key, rid, comparator_, bpm_, &drop)) {
+    return false;
+  }
+  // 只删掉posting list中的一个RID时叶子的大小不变，不需要合并
+  if (!drop) {
+    return true;
+  }
 
-  // 如果不需要split，直接插入到叶子结点中
-  if (leaf_page->GetSize() < leaf_page->GetMaxSize() - 1) {
-    return leaf_page->Insert(key, value, comparator_);
+  // 自底向上合并不足半满的结点，它的父结点一定还锁着
+  while (ctx.write_set_.size() > 1 && IsUnderfull(ctx.write_set_.back().As<BPlusTreePage>())) {
+    page_id_t page_id = ctx.write_set_.back().PageId();
+    // 合并时从左到右重新给两个孩子加锁，先放掉这个孩子
+    ctx.write_set_.pop_back();
+    auto &parent_guard = ctx.write_set_.back();
+    const auto *parent_page = parent_guard.As<InternalPage>();
+    int child_idx = parent_page->ValueIndex(page_id);
+    // 和右兄弟合并，最右边的孩子和左兄弟合并
+    int left_idx = child_idx + 1 < parent_page->GetSize() ? child_idx : child_idx - 1;
+    if (left_idx < 0 || !MergeChildren(parent_guard, left_idx)) {
+      break;
+    }
   }
 
-  guard.Drop();
-  return InsertAndSplitLeaf(leaf_page_id, key, value, ctx);
+  bool may_collapse = ctx.header_page_.has_value();
+  ctx.write_set_.clear();
+  if (may_collapse) {
+    CollapseRoot(ctx);
+  }
+  ctx.header_page_ = std::nullopt;
+  ReclaimPages();
+  return true;
 }
 
 /*****************************************************************************
- * REMOVE
+ * COMPACTION
  *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MergeChildren(WritePageGuard &parent_guard, int index) -> bool {
+  auto *parent_page = parent_guard.AsMut<InternalPage>();
+  page_id_t left_page_id = parent_page->ValueAt(index);
+  page_id_t right_page_id = parent_page->ValueAt(index + 1);
+  // 从左到右加锁，和分裂叶子结点、正向迭代的顺序一致
+  auto left_guard = bpm_->FetchPageWrite(left_page_id);
+  auto right_guard = bpm_->FetchPageWrite(right_page_id);
+  const auto *left = left_guard.As<BPlusTreePage>();
+  const auto *right = right_guard.As<BPlusTreePage>();
+  if (!IsUnderfull(left) && !IsUnderfull(right)) {
+    return false;
+  }
+
+  // 右边的页并入左边，这样死页只需要指向左边的页：B-link读者和迭代器到达死页后都转到那里
+  if (left->IsLeafPage()) {
+    auto *left_page = left_guard.AsMut<LeafPage>();
+    auto *right_page = right_guard.AsMut<LeafPage>();
+    if (left_page->GetSize() + right_page->GetSize() >
+        std::min(left_page->GetCapacity(), right_page->GetCapacity())) {
+      return false;
+    }
+    page_id_t next_page_id = right_page->GetNextPageId();
+    if (next_page_id != INVALID_PAGE_ID) {
+      auto next_guard = bpm_->FetchPageWrite(next_page_id);
+      next_guard.AsMut<LeafPage>()->SetPrevPageId(left_page_id);
+    }
+    right_page->MoveAllTo(left_page, left_page_id);
+  } else {
+    auto *left_page = left_guard.AsMut<InternalPage>();
+    auto *right_page = right_guard.AsMut<InternalPage>();
+    if (left_page->GetSize() + right_page->GetSize() >
+        std::min(left_page->GetCapacity(), right_page->GetCapacity())) {
+      return false;
+    }
+    right_page->MoveAllTo(left_page, parent_page->KeyAt(index + 1), left_page_id);
+  }
+  parent_page->RemoveAt(index + 1);
+  RetirePage(right_page_id);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CompactSubtree(page_id_t page_id) -> size_t {
+  std::vector<page_id_t> children;
+  {
+    auto guard = bpm_->FetchPageRead(page_id);
+    const auto *page = guard.As<BPlusTreePage>();
+    if (page->IsLeafPage() || page->IsDead()) {
+      return 0;
+    }
+    const auto *internal_page = guard.As<InternalPage>();
+    for (int idx = 0; idx < internal_page->GetSize(); ++idx) {
+      children.push_back(internal_page->ValueAt(idx));
+    }
+  }
+
+  // 先整理下一层，再合并这一层的孩子；整理孩子的时候不持有这个结点的锁
+  size_t retired = 0;
+  bool leaf_children = bpm_->FetchPageRead(children[0]).As<BPlusTreePage>()->IsLeafPage();
+  if (!leaf_children) {
+    for (auto child_page_id : children) {
+      retired += CompactSubtree(child_page_id);
+    }
+  }
+
+  auto guard = bpm_->FetchPageWrite(page_id);
+  if (guard.As<BPlusTreePage>()->IsDead()) {
+    return retired;
+  }
+  for (int idx = 0; idx + 1 < guard.As<InternalPage>()->GetSize();) {
+    // 合并之后左边的页可能还能和新的右兄弟合并，停在原地再试一次
+    if (MergeChildren(guard, idx)) {
+      retired++;
+    } else {
+      idx++;
+    }
+  }
+  return retired;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::CollapseRoot(Context &ctx) -> size_t {
+  size_t retired = 0;
+  while (true) {
+    page_id_t root_page_id = ctx.header_page_->As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (root_page_id == INVALID_PAGE_ID) {
+      return retired;
+    }
+    auto root_guard = bpm_->FetchPageWrite(root_page_id);
+    const auto *root_page = root_guard.As<BPlusTreePage>();
+    if (root_page->IsLeafPage() || root_page->GetSize() > 1) {
+      return retired;
+    }
+    // 唯一的孩子成为新的root，旧root指向它，拿着旧root的读者会被转过去
+    auto *internal_page = root_guard.AsMut<InternalPage>();
+    page_id_t child_page_id = internal_page->ValueAt(0);
+    internal_page->Retire(child_page_id);
+    SetRootPageId(child_page_id, ctx);
+    RetirePage(root_page_id);
+    retired++;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RetirePage(page_id_t page_id) {
+  std::scoped_lock lock(reclaim_latch_);
+  pending_reclaim_.push_back(page_id);
+  retired_pages_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReclaimPages() {
+  std::vector<page_id_t> pages;
+  {
+    std::scoped_lock lock(reclaim_latch_);
+    pages.swap(pending_reclaim_);
+  }
+  std::vector<page_id_t> pinned;
+  for (auto page_id : pages) {
+    // 死页不会再被修改，先写回磁盘再从buffer pool中删掉
+    bpm_->FlushPage(page_id);
+    if (bpm_->DeletePage(page_id)) {
+      reclaimed_pages_++;
+    } else {
+      pinned.push_back(page_id);
+    }
+  }
+  if (!pinned.empty()) {
+    std::scoped_lock lock(reclaim_latch_);
+    pending_reclaim_.insert(pending_reclaim_.end(), pinned.begin(), pinned.end());
+  }
+}
+
 /*
- * Delete key & value pair associated with input key
- * If current tree is empty, return immediately.
- * If not, User needs to first find the right leaf page as deletion target, then
- * delete entry from leaf page. Remember to deal with redistribute or merge if
- * necessary.
+ * Merge bottom-up, then shrink the height of the tree, then reclaim the
+ * retired pages. Merging two internal pages makes children adjacent that
+ * had different parents before, so passes repeat until nothing is merged.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
-  // Declaration of context instance.
-  Context ctx;
-  (void)ctx;
+auto BPLUSTREE_TYPE::Compact() -> size_t {
+  std::scoped_lock lock(compact_latch_);
+  size_t retired = 0;
+  while (true) {
+    page_id_t root_page_id = GetRootPageId();
+    if (root_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    size_t pass_retired = CompactSubtree(root_page_id);
+    Context ctx;
+    ctx.header_page_ = bpm_->FetchPageWrite(header_page_id_);
+    pass_retired += CollapseRoot(ctx);
+    retired += pass_retired;
+    if (pass_retired == 0) {
+      break;
+    }
+  }
+  ReclaimPages();
+  return retired;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartCompaction(std::chrono::milliseconds interval) {
+  StopCompaction();
+  stop_compaction_ = false;
+  compaction_thread_ = std::thread([this, interval] {
+    std::unique_lock lock(compaction_thread_latch_);
+    while (!compaction_cv_.wait_for(lock, interval, [this] { return stop_compaction_; })) {
+      lock.unlock();
+      Compact();
+      lock.lock();
+    }
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopCompaction() {
+  if (!compaction_thread_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(compaction_thread_latch_);
+    stop_compaction_ = true;
+  }
+  compaction_cv_.notify_all();
+  compaction_thread_.join();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetStats() -> BPlusTreeStats {
+  BPlusTreeStats stats;
+  stats.retired_pages_ = retired_pages_.load();
+  stats.reclaimed_pages_ = reclaimed_pages_.load();
+  page_id_t level_page_id;
+  {
+    auto root_guard = FetchRootRead();
+    if (!root_guard.has_value()) {
+      return stats;
+    }
+    level_page_id = root_guard->PageId();
+  }
+
+  // 从每一层最左边的页开始沿兄弟链接向右走，每次只锁一个页
+  double leaf_fill = 0;
+  double internal_fill = 0;
+  while (level_page_id != INVALID_PAGE_ID) {
+    stats.height_++;
+    page_id_t next_level_page_id = INVALID_PAGE_ID;
+    page_id_t page_id = level_page_id;
+    while (page_id != INVALID_PAGE_ID) {
+      auto guard = bpm_->FetchPageRead(page_id);
+      const auto *page = guard.As<BPlusTreePage>();
+      bool dead = page->IsDead();
+      if (page->IsLeafPage()) {
+        page_id = guard.As<LeafPage>()->GetNextPageId();
+      } else {
+        const auto *internal_page = guard.As<InternalPage>();
+        page_id = internal_page->GetRightPageId();
+        if (!dead && next_level_page_id == INVALID_PAGE_ID) {
+          next_level_page_id = internal_page->ValueAt(0);
+        }
+      }
+      if (dead) {
+        continue;
+      }
+      double fill = static_cast<double>(page->GetSize()) / page->GetMaxSize();
+      if (page->IsLeafPage()) {
+        stats.leaf_pages_++;
+        stats.entries_ += page->GetSize();
+        leaf_fill += fill;
+      } else {
+        stats.internal_pages_++;
+        internal_fill += fill;
+      }
+    }
+    level_page_id = next_level_page_id;
+  }
+  stats.leaf_fill_factor_ = stats.leaf_pages_ > 0 ? leaf_fill / stats.leaf_pages_ : 0;
+  stats.internal_fill_factor_ = stats.internal_pages_ > 0 ? internal_fill / stats.internal_pages_ : 0;
+  return stats;
 }
 
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::MakeIterator(const KeyType *key, std::optional<KeyType> stop_key, bool reverse)
+    -> INDEXITERATOR_TYPE {
+  auto leaf_guard = key == nullptr ? FindEdgeLeafRead(reverse) : FindLeafRead(*key);
+  if (!leaf_guard.has_value()) {
+    return INDEXITERATOR_TYPE();
+  }
+
+  const auto *leaf_page = leaf_guard->template As<LeafPage>();
+  int start;
+  if (key == nullptr) {
+    start = reverse ? leaf_page->GetSize() - 1 : 0;
+  } else {
+    start = leaf_page->KeyIndex(*key, comparator_);
+    if (reverse && (start == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(start), *key) != 0)) {
+      // 反向迭代从最后一个不大于key的位置开始
+      start -= 1;
+    }
+  }
+  return INDEXITERATOR_TYPE(bpm_, std::move(*leaf_guard), start, &comparator_, std::move(stop_key), reverse);
+}
+
 /*
  * Input parameter is void, find the leftmost leaf page first, then construct
  * index iterator
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return MakeIterator(nullptr, std::nullopt, false); }
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -300,7 +949,23 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE()
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
+auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE { return MakeIterator(&key, std::nullopt, false); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::Begin(const KeyType &key, const KeyType &end_key) -> INDEXITERATOR_TYPE {
+  return MakeIterator(&key, end_key, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return MakeIterator(nullptr, std::nullopt, true); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE { return MakeIterator(&key, std::nullopt, true); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key, const KeyType &end_key) -> INDEXITERATOR_TYPE {
+  return MakeIterator(&key, end_key, true);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -315,11 +980,7 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE();
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetRootPageId() -> page_id_t {
-  auto guard = bpm_->FetchPageRead(header_page_id_);
-  const auto *header_page = guard.As<BPlusTreeHeaderPage>();
-
-  return header_page->root_page_id_;
-   return 0; 
+  return RootPageIdOf(root_state_.load(std::memory_order_acquire));
 }
 
 /*****************************************************************************
@@ -340,7 +1001,7 @@ void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *t
     KeyType index_key;
     index_key.SetFromInteger(key);
     RID rid(key);
-    Insert(index_key, rid, txn);
+    Insert(index_key, ValueType(rid), txn);
   }
 }
 /*
@@ -555,4 +1216,22 @@ template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class BPlusTree<GenericKey<4>, PostingList, GenericComparator<4>>;
+
+template class BPlusTree<GenericKey<8>, PostingList, GenericComparator<8>>;
+
+template class BPlusTree<GenericKey<16>, PostingList, GenericComparator<16>>;
+
+template class BPlusTree<GenericKey<32>, PostingList, GenericComparator<32>>;
+
+template class BPlusTree<GenericKey<64>, PostingList, GenericComparator<64>>;
+
+template class BPlusTree<VarKey<32>, RID, VarKeyComparator<32>>;
+
+template class BPlusTree<VarKey<64>, RID, VarKeyComparator<64>>;
+
+template class BPlusTree<VarKey<32>, PostingList, VarKeyComparator<32>>;
+
+template class BPlusTree<VarKey<64>, PostingList, VarKeyComparator<64>>;
+
 }  // namespace bustub
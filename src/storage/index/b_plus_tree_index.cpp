@@ -28,27 +28,47 @@ INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  return container_->Insert(index_key, rid, transaction);
+  return container_->Insert(index_key, ValueType(rid), transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::InsertEntries(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction)
+    -> size_t {
+  // construct insert index keys, the tree sorts them and inserts keys sharing a leaf together
+  std::vector<std::pair<KeyType, ValueType>> index_entries;
+  index_entries.reserve(entries.size());
+  for (const auto &[key, rid] : entries) {
+    KeyType index_key;
+    index_key.SetFromKey(key, *GetKeySchema());
+    index_entries.emplace_back(index_key, ValueType(rid));
+  }
+
+  return container_->InsertBatch(std::move(index_entries), transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  container_->Remove(index_key, transaction);
+  container_->RemoveRID(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, *GetKeySchema());
 
-  container_->GetValue(index_key, result, transaction);
+  container_->GetRIDs(index_key, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::GetRIDs(const KeyType &key, std::vector<RID> *result, Transaction *transaction) {
+  container_->GetRIDs(key, result, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -57,6 +77,19 @@ auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return con
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE { return container_->Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key, const KeyType &end_key) -> INDEXITERATOR_TYPE {
+  return container_->Begin(key, end_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() -> INDEXITERATOR_TYPE { return container_->RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE {
+  return container_->RBegin(key);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetEndIterator() -> INDEXITERATOR_TYPE { return container_->End(); }
 
@@ -65,5 +98,14 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<4>, PostingList, GenericComparator<4>>;
+template class BPlusTreeIndex<GenericKey<8>, PostingList, GenericComparator<8>>;
+template class BPlusTreeIndex<GenericKey<16>, PostingList, GenericComparator<16>>;
+template class BPlusTreeIndex<GenericKey<32>, PostingList, GenericComparator<32>>;
+template class BPlusTreeIndex<GenericKey<64>, PostingList, GenericComparator<64>>;
+template class BPlusTreeIndex<VarKey<32>, RID, VarKeyComparator<32>>;
+template class BPlusTreeIndex<VarKey<64>, RID, VarKeyComparator<64>>;
+template class BPlusTreeIndex<VarKey<32>, PostingList, VarKeyComparator<32>>;
+template class BPlusTreeIndex<VarKey<64>, PostingList, VarKeyComparator<64>>;
 
 }  // namespace bustub
@@ -0,0 +1,513 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree.cpp
+//
+// Identification: src/storage/index/bw_tree.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/bw_tree.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** Common header of base nodes and delta records */
+struct BwTree::Node {
+  /** A base node */
+  Node(NodeType type, uint32_t level) : type_(type), level_(level) {}
+  /** A delta record on top of `next`, which starts with the size of the node below */
+  Node(NodeType type, Node *next)
+      : type_(type), level_(next->level_), chain_length_(next->chain_length_ + 1), size_(next->size_), next_(next) {}
+  virtual ~Node() = default;
+
+  NodeType type_;
+  /** 0 for leaves */
+  uint32_t level_;
+  /** Number of delta records from this one down to the base node */
+  uint32_t chain_length_{0};
+  /** Number of entries (leaf) or children (inner node) of the node as of this record */
+  size_t size_{0};
+  /** The next record in the delta chain, nullptr for base nodes */
+  Node *next_{nullptr};
+};
+
+/** Fields shared by leaf and inner base nodes: sorted entries and the B-link fence */
+template <typename ValueType>
+struct BwTreeBaseNode {
+  std::vector<std::pair<std::string, ValueType>> entries_;
+  /** Keys >= high key belong to the right sibling */
+  bool has_high_key_{false};
+  std::string high_key_;
+  BwTree::NodeId right_;
+};
+
+struct BwTree::LeafNode : public Node, public BwTreeBaseNode<RID> {
+  LeafNode() : Node(NodeType::LEAF, 0U) { right_ = INVALID_NODE_ID; }
+};
+
+/** The key of the first entry is ignored, as in BPlusTreeInternalPage */
+struct BwTree::InnerNode : public Node, public BwTreeBaseNode<NodeId> {
+  explicit InnerNode(uint32_t level) : Node(NodeType::INNER, level) { right_ = INVALID_NODE_ID; }
+};
+
+struct BwTree::InsertDelta : public Node {
+  InsertDelta(std::string_view key, const RID &value, Node *next)
+      : Node(NodeType::INSERT, next), key_(key), value_(value) {
+    size_++;
+  }
+  std::string key_;
+  RID value_;
+};
+
+struct BwTree::DeleteDelta : public Node {
+  DeleteDelta(std::string_view key, Node *next) : Node(NodeType::DELETE, next), key_(key) { size_--; }
+  std::string key_;
+};
+
+/** Keys >= key_ moved to the node right_ */
+struct BwTree::SplitDelta : public Node {
+  SplitDelta(std::string key, NodeId right, size_t size, Node *next)
+      : Node(NodeType::SPLIT, next), key_(std::move(key)), right_(right) {
+    size_ = size;
+  }
+  std::string key_;
+  NodeId right_;
+};
+
+/** Keys in [low_key_, high_key_) are in the child child_, which was split off from its left sibling */
+struct BwTree::IndexEntryDelta : public Node {
+  IndexEntryDelta(std::string low_key, bool has_high_key, std::string high_key, NodeId child, Node *next)
+      : Node(NodeType::INDEX_ENTRY, next),
+        low_key_(std::move(low_key)),
+        has_high_key_(has_high_key),
+        high_key_(std::move(high_key)),
+        child_(child) {
+    size_++;
+  }
+  std::string low_key_;
+  bool has_high_key_;
+  std::string high_key_;
+  NodeId child_;
+};
+
+BwTree::BwTree(size_t leaf_max_size, size_t inner_max_size, size_t max_chain_length, size_t mapping_table_size)
+    : leaf_max_size_(leaf_max_size),
+      inner_max_size_(inner_max_size),
+      max_chain_length_(max_chain_length),
+      mapping_table_size_(mapping_table_size),
+      mapping_table_(std::make_unique<std::atomic<Node *>[]>(mapping_table_size)) {
+  BUSTUB_ASSERT(leaf_max_size >= 2 && inner_max_size >= 3, "nodes are too small to be split");
+  root_id_.store(NewNodeId(new LeafNode()));
+}
+
+BwTree::~BwTree() {
+  NodeId num_nodes = next_node_id_.load();
+  for (NodeId id = 0; id < num_nodes; ++id) {
+    DeleteChain(GetNode(id));
+  }
+}
+
+void BwTree::DeleteChain(void *head) {
+  auto *node = static_cast<Node *>(head);
+  while (node != nullptr) {
+    Node *next = node->next_;
+    delete node;
+    node = next;
+  }
+}
+
+auto BwTree::NewNodeId(Node *node) -> NodeId {
+  NodeId id = next_node_id_.fetch_add(1);
+  if (id >= mapping_table_size_) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Bw-tree mapping table is full");
+  }
+  mapping_table_[id].store(node);
+  return id;
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+
+auto BwTree::InnerLookup(const Node *head, std::string_view key) -> NodeId {
+  for (const Node *node = head;; node = node->next_) {
+    switch (node->type_) {
+      case NodeType::SPLIT: {
+        const auto *split = static_cast<const SplitDelta *>(node);
+        if (key >= split->key_) {
+          return split->right_;
+        }
+        break;
+      }
+      case NodeType::INDEX_ENTRY: {
+        const auto *entry = static_cast<const IndexEntryDelta *>(node);
+        if (key >= entry->low_key_ && (!entry->has_high_key_ || key < entry->high_key_)) {
+          return entry->child_;
+        }
+        break;
+      }
+      case NodeType::INNER: {
+        const auto *inner = static_cast<const InnerNode *>(node);
+        if (inner->has_high_key_ && key >= inner->high_key_) {
+          return inner->right_;
+        }
+        // K(i) <= key < K(i+1)，因此取第一个大于key的位置的前一个指针
+        auto it = std::upper_bound(inner->entries_.begin() + 1, inner->entries_.end(), key,
+                                   [](std::string_view search_key, const auto &entry) { return search_key < entry.first; });
+        return std::prev(it)->second;
+      }
+      default:
+        UNREACHABLE("unexpected record in an inner node");
+    }
+  }
+}
+
+auto BwTree::LeafLookup(const Node *head, std::string_view key, RID *value, NodeId *right) -> LookupResult {
+  // 从新到旧遍历，第一个提到key的记录决定结果
+  for (const Node *node = head;; node = node->next_) {
+    switch (node->type_) {
+      case NodeType::INSERT: {
+        const auto *insert = static_cast<const InsertDelta *>(node);
+        if (insert->key_ == key) {
+          *value = insert->value_;
+          return LookupResult::FOUND;
+        }
+        break;
+      }
+      case NodeType::DELETE:
+        if (static_cast<const DeleteDelta *>(node)->key_ == key) {
+          return LookupResult::NOT_FOUND;
+        }
+        break;
+      case NodeType::SPLIT: {
+        const auto *split = static_cast<const SplitDelta *>(node);
+        if (key >= split->key_) {
+          *right = split->right_;
+          return LookupResult::MOVE_RIGHT;
+        }
+        break;
+      }
+      case NodeType::LEAF: {
+        const auto *leaf = static_cast<const LeafNode *>(node);
+        if (leaf->has_high_key_ && key >= leaf->high_key_) {
+          *right = leaf->right_;
+          return LookupResult::MOVE_RIGHT;
+        }
+        auto it = std::lower_bound(leaf->entries_.begin(), leaf->entries_.end(), key,
+                                   [](const auto &entry, std::string_view search_key) { return entry.first < search_key; });
+        if (it == leaf->entries_.end() || it->first != key) {
+          return LookupResult::NOT_FOUND;
+        }
+        *value = it->second;
+        return LookupResult::FOUND;
+      }
+      default:
+        UNREACHABLE("unexpected record in a leaf");
+    }
+  }
+}
+
+auto BwTree::NeedMoveRight(const Node *head, std::string_view key, NodeId *right) -> bool {
+  const Node *node = head;
+  for (; node->next_ != nullptr; node = node->next_) {
+    if (node->type_ == NodeType::SPLIT) {
+      const auto *split = static_cast<const SplitDelta *>(node);
+      if (key >= split->key_) {
+        *right = split->right_;
+        return true;
+      }
+    }
+  }
+  bool has_high_key;
+  const std::string *high_key;
+  if (node->type_ == NodeType::LEAF) {
+    const auto *leaf = static_cast<const LeafNode *>(node);
+    has_high_key = leaf->has_high_key_;
+    high_key = &leaf->high_key_;
+    *right = leaf->right_;
+  } else {
+    const auto *inner = static_cast<const InnerNode *>(node);
+    has_high_key = inner->has_high_key_;
+    high_key = &inner->high_key_;
+    *right = inner->right_;
+  }
+  return has_high_key && key >= *high_key;
+}
+
+auto BwTree::FindNode(std::string_view key, uint32_t level) const -> NodeId {
+  NodeId id = root_id_.load();
+  while (true) {
+    const Node *head = GetNode(id);
+    if (head->level_ <= level) {
+      return id;
+    }
+    id = InnerLookup(head, key);
+  }
+}
+
+auto BwTree::GetValue(std::string_view key, RID *value) const -> bool {
+  EpochManager::Guard guard(&epoch_);
+  NodeId id = FindNode(key, 0);
+  while (true) {
+    NodeId right;
+    auto result = LeafLookup(GetNode(id), key, value, &right);
+    if (result != LookupResult::MOVE_RIGHT) {
+      return result == LookupResult::FOUND;
+    }
+    id = right;
+  }
+}
+
+/*****************************************************************************
+ * INSERTION / REMOVAL
+ *****************************************************************************/
+
+auto BwTree::Insert(std::string_view key, const RID &value) -> bool {
+  EpochManager::Guard guard(&epoch_);
+  NodeId id = FindNode(key, 0);
+  while (true) {
+    Node *head = GetNode(id);
+    RID existing;
+    NodeId right;
+    auto result = LeafLookup(head, key, &existing, &right);
+    if (result == LookupResult::MOVE_RIGHT) {
+      id = right;
+      continue;
+    }
+    if (result == LookupResult::FOUND) {
+      return false;
+    }
+
+    // 只有在这个头上判断过key不存在，CAS成功才说明判断仍然成立
+    auto *delta = new InsertDelta(key, value, head);
+    if (mapping_table_[id].compare_exchange_strong(head, delta)) {
+      Restructure(id, delta);
+      return true;
+    }
+    delete delta;
+  }
+}
+
+auto BwTree::Remove(std::string_view key) -> bool {
+  EpochManager::Guard guard(&epoch_);
+  NodeId id = FindNode(key, 0);
+  while (true) {
+    Node *head = GetNode(id);
+    RID existing;
+    NodeId right;
+    auto result = LeafLookup(head, key, &existing, &right);
+    if (result == LookupResult::MOVE_RIGHT) {
+      id = right;
+      continue;
+    }
+    if (result == LookupResult::NOT_FOUND) {
+      return false;
+    }
+
+    auto *delta = new DeleteDelta(key, head);
+    if (mapping_table_[id].compare_exchange_strong(head, delta)) {
+      Restructure(id, delta);
+      return true;
+    }
+    delete delta;
+  }
+}
+
+/*****************************************************************************
+ * STRUCTURE MODIFICATIONS
+ *****************************************************************************/
+
+auto BwTree::BuildLeaf(const Node *head) -> LeafNode * {
+  auto *leaf = new LeafNode();
+  std::vector<const Node *> deltas;
+  bool split = false;
+  const Node *node = head;
+  for (; node->next_ != nullptr; node = node->next_) {
+    deltas.push_back(node);
+    // 最新的split delta给出当前的high key
+    if (node->type_ == NodeType::SPLIT && !split) {
+      const auto *split_delta = static_cast<const SplitDelta *>(node);
+      split = true;
+      leaf->has_high_key_ = true;
+      leaf->high_key_ = split_delta->key_;
+      leaf->right_ = split_delta->right_;
+    }
+  }
+  const auto *base = static_cast<const LeafNode *>(node);
+  if (!split) {
+    leaf->has_high_key_ = base->has_high_key_;
+    leaf->high_key_ = base->high_key_;
+    leaf->right_ = base->right_;
+  }
+
+  auto &entries = leaf->entries_;
+  entries = base->entries_;
+  auto compare = [](const auto &entry, std::string_view search_key) { return entry.first < search_key; };
+  for (auto it = deltas.rbegin(); it != deltas.rend(); ++it) {
+    if ((*it)->type_ == NodeType::INSERT) {
+      const auto *insert = static_cast<const InsertDelta *>(*it);
+      entries.emplace(std::lower_bound(entries.begin(), entries.end(), insert->key_, compare), insert->key_,
+                      insert->value_);
+    } else if ((*it)->type_ == NodeType::DELETE) {
+      const auto *del = static_cast<const DeleteDelta *>(*it);
+      entries.erase(std::lower_bound(entries.begin(), entries.end(), del->key_, compare));
+    }
+  }
+  // split之前插入的大key已经搬到了右兄弟
+  if (leaf->has_high_key_) {
+    entries.erase(std::lower_bound(entries.begin(), entries.end(), leaf->high_key_, compare), entries.end());
+  }
+  leaf->size_ = entries.size();
+  return leaf;
+}
+
+auto BwTree::BuildInner(const Node *head) -> InnerNode * {
+  auto *inner = new InnerNode(head->level_);
+  std::vector<const Node *> deltas;
+  bool split = false;
+  const Node *node = head;
+  for (; node->next_ != nullptr; node = node->next_) {
+    deltas.push_back(node);
+    if (node->type_ == NodeType::SPLIT && !split) {
+      const auto *split_delta = static_cast<const SplitDelta *>(node);
+      split = true;
+      inner->has_high_key_ = true;
+      inner->high_key_ = split_delta->key_;
+      inner->right_ = split_delta->right_;
+    }
+  }
+  const auto *base = static_cast<const InnerNode *>(node);
+  if (!split) {
+    inner->has_high_key_ = base->has_high_key_;
+    inner->high_key_ = base->high_key_;
+    inner->right_ = base->right_;
+  }
+
+  auto &entries = inner->entries_;
+  entries = base->entries_;
+  auto compare = [](const auto &entry, std::string_view search_key) { return entry.first < search_key; };
+  for (auto it = deltas.rbegin(); it != deltas.rend(); ++it) {
+    if ((*it)->type_ == NodeType::INDEX_ENTRY) {
+      const auto *entry = static_cast<const IndexEntryDelta *>(*it);
+      entries.emplace(std::lower_bound(entries.begin() + 1, entries.end(), entry->low_key_, compare), entry->low_key_,
+                      entry->child_);
+    }
+  }
+  if (inner->has_high_key_) {
+    entries.erase(std::lower_bound(entries.begin() + 1, entries.end(), inner->high_key_, compare), entries.end());
+  }
+  inner->size_ = entries.size();
+  return inner;
+}
+
+void BwTree::Restructure(NodeId id, Node *head) {
+  size_t max_size = head->level_ == 0 ? leaf_max_size_ : inner_max_size_;
+  if (head->size_ > max_size) {
+    Split(id, head);
+  } else if (head->chain_length_ >= max_chain_length_) {
+    Consolidate(id, head);
+  }
+}
+
+void BwTree::Consolidate(NodeId id, Node *head) {
+  Node *base = head->level_ == 0 ? static_cast<Node *>(BuildLeaf(head)) : static_cast<Node *>(BuildInner(head));
+  if (mapping_table_[id].compare_exchange_strong(head, base)) {
+    epoch_.Retire(head, &BwTree::DeleteChain);
+  } else {
+    // 有别的线程抢先修改了这个节点，下一次修改会再尝试合并
+    delete base;
+  }
+}
+
+void BwTree::Split(NodeId id, Node *head) {
+  // 先把整条链合并成一个临时的base，再把后一半拷贝到新的右兄弟
+  uint32_t level = head->level_;
+  std::string separator;
+  bool has_high_key;
+  std::string high_key;
+  size_t left_size;
+  Node *right;
+  if (level == 0) {
+    std::unique_ptr<LeafNode> full(BuildLeaf(head));
+    left_size = full->entries_.size() / 2;
+    auto *leaf = new LeafNode();
+    leaf->entries_.assign(full->entries_.begin() + left_size, full->entries_.end());
+    leaf->size_ = leaf->entries_.size();
+    leaf->has_high_key_ = has_high_key = full->has_high_key_;
+    leaf->high_key_ = high_key = full->high_key_;
+    leaf->right_ = full->right_;
+    separator = leaf->entries_.front().first;
+    right = leaf;
+  } else {
+    std::unique_ptr<InnerNode> full(BuildInner(head));
+    left_size = full->entries_.size() / 2;
+    auto *inner = new InnerNode(level);
+    inner->entries_.assign(full->entries_.begin() + left_size, full->entries_.end());
+    inner->size_ = inner->entries_.size();
+    inner->has_high_key_ = has_high_key = full->has_high_key_;
+    inner->high_key_ = high_key = full->high_key_;
+    inner->right_ = full->right_;
+    separator = inner->entries_.front().first;
+    right = inner;
+  }
+
+  // 右兄弟在split delta装上之前没有人能访问到
+  NodeId right_id = NewNodeId(right);
+  auto *split = new SplitDelta(separator, right_id, left_size, head);
+  if (!mapping_table_[id].compare_exchange_strong(head, split)) {
+    // the node changed under us, the id of the right sibling is leaked
+    mapping_table_[right_id].store(nullptr);
+    delete split;
+    delete right;
+    return;
+  }
+  PostSplit(id, separator, has_high_key, high_key, right_id, level);
+}
+
+void BwTree::PostSplit(NodeId left_id, const std::string &separator, bool has_high_key, const std::string &high_key,
+                       NodeId right_id, uint32_t level) {
+  while (true) {
+    NodeId root_id = root_id_.load();
+    if (GetNode(root_id)->level_ == level) {
+      if (root_id != left_id) {
+        // 左兄弟是刚刚分裂的根，等它的分裂线程装上新的根
+        std::this_thread::yield();
+        continue;
+      }
+      auto *root = new InnerNode(level + 1);
+      root->entries_ = {{std::string(), left_id}, {separator, right_id}};
+      root->size_ = root->entries_.size();
+      NodeId new_root_id = NewNodeId(root);
+      if (root_id_.compare_exchange_strong(root_id, new_root_id)) {
+        return;
+      }
+      mapping_table_[new_root_id].store(nullptr);
+      delete root;
+      continue;
+    }
+
+    NodeId parent_id = FindNode(separator, level + 1);
+    Node *head;
+    NodeId parent_right;
+    while (NeedMoveRight(head = GetNode(parent_id), separator, &parent_right)) {
+      parent_id = parent_right;
+    }
+    auto *delta = new IndexEntryDelta(separator, has_high_key, high_key, right_id, head);
+    if (mapping_table_[parent_id].compare_exchange_strong(head, delta)) {
+      Restructure(parent_id, delta);
+      return;
+    }
+    delete delta;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree_index.cpp
+//
+// Identification: src/storage/index/bw_tree_index.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/bw_tree_index.h"
+
+#include "storage/index/var_key.h"
+
+namespace bustub {
+
+BwTreeIndex::BwTreeIndex(std::unique_ptr<IndexMetadata> &&metadata) : Index(std::move(metadata)) {}
+
+auto BwTreeIndex::EncodeKey(const Tuple &key) const -> std::string {
+  VarKey<MAX_KEY_SIZE> index_key;
+  index_key.SetFromKey(key, *GetKeySchema());
+  return {index_key.Data(), index_key.Size()};
+}
+
+auto BwTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) -> bool {
+  return tree_.Insert(EncodeKey(key), rid);
+}
+
+void BwTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) { tree_.Remove(EncodeKey(key)); }
+
+void BwTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  RID rid;
+  if (tree_.GetValue(EncodeKey(key), &rid)) {
+    result->push_back(rid);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.cpp
+//
+// Identification: src/storage/index/epoch_manager.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/epoch_manager.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+EpochManager::EpochManager(size_t num_slots)
+    : num_slots_(num_slots), slots_(std::make_unique<std::atomic<uint64_t>[]>(num_slots)) {
+  for (size_t i = 0; i < num_slots_; ++i) {
+    slots_[i].store(INACTIVE);
+  }
+}
+
+EpochManager::~EpochManager() {
+  for (const auto &garbage : garbage_) {
+    garbage.deleter_(garbage.ptr_);
+  }
+}
+
+auto EpochManager::Enter() -> size_t {
+  // 从线程id对应的位置开始找空闲的slot，减少线程之间的冲突
+  size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % num_slots_;
+  while (true) {
+    for (size_t i = 0; i < num_slots_; ++i) {
+      size_t slot = (start + i) % num_slots_;
+      uint64_t expected = INACTIVE;
+      // 公布的epoch可能已经过时，过时只会让回收更保守
+      if (slots_[slot].load() == INACTIVE && slots_[slot].compare_exchange_strong(expected, global_epoch_.load())) {
+        return slot;
+      }
+    }
+    std::this_thread::yield();
+  }
+}
+
+void EpochManager::Leave(size_t slot) { slots_[slot].store(INACTIVE); }
+
+void EpochManager::Retire(void *ptr, void (*deleter)(void *)) {
+  std::vector<Garbage> reclaimable;
+  {
+    std::scoped_lock lock(garbage_latch_);
+    garbage_.push_back({ptr, deleter, global_epoch_.load()});
+    if (garbage_.size() < RECLAIM_THRESHOLD) {
+      return;
+    }
+
+    // 推进epoch之后进入的线程看不到已经摘下的内存；只要所有活跃线程的epoch都比垃圾新，就可以释放
+    uint64_t min_epoch = global_epoch_.fetch_add(1) + 1;
+    for (size_t i = 0; i < num_slots_; ++i) {
+      min_epoch = std::min(min_epoch, slots_[i].load());
+    }
+    auto it = std::partition(garbage_.begin(), garbage_.end(),
+                             [min_epoch](const Garbage &garbage) { return garbage.epoch_ >= min_epoch; });
+    reclaimable.assign(it, garbage_.end());
+    garbage_.erase(it, garbage_.end());
+  }
+  for (const auto &garbage : reclaimable) {
+    garbage.deleter_(garbage.ptr_);
+  }
+}
+
+}  // namespace bustub
@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "storage/index/index_iterator.h"
+#include "storage/index/posting_list.h"
 
 namespace bustub {
 
@@ -14,17 +15,141 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, ReadPageGuard guard, int index,
+                                  const KeyComparator *comparator, std::optional<KeyType> stop_key, bool reverse)
+    : bpm_(bpm), comparator_(comparator), stop_key_(std::move(stop_key)), reverse_(reverse) {
+  page_id_ = guard.PageId();
+  LoadBatch(guard, index);
+  guard.Drop();
+  if (IsEndInternal()) {
+    // the start position is past the last entry of this leaf
+    AdvanceLeaf();
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return IsEndInternal(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
+  BUSTUB_ASSERT(!IsEndInternal(), "dereferencing an end iterator");
+  return batch_[cursor_];
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
+  if (IsEndInternal()) {
+    return *this;
+  }
+  last_key_ = batch_[cursor_].first;
+  ++cursor_;
+  slot_ += reverse_ ? -1 : 1;
+  if (IsEndInternal()) {
+    AdvanceLeaf();
+  }
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { throw std::runtime_error("unimplemented"); }
+auto INDEXITERATOR_TYPE::PastStopKey(const KeyType &key) const -> bool {
+  if (!stop_key_.has_value()) {
+    return false;
+  }
+  int cmp = (*comparator_)(key, *stop_key_);
+  return reverse_ ? cmp < 0 : cmp > 0;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::LoadBatch(ReadPageGuard &guard, int start) {
+  const auto *leaf = guard.As<LeafPage>();
+  batch_.clear();
+  cursor_ = 0;
+  sibling_page_id_ = reverse_ ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+
+  int size = leaf->GetSize();
+  int step = reverse_ ? -1 : 1;
+  int idx = reverse_ ? std::min(start, size - 1) : std::max(start, 0);
+  batch_.reserve(std::max(0, reverse_ ? idx + 1 : size - idx));
+  for (; idx >= 0 && idx < size; idx += step) {
+    const auto &item = leaf->ItemAt(idx);
+    if (last_key_.has_value()) {
+      // skip what has been returned already, this happens when a split moved entries to the page we are entering
+      int cmp = (*comparator_)(item.first, *last_key_);
+      if (reverse_ ? cmp >= 0 : cmp <= 0) {
+        continue;
+      }
+    }
+    if (PastStopKey(item.first)) {
+      exhausted_ = true;
+      break;
+    }
+    if (batch_.empty()) {
+      first_slot_ = idx;
+    }
+    batch_.push_back(item);
+  }
+  slot_ = first_slot_;
+
+  if (!exhausted_ && sibling_page_id_ != INVALID_PAGE_ID) {
+    bpm_->PrefetchPage(sibling_page_id_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::AdvanceLeaf() {
+  while (!exhausted_ && page_id_ != INVALID_PAGE_ID) {
+    ReadPageGuard sibling_guard;
+    auto curr_guard = bpm_->FetchPageRead(page_id_);
+    const auto *curr_page = curr_guard.template As<LeafPage>();
+    if (curr_page->IsDead()) {
+      // the leaf was merged into the one its next page id points to, in either direction continue there; the
+      // entries that came from the dead leaf and were returned already are filtered out by last_key_
+      page_id_t forward_page_id = curr_page->GetNextPageId();
+      curr_guard.Drop();
+      sibling_guard = bpm_->FetchPageRead(forward_page_id);
+    } else if (!reverse_) {
+      // latch crabbing from left to right: re-read the next pointer of the current leaf and latch the next leaf
+      // before letting the current one go, the same order writers use when they split a leaf
+      page_id_t next_page_id = curr_page->GetNextPageId();
+      if (next_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      sibling_guard = bpm_->FetchPageRead(next_page_id);
+      curr_guard.Drop();
+    } else {
+      // going right to left while holding the right page could deadlock with a splitting writer, so release the
+      // current leaf first and then walk right from its old left neighbour until we are adjacent again
+      page_id_t prev_page_id = curr_page->GetPrevPageId();
+      curr_guard.Drop();
+      if (prev_page_id == INVALID_PAGE_ID) {
+        break;
+      }
+      sibling_guard = bpm_->FetchPageRead(prev_page_id);
+      while (true) {
+        page_id_t next_page_id = sibling_guard.template As<LeafPage>()->GetNextPageId();
+        if (next_page_id == page_id_ || next_page_id == INVALID_PAGE_ID) {
+          break;
+        }
+        sibling_guard = bpm_->FetchPageRead(next_page_id);
+      }
+    }
+
+    page_id_ = sibling_guard.PageId();
+    int start = reverse_ ? sibling_guard.template As<LeafPage>()->GetSize() - 1 : 0;
+    LoadBatch(sibling_guard, start);
+    if (!IsEndInternal()) {
+      return;
+    }
+  }
+
+  batch_.clear();
+  cursor_ = 0;
+  page_id_ = INVALID_PAGE_ID;
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -36,4 +161,22 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<GenericKey<4>, PostingList, GenericComparator<4>>;
+
+template class IndexIterator<GenericKey<8>, PostingList, GenericComparator<8>>;
+
+template class IndexIterator<GenericKey<16>, PostingList, GenericComparator<16>>;
+
+template class IndexIterator<GenericKey<32>, PostingList, GenericComparator<32>>;
+
+template class IndexIterator<GenericKey<64>, PostingList, GenericComparator<64>>;
+
+template class IndexIterator<VarKey<32>, RID, VarKeyComparator<32>>;
+
+template class IndexIterator<VarKey<64>, RID, VarKeyComparator<64>>;
+
+template class IndexIterator<VarKey<32>, PostingList, VarKeyComparator<32>>;
+
+template class IndexIterator<VarKey<64>, PostingList, VarKeyComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// posting_list.cpp
+//
+// Identification: src/storage/index/posting_list.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include "common/exception.h"
+#include "storage/index/posting_list.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+PostingList::PostingList(const RID &rid) {
+  uint32_t size;
+  BUSTUB_ENSURE(EncodePostings({rid}, data_, INLINE_SIZE, &size), "a single RID must fit inline");
+  count_ = 1;
+  size_ = size;
+}
+
+auto PostingList::Add(const RID &rid, BufferPoolManager *bpm) -> bool {
+  std::vector<RID> rids;
+  if (overflow_page_id_ == INVALID_PAGE_ID) {
+    DecodePostings(data_, size_, &rids);
+    auto pos = std::lower_bound(rids.begin(), rids.end(), rid, PostingLess);
+    if (pos != rids.end() && *pos == rid) {
+      return false;
+    }
+    rids.insert(pos, rid);
+
+    uint32_t size;
+    if (EncodePostings(rids, data_, INLINE_SIZE, &size)) {
+      size_ = size;
+    } else {
+      // 列表超出了entry的大小，整体搬到溢出页
+      page_id_t page_id = INVALID_PAGE_ID;
+      auto guard = bpm->NewPageGuarded(&page_id);
+      BUSTUB_ENSURE(page_id != INVALID_PAGE_ID, "cannot allocate posting page");
+      auto *page = guard.AsMut<BPlusTreePostingPage>();
+      page->Init();
+      BUSTUB_ENSURE(page->Store(rids), "an inline posting list must fit into a page");
+      overflow_page_id_ = page_id;
+      size_ = 0;
+    }
+    count_++;
+    return true;
+  }
+
+  // 找到最后一个第一个RID不大于rid的页，rid属于这一页
+  auto guard = bpm->FetchPageWrite(overflow_page_id_);
+  while (true) {
+    page_id_t next_page_id = guard.As<BPlusTreePostingPage>()->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    auto next_guard = bpm->FetchPageWrite(next_page_id);
+    if (PostingLess(rid, next_guard.As<BPlusTreePostingPage>()->GetFirstRID())) {
+      break;
+    }
+    guard = std::move(next_guard);
+  }
+
+  auto *page = guard.AsMut<BPlusTreePostingPage>();
+  page->GetRIDs(&rids);
+  auto pos = std::lower_bound(rids.begin(), rids.end(), rid, PostingLess);
+  if (pos != rids.end() && *pos == rid) {
+    return false;
+  }
+  rids.insert(pos, rid);
+
+  if (!page->Store(rids)) {
+    // 页满了，分出一个新页接在后面。在末尾追加时当前页保持满，递增插入不会留下半空的页
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    auto new_guard = bpm->NewPageGuarded(&new_page_id);
+    BUSTUB_ENSURE(new_page_id != INVALID_PAGE_ID, "cannot allocate posting page");
+    auto *new_page = new_guard.AsMut<BPlusTreePostingPage>();
+    new_page->Init();
+
+    size_t keep = rids.back() == rid ? rids.size() - 1 : rids.size() / 2;
+    std::vector<RID> tail(rids.begin() + keep, rids.end());
+    rids.resize(keep);
+    BUSTUB_ENSURE(new_page->Store(tail) && page->Store(rids), "both halves of a posting page must fit");
+    new_page->SetNextPageId(page->GetNextPageId());
+    page->SetNextPageId(new_page_id);
+  }
+  count_++;
+  return true;
+}
+
+auto PostingList::Merge(const PostingList &other, BufferPoolManager *bpm) -> size_t {
+  BUSTUB_ASSERT(other.overflow_page_id_ == INVALID_PAGE_ID, "only inline lists can be merged");
+  std::vector<RID> rids;
+  DecodePostings(other.data_, other.size_, &rids);
+  size_t added = 0;
+  for (const auto &rid : rids) {
+    added += Add(rid, bpm) ? 1 : 0;
+  }
+  return added;
+}
+
+auto PostingList::Erase(const RID &rid, BufferPoolManager *bpm) -> bool {
+  std::vector<RID> rids;
+  if (overflow_page_id_ == INVALID_PAGE_ID) {
+    DecodePostings(data_, size_, &rids);
+    auto pos = std::lower_bound(rids.begin(), rids.end(), rid, PostingLess);
+    if (pos == rids.end() || !(*pos == rid)) {
+      return false;
+    }
+    rids.erase(pos);
+    // 删掉一个RID后编码只会变短
+    uint32_t size;
+    EncodePostings(rids, data_, INLINE_SIZE, &size);
+    size_ = size;
+    count_--;
+    return true;
+  }
+
+  std::optional<WritePageGuard> prev_guard;
+  auto guard = bpm->FetchPageWrite(overflow_page_id_);
+  while (true) {
+    page_id_t next_page_id = guard.As<BPlusTreePostingPage>()->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    auto next_guard = bpm->FetchPageWrite(next_page_id);
+    if (PostingLess(rid, next_guard.As<BPlusTreePostingPage>()->GetFirstRID())) {
+      break;
+    }
+    prev_guard = std::move(guard);
+    guard = std::move(next_guard);
+  }
+
+  auto *page = guard.AsMut<BPlusTreePostingPage>();
+  page->GetRIDs(&rids);
+  auto pos = std::lower_bound(rids.begin(), rids.end(), rid, PostingLess);
+  if (pos == rids.end() || !(*pos == rid)) {
+    return false;
+  }
+  rids.erase(pos);
+
+  if (rids.empty()) {
+    // 空页从链表中摘掉并释放
+    page_id_t page_id = guard.PageId();
+    page_id_t next_page_id = page->GetNextPageId();
+    if (prev_guard.has_value()) {
+      prev_guard->AsMut<BPlusTreePostingPage>()->SetNextPageId(next_page_id);
+    } else {
+      overflow_page_id_ = next_page_id;
+    }
+    guard.Drop();
+    bpm->DeletePage(page_id);
+  } else {
+    page->Store(rids);
+    guard.Drop();
+  }
+  prev_guard = std::nullopt;
+  count_--;
+  TryInline(bpm);
+  return true;
+}
+
+void PostingList::TryInline(BufferPoolManager *bpm) {
+  // 每个RID至少占一个字节；只在列表缩到entry的一半以内时搬回，避免在边界附近反复搬进搬出
+  if (overflow_page_id_ == INVALID_PAGE_ID || count_ > INLINE_SIZE / 2) {
+    return;
+  }
+
+  page_id_t page_id = overflow_page_id_;
+  {
+    auto guard = bpm->FetchPageRead(page_id);
+    const auto *page = guard.As<BPlusTreePostingPage>();
+    if (page->GetNextPageId() != INVALID_PAGE_ID) {
+      return;
+    }
+    std::vector<RID> rids;
+    page->GetRIDs(&rids);
+    char buf[INLINE_SIZE / 2];
+    uint32_t size;
+    if (!EncodePostings(rids, buf, sizeof(buf), &size)) {
+      return;
+    }
+    memcpy(data_, buf, size);
+    size_ = size;
+  }
+  overflow_page_id_ = INVALID_PAGE_ID;
+  bpm->DeletePage(page_id);
+}
+
+void PostingList::Clear(BufferPoolManager *bpm) {
+  page_id_t page_id = overflow_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    page_id_t next_page_id;
+    {
+      auto guard = bpm->FetchPageRead(page_id);
+      next_page_id = guard.As<BPlusTreePostingPage>()->GetNextPageId();
+    }
+    bpm->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  count_ = 0;
+  overflow_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+}
+
+void PostingList::GetRIDs(BufferPoolManager *bpm, std::vector<RID> *result) const {
+  if (overflow_page_id_ == INVALID_PAGE_ID) {
+    DecodePostings(data_, size_, result);
+    return;
+  }
+  result->reserve(result->size() + count_);
+  for (page_id_t page_id = overflow_page_id_; page_id != INVALID_PAGE_ID;) {
+    auto guard = bpm->FetchPageRead(page_id);
+    const auto *page = guard.As<BPlusTreePostingPage>();
+    page->GetRIDs(result);
+    page_id = page->GetNextPageId();
+  }
+}
+
+}  // namespace bustub
@@ -28,7 +28,32 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) {
   this->SetMaxSize(max_size);
   this->SetPageType(IndexPageType::INTERNAL_PAGE);
   this->SetSize(0);
+  SetRightPageId(INVALID_PAGE_ID);
 }
+
+/*
+ * Helper methods to get/set the right sibling and the high key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetRightPageId() const -> page_id_t { return right_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetRightPageId(page_id_t right_page_id) { right_page_id_ = right_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::NeedMoveRight(const KeyType &key, const KeyComparator &comparator) const
+    -> bool {
+  return IsDead() || (right_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetCapacity() const -> int { return GetMaxSize(); }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
@@ -68,16 +93,25 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   return array_[index].second;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    if (array_[idx].second == value) {
+      return idx;
+    }
+  }
+  return -1;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertVal(const KeyType &key, const ValueType &value,
                                                const KeyComparator &comparator) {
-  // TODO: check the function here
-  int idx = FindKeyIndexLowerBound(key, comparator);  // key[idx]<=value
+  int idx = FindKeyIndexLowerBound(key, comparator);  // key[idx]>=key
   int old_size = GetSize();
 
   // 从idx开始的元素全部向后移动一位
   for (int j = old_size; j > idx; --j) {
-    std::swap(array_[j], array_[j - 1]);
+    array_[j] = array_[j - 1];
   }
   // 插入value
   array_[idx].first = key;
@@ -86,15 +120,15 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertVal(const KeyType &key, const ValueTy
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindKeyIndexLowerBound(const KeyType &key, const KeyComparator &comparator) {
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindKeyIndexLowerBound(const KeyType &key, const KeyComparator &comparator) const
+    -> int {
   // 左闭右开
   int left = 1;
   int right = GetSize();
 
   while (left < right) {
     int mid = left + (right - left) / 2;
-    KeyType mid_key = KeyAt(mid);
-    if (comparator(mid_key, key)) {
+    if (comparator(array_[mid].first, key) < 0) {
       // mid_key < key
       left = mid + 1;
     } else {
@@ -106,24 +140,102 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindKeyIndexLowerBound(const KeyType &key, c
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindKeyIndexUpperBound(const KeyType &key, const KeyComparator &comparator) {
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindKeyIndexUpperBound(const KeyType &key, const KeyComparator &comparator) const
+    -> int {
   // 左闭右开
   int left = 1;
   int right = GetSize();
   while (left < right) {
     int mid = left + (right - left) / 2;
-    KeyType mid_key = KeyAt(mid);
-    if (comparator(key, mid_key)) {
-      // mid_key < key
+    if (comparator(array_[mid].first, key) <= 0) {
+      // mid_key <= key
       left = mid + 1;
     } else {
-      // mid_key >=key
+      // mid_key > key
+      right = mid;
     }
   }
-
   return left;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  // K(i) <= key < K(i+1)，因此取第一个大于key的位置的前一个指针
+  return array_[FindKeyIndexUpperBound(key, comparator) - 1].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
+  array_[0].second = old_value;
+  array_[1] = std::make_pair(new_key, new_value);
+  SetSize(2);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) -> int {
+  int idx = ValueIndex(old_value) + 1;
+  BUSTUB_ASSERT(idx > 0, "old value must exist in the internal page");
+  for (int j = GetSize(); j > idx; --j) {
+    array_[j] = array_[j - 1];
+  }
+  array_[idx] = std::make_pair(new_key, new_value);
+  IncreaseSize(1);
+  return GetSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SplitEntries(const std::vector<MappingType> &entries, int split_idx,
+                                                  BPlusTreeInternalPage *recipient, page_id_t recipient_page_id) {
+  int total = static_cast<int>(entries.size());
+  BUSTUB_ASSERT(split_idx > 0 && split_idx < total, "both pages must be non-empty after a split");
+  SetSize(split_idx);
+  for (int idx = 0; idx < split_idx; ++idx) {
+    array_[idx] = entries[idx];
+  }
+  recipient->SetSize(total - split_idx);
+  for (int idx = split_idx; idx < total; ++idx) {
+    recipient->array_[idx - split_idx] = entries[idx];
+  }
+
+  // 维护B-link结构：新结点继承原来的右链接和high key，分隔key成为左结点新的high key
+  recipient->SetRightPageId(right_page_id_);
+  recipient->SetHighKey(high_key_);
+  SetRightPageId(recipient_page_id);
+  SetHighKey(entries[split_idx].first);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
+  BUSTUB_ASSERT(index > 0 && index < GetSize(), "Invalid idx !");
+  for (int idx = index + 1; idx < GetSize(); ++idx) {
+    array_[idx - 1] = array_[idx];
+  }
+  IncreaseSize(-1);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+                                               page_id_t recipient_page_id) {
+  // 第0个key无效，合并后由父结点中的分隔key补上
+  int base = recipient->GetSize();
+  recipient->IncreaseSize(GetSize());
+  recipient->array_[base] = std::make_pair(middle_key, array_[0].second);
+  for (int idx = 1; idx < GetSize(); ++idx) {
+    recipient->array_[base + idx] = array_[idx];
+  }
+  recipient->SetRightPageId(right_page_id_);
+  recipient->SetHighKey(high_key_);
+  Retire(recipient_page_id);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Retire(page_id_t page_id) {
+  MarkDead();
+  right_page_id_ = page_id;
+}
+
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
 template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
@@ -13,6 +13,7 @@
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/posting_list.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -30,20 +31,49 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetMaxSize(max_size);
   SetSize(0);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  version_ = 0;
 }
 
 /**
  * Helper methods to set/get next page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t {
-  BUSTUB_ASSERT(next_page_id_ != INVALID_PAGE_ID, "next page id should be valid");
-  return next_page_id_;
-}
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/**
+ * Helper methods to set/get previous page id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetVersion() const -> uint32_t { return version_; }
+
+/**
+ * Helper methods to set/get the high key, which is only valid when there is a next page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::NeedMoveRight(const KeyType &key, const KeyComparator &comp) const -> bool {
+  return IsDead() || (next_page_id_ != INVALID_PAGE_ID && comp(key, high_key_) >= 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetCapacity() const -> int { return GetMaxSize() - 1; }
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -57,22 +87,50 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::ItemAt(int index) const -> const MappingType & { return array_[index]; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comp) const -> int {
+  // 二分查找第一个大于等于key的位置
+  int left = 0;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (comp(array_[mid].first, key) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comp) const
+    -> bool {
+  int idx = KeyIndex(key, comp);
+  if (idx == GetSize() || comp(array_[idx].first, key) != 0) {
+    return false;
+  }
+  *value = array_[idx].second;
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::PushBack(const KeyType &key, const ValueType &value) {
   array_[GetSize()] = {key, value};
   IncreaseSize(1);
-  return;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::InsertBefore(const KeyType &key, const ValueType &value, int idx) -> bool {
   int curr_size = GetSize();
-  int max_size = GetMaxSize();
-  if (curr_size >= max_size - 1 || idx < 0 || idx > curr_size) {
+  if (curr_size >= GetMaxSize() || idx < 0 || idx > curr_size) {
     return false;
   }
 
-  for (int i = curr_size + 1; i >= idx; --i) {
+  for (int i = curr_size; i > idx; --i) {
     array_[i] = array_[i - 1];
   }
   array_[idx] = std::make_pair(key, value);
@@ -81,38 +139,51 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::InsertBefore(const KeyType &key, const ValueTyp
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::InsertAfter(const KeyType &key, const ValueType &value, int idx) -> bool {
-  int curr_size = GetSize();
-  int max_size = GetMaxSize();
-  if (curr_size >= max_size - 1 || idx < 0 || idx >= curr_size) {
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp) -> bool {
+  int idx = KeyIndex(key, comp);
+  if (idx < GetSize() && comp(array_[idx].first, key) == 0) {
+    // only support unique key
     return false;
   }
+  return InsertBefore(key, value, idx);
+}
 
-  for (int i = curr_size + 1; i > idx; --i) {
-    array_[i] = array_[i - 1];
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_[index].second = value; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  for (int i = index + 1; i < GetSize(); ++i) {
+    array_[i - 1] = array_[i];
   }
-  array_[idx + 1] = {key, value};
-  IncreaseSize(1);
-  return true;
+  IncreaseSize(-1);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp) -> bool {
-  int curr_size = GetSize();
-  int max_size = GetMaxSize();
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) { MoveTailTo(recipient, GetSize() / 2); }
 
-  if (curr_size >= max_size - 1) {
-    return false;
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveTailTo(BPlusTreeLeafPage *recipient, int keep) {
+  BUSTUB_ASSERT(keep > 0 && keep < GetSize(), "both pages must be non-empty after a split");
+  for (int idx = keep; idx < GetSize(); ++idx) {
+    recipient->PushBack(array_[idx].first, array_[idx].second);
   }
+  SetSize(keep);
+  recipient->SetHighKey(high_key_);
+  high_key_ = recipient->KeyAt(0);
+  version_++;
+}
 
-  int idx = 0;
-  int key_size = GetSize();
-  for (idx = 0; idx < key_size; ++idx) {
-    if (comp(key, KeyAt(idx)) < 0) {
-      break;
-    }
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient, page_id_t recipient_page_id) {
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    recipient->PushBack(array_[idx].first, array_[idx].second);
   }
-  return this->InsertBefore(key, value, idx);
+  recipient->SetHighKey(high_key_);
+  recipient->SetNextPageId(next_page_id_);
+  // 死页的next指向接管它的页，还拿着这个page id的读者和迭代器会被转到那里
+  MarkDead();
+  next_page_id_ = recipient_page_id;
 }
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
@@ -120,4 +191,10 @@ template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class BPlusTreeLeafPage<GenericKey<4>, PostingList, GenericComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, PostingList, GenericComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, PostingList, GenericComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<32>, PostingList, GenericComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, PostingList, GenericComparator<64>>;
 }  // namespace bustub
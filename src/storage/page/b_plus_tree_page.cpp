@@ -44,4 +44,13 @@ void BPlusTreePage::SetMaxSize(int size) { max_size_ = size; }
  */
 auto BPlusTreePage::GetMinSize() const -> int { return max_size_ / 2; }
 
+/*
+ * Helper methods for dead pages, no live page has a max size of 0
+ */
+auto BPlusTreePage::IsDead() const -> bool { return max_size_ == 0; }
+void BPlusTreePage::MarkDead() {
+  size_ = 0;
+  max_size_ = 0;
+}
+
 }  // namespace bustub
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_posting_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_posting_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_posting_page.h"
+
+namespace bustub {
+
+namespace {
+
+auto PostingOrder(const RID &rid) -> uint64_t {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(rid.GetPageId())) << 32) | rid.GetSlotNum();
+}
+
+}  // namespace
+
+auto PostingLess(const RID &lhs, const RID &rhs) -> bool { return PostingOrder(lhs) < PostingOrder(rhs); }
+
+auto EncodePostings(const std::vector<RID> &rids, char *buf, size_t capacity, uint32_t *size) -> bool {
+  size_t offset = 0;
+  uint64_t prev = 0;
+  for (const auto &rid : rids) {
+    uint64_t curr = PostingOrder(rid);
+    BUSTUB_ASSERT(offset == 0 || curr > prev, "posting list must be sorted and distinct");
+    uint64_t delta = curr - prev;
+    prev = curr;
+    // 7 bits per byte, the high bit marks that more bytes follow
+    do {
+      if (offset == capacity) {
+        return false;
+      }
+      auto byte = static_cast<uint8_t>(delta & 0x7F);
+      delta >>= 7;
+      buf[offset++] = static_cast<char>(delta != 0 ? (byte | 0x80) : byte);
+    } while (delta != 0);
+  }
+  *size = static_cast<uint32_t>(offset);
+  return true;
+}
+
+void DecodePostings(const char *buf, uint32_t size, std::vector<RID> *result) {
+  uint64_t prev = 0;
+  uint32_t offset = 0;
+  while (offset < size) {
+    uint64_t delta = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      byte = static_cast<uint8_t>(buf[offset++]);
+      delta |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      shift += 7;
+    } while ((byte & 0x80) != 0);
+    prev += delta;
+    result->emplace_back(static_cast<page_id_t>(prev >> 32), static_cast<uint32_t>(prev));
+  }
+}
+
+void BPlusTreePostingPage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  count_ = 0;
+  size_ = 0;
+  first_rid_ = RID();
+}
+
+auto BPlusTreePostingPage::Store(const std::vector<RID> &rids) -> bool {
+  BUSTUB_ASSERT(!rids.empty(), "posting pages are never empty");
+  // 先编码到临时缓冲区，放不下时页面保持原样
+  char buf[DATA_SIZE];
+  uint32_t size;
+  if (!EncodePostings(rids, buf, DATA_SIZE, &size)) {
+    return false;
+  }
+  memcpy(data_, buf, size);
+  count_ = rids.size();
+  size_ = size;
+  first_rid_ = rids[0];
+  return true;
+}
+
+}  // namespace bustub
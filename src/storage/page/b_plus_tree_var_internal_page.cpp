@@ -0,0 +1,248 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_var_internal_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_var_internal_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "storage/page/b_plus_tree_var_internal_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::Init(int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  right_page_id_ = INVALID_PAGE_ID;
+  max_entries_ = max_size;
+  heap_offset_ = BUSTUB_PAGE_SIZE;
+  prefix_size_ = 0;
+  has_high_key_ = 0;
+  low_key_.size_ = 0;
+  high_key_.size_ = 0;
+  UpdateMaxSize();
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::GetRightPageId() const -> page_id_t { return right_page_id_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::GetPrefixSize() const -> int { return prefix_size_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::NeedMoveRight(const KeyType &key, const KeyComparator &comparator) const
+    -> bool {
+  return IsDead() || (right_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::GetCapacity() const -> int {
+  // 空页按最长的key能放下的entry数
+  size_t header_size = reinterpret_cast<const char *>(&slots_[0]) - reinterpret_cast<const char *>(this);
+  size_t worst_entry_size = sizeof(Slot) + KeySize + sizeof(ValueType);
+  size_t room = (BUSTUB_PAGE_SIZE - header_size) / worst_entry_size;
+  return static_cast<int>(std::min<size_t>(max_entries_, room));
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::SuffixAt(int index) const -> const char * {
+  return reinterpret_cast<const char *>(this) + slots_[index].offset_;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::FreeSpace() const -> size_t {
+  size_t slots_end = reinterpret_cast<const char *>(&slots_[GetSize()]) - reinterpret_cast<const char *>(this);
+  return heap_offset_ - slots_end;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::UpdateMaxSize() {
+  // 按最长的key估算剩余空间还能放下多少个entry
+  size_t worst_entry_size = sizeof(Slot) + KeySize + sizeof(ValueType);
+  size_t room = FreeSpace() / worst_entry_size;
+  SetMaxSize(static_cast<int>(std::min<size_t>(max_entries_, GetSize() + room)));
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  BUSTUB_ASSERT(index < GetSize(), "Invalid idx !");
+  KeyType key;
+  uint16_t suffix_size = slots_[index].size_;
+  memcpy(key.data_, low_key_.data_, prefix_size_);
+  memcpy(key.data_ + prefix_size_, SuffixAt(index), suffix_size);
+  key.size_ = prefix_size_ + suffix_size;
+  return key;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  BUSTUB_ASSERT(index < GetSize(), "Invalid idx !");
+  ValueType value;
+  memcpy(&value, SuffixAt(index) + slots_[index].size_, sizeof(ValueType));
+  return value;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const -> int {
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    if (ValueAt(idx) == value) {
+      return idx;
+    }
+  }
+  return -1;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const
+    -> ValueType {
+  // 先和页内公共前缀比较一次：key在前缀范围之外时，直接落在第一个或最后一个孩子
+  size_t common = std::min<size_t>(key.Size(), prefix_size_);
+  int cmp = memcmp(low_key_.data_, key.data_, common);
+  if (cmp > 0 || (cmp == 0 && key.Size() < prefix_size_)) {
+    return ValueAt(0);
+  }
+  if (cmp < 0) {
+    return ValueAt(GetSize() - 1);
+  }
+
+  // K(i) <= key < K(i+1)，因此取第一个大于key的位置的前一个指针
+  const char *key_suffix = key.data_ + prefix_size_;
+  size_t key_suffix_size = key.Size() - prefix_size_;
+  int left = 1;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (KeyType::Compare(SuffixAt(mid), slots_[mid].size_, key_suffix, key_suffix_size) <= 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return ValueAt(left - 1);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::WriteEntry(int index, const KeyType &key, const ValueType &value) {
+  // 第0个key无效，只保存孩子指针
+  uint16_t suffix_size = index == 0 ? 0 : key.size_ - prefix_size_;
+  heap_offset_ -= suffix_size + sizeof(ValueType);
+  char *entry = reinterpret_cast<char *>(this) + heap_offset_;
+  if (suffix_size > 0) {
+    memcpy(entry, key.data_ + prefix_size_, suffix_size);
+  }
+  memcpy(entry + suffix_size, &value, sizeof(ValueType));
+  slots_[index] = {heap_offset_, suffix_size};
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::Rebuild(const MappingType *first, const MappingType *last) {
+  // 区间变窄后公共前缀只会变长，重写后的页一定放得下原来的entry；合并时区间变宽，由调用者保证放得下
+  prefix_size_ = has_high_key_ != 0 ? CommonPrefixSize(low_key_, high_key_) : 0;
+  heap_offset_ = BUSTUB_PAGE_SIZE;
+  SetSize(0);
+  SetMaxSize(max_entries_);
+  for (const auto *entry = first; entry != last; ++entry) {
+    WriteEntry(GetSize(), entry->first, entry->second);
+    IncreaseSize(1);
+  }
+  UpdateMaxSize();
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                         const ValueType &new_value) {
+  MappingType entries[2] = {{KeyType{}, old_value}, {new_key, new_value}};
+  Rebuild(entries, entries + 2);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
+                                                         const ValueType &new_value) -> int {
+  int idx = ValueIndex(old_value) + 1;
+  BUSTUB_ASSERT(idx > 0, "old value must exist in the internal page");
+  BUSTUB_ASSERT(GetSize() < GetMaxSize(), "internal page is full");
+  BUSTUB_ASSERT(new_key.Size() >= prefix_size_ && memcmp(new_key.data_, low_key_.data_, prefix_size_) == 0,
+                "key is out of the range of the internal page");
+  memmove(&slots_[idx + 1], &slots_[idx], (GetSize() - idx) * sizeof(Slot));
+  IncreaseSize(1);
+  WriteEntry(idx, new_key, new_value);
+  UpdateMaxSize();
+  return GetSize();
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::SplitEntries(const std::vector<MappingType> &entries, int split_idx,
+                                                      BPlusTreeInternalPage *recipient, page_id_t recipient_page_id) {
+  BUSTUB_ASSERT(split_idx > 0 && split_idx < static_cast<int>(entries.size()),
+                "both pages must be non-empty after a split");
+  const KeyType &separator = entries[split_idx].first;
+  recipient->right_page_id_ = right_page_id_;
+  recipient->low_key_ = separator;
+  recipient->high_key_ = high_key_;
+  recipient->has_high_key_ = has_high_key_;
+  recipient->Rebuild(entries.data() + split_idx, entries.data() + entries.size());
+
+  right_page_id_ = recipient_page_id;
+  high_key_ = separator;
+  has_high_key_ = 1;
+  Rebuild(entries.data(), entries.data() + split_idx);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
+  BUSTUB_ASSERT(index > 0 && index < GetSize(), "Invalid idx !");
+  std::vector<MappingType> entries;
+  entries.reserve(GetSize() - 1);
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    if (idx != index) {
+      entries.emplace_back(KeyAt(idx), ValueAt(idx));
+    }
+  }
+  Rebuild(entries.data(), entries.data() + entries.size());
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+                                                   page_id_t recipient_page_id) {
+  std::vector<MappingType> entries;
+  entries.reserve(recipient->GetSize() + GetSize());
+  for (int idx = 0; idx < recipient->GetSize(); ++idx) {
+    entries.emplace_back(recipient->KeyAt(idx), recipient->ValueAt(idx));
+  }
+  // 第0个key无效，合并后由父结点中的分隔key补上
+  entries.emplace_back(middle_key, ValueAt(0));
+  for (int idx = 1; idx < GetSize(); ++idx) {
+    entries.emplace_back(KeyAt(idx), ValueAt(idx));
+  }
+
+  recipient->right_page_id_ = right_page_id_;
+  recipient->high_key_ = high_key_;
+  recipient->has_high_key_ = has_high_key_;
+  recipient->Rebuild(entries.data(), entries.data() + entries.size());
+  Retire(recipient_page_id);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_INTERNAL_PAGE_TYPE::Retire(page_id_t page_id) {
+  MarkDead();
+  right_page_id_ = page_id;
+}
+
+// valuetype for internalNode should be page id_t
+template class BPlusTreeInternalPage<VarKey<32>, page_id_t, VarKeyComparator<32>>;
+template class BPlusTreeInternalPage<VarKey<64>, page_id_t, VarKeyComparator<64>>;
+}  // namespace bustub
@@ -0,0 +1,271 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_var_leaf_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_var_leaf_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/posting_list.h"
+#include "storage/page/b_plus_tree_var_leaf_page.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::Init(int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  version_ = 0;
+  max_entries_ = max_size;
+  heap_offset_ = BUSTUB_PAGE_SIZE;
+  prefix_size_ = 0;
+  has_high_key_ = 0;
+  low_key_.size_ = 0;
+  high_key_.size_ = 0;
+  UpdateMaxSize();
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::GetVersion() const -> uint32_t { return version_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::GetHighKey() const -> const KeyType & { return high_key_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::GetPrefixSize() const -> int { return prefix_size_; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::NeedMoveRight(const KeyType &key, const KeyComparator &comp) const -> bool {
+  return IsDead() || (next_page_id_ != INVALID_PAGE_ID && comp(key, high_key_) >= 0);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::GetCapacity() const -> int {
+  // 空页按最长的key能放下的entry数；叶子在size达到max size时分裂，所以还要少一个
+  size_t header_size = reinterpret_cast<const char *>(&slots_[0]) - reinterpret_cast<const char *>(this);
+  size_t worst_entry_size = sizeof(Slot) + KeySize + sizeof(ValueType);
+  size_t room = (BUSTUB_PAGE_SIZE - header_size) / worst_entry_size;
+  return static_cast<int>(std::min<size_t>(max_entries_, room)) - 1;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::SuffixAt(int index) const -> const char * {
+  return reinterpret_cast<const char *>(this) + slots_[index].offset_;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::FreeSpace() const -> size_t {
+  size_t slots_end = reinterpret_cast<const char *>(&slots_[GetSize()]) - reinterpret_cast<const char *>(this);
+  return heap_offset_ - slots_end;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::UpdateMaxSize() {
+  // 按最长的key估算剩余空间还能放下多少个entry
+  size_t worst_entry_size = sizeof(Slot) + KeySize + sizeof(ValueType);
+  size_t room = FreeSpace() / worst_entry_size;
+  SetMaxSize(static_cast<int>(std::min<size_t>(max_entries_, GetSize() + room)));
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
+  KeyType key;
+  uint16_t suffix_size = slots_[index].size_;
+  memcpy(key.data_, low_key_.data_, prefix_size_);
+  memcpy(key.data_ + prefix_size_, SuffixAt(index), suffix_size);
+  key.size_ = prefix_size_ + suffix_size;
+  return key;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
+  ValueType value;
+  memcpy(&value, SuffixAt(index) + slots_[index].size_, sizeof(ValueType));
+  return value;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::ItemAt(int index) const -> MappingType { return {KeyAt(index), ValueAt(index)}; }
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comp) const -> int {
+  // 先和页内公共前缀比较一次，之后二分查找只需要比较后缀
+  size_t common = std::min<size_t>(key.Size(), prefix_size_);
+  int cmp = memcmp(low_key_.data_, key.data_, common);
+  if (cmp > 0 || (cmp == 0 && key.Size() < prefix_size_)) {
+    return 0;
+  }
+  if (cmp < 0) {
+    return GetSize();
+  }
+
+  const char *key_suffix = key.data_ + prefix_size_;
+  size_t key_suffix_size = key.Size() - prefix_size_;
+  int left = 0;
+  int right = GetSize();
+  while (left < right) {
+    int mid = left + (right - left) / 2;
+    if (KeyType::Compare(SuffixAt(mid), slots_[mid].size_, key_suffix, key_suffix_size) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comp) const
+    -> bool {
+  int idx = KeyIndex(key, comp);
+  if (idx == GetSize() || comp(KeyAt(idx), key) != 0) {
+    return false;
+  }
+  *value = ValueAt(idx);
+  return true;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp)
+    -> bool {
+  int idx = KeyIndex(key, comp);
+  if (idx < GetSize() && comp(KeyAt(idx), key) == 0) {
+    // only support unique key
+    return false;
+  }
+  if (GetSize() >= GetMaxSize()) {
+    return false;
+  }
+  BUSTUB_ASSERT(key.Size() >= prefix_size_ && memcmp(key.data_, low_key_.data_, prefix_size_) == 0,
+                "key is out of the range of the leaf");
+
+  uint16_t suffix_size = key.size_ - prefix_size_;
+  heap_offset_ -= suffix_size + sizeof(ValueType);
+  char *entry = reinterpret_cast<char *>(this) + heap_offset_;
+  memcpy(entry, key.data_ + prefix_size_, suffix_size);
+  memcpy(entry + suffix_size, &value, sizeof(ValueType));
+  memmove(&slots_[idx + 1], &slots_[idx], (GetSize() - idx) * sizeof(Slot));
+  slots_[idx] = {heap_offset_, suffix_size};
+  IncreaseSize(1);
+  UpdateMaxSize();
+  return true;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  memcpy(reinterpret_cast<char *>(this) + slots_[index].offset_ + slots_[index].size_, &value, sizeof(ValueType));
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::RemoveAt(int index) {
+  std::vector<MappingType> entries;
+  entries.reserve(GetSize() - 1);
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    if (idx != index) {
+      entries.emplace_back(ItemAt(idx));
+    }
+  }
+  Rebuild(entries.data(), entries.data() + entries.size());
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::AppendEntry(const KeyType &key, const ValueType &value) {
+  uint16_t suffix_size = key.size_ - prefix_size_;
+  heap_offset_ -= suffix_size + sizeof(ValueType);
+  char *entry = reinterpret_cast<char *>(this) + heap_offset_;
+  memcpy(entry, key.data_ + prefix_size_, suffix_size);
+  memcpy(entry + suffix_size, &value, sizeof(ValueType));
+  slots_[GetSize()] = {heap_offset_, suffix_size};
+  IncreaseSize(1);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::Rebuild(const MappingType *first, const MappingType *last) {
+  // 区间变窄后公共前缀只会变长，重写后的页一定放得下原来的entry；合并时区间变宽，由调用者保证放得下
+  prefix_size_ = has_high_key_ != 0 ? CommonPrefixSize(low_key_, high_key_) : 0;
+  heap_offset_ = BUSTUB_PAGE_SIZE;
+  SetSize(0);
+  SetMaxSize(max_entries_);
+  for (const auto *entry = first; entry != last; ++entry) {
+    AppendEntry(entry->first, entry->second);
+  }
+  UpdateMaxSize();
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  MoveTailTo(recipient, GetSize() / 2);
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::MoveTailTo(BPlusTreeLeafPage *recipient, int keep) {
+  BUSTUB_ASSERT(keep > 0 && keep < GetSize(), "both pages must be non-empty after a split");
+  std::vector<MappingType> entries;
+  entries.reserve(GetSize());
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    entries.emplace_back(ItemAt(idx));
+  }
+
+  KeyType separator = ShortestSeparator(entries[keep - 1].first, entries[keep].first);
+  recipient->low_key_ = separator;
+  recipient->high_key_ = high_key_;
+  recipient->has_high_key_ = has_high_key_;
+  recipient->Rebuild(entries.data() + keep, entries.data() + entries.size());
+
+  high_key_ = separator;
+  has_high_key_ = 1;
+  Rebuild(entries.data(), entries.data() + keep);
+  version_++;
+}
+
+VAR_INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_VAR_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient, page_id_t recipient_page_id) {
+  std::vector<MappingType> entries;
+  entries.reserve(recipient->GetSize() + GetSize());
+  for (int idx = 0; idx < recipient->GetSize(); ++idx) {
+    entries.emplace_back(recipient->ItemAt(idx));
+  }
+  for (int idx = 0; idx < GetSize(); ++idx) {
+    entries.emplace_back(ItemAt(idx));
+  }
+
+  // 合并后的区间是[recipient的low key, 本页的high key)
+  recipient->high_key_ = high_key_;
+  recipient->has_high_key_ = has_high_key_;
+  recipient->next_page_id_ = next_page_id_;
+  recipient->Rebuild(entries.data(), entries.data() + entries.size());
+
+  MarkDead();
+  next_page_id_ = recipient_page_id;
+}
+
+template class BPlusTreeLeafPage<VarKey<32>, RID, VarKeyComparator<32>>;
+template class BPlusTreeLeafPage<VarKey<64>, RID, VarKeyComparator<64>>;
+template class BPlusTreeLeafPage<VarKey<32>, PostingList, VarKeyComparator<32>>;
+template class BPlusTreeLeafPage<VarKey<64>, PostingList, VarKeyComparator<64>>;
+}  // namespace bustub
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  num_entries_ = 0;
+}
+
+auto FreeSpaceMapPage::ToCategory(uint32_t free_bytes) -> uint8_t {
+  return static_cast<uint8_t>(std::min<uint32_t>(free_bytes / CATEGORY_BYTES, MAX_CATEGORY));
+}
+
+auto FreeSpaceMapPage::Append(page_id_t page_id, uint8_t category) -> uint32_t {
+  BUSTUB_ASSERT(!IsFull(), "free space map page is full");
+  page_ids_[num_entries_] = page_id;
+  Categories()[num_entries_] = category;
+  return num_entries_++;
+}
+
+auto FreeSpaceMapPage::Find(uint8_t category) const -> int {
+  const uint8_t *cats = Categories();
+  for (uint32_t i = 0; i < num_entries_; i++) {
+    if (cats[i] >= category && cats[i] != IN_USE) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
+auto FreeSpaceMapPage::MaxCategory() const -> uint8_t {
+  const uint8_t *cats = Categories();
+  uint8_t max_category = 0;
+  for (uint32_t i = 0; i < num_entries_; i++) {
+    if (cats[i] != IN_USE) {
+      max_category = std::max(max_category, cats[i]);
+    }
+  }
+  return max_category;
+}
+
+}  // namespace bustub
@@ -11,38 +11,129 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_block_page.h"
+#include "common/logger.h"
 #include "storage/index/generic_key.h"
 
 namespace bustub {
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  for (size_t i = 0; i < sizeof(occupied_); i++) {
+    occupied_[i] = 0;
+    readable_[i] = 0;
+  }
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::KeyAt(slot_offset_t bucket_ind) const -> KeyType {
-  return {};
+  return array_[bucket_ind].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::ValueAt(slot_offset_t bucket_ind) const -> ValueType {
-  return {};
+  return array_[bucket_ind].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value) -> bool {
-  return false;
+  auto mask = static_cast<char>(1 << (bucket_ind % 8));
+  // 用CAS抢占readable位，墓碑可以重新使用
+  if ((readable_[bucket_ind / 8].fetch_or(mask) & mask) != 0) {
+    return false;
+  }
+  occupied_[bucket_ind / 8] |= mask;
+  array_[bucket_ind] = MappingType(key, value);
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {}
+void HASH_TABLE_BLOCK_TYPE::Remove(slot_offset_t bucket_ind) {
+  // 只清除readable，occupied保留作为墓碑，探测时不会提前停下
+  readable_[bucket_ind / 8] &= static_cast<char>(~(1 << (bucket_ind % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::IsOccupied(slot_offset_t bucket_ind) const -> bool {
-  return false;
+  return (occupied_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BLOCK_TYPE::IsReadable(slot_offset_t bucket_ind) const -> bool {
+  return (readable_[bucket_ind / 8] & (1 << (bucket_ind % 8))) != 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::GetValue(KeyType key, KeyComparator cmp, slot_offset_t start,
+                                     std::vector<ValueType> *result) const -> bool {
+  bool found = false;
+  // 探测到从未被占用过的槽为止
+  for (slot_offset_t i = 0, idx = start; i < BLOCK_ARRAY_SIZE && IsOccupied(idx);
+       i++, idx = (idx + 1) % BLOCK_ARRAY_SIZE) {
+    if (IsReadable(idx) && cmp(key, array_[idx].first) == 0) {
+      result->push_back(array_[idx].second);
+      found = true;
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::Insert(const KeyType &key, const ValueType &value, slot_offset_t start) -> bool {
+  for (slot_offset_t i = 0, idx = start; i < BLOCK_ARRAY_SIZE; i++, idx = (idx + 1) % BLOCK_ARRAY_SIZE) {
+    if (!IsReadable(idx)) {
+      return Insert(idx, key, value);
+    }
+  }
   return false;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp, slot_offset_t start) -> bool {
+  for (slot_offset_t i = 0, idx = start; i < BLOCK_ARRAY_SIZE && IsOccupied(idx);
+       i++, idx = (idx + 1) % BLOCK_ARRAY_SIZE) {
+    if (IsReadable(idx) && cmp(key, array_[idx].first) == 0 && array_[idx].second == value) {
+      Remove(idx);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::NumReadable() const -> uint32_t {
+  uint32_t count = 0;
+  for (const auto &byte : readable_) {
+    count += __builtin_popcount(static_cast<uint8_t>(byte.load()));
+  }
+  return count;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BLOCK_TYPE::IsEmpty() const -> bool {
+  for (const auto &byte : readable_) {
+    if (byte != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BLOCK_TYPE::PrintBucket() const {
+  uint32_t taken = 0;
+  uint32_t tombstones = 0;
+  for (slot_offset_t idx = 0; idx < BLOCK_ARRAY_SIZE; idx++) {
+    if (IsReadable(idx)) {
+      taken++;
+    } else if (IsOccupied(idx)) {
+      tombstones++;
+    }
+  }
+  LOG_INFO("Block Capacity: %lu, Taken: %u, Tombstones: %u, Next: %d", BLOCK_ARRAY_SIZE, taken, tombstones,
+           next_page_id_);
+}
+
 // DO NOT REMOVE ANYTHING BELOW THIS LINE
 template class HashTableBlockPage<int, int, IntComparator>;
 template class HashTableBlockPage<GenericKey<4>, RID, GenericComparator<4>>;
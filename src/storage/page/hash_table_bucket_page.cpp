@@ -10,6 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
 #include "storage/page/hash_table_bucket_page.h"
 #include "common/logger.h"
 #include "common/util/hash_util.h"
@@ -20,62 +27,180 @@
 namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result,
+                                      uint8_t fingerprint) const -> bool {
+  bool found = false;
+  // 槽位按顺序占用，一组里没有被占用过的槽时后面也不会再有数据
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE && GroupBits(occupied_, base) != 0; base += GROUP_SIZE) {
+    for (uint32_t matches = MatchGroup(base, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_idx].first) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+auto HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) -> bool {
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE && GroupBits(occupied_, base) != 0; base += GROUP_SIZE) {
+    for (uint32_t matches = MatchGroup(base, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_idx].first) == 0 && array_[bucket_idx].second == value) {
+        return false;
+      }
+    }
+  }
+  // 第一个空槽（墓碑或从未占用过的槽）
+  uint32_t free_idx = FirstFreeSlot();
+  if (free_idx == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  fingerprints_[free_idx] = fingerprint;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) -> bool {
+auto HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp, uint8_t fingerprint) -> bool {
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE && GroupBits(occupied_, base) != 0; base += GROUP_SIZE) {
+    for (uint32_t matches = MatchGroup(base, fingerprint); matches != 0; matches &= matches - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(matches);
+      if (cmp(key, array_[bucket_idx].first) == 0 && array_[bucket_idx].second == value) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::MatchGroup(uint32_t base, uint8_t fingerprint) const -> uint32_t {
+  uint32_t readable = GroupBits(readable_, base);
+  if (readable == 0) {
+    return 0;
+  }
+#if defined(__SSE2__)
+  // 一次比较16个fingerprint。最后一组会读过数组末尾，那些槽的readable位一定是0
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + base));
+  __m128i target = _mm_set1_epi8(static_cast<char>(fingerprint));
+  auto matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, target)));
+#else
+  uint32_t matches = 0;
+  for (uint32_t i = 0; i < GROUP_SIZE && base + i < BUCKET_ARRAY_SIZE; i++) {
+    matches |= static_cast<uint32_t>(fingerprints_[base + i] == fingerprint) << i;
+  }
+#endif
+  return matches & readable;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::GroupBits(const char *bitmap, uint32_t base) -> uint32_t {
+  uint32_t byte_idx = base / 8;
+  uint32_t bits = static_cast<uint8_t>(bitmap[byte_idx]);
+  if (byte_idx + 1 < (BUCKET_ARRAY_SIZE - 1) / 8 + 1) {
+    bits |= static_cast<uint32_t>(static_cast<uint8_t>(bitmap[byte_idx + 1])) << 8;
+  }
+  return bits;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+auto HASH_TABLE_BUCKET_TYPE::FirstFreeSlot() const -> uint32_t {
+  // 按8字节一组找第一个不全为1的字
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= sizeof(readable_); offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, readable_ + offset, sizeof(uint64_t));
+    if (word != ~0ULL) {
+      return std::min<uint32_t>(offset * 8 + __builtin_ctzll(~word), BUCKET_ARRAY_SIZE);
+    }
+  }
+  for (; offset < sizeof(readable_); offset++) {
+    auto byte = static_cast<uint8_t>(readable_[offset]);
+    if (byte != 0xFF) {
+      return std::min<uint32_t>(offset * 8 + __builtin_ctz(~byte & 0xFFU), BUCKET_ARRAY_SIZE);
+    }
+  }
+  return BUCKET_ARRAY_SIZE;
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const -> KeyType {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const -> ValueType {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  // 只清除readable，occupied保留作为墓碑，查找时不会提前停下
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 auto HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const -> bool {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::IsFull() -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::IsFull() const -> bool {
+  return FirstFreeSlot() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::NumReadable() -> uint32_t {
-  return 0;
+auto HASH_TABLE_BUCKET_TYPE::NumReadable() const -> uint32_t {
+  uint32_t count = 0;
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= sizeof(readable_); offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, readable_ + offset, sizeof(uint64_t));
+    count += __builtin_popcountll(word);
+  }
+  for (; offset < sizeof(readable_); offset++) {
+    count += __builtin_popcount(static_cast<uint8_t>(readable_[offset]));
+  }
+  return count;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-auto HASH_TABLE_BUCKET_TYPE::IsEmpty() -> bool {
-  return false;
+auto HASH_TABLE_BUCKET_TYPE::IsEmpty() const -> bool {
+  size_t offset = 0;
+  for (; offset + sizeof(uint64_t) <= sizeof(readable_); offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, readable_ + offset, sizeof(uint64_t));
+    if (word != 0) {
+      return false;
+    }
+  }
+  for (; offset < sizeof(readable_); offset++) {
+    if (readable_[offset] != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
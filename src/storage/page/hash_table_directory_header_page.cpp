@@ -0,0 +1,29 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_header_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_header_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_header_page.h"
+
+namespace bustub {
+
+void HashTableDirectoryHeaderPage::Init() {
+  for (auto &directory_page_id : directory_page_ids_) {
+    directory_page_id = INVALID_PAGE_ID;
+  }
+}
+
+auto HashTableDirectoryHeaderPage::GetDirectoryPageId(uint32_t directory_idx) const -> page_id_t {
+  return directory_page_ids_[directory_idx];
+}
+
+void HashTableDirectoryHeaderPage::SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id) {
+  directory_page_ids_[directory_idx] = directory_page_id;
+}
+
+}  // namespace bustub
@@ -11,24 +11,40 @@
 //===----------------------------------------------------------------------===//
 
 #include "storage/page/hash_table_header_page.h"
+#include "common/macros.h"
 
 namespace bustub {
-auto HashTableHeaderPage::GetBlockPageId(size_t index) -> page_id_t { return 0; }
+auto HashTableHeaderPage::GetBlockPageId(size_t index) const -> page_id_t {
+  BUSTUB_ASSERT(index < next_ind_, "block index out of range");
+  return block_page_ids_[index];
+}
 
-auto HashTableHeaderPage::GetPageId() const -> page_id_t { return 0; }
+auto HashTableHeaderPage::GetPageId() const -> page_id_t { return page_id_; }
 
-void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) {}
+void HashTableHeaderPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
 
-auto HashTableHeaderPage::GetLSN() const -> lsn_t { return 0; }
+auto HashTableHeaderPage::GetLSN() const -> lsn_t { return lsn_; }
 
-void HashTableHeaderPage::SetLSN(lsn_t lsn) {}
+void HashTableHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
-void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {}
+void HashTableHeaderPage::AddBlockPageId(page_id_t page_id) {
+  BUSTUB_ASSERT(next_ind_ < MAX_BLOCKS, "header page is full");
+  block_page_ids_[next_ind_] = page_id;
+  next_ind_++;
+}
 
-auto HashTableHeaderPage::NumBlocks() -> size_t { return 0; }
+auto HashTableHeaderPage::NumBlocks() const -> size_t { return next_ind_; }
 
-void HashTableHeaderPage::SetSize(size_t size) {}
+void HashTableHeaderPage::SetSize(size_t size) { __atomic_store_n(&size_, size, __ATOMIC_RELAXED); }
 
-auto HashTableHeaderPage::GetSize() const -> size_t { return 0; }
+auto HashTableHeaderPage::GetSize() const -> size_t { return __atomic_load_n(&size_, __ATOMIC_RELAXED); }
+
+auto HashTableHeaderPage::IncrSize(int64_t delta) -> size_t {
+  return __atomic_add_fetch(&size_, static_cast<size_t>(delta), __ATOMIC_RELAXED);
+}
+
+auto HashTableHeaderPage::GetInitialBlocks() const -> size_t { return initial_blocks_; }
+
+void HashTableHeaderPage::SetInitialBlocks(size_t initial_blocks) { initial_blocks_ = initial_blocks; }
 
 }  // namespace bustub
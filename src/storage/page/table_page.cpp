@@ -12,60 +12,300 @@
 
 #include "storage/page/table_page.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <optional>
 #include <tuple>
+#include <vector>
 #include "common/config.h"
 #include "common/exception.h"
+#include "common/macros.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
-void TablePage::Init() {
+void TablePage::Init(uint8_t version, uint8_t null_bitmap_size) {
+  BUSTUB_ASSERT(version == TABLE_PAGE_VERSION_2 || null_bitmap_size == 0, "version 1 pages have no null bitmap");
   next_page_id_ = INVALID_PAGE_ID;
   num_tuples_ = 0;
   num_deleted_tuples_ = 0;
+  num_dead_tuples_ = 0;
+  free_space_pointer_ = BUSTUB_PAGE_SIZE;
+  dead_bytes_ = 0;
+  version_ = version;
+  null_bitmap_size_ = null_bitmap_size;
+  if (version_ == TABLE_PAGE_VERSION_2) {
+    std::fill(TxnTable(), TxnTable() + TXN_TABLE_SIZE, INVALID_TXN_ID);
+  }
 }
 
-auto TablePage::GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t> {
-  size_t slot_end_offset;
-  if (num_tuples_ > 0) {
-    auto &[offset, size, meta] = tuple_info_[num_tuples_ - 1];
-    slot_end_offset = offset;
+auto TablePage::GetFreeSpace() const -> uint32_t {
+  // 新格式的页给每个slot留着写事务id的空间；已经写出去的事务id占着这份空间，所以这里可能是负的
+  auto free_space = static_cast<int64_t>(free_space_pointer_) + dead_bytes_ - static_cast<int64_t>(HeaderSize()) -
+                    static_cast<int64_t>((SlotSize() + SpillReserve()) * num_tuples_);
+  // SpaceFor按4字节的slot算，要扣掉新slot多出来的部分
+  auto extra_slot_size = static_cast<int64_t>(SlotSize() + SpillReserve() - SLOT_SIZE);
+  return free_space > extra_slot_size ? free_space - extra_slot_size : 0;
+}
+
+auto TablePage::GetSlot(uint16_t tuple_id) const -> TupleInfo {
+  if (version_ != TABLE_PAGE_VERSION_2) {
+    return tuple_info_[tuple_id];
+  }
+  uint32_t slot = Slots()[tuple_id];
+  auto bits = [&slot](uint32_t width) {
+    uint32_t value = slot & ((1U << width) - 1);
+    slot >>= width;
+    return value;
+  };
+  auto offset = static_cast<uint16_t>(bits(OFFSET_BITS));
+  auto size = static_cast<uint16_t>(bits(SIZE_BITS));
+  uint32_t insert_index = bits(TXN_INDEX_BITS);
+  uint32_t delete_index = bits(TXN_INDEX_BITS);
+  if (insert_index == SPILLED_TXN_INDEX) {
+    txn_id_t txn_ids[2];
+    memcpy(txn_ids, page_start_ + offset - SPILL_SIZE, SPILL_SIZE);
+    return std::make_tuple(offset, size, TupleMeta{txn_ids[0], txn_ids[1], slot != 0});
+  }
+  auto txn_id = [this](uint32_t index) { return index == 0 ? INVALID_TXN_ID : TxnTable()[index - 1]; };
+  return std::make_tuple(offset, size, TupleMeta{txn_id(insert_index), txn_id(delete_index), slot != 0});
+}
+
+void TablePage::SetSlot(uint16_t tuple_id, uint16_t offset, uint16_t size, const TupleMeta &meta) {
+  if (version_ != TABLE_PAGE_VERSION_2) {
+    tuple_info_[tuple_id] = std::make_tuple(offset, size, meta);
+    return;
+  }
+  uint32_t slot = static_cast<uint32_t>(meta.is_deleted_);
+  if (InTxnTable(meta)) {
+    slot = (slot << TXN_INDEX_BITS) | TxnIndex(meta.delete_txn_id_);
+    slot = (slot << TXN_INDEX_BITS) | TxnIndex(meta.insert_txn_id_);
   } else {
-    slot_end_offset = BUSTUB_PAGE_SIZE;
+    txn_id_t txn_ids[2] = {meta.insert_txn_id_, meta.delete_txn_id_};
+    memcpy(page_start_ + offset - SPILL_SIZE, txn_ids, SPILL_SIZE);
+    slot = (slot << TXN_INDEX_BITS) | SPILLED_TXN_INDEX;
+    slot = (slot << TXN_INDEX_BITS) | SPILLED_TXN_INDEX;
+  }
+  slot = (slot << SIZE_BITS) | size;
+  slot = (slot << OFFSET_BITS) | offset;
+  Slots()[tuple_id] = slot;
+}
+
+auto TablePage::TxnIndex(txn_id_t txn_id) const -> uint32_t {
+  if (txn_id == INVALID_TXN_ID) {
+    return 0;
+  }
+  const txn_id_t *entry = std::find(TxnTable(), TxnTable() + TXN_TABLE_SIZE, txn_id);
+  BUSTUB_ASSERT(entry != TxnTable() + TXN_TABLE_SIZE, "transaction id not in the transaction table");
+  return entry - TxnTable() + 1;
+}
+
+auto TablePage::InTxnTable(const TupleMeta &meta) const -> bool {
+  if (version_ != TABLE_PAGE_VERSION_2) {
+    return true;
+  }
+  auto in_table = [this](txn_id_t txn_id) {
+    return txn_id == INVALID_TXN_ID ||
+           std::find(TxnTable(), TxnTable() + TXN_TABLE_SIZE, txn_id) != TxnTable() + TXN_TABLE_SIZE;
+  };
+  return in_table(meta.insert_txn_id_) && in_table(meta.delete_txn_id_);
+}
+
+auto TablePage::IsSpilled(uint16_t tuple_id) const -> bool {
+  return version_ == TABLE_PAGE_VERSION_2 &&
+         ((Slots()[tuple_id] >> (OFFSET_BITS + SIZE_BITS)) & SPILLED_TXN_INDEX) == SPILLED_TXN_INDEX;
+}
+
+auto TablePage::ReserveTxnIds(const TupleMeta &meta) -> bool {
+  if (version_ != TABLE_PAGE_VERSION_2) {
+    return true;
+  }
+  txn_id_t *table = TxnTable();
+  auto missing = [&](txn_id_t txn_id) {
+    return txn_id != INVALID_TXN_ID && std::find(table, table + TXN_TABLE_SIZE, txn_id) == table + TXN_TABLE_SIZE;
+  };
+  std::vector<txn_id_t> txn_ids;
+  for (txn_id_t txn_id : {meta.insert_txn_id_, meta.delete_txn_id_}) {
+    if (missing(txn_id) && std::find(txn_ids.begin(), txn_ids.end(), txn_id) == txn_ids.end()) {
+      txn_ids.push_back(txn_id);
+    }
+  }
+  if (txn_ids.empty()) {
+    return true;
+  }
+  auto num_free = std::count(table, table + TXN_TABLE_SIZE, INVALID_TXN_ID);
+  if (num_free < static_cast<int64_t>(txn_ids.size())) {
+    // 表满了才扫一遍slot，释放没有slot引用的项
+    bool used[SPILLED_TXN_INDEX + 1] = {};
+    for (uint16_t i = 0; i < num_tuples_; i++) {
+      uint32_t indexes = Slots()[i] >> (OFFSET_BITS + SIZE_BITS);
+      used[indexes & ((1U << TXN_INDEX_BITS) - 1)] = true;
+      used[(indexes >> TXN_INDEX_BITS) & ((1U << TXN_INDEX_BITS) - 1)] = true;
+    }
+    for (uint32_t index = 1; index <= TXN_TABLE_SIZE; index++) {
+      if (!used[index]) {
+        table[index - 1] = INVALID_TXN_ID;
+      }
+    }
+    num_free = std::count(table, table + TXN_TABLE_SIZE, INVALID_TXN_ID);
+    if (num_free < static_cast<int64_t>(txn_ids.size())) {
+      return false;
+    }
+  }
+  for (txn_id_t txn_id : txn_ids) {
+    *std::find(table, table + TXN_TABLE_SIZE, INVALID_TXN_ID) = txn_id;
   }
-  auto tuple_offset = slot_end_offset - tuple.GetLength();
-  auto offset_size = TABLE_PAGE_HEADER_SIZE + TUPLE_INFO_SIZE * (num_tuples_ + 1);
-  if (tuple_offset < offset_size) {
+  return true;
+}
+
+auto TablePage::SpillTuple(uint16_t tuple_id, uint16_t offset, uint16_t *size, const TupleMeta &old_meta,
+                           const TupleMeta &meta) -> uint16_t {
+  // 死tuple的数据不用留；活tuple原来的数据变成垃圾，先让slot不再指向它，整理页时就能回收
+  uint16_t data_size = IsDead(old_meta) || IsDead(meta) ? 0 : *size;
+  std::vector<char> data(page_start_ + offset, page_start_ + offset + data_size);
+  SetSlot(tuple_id, BUSTUB_PAGE_SIZE, 0, old_meta);
+  if (data_size > 0) {
+    dead_bytes_ += data_size;
+  }
+  // 每个slot都留了SPILL_SIZE字节，整理之后一定放得下
+  size_t slot_end_offset = HeaderSize() + SlotSize() * num_tuples_;
+  if (free_space_pointer_ < slot_end_offset + SPILL_SIZE + data_size) {
+    Compact();
+  }
+  BUSTUB_ASSERT(free_space_pointer_ >= slot_end_offset + SPILL_SIZE + data_size, "no space to spill transaction ids");
+  uint16_t new_offset = free_space_pointer_ - data_size;
+  memcpy(page_start_ + new_offset, data.data(), data_size);
+  free_space_pointer_ = new_offset - SPILL_SIZE;
+  *size = data_size;
+  return new_offset;
+}
+
+auto TablePage::GetNextTupleOffset(const TupleMeta &meta, const Tuple &tuple) const -> std::optional<uint16_t> {
+  auto tuple_offset = static_cast<size_t>(free_space_pointer_) - tuple.data_.size();
+  auto offset_size = HeaderSize() + SlotSize() * (num_tuples_ + 1);
+  if (free_space_pointer_ < tuple.data_.size() || tuple_offset < offset_size) {
     return std::nullopt;
   }
   return tuple_offset;
 }
 
-auto TablePage::InsertTuple(const TupleMeta &meta, const Tuple &tuple) -> std::optional<uint16_t> {
-  auto tuple_offset = GetNextTupleOffset(meta, tuple);
-  if (tuple_offset == std::nullopt) {
+auto TablePage::InsertTuple(const TupleMeta &meta, const Tuple &tuple, bool reuse_slot) -> std::optional<uint16_t> {
+  BUSTUB_ASSERT(tuple.null_bitmap_size_ == null_bitmap_size_, "the tuple does not have the null bitmap of the page");
+  // 数据后面紧跟着null bitmap，一起存
+  uint32_t size = tuple.data_.size();
+  uint16_t tuple_id = num_tuples_;
+  if (reuse_slot && num_dead_tuples_ > 0) {
+    for (tuple_id = 0; tuple_id < num_tuples_; tuple_id++) {
+      if (IsDead(std::get<2>(GetSlot(tuple_id)))) {
+        break;
+      }
+    }
+  }
+  // 新的slot也要占空间，新格式的页还要给每个slot留着写事务id的空间；空闲空间不够但加上死tuple的空间够时先整理页
+  uint32_t slots_after = num_tuples_ + (tuple_id == num_tuples_ ? 1 : 0);
+  size_t slot_end_offset = HeaderSize() + SlotSize() * slots_after;
+  if (free_space_pointer_ + dead_bytes_ < slot_end_offset + size + SpillReserve() * slots_after) {
     return std::nullopt;
   }
-  auto tuple_id = num_tuples_;
-  tuple_info_[tuple_id] = std::make_tuple(*tuple_offset, tuple.GetLength(), meta);
-  num_tuples_++;
-  memcpy(page_start_ + *tuple_offset, tuple.data_.data(), tuple.GetLength());
+  // 事务表放不下的插入当作页满了，让堆换一页
+  if (!ReserveTxnIds(meta)) {
+    return std::nullopt;
+  }
+  if (free_space_pointer_ < slot_end_offset + size) {
+    Compact();
+  }
+
+  uint16_t tuple_offset = free_space_pointer_ - size;
+  if (tuple_id == num_tuples_) {
+    num_tuples_++;
+  } else {
+    // 复用死tuple的slot；它原来的数据如果还没被整理掉，仍然算在dead_bytes_里，写在前面的事务id也变成垃圾
+    num_dead_tuples_--;
+    num_deleted_tuples_--;
+    if (IsSpilled(tuple_id)) {
+      dead_bytes_ += SPILL_SIZE;
+    }
+  }
+  SetSlot(tuple_id, tuple_offset, size, meta);
+  free_space_pointer_ = tuple_offset;
+  memcpy(page_start_ + tuple_offset, tuple.data_.data(), size);
   return tuple_id;
 }
 
+void TablePage::Compact() {
+  if (dead_bytes_ == 0) {
+    return;
+  }
+  // 按offset从大到小把活tuple搬到页尾，目标位置不会低于原位置，memmove可以处理重叠。
+  // 事务id写在数据前面的tuple连同事务id一起搬，死tuple只留下事务id；事务表已经放得下的就不再留
+  std::vector<std::pair<uint16_t, TupleInfo>> slots;
+  slots.reserve(num_tuples_);
+  for (uint16_t i = 0; i < num_tuples_; i++) {
+    auto info = GetSlot(i);
+    if (IsDead(std::get<2>(info))) {
+      if (InTxnTable(std::get<2>(info))) {
+        SetSlot(i, BUSTUB_PAGE_SIZE, 0, std::get<2>(info));
+        continue;
+      }
+      std::get<1>(info) = 0;
+    }
+    slots.emplace_back(i, info);
+  }
+  std::sort(slots.begin(), slots.end(),
+            [](const auto &a, const auto &b) { return std::get<0>(a.second) > std::get<0>(b.second); });
+  size_t end = BUSTUB_PAGE_SIZE;
+  for (const auto &[slot, info] : slots) {
+    const auto &[offset, size, meta] = info;
+    end -= size;
+    memmove(page_start_ + end, page_start_ + offset, size);
+    SetSlot(slot, end, size, meta);
+    if (!InTxnTable(meta)) {
+      end -= SPILL_SIZE;
+    }
+  }
+  free_space_pointer_ = end;
+  dead_bytes_ = 0;
+}
+
+void TablePage::OnMetaChange(const TupleMeta &old_meta, const TupleMeta &meta, uint16_t size) {
+  if (!old_meta.is_deleted_ && meta.is_deleted_) {
+    num_deleted_tuples_++;
+  }
+  if (IsDead(old_meta)) {
+    // 死tuple的空间随时可能被整理掉，不能再复活
+    if (!IsDead(meta)) {
+      throw bustub::Exception("cannot revive a tuple whose deletion completed");
+    }
+  } else if (IsDead(meta)) {
+    num_dead_tuples_++;
+    dead_bytes_ += size;
+  }
+}
+
+auto TablePage::PrepareMetaUpdate(uint16_t tuple_id, uint16_t offset, uint16_t *size, const TupleMeta &old_meta,
+                                  const TupleMeta &meta) -> uint16_t {
+  bool spilled = IsSpilled(tuple_id);
+  if (ReserveTxnIds(meta)) {
+    if (spilled) {
+      // 写在数据前面的事务id用不着了，整理页时回收
+      dead_bytes_ += SPILL_SIZE;
+    }
+    return offset;
+  }
+  // 事务表满了：已经在数据前面留了位置就直接写，否则把tuple挪出去留出位置
+  return spilled ? offset : SpillTuple(tuple_id, offset, size, old_meta, meta);
+}
+
 void TablePage::UpdateTupleMeta(const TupleMeta &meta, const RID &rid) {
   auto tuple_id = rid.GetSlotNum();
   if (tuple_id >= num_tuples_) {
     throw bustub::Exception("Tuple ID out of range");
   }
-  auto &[offset, size, old_meta] = tuple_info_[tuple_id];
-  if (!old_meta.is_deleted_ && meta.is_deleted_) {
-    num_deleted_tuples_++;
-  }
-  tuple_info_[tuple_id] = std::make_tuple(offset, size, meta);
+  auto [offset, size, old_meta] = GetSlot(tuple_id);
+  OnMetaChange(old_meta, meta, size);
+  offset = PrepareMetaUpdate(tuple_id, offset, &size, old_meta, meta);
+  SetSlot(tuple_id, offset, size, meta);
 }
 
 auto TablePage::GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple> {
@@ -73,21 +313,32 @@ auto TablePage::GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple> {
   if (tuple_id >= num_tuples_) {
     throw bustub::Exception("Tuple ID out of range");
   }
-  auto &[offset, size, meta] = tuple_info_[tuple_id];
+  auto [offset, size, meta] = GetSlot(tuple_id);
   Tuple tuple;
   tuple.data_.resize(size);
   memmove(tuple.data_.data(), page_start_ + offset, size);
+  // 死tuple的数据可能已经被整理掉了，连null bitmap也没有
+  tuple.null_bitmap_size_ = size == 0 ? 0 : null_bitmap_size_;
   tuple.rid_ = rid;
   return std::make_pair(meta, std::move(tuple));
 }
 
+auto TablePage::GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView> {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  auto [offset, size, meta] = GetSlot(tuple_id);
+  uint8_t null_bitmap_size = size == 0 ? 0 : null_bitmap_size_;
+  return std::make_pair(meta, TupleView(page_start_ + offset, size - null_bitmap_size, rid, null_bitmap_size));
+}
+
 auto TablePage::GetTupleMeta(const RID &rid) const -> TupleMeta {
   auto tuple_id = rid.GetSlotNum();
   if (tuple_id >= num_tuples_) {
     throw bustub::Exception("Tuple ID out of range");
   }
-  auto &[_1, _2, meta] = tuple_info_[tuple_id];
-  return meta;
+  return std::get<2>(GetSlot(tuple_id));
 }
 
 void TablePage::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
@@ -95,15 +346,15 @@ void TablePage::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tup
   if (tuple_id >= num_tuples_) {
     throw bustub::Exception("Tuple ID out of range");
   }
-  auto &[offset, size, old_meta] = tuple_info_[tuple_id];
-  if (size != tuple.GetLength()) {
+  auto [offset, size, old_meta] = GetSlot(tuple_id);
+  BUSTUB_ASSERT(tuple.null_bitmap_size_ == null_bitmap_size_, "the tuple does not have the null bitmap of the page");
+  if (size != tuple.data_.size()) {
     throw bustub::Exception("Tuple size mismatch");
   }
-  if (!old_meta.is_deleted_ && meta.is_deleted_) {
-    num_deleted_tuples_++;
-  }
-  tuple_info_[tuple_id] = std::make_tuple(offset, size, meta);
-  memcpy(page_start_ + offset, tuple.data_.data(), tuple.GetLength());
+  OnMetaChange(old_meta, meta, size);
+  offset = PrepareMetaUpdate(tuple_id, offset, &size, old_meta, meta);
+  SetSlot(tuple_id, offset, size, meta);
+  memcpy(page_start_ + offset, tuple.data_.data(), size);
 }
 
 }  // namespace bustub
@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_pax_page.cpp
+//
+// Identification: src/storage/page/table_pax_page.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/table_pax_page.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+auto TablePaxPage::ComputeCapacity(const Schema &schema) -> uint32_t {
+  uint32_t num_columns = schema.GetColumnCount();
+  if (num_columns == 0) {
+    return 0;
+  }
+  // 每个minipage按MINIPAGE_ALIGN对齐，最多浪费MINIPAGE_ALIGN - 1字节
+  uint32_t minipage_start = AlignUp(TABLE_PAX_PAGE_HEADER_SIZE + sizeof(ColumnInfo) * num_columns);
+  uint32_t padding = MINIPAGE_ALIGN * (num_columns + 1);
+  if (minipage_start + padding >= BUSTUB_PAGE_SIZE) {
+    return 0;
+  }
+  // VARCHAR列在minipage里存值的偏移，值本身（长度+数据）放在页尾，按声明长度预留一部分
+  uint32_t tuple_bytes = TUPLE_META_SIZE;
+  for (const auto &col : schema.GetColumns()) {
+    if (col.IsInlined()) {
+      tuple_bytes += col.GetFixedLength();
+    } else {
+      tuple_bytes += 2 * sizeof(uint32_t) + std::min(col.GetLength(), VARCHAR_RESERVE);
+    }
+  }
+  return (BUSTUB_PAGE_SIZE - minipage_start - padding) / tuple_bytes;
+}
+
+void TablePaxPage::Init(const Schema &schema) {
+  next_page_id_ = INVALID_PAGE_ID;
+  num_tuples_ = 0;
+  capacity_ = ComputeCapacity(schema);
+  BUSTUB_ENSURE(capacity_ > 0, "a tuple of the schema does not fit into a PAX page");
+  num_columns_ = schema.GetColumnCount();
+  fixed_length_ = schema.GetLength();
+  heap_pointer_ = BUSTUB_PAGE_SIZE;
+
+  uint32_t offset = AlignUp(TABLE_PAX_PAGE_HEADER_SIZE + sizeof(ColumnInfo) * num_columns_);
+  meta_offset_ = offset;
+  offset = AlignUp(offset + TUPLE_META_SIZE * capacity_);
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = schema.GetColumn(i);
+    uint16_t width = col.IsInlined() ? col.GetFixedLength() : sizeof(uint32_t);
+    columns_[i] = ColumnInfo{static_cast<uint16_t>(col.GetOffset()), width, static_cast<uint16_t>(offset),
+                             static_cast<uint16_t>(col.IsInlined() ? 0 : 1)};
+    offset = AlignUp(offset + width * capacity_);
+  }
+}
+
+auto TablePaxPage::VarcharInTuple(const char *tuple_data, const ColumnInfo &col) -> const char * {
+  return tuple_data + *reinterpret_cast<const uint32_t *>(tuple_data + col.tuple_offset_);
+}
+
+auto TablePaxPage::GetColumnData(uint16_t slot, uint32_t column_idx) const -> const char * {
+  BUSTUB_ASSERT(slot < num_tuples_ && column_idx < num_columns_, "value out of range");
+  const auto &col = columns_[column_idx];
+  const char *data = page_start_ + col.minipage_offset_ + col.width_ * slot;
+  if (col.is_varchar_ == 0) {
+    return data;
+  }
+  return page_start_ + *reinterpret_cast<const uint32_t *>(data);
+}
+
+auto TablePaxPage::InsertTuple(const TupleMeta &meta, const Tuple &tuple, bool /* reuse_slot */)
+    -> std::optional<uint16_t> {
+  BUSTUB_ASSERT(tuple.GetLength() >= fixed_length_, "tuple does not match the schema of the page");
+  if (num_tuples_ == capacity_) {
+    return std::nullopt;
+  }
+  const char *tuple_data = tuple.data_.data();
+  uint32_t varchar_bytes = 0;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    if (columns_[i].is_varchar_ != 0) {
+      varchar_bytes += VarcharPayloadSize(VarcharInTuple(tuple_data, columns_[i]));
+    }
+  }
+  if (heap_pointer_ - HeapStart() < varchar_bytes) {
+    return std::nullopt;
+  }
+
+  // 把tuple按列拆开，每列的值写到自己minipage的slot位置
+  uint16_t slot = num_tuples_++;
+  Metas()[slot] = meta;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = columns_[i];
+    char *dest = page_start_ + col.minipage_offset_ + col.width_ * slot;
+    if (col.is_varchar_ == 0) {
+      memcpy(dest, tuple_data + col.tuple_offset_, col.width_);
+      continue;
+    }
+    const char *value = VarcharInTuple(tuple_data, col);
+    uint32_t size = VarcharPayloadSize(value);
+    heap_pointer_ -= size;
+    memcpy(page_start_ + heap_pointer_, value, size);
+    *reinterpret_cast<uint32_t *>(dest) = heap_pointer_;
+  }
+  return slot;
+}
+
+void TablePaxPage::UpdateTupleMeta(const TupleMeta &meta, const RID &rid) {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  Metas()[tuple_id] = meta;
+}
+
+auto TablePaxPage::GetTuple(const RID &rid) const -> std::pair<TupleMeta, Tuple> {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  // 按Tuple的格式拼回一行：定长部分在前，VARCHAR值按列的顺序接在后面
+  uint32_t size = fixed_length_;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    if (columns_[i].is_varchar_ != 0) {
+      size += VarcharPayloadSize(GetColumnData(tuple_id, i));
+    }
+  }
+  Tuple tuple(rid);
+  tuple.data_.resize(size);
+  uint32_t offset = fixed_length_;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = columns_[i];
+    const char *data = GetColumnData(tuple_id, i);
+    char *dest = tuple.data_.data() + col.tuple_offset_;
+    if (col.is_varchar_ == 0) {
+      memcpy(dest, data, col.width_);
+      continue;
+    }
+    uint32_t value_size = VarcharPayloadSize(data);
+    *reinterpret_cast<uint32_t *>(dest) = offset;
+    memcpy(tuple.data_.data() + offset, data, value_size);
+    offset += value_size;
+  }
+  return std::make_pair(Metas()[tuple_id], std::move(tuple));
+}
+
+auto TablePaxPage::GetTupleView(const RID &rid) const -> std::pair<TupleMeta, TupleView> {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  return std::make_pair(Metas()[tuple_id], TupleView(this, tuple_id, rid));
+}
+
+auto TablePaxPage::GetTupleMeta(const RID &rid) const -> TupleMeta {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  return Metas()[tuple_id];
+}
+
+void TablePaxPage::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
+  auto tuple_id = rid.GetSlotNum();
+  if (tuple_id >= num_tuples_) {
+    throw bustub::Exception("Tuple ID out of range");
+  }
+  // VARCHAR值原地覆盖，大小必须不变
+  const char *tuple_data = tuple.data_.data();
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    if (columns_[i].is_varchar_ != 0 &&
+        VarcharPayloadSize(VarcharInTuple(tuple_data, columns_[i])) != VarcharPayloadSize(GetColumnData(tuple_id, i))) {
+      throw bustub::Exception("Tuple size mismatch");
+    }
+  }
+  Metas()[tuple_id] = meta;
+  for (uint32_t i = 0; i < num_columns_; i++) {
+    const auto &col = columns_[i];
+    char *dest = page_start_ + col.minipage_offset_ + col.width_ * tuple_id;
+    if (col.is_varchar_ == 0) {
+      memcpy(dest, tuple_data + col.tuple_offset_, col.width_);
+    } else {
+      const char *value = VarcharInTuple(tuple_data, col);
+      memcpy(page_start_ + *reinterpret_cast<const uint32_t *>(dest), value, VarcharPayloadSize(value));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dictionary.cpp
+//
+// Identification: src/storage/table/dictionary.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/dictionary.h"
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+Dictionary::Dictionary(BufferPoolManager *bpm, uint32_t num_columns, const std::vector<uint32_t> &columns)
+    : bpm_(bpm) {
+  if (columns.empty()) {
+    return;
+  }
+  columns_.resize(num_columns);
+  for (uint32_t column_idx : columns) {
+    BUSTUB_ENSURE(column_idx < num_columns, "dictionary column out of range");
+    columns_[column_idx].emplace();
+  }
+}
+
+auto Dictionary::Encode(uint32_t column_idx, const char *data, uint32_t len) -> std::optional<uint32_t> {
+  if (!IsEncoded(column_idx) || len > MAX_VALUE_LENGTH) {
+    return std::nullopt;
+  }
+  std::string value(data, len);
+  {
+    std::shared_lock<std::shared_mutex> guard(latch_);
+    const auto &codes = columns_[column_idx]->codes_;
+    if (auto iter = codes.find(value); iter != codes.end()) {
+      return iter->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> guard(latch_);
+  auto &column = *columns_[column_idx];
+  // 拿写锁之前别的线程可能已经加进去了
+  if (auto iter = column.codes_.find(value); iter != column.codes_.end()) {
+    return iter->second;
+  }
+  if (column.values_.size() == MAX_CODES) {
+    return std::nullopt;
+  }
+  AppendEntry(column_idx, value);
+  auto code = static_cast<uint32_t>(column.values_.size());
+  column.codes_.emplace(value, code);
+  column.values_.push_back(std::move(value));
+  return code;
+}
+
+void Dictionary::AppendEntry(uint32_t column_idx, const std::string &value) {
+  if (last_page_id_ != INVALID_PAGE_ID) {
+    auto guard = bpm_->FetchPageWrite(last_page_id_);
+    auto page = guard.AsMut<DictionaryPage>();
+    if (page->Append(column_idx, value.data(), value.size())) {
+      return;
+    }
+  }
+  // 第一条或末页满了，接一个新页
+  page_id_t page_id = INVALID_PAGE_ID;
+  auto new_guard = bpm_->NewPageGuarded(&page_id);
+  BUSTUB_ENSURE(page_id != INVALID_PAGE_ID, "cannot allocate dictionary page");
+  auto new_page = new_guard.AsMut<DictionaryPage>();
+  new_page->Init();
+  BUSTUB_ENSURE(new_page->Append(column_idx, value.data(), value.size()), "dictionary entry does not fit in a page");
+  new_guard.Drop();
+  if (last_page_id_ == INVALID_PAGE_ID) {
+    first_page_id_ = page_id;
+  } else {
+    bpm_->FetchPageWrite(last_page_id_).AsMut<DictionaryPage>()->SetNextPageId(page_id);
+  }
+  last_page_id_ = page_id;
+}
+
+auto Dictionary::Lookup(uint32_t column_idx, const Value &value) const -> std::optional<uint32_t> {
+  if (!IsEncoded(column_idx) || value.IsNull() || value.GetTypeId() != TypeId::VARCHAR) {
+    return std::nullopt;
+  }
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  const auto &codes = columns_[column_idx]->codes_;
+  auto iter = codes.find(std::string(value.GetData(), value.GetLength()));
+  return iter == codes.end() ? std::nullopt : std::make_optional(iter->second);
+}
+
+auto Dictionary::Decode(uint32_t column_idx, uint32_t code) const -> Value {
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  BUSTUB_ASSERT(IsEncoded(column_idx) && code < columns_[column_idx]->values_.size(), "unknown dictionary code");
+  const auto &value = columns_[column_idx]->values_[code];
+  return {TypeId::VARCHAR, value.data(), static_cast<uint32_t>(value.size()), true};
+}
+
+auto Dictionary::GetFirstPageId() const -> page_id_t {
+  std::shared_lock<std::shared_mutex> guard(latch_);
+  return first_page_id_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "common/macros.h"
+#include "storage/page/page_guard.h"
+#include "storage/table/free_space_map.h"
+
+namespace bustub {
+
+FreeSpaceMap::FreeSpaceMap(BufferPoolManager *bpm) : bpm_(bpm) {
+  auto guard = bpm_->NewPageGuarded(&first_page_id_);
+  BUSTUB_ENSURE(first_page_id_ != INVALID_PAGE_ID, "cannot allocate free space map page");
+  guard.AsMut<FreeSpaceMapPage>()->Init();
+  map_page_ids_.push_back(first_page_id_);
+  max_categories_.push_back(0);
+}
+
+void FreeSpaceMap::AddPage(page_id_t page_id, uint32_t free_bytes, bool in_use) {
+  uint8_t category = in_use ? FreeSpaceMapPage::IN_USE : FreeSpaceMapPage::ToCategory(free_bytes);
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto guard = bpm_->FetchPageWrite(map_page_ids_.back());
+  if (guard.As<FreeSpaceMapPage>()->IsFull()) {
+    // 末页满了，接一个新的map页
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    auto new_guard = bpm_->NewPageGuarded(&new_page_id);
+    BUSTUB_ENSURE(new_page_id != INVALID_PAGE_ID, "cannot allocate free space map page");
+    new_guard.AsMut<FreeSpaceMapPage>()->Init();
+    new_guard.Drop();
+    guard.AsMut<FreeSpaceMapPage>()->SetNextPageId(new_page_id);
+    map_page_ids_.push_back(new_page_id);
+    max_categories_.push_back(0);
+    guard = bpm_->FetchPageWrite(new_page_id);
+  }
+  uint32_t index = guard.AsMut<FreeSpaceMapPage>()->Append(page_id, category);
+  entries_[page_id] = (map_page_ids_.size() - 1) * FreeSpaceMapPage::CAPACITY + index;
+  if (!in_use) {
+    max_categories_.back() = std::max(max_categories_.back(), category);
+  }
+}
+
+void FreeSpaceMap::Update(page_id_t page_id, uint32_t free_bytes) {
+  SetCategory(page_id, FreeSpaceMapPage::ToCategory(free_bytes), false);
+}
+
+void FreeSpaceMap::Release(page_id_t page_id, uint32_t free_bytes) {
+  SetCategory(page_id, FreeSpaceMapPage::ToCategory(free_bytes), true);
+}
+
+void FreeSpaceMap::SetCategory(page_id_t page_id, uint8_t category, bool force) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto iter = entries_.find(page_id);
+  BUSTUB_ASSERT(iter != entries_.end(), "page is not in the free space map");
+  size_t map_index = iter->second / FreeSpaceMapPage::CAPACITY;
+  auto guard = bpm_->FetchPageWrite(map_page_ids_[map_index]);
+  auto *page = guard.AsMut<FreeSpaceMapPage>();
+  uint32_t index = iter->second % FreeSpaceMapPage::CAPACITY;
+  if (!force && page->CategoryAt(index) == FreeSpaceMapPage::IN_USE) {
+    return;
+  }
+  page->SetCategoryAt(index, category);
+  max_categories_[map_index] = std::max(max_categories_[map_index], category);
+}
+
+auto FreeSpaceMap::Claim(uint32_t free_bytes) -> page_id_t {
+  // 向上取整，分类够了就一定放得下
+  uint32_t needed = (free_bytes + FreeSpaceMapPage::CATEGORY_BYTES - 1) / FreeSpaceMapPage::CATEGORY_BYTES;
+  if (needed > FreeSpaceMapPage::MAX_CATEGORY) {
+    return INVALID_PAGE_ID;
+  }
+  auto category = static_cast<uint8_t>(needed);
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (size_t i = 0; i < map_page_ids_.size(); i++) {
+    if (max_categories_[i] < category) {
+      continue;
+    }
+    auto guard = bpm_->FetchPageWrite(map_page_ids_[i]);
+    auto *page = guard.AsMut<FreeSpaceMapPage>();
+    int index = page->Find(category);
+    if (index >= 0) {
+      page->SetCategoryAt(index, FreeSpaceMapPage::IN_USE);
+    }
+    // 上界可能偏大，顺便收紧
+    max_categories_[i] = page->MaxCategory();
+    if (index >= 0) {
+      return page->PageIdAt(index);
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+}  // namespace bustub
@@ -10,9 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <mutex>  // NOLINT
+#include <optional>
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -23,104 +30,368 @@
 #include "storage/page/page_guard.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_heap.h"
+#include "type/limits.h"
 
 namespace bustub {
 
-TableHeap::TableHeap(BufferPoolManager *bpm) : bpm_(bpm) {
+TableHeap::TableHeap(BufferPoolManager *bpm) : TableHeap(bpm, TableFormat::ROW, Schema(std::vector<Column>{})) {}
+
+TableHeap::TableHeap(BufferPoolManager *bpm, TableFormat format, const Schema &schema,
+                     const std::vector<uint32_t> &dictionary_columns)
+    : bpm_(bpm),
+      format_(format),
+      schema_(schema),
+      toast_store_(bpm),
+      dictionary_(bpm, schema.GetColumnCount(), dictionary_columns),
+      free_space_map_(bpm) {
+  for (uint32_t col_idx : dictionary_columns) {
+    BUSTUB_ENSURE(schema_.GetColumn(col_idx).GetType() == TypeId::VARCHAR, "only VARCHAR columns can be encoded");
+  }
+  if (format_ == TableFormat::ROW) {
+    uint32_t null_bitmap_size = (schema_.GetColumnCount() + 7) / 8;
+    BUSTUB_ENSURE(null_bitmap_size <= UINT8_MAX, "too many columns for the null bitmap");
+    null_bitmap_size_ = static_cast<uint8_t>(null_bitmap_size);
+  }
   // Initialize the first table page.
   auto guard = bpm->NewPageGuarded(&first_page_id_);
   last_page_id_ = first_page_id_;
-  auto first_page = guard.AsMut<TablePage>();
-  BUSTUB_ASSERT(first_page != nullptr,
+  BUSTUB_ASSERT(guard.AsMut<TablePage>() != nullptr,
                 "Couldn't create a page for the table heap. Have you completed the buffer pool manager project?");
-  first_page->Init();
+  uint32_t free_bytes = InitPage(&guard);
+  zone_map_.AddPage(first_page_id_);
+  // 第一页交给最先插入的target
+  free_space_map_.AddPage(first_page_id_, free_bytes, false);
 }
 
-auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr, Transaction *txn,
-                            table_oid_t oid) -> std::optional<RID> {
-  std::unique_lock<std::mutex> guard(latch_);
-  auto page_guard = bpm_->FetchPageWrite(last_page_id_);
-  while (true) {
-    auto page = page_guard.AsMut<TablePage>();
-    if (page->GetNextTupleOffset(meta, tuple) != std::nullopt) {
-      break;
+auto TableHeap::InitPage(BasicPageGuard *guard) -> uint32_t {
+  if (format_ == TableFormat::PAX) {
+    auto page = guard->AsMut<TablePaxPage>();
+    page->Init(schema_);
+    return page->GetFreeSpace();
+  }
+  auto page = guard->AsMut<TablePage>();
+  page->Init(TABLE_PAGE_VERSION_2, null_bitmap_size_);
+  return page->GetFreeSpace();
+}
+
+auto TableHeap::EncodeValues(const Tuple &tuple) -> std::optional<Tuple> {
+  auto encoded = EncodeVarcharValues(tuple);
+  if (null_bitmap_size_ == 0 && tuple.null_bitmap_size_ == 0) {
+    return encoded;
+  }
+  // 从别的堆读出来的tuple可能带着null bitmap，去掉之后按本堆的schema重新生成
+  Tuple stored = encoded.has_value() ? std::move(*encoded) : tuple;
+  stored.data_.resize(stored.GetLength());
+  stored.null_bitmap_size_ = 0;
+  size_t data_size = stored.data_.size();
+  stored.data_.resize(data_size + null_bitmap_size_, 0);
+  for (uint32_t col_idx = 0; col_idx < schema_.GetColumnCount(); col_idx++) {
+    if (stored.IsNull(&schema_, col_idx)) {
+      stored.data_[data_size + col_idx / 8] |= static_cast<char>(1 << (col_idx % 8));
     }
+  }
+  stored.null_bitmap_size_ = null_bitmap_size_;
+  return stored;
+}
 
-    // if there's no tuple in the page, and we can't insert the tuple, then this tuple is too large.
-    BUSTUB_ENSURE(page->GetNumTuples() != 0, "tuple is too large, cannot insert");
+auto TableHeap::EncodeVarcharValues(const Tuple &tuple) -> std::optional<Tuple> {
+  if (schema_.IsInlined()) {
+    return std::nullopt;
+  }
+  auto payload_len = [](const char *data) { return *reinterpret_cast<const uint32_t *>(data); };
+  // 只有按原样存的非null值需要换
+  auto is_plain = [&](const char *data) {
+    return !IsToastPointer(data) && !IsDictionaryCode(data) && payload_len(data) != BUSTUB_VALUE_NULL;
+  };
+  // 别的堆的toast指针和字典编码只在那个堆里有意义，要取出值重新编码
+  auto is_foreign = [&](const char *data) {
+    return (IsToastPointer(data) && tuple.toast_store_ != &toast_store_) ||
+           (IsDictionaryCode(data) && tuple.dictionary_ != &dictionary_);
+  };
+  const auto &columns = schema_.GetUnlinedColumns();
+  if (std::none_of(columns.begin(), columns.end(), [&](uint32_t col_idx) {
+        const char *data = tuple.GetDataPtr(&schema_, col_idx);
+        return is_foreign(data) ||
+               (is_plain(data) && (dictionary_.IsEncoded(col_idx) || payload_len(data) > ToastStore::THRESHOLD));
+      })) {
+    return std::nullopt;
+  }
 
-    page_id_t next_page_id = INVALID_PAGE_ID;
-    auto npg = bpm_->NewPage(&next_page_id);
-    BUSTUB_ENSURE(next_page_id != INVALID_PAGE_ID, "cannot allocate page");
+  // 定长部分照抄，VARCHAR的值按列的顺序重新排，能编码的换成编码，长的值换成toast指针
+  Tuple encoded(tuple.rid_);
+  encoded.data_.assign(tuple.data_.begin(), tuple.data_.begin() + schema_.GetLength());
+  auto append = [&encoded](const void *payload, uint32_t size) {
+    const auto *bytes = static_cast<const char *>(payload);
+    encoded.data_.insert(encoded.data_.end(), bytes, bytes + size);
+  };
+  std::vector<char> decoded;
+  for (uint32_t col_idx : columns) {
+    const char *data = tuple.GetDataPtr(&schema_, col_idx);
+    if (is_foreign(data)) {
+      Value value = tuple.GetValue(&schema_, col_idx);
+      decoded.resize(sizeof(uint32_t) + value.GetLength());
+      value.SerializeTo(decoded.data());
+      data = decoded.data();
+    }
+    uint32_t offset = encoded.data_.size();
+    memcpy(encoded.data_.data() + schema_.GetColumn(col_idx).GetOffset(), &offset, sizeof(uint32_t));
+    if (is_plain(data) && dictionary_.IsEncoded(col_idx)) {
+      if (auto code = dictionary_.Encode(col_idx, data + sizeof(uint32_t), payload_len(data)); code.has_value()) {
+        uint32_t payload = *code | DICTIONARY_FLAG;
+        append(&payload, sizeof(uint32_t));
+        continue;
+      }
+    }
+    if (is_plain(data) && payload_len(data) > ToastStore::THRESHOLD) {
+      uint32_t pointer[2] = {payload_len(data) | TOAST_FLAG,
+                             static_cast<uint32_t>(toast_store_.Store(data + sizeof(uint32_t), payload_len(data)))};
+      append(pointer, TOAST_POINTER_SIZE);
+      continue;
+    }
+    append(data, VarcharPayloadSize(data));
+  }
+  return encoded;
+}
 
-    page->SetNextPageId(next_page_id);
+auto TableHeap::GetInsertTarget() -> InsertTarget & {
+  // 同一个线程总是用同一个target，单线程插入的tuple按插入顺序排列
+  return insert_targets_[std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_INSERT_TARGETS];
+}
 
-    auto next_page = reinterpret_cast<TablePage *>(npg->GetData());
-    next_page->Init();
+void TableHeap::SwitchPage(InsertTarget *target, WritePageGuard *page_guard, uint32_t free_bytes,
+                           size_t run_length) {
+  if (target->page_id_ != INVALID_PAGE_ID) {
+    // 把当前页剩下的空间交给free space map。拿latch_之前必须先放掉页锁
+    uint32_t page_free_bytes = VisitPage(*page_guard, [](auto *page) { return page->GetFreeSpace(); });
+    page_guard->Drop();
+    free_space_map_.Release(target->page_id_, page_free_bytes);
+  }
 
-    page_guard.Drop();
+  // 有扫描进行时只能往新页上插，否则新tuple可能落在迭代器还没扫到、也没有记录上限的页上
+  page_id_t page_id = INVALID_PAGE_ID;
+  if (!target->spare_pages_.empty()) {
+    page_id = target->spare_pages_.back();
+    target->spare_pages_.pop_back();
+  } else if (active_scans_ == 0) {
+    page_id = free_space_map_.Claim(std::max(free_bytes, MIN_REUSE_BYTES));
+  }
+  if (page_id == INVALID_PAGE_ID) {
+    auto run = AppendPages(run_length);
+    page_id = run[0];
+    target->spare_pages_.assign(run.rbegin(), run.rend() - 1);
+  }
+  target->page_id_ = page_id;
+  *page_guard = bpm_->FetchPageWrite(page_id);
+}
 
-    // acquire latch here as TSAN complains. Given we only have one insertion thread, this is fine.
-    npg->WLatch();
-    auto next_page_guard = WritePageGuard{bpm_, npg};
+auto TableHeap::AppendPages(size_t n) -> std::vector<page_id_t> {
+  std::scoped_lock<std::mutex> guard(latch_);
+  // 新页在latch_下分配并依次挂到链表尾，链表上的page id保持递增
+  std::vector<page_id_t> page_ids(n, INVALID_PAGE_ID);
+  WritePageGuard prev_guard = bpm_->FetchPageWrite(last_page_id_);
+  for (size_t i = 0; i < n; i++) {
+    auto page_guard = bpm_->NewPageGuarded(&page_ids[i]);
+    BUSTUB_ENSURE(page_ids[i] != INVALID_PAGE_ID, "cannot allocate page");
+    InitPage(&page_guard);
+    zone_map_.AddPage(page_ids[i]);
+    page_guard.Drop();
+    VisitPage(prev_guard, [&](auto *page) { page->SetNextPageId(page_ids[i]); });
+    prev_guard = bpm_->FetchPageWrite(page_ids[i]);
+    free_space_map_.AddPage(page_ids[i], 0, true);
+  }
+  last_page_id_ = page_ids.back();
+  return page_ids;
+}
 
-    last_page_id_ = next_page_id;
-    page_guard = std::move(next_page_guard);
+void TableHeap::RecordFreeSpace(page_id_t page_id, uint32_t free_bytes) {
+  if (free_bytes >= MIN_REUSE_BYTES) {
+    free_space_map_.Update(page_id, free_bytes);
   }
-  auto last_page_id = last_page_id_;
+}
 
-  auto page = page_guard.AsMut<TablePage>();
-  auto slot_id = *page->InsertTuple(meta, tuple);
+auto TableHeap::InsertTuple(const TupleMeta &meta, const Tuple &tuple, LockManager *lock_mgr, Transaction *txn,
+                            table_oid_t oid) -> std::optional<RID> {
+  // 编码和长的值写到toast链上都在拿锁之前做
+  auto encoded = EncodeValues(tuple);
+  const Tuple &stored = encoded.has_value() ? *encoded : tuple;
+  auto &target = GetInsertTarget();
+  std::unique_lock<std::mutex> guard(target.latch_);
+  // 在target的锁下读；之后创建的迭代器要等这次插入完成才能记录这一页的上限
+  bool reuse_slot = active_scans_ == 0;
+  WritePageGuard page_guard;
+  if (target.page_id_ != INVALID_PAGE_ID) {
+    page_guard = bpm_->FetchPageWrite(target.page_id_);
+  }
+  std::optional<uint16_t> slot_id;
+  auto insert = [&](auto *page) {
+    slot_id = page->InsertTuple(meta, stored, reuse_slot);
+    // if there's no tuple in the page, and we can't insert the tuple, then this tuple is too large.
+    BUSTUB_ENSURE(slot_id != std::nullopt || page->GetNumTuples() != 0, "tuple is too large, cannot insert");
+  };
+  while (true) {
+    if (target.page_id_ != INVALID_PAGE_ID) {
+      VisitPage(page_guard, insert);
+      if (slot_id != std::nullopt) {
+        // 放掉target的锁之前更新区间图，之后创建的迭代器看到这个tuple时区间图里一定已经有它
+        zone_map_.Update(target.page_id_, tuple);
+        break;
+      }
+    }
+    SwitchPage(&target, &page_guard, TablePage::SpaceFor(stored), 1);
+  }
+  auto page_id = target.page_id_;
 
-  // only allow one insertion at a time, otherwise it will deadlock.
+  // 其他target上的插入不受影响，这里放掉target的锁即可
   guard.unlock();
 
   if (lock_mgr != nullptr) {
-    BUSTUB_ENSURE(lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{last_page_id, slot_id}),
+    BUSTUB_ENSURE(lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, RID{page_id, *slot_id}),
                   "failed to lock when inserting new tuple");
   }
 
   page_guard.Drop();
 
-  return RID(last_page_id, slot_id);
+  return RID(page_id, *slot_id);
+}
+
+auto TableHeap::InsertTuples(const std::vector<std::pair<TupleMeta, Tuple>> &tuples, LockManager *lock_mgr,
+                             Transaction *txn, table_oid_t oid) -> std::vector<RID> {
+  std::vector<RID> rids;
+  rids.reserve(tuples.size());
+  // 编码和长的值写到toast链上都在拿锁之前做；还没插入的tuple一共要占多少空间，用来决定一次挂多少新页
+  std::vector<std::optional<Tuple>> encoded;
+  encoded.reserve(tuples.size());
+  size_t remaining_bytes = 0;
+  for (const auto &[meta, tuple] : tuples) {
+    encoded.push_back(EncodeValues(tuple));
+    remaining_bytes += TablePage::SpaceFor(encoded.back().has_value() ? *encoded.back() : tuple);
+  }
+
+  auto &target = GetInsertTarget();
+  std::unique_lock<std::mutex> guard(target.latch_);
+  bool reuse_slot = active_scans_ == 0;
+  WritePageGuard page_guard;
+  if (target.page_id_ != INVALID_PAGE_ID) {
+    page_guard = bpm_->FetchPageWrite(target.page_id_);
+  }
+  // 一页上新插入的行在放掉页锁之前一起加锁
+  auto lock_page_rows = [&](size_t first) {
+    if (lock_mgr != nullptr && first < rids.size()) {
+      std::vector<RID> page_rids(rids.begin() + first, rids.end());
+      BUSTUB_ENSURE(lock_mgr->LockRows(txn, LockManager::LockMode::EXCLUSIVE, oid, page_rids),
+                    "failed to lock when inserting new tuples");
+    }
+  };
+
+  size_t page_first = 0;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    const auto &[meta, tuple] = tuples[i];
+    const Tuple &stored = encoded[i].has_value() ? *encoded[i] : tuple;
+    auto insert = [&, &meta = meta](auto *page) {
+      auto slot_id = page->InsertTuple(meta, stored, reuse_slot);
+      BUSTUB_ENSURE(slot_id != std::nullopt || page->GetNumTuples() != 0, "tuple is too large, cannot insert");
+      return slot_id;
+    };
+    while (true) {
+      if (target.page_id_ != INVALID_PAGE_ID) {
+        auto slot_id = VisitPage(page_guard, insert);
+        if (slot_id != std::nullopt) {
+          rids.emplace_back(target.page_id_, *slot_id);
+          zone_map_.Update(target.page_id_, tuple);
+          break;
+        }
+      }
+      lock_page_rows(page_first);
+      page_first = rids.size();
+      size_t run_length = remaining_bytes / (BUSTUB_PAGE_SIZE - TABLE_PAGE_HEADER_SIZE) + 1;
+      SwitchPage(&target, &page_guard, TablePage::SpaceFor(stored), std::min(run_length, MAX_PAGE_RUN));
+    }
+    remaining_bytes -= TablePage::SpaceFor(stored);
+  }
+
+  guard.unlock();
+  lock_page_rows(page_first);
+  page_guard.Drop();
+  return rids;
 }
 
 void TableHeap::UpdateTupleMeta(const TupleMeta &meta, RID rid) {
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
-  auto page = page_guard.AsMut<TablePage>();
-  page->UpdateTupleMeta(meta, rid);
+  uint32_t free_bytes = VisitPage(page_guard, [&](auto *page) {
+    page->UpdateTupleMeta(meta, rid);
+    return page->GetFreeSpace();
+  });
+  if (meta.is_deleted_ && meta.delete_txn_id_ == INVALID_TXN_ID) {
+    page_guard.Drop();
+    RecordFreeSpace(rid.GetPageId(), free_bytes);
+  }
 }
 
 auto TableHeap::GetTuple(RID rid) -> std::pair<TupleMeta, Tuple> {
   auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
-  auto page = page_guard.As<TablePage>();
-  auto [meta, tuple] = page->GetTuple(rid);
+  auto [meta, tuple] = VisitPage(page_guard, [&](const auto *page) { return page->GetTuple(rid); });
   tuple.rid_ = rid;
+  tuple.toast_store_ = &toast_store_;
+  tuple.dictionary_ = &dictionary_;
   return std::make_pair(meta, std::move(tuple));
 }
 
 auto TableHeap::GetTupleMeta(RID rid) -> TupleMeta {
   auto page_guard = bpm_->FetchPageRead(rid.GetPageId());
-  auto page = page_guard.As<TablePage>();
-  return page->GetTupleMeta(rid);
+  return VisitPage(page_guard, [&](const auto *page) { return page->GetTupleMeta(rid); });
 }
 
-auto TableHeap::MakeIterator() -> TableIterator {
+auto TableHeap::MakeIterator(TableIterator::Filter filter, std::vector<ZonePredicate> zone_predicates)
+    -> TableIterator {
+  // 先登记扫描，之后的插入不再复用slot和free space map里的页。再依次记下末页和各个target正在填的页、备用页的
+  // tuple数，之后插入的tuple要么落在这些页上超过记录的位置，要么落在末页之后的新页上，迭代器都看不到
+  active_scans_++;
   std::unique_lock<std::mutex> guard(latch_);
   auto last_page_id = last_page_id_;
   guard.unlock();
+  std::vector<page_id_t> open_page_ids;
+  for (auto &target : insert_targets_) {
+    std::scoped_lock<std::mutex> target_guard(target.latch_);
+    if (target.page_id_ != INVALID_PAGE_ID) {
+      open_page_ids.push_back(target.page_id_);
+    }
+    open_page_ids.insert(open_page_ids.end(), target.spare_pages_.begin(), target.spare_pages_.end());
+  }
 
+  std::vector<RID> page_limits;
+  for (page_id_t page_id : open_page_ids) {
+    if (page_id != last_page_id) {
+      auto page_guard = bpm_->FetchPageRead(page_id);
+      page_limits.emplace_back(page_id, VisitPage(page_guard, [](const auto *page) { return page->GetNumTuples(); }));
+    }
+  }
   auto page_guard = bpm_->FetchPageRead(last_page_id);
-  auto page = page_guard.As<TablePage>();
-  return {this, {first_page_id_, 0}, {last_page_id, page->GetNumTuples()}};
+  RID stop_at_rid{last_page_id, VisitPage(page_guard, [](const auto *page) { return page->GetNumTuples(); })};
+  page_guard.Drop();
+  return {this,
+          {first_page_id_, 0},
+          stop_at_rid,
+          std::move(page_limits),
+          true,
+          std::move(filter),
+          std::move(zone_predicates)};
 }
 
 auto TableHeap::MakeEagerIterator() -> TableIterator { return {this, {first_page_id_, 0}, {INVALID_PAGE_ID, 0}}; }
 
 void TableHeap::UpdateTupleInPlaceUnsafe(const TupleMeta &meta, const Tuple &tuple, RID rid) {
+  // 先放宽区间图再改页，读到新值的扫描不会被区间图挡掉
+  zone_map_.Update(rid.GetPageId(), tuple);
+  auto encoded = EncodeValues(tuple);
   auto page_guard = bpm_->FetchPageWrite(rid.GetPageId());
-  auto page = page_guard.AsMut<TablePage>();
-  page->UpdateTupleInPlaceUnsafe(meta, tuple, rid);
+  uint32_t free_bytes = VisitPage(page_guard, [&](auto *page) {
+    page->UpdateTupleInPlaceUnsafe(meta, encoded.has_value() ? *encoded : tuple, rid);
+    return page->GetFreeSpace();
+  });
+  if (meta.is_deleted_ && meta.delete_txn_id_ == INVALID_TXN_ID) {
+    page_guard.Drop();
+    RecordFreeSpace(rid.GetPageId(), free_bytes);
+  }
 }
 
 }  // namespace bustub
@@ -10,8 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
 #include <optional>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "common/exception.h"
@@ -20,51 +23,150 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid)
-    : table_heap_(table_heap), rid_(rid), stop_at_rid_(stop_at_rid) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, RID stop_at_rid, std::vector<RID> page_limits,
+                             bool in_scan, Filter filter, std::vector<ZonePredicate> zone_predicates)
+    : table_heap_(table_heap),
+      rid_(rid),
+      stop_at_rid_(stop_at_rid),
+      page_limits_(std::move(page_limits)),
+      filter_(std::move(filter)),
+      zone_predicates_(std::move(zone_predicates)),
+      in_scan_(in_scan) {
+  // 等值条件的常量有编码时，先比编码，不相等的tuple不用解码
+  for (const auto &predicate : zone_predicates_) {
+    if (predicate.op_ != ZoneOp::Equal) {
+      continue;
+    }
+    if (auto code = table_heap_->dictionary_.Lookup(predicate.col_idx_, predicate.value_); code.has_value()) {
+      code_predicates_.emplace_back(predicate.col_idx_, *code);
+    }
+  }
   // If the rid doesn't correspond to a tuple (i.e., the table has just been initialized), then
   // we set rid_ to invalid.
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
-  auto page = page_guard.As<TablePage>();
-  if (rid_.GetSlotNum() >= page->GetNumTuples()) {
-    rid_ = RID{INVALID_PAGE_ID, 0};
+  SeekVisible();
+}
+
+TableIterator::TableIterator(TableIterator &&that) noexcept
+    : table_heap_(that.table_heap_),
+      rid_(that.rid_),
+      stop_at_rid_(that.stop_at_rid_),
+      page_limits_(std::move(that.page_limits_)),
+      filter_(std::move(that.filter_)),
+      zone_predicates_(std::move(that.zone_predicates_)),
+      code_predicates_(std::move(that.code_predicates_)),
+      batch_(std::move(that.batch_)),
+      cursor_(that.cursor_),
+      batch_end_(that.batch_end_),
+      in_scan_(that.in_scan_) {
+  that.in_scan_ = false;
+}
+
+TableIterator::~TableIterator() { EndScan(); }
+
+void TableIterator::EndScan() {
+  if (in_scan_) {
+    in_scan_ = false;
+    table_heap_->EndScan();
   }
 }
 
-auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> { return table_heap_->GetTuple(rid_); }
+auto TableIterator::GetTuple() -> std::pair<TupleMeta, Tuple> {
+  BUSTUB_ASSERT(!IsEnd(), "iterate out of bound");
+  return batch_[cursor_];
+}
 
 auto TableIterator::GetRID() -> RID { return rid_; }
 
 auto TableIterator::IsEnd() -> bool { return rid_.GetPageId() == INVALID_PAGE_ID; }
 
 auto TableIterator::operator++() -> TableIterator & {
-  auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
-  auto page = page_guard.As<TablePage>();
-  auto next_tuple_id = rid_.GetSlotNum() + 1;
-
-  if (stop_at_rid_.GetPageId() != INVALID_PAGE_ID) {
-    BUSTUB_ASSERT(
-        /* case 1: cursor before the page of the stop tuple */ rid_.GetPageId() < stop_at_rid_.GetPageId() ||
-            /* case 2: cursor at the page before the tuple */
-            (rid_.GetPageId() == stop_at_rid_.GetPageId() && next_tuple_id <= stop_at_rid_.GetSlotNum()),
-        "iterate out of bound");
+  BUSTUB_ASSERT(!IsEnd(), "iterate out of bound");
+  if (++cursor_ < batch_.size()) {
+    rid_ = batch_[cursor_].second.GetRid();
+    return *this;
   }
+  rid_ = RID{rid_.GetPageId(), batch_end_};
+  SeekVisible();
+  return *this;
+}
 
-  rid_ = RID{rid_.GetPageId(), next_tuple_id};
-
-  if (rid_ == stop_at_rid_) {
-    rid_ = RID{INVALID_PAGE_ID, 0};
-  } else if (next_tuple_id < page->GetNumTuples()) {
-    // that's fine
-  } else {
-    auto next_page_id = page->GetNextPageId();
-    // if next page is invalid, RID is set to invalid page; otherwise, it's the first tuple in that page.
-    rid_ = RID{next_page_id, 0};
+void TableIterator::SeekVisible() {
+  while (rid_.GetPageId() != INVALID_PAGE_ID) {
+    if (!zone_predicates_.empty()) {
+      // 区间图排除的页不用读；page id沿链表递增，跳过了终止页就扫完了
+      page_id_t page_id = table_heap_->zone_map_.NextCandidate(rid_.GetPageId(), zone_predicates_);
+      if (page_id != rid_.GetPageId()) {
+        if (page_id == INVALID_PAGE_ID ||
+            (stop_at_rid_.GetPageId() != INVALID_PAGE_ID && page_id > stop_at_rid_.GetPageId())) {
+          rid_ = RID{INVALID_PAGE_ID, 0};
+          break;
+        }
+        rid_ = RID{page_id, 0};
+      }
+    }
+    auto page_guard = table_heap_->bpm_->FetchPageRead(rid_.GetPageId());
+    bool is_stop_page = rid_.GetPageId() == stop_at_rid_.GetPageId();
+    bool loaded = table_heap_->VisitPage(page_guard, [&](const auto *page) { return LoadBatch(page, is_stop_page); });
+    if (loaded) {
+      return;
+    }
+    // 这一页没有要扫的tuple了；其他线程可能正在往前面的页插入，空页也要跳过
+    page_id_t next_page_id = table_heap_->VisitPage(page_guard, [](const auto *page) { return page->GetNextPageId(); });
+    rid_ = is_stop_page ? RID{INVALID_PAGE_ID, 0} : RID{next_page_id, 0};
   }
+  // 扫完了，插入可以复用空间了
+  batch_.clear();
+  cursor_ = 0;
+  EndScan();
+}
 
-  page_guard.Drop();
+auto TableIterator::MatchesCodes(const TupleView &view) const -> bool {
+  for (const auto &[col_idx, code] : code_predicates_) {
+    auto view_code = view.GetCode(&table_heap_->schema_, col_idx);
+    if (view_code.has_value() && *view_code != code) {
+      return false;
+    }
+  }
+  return true;
+}
 
-  return *this;
+template <typename Page>
+auto TableIterator::LoadBatch(const Page *page, bool is_stop_page) -> bool {
+  uint32_t limit = page->GetNumTuples();
+  if (is_stop_page) {
+    limit = std::min(limit, stop_at_rid_.GetSlotNum());
+  }
+  for (const auto &page_limit : page_limits_) {
+    if (page_limit.GetPageId() == rid_.GetPageId()) {
+      limit = std::min(limit, page_limit.GetSlotNum());
+    }
+  }
+  if (rid_.GetSlotNum() >= limit) {
+    return false;
+  }
+  // 一次拷出这一页上要扫的所有tuple，被过滤掉的tuple不拷贝
+  batch_.clear();
+  cursor_ = 0;
+  batch_end_ = limit;
+  for (uint32_t slot = rid_.GetSlotNum(); slot < limit; slot++) {
+    RID rid{rid_.GetPageId(), slot};
+    if (filter_ == nullptr) {
+      batch_.push_back(page->GetTuple(rid));
+      batch_.back().second.toast_store_ = &table_heap_->toast_store_;
+      batch_.back().second.dictionary_ = &table_heap_->dictionary_;
+      continue;
+    }
+    auto [meta, view] = page->GetTupleView(rid);
+    view.SetValueStores(&table_heap_->toast_store_, &table_heap_->dictionary_);
+    if (MatchesCodes(view) && filter_(meta, view)) {
+      batch_.emplace_back(meta, view.ToTuple());
+    }
+  }
+  if (batch_.empty()) {
+    return false;
+  }
+  rid_ = batch_[0].second.GetRid();
+  return true;
 }
 
 }  // namespace bustub
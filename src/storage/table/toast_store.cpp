@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// toast_store.cpp
+//
+// Identification: src/storage/table/toast_store.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/toast_store.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/page/page_guard.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+auto ToastStore::Store(const char *data, uint32_t len) const -> page_id_t {
+  // 从最后一段往前写，每一页写的时候就知道下一页是哪个
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  uint32_t num_pages = std::max<uint32_t>(1, (len + ToastPage::CAPACITY - 1) / ToastPage::CAPACITY);
+  for (uint32_t i = num_pages; i > 0; i--) {
+    uint32_t offset = (i - 1) * ToastPage::CAPACITY;
+    uint32_t size = std::min(len - offset, ToastPage::CAPACITY);
+    page_id_t page_id = INVALID_PAGE_ID;
+    auto guard = bpm_->NewPageGuarded(&page_id);
+    BUSTUB_ENSURE(page_id != INVALID_PAGE_ID, "cannot allocate toast page");
+    auto page = guard.AsMut<ToastPage>();
+    page->Init(next_page_id, size);
+    memcpy(page->GetData(), data + offset, size);
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+auto ToastStore::Fetch(const char *pointer) const -> Value {
+  BUSTUB_ASSERT(IsToastPointer(pointer), "not a toast pointer");
+  uint32_t len = *reinterpret_cast<const uint32_t *>(pointer) & ~TOAST_FLAG;
+  page_id_t page_id = *reinterpret_cast<const page_id_t *>(pointer + sizeof(uint32_t));
+  std::vector<char> buf(len);
+  uint32_t offset = 0;
+  while (offset < len) {
+    BUSTUB_ENSURE(page_id != INVALID_PAGE_ID, "toast chain is shorter than its value");
+    auto guard = bpm_->FetchPageRead(page_id);
+    auto page = guard.As<ToastPage>();
+    memcpy(buf.data() + offset, page->GetData(), page->GetSize());
+    offset += page->GetSize();
+    page_id = page->GetNextPageId();
+  }
+  return {TypeId::VARCHAR, buf.data(), len, true};
+}
+
+}  // namespace bustub
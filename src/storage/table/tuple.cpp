@@ -16,10 +16,62 @@
 #include <string>
 #include <vector>
 
+#include "common/macros.h"
+#include "storage/page/table_pax_page.h"
+#include "storage/table/dictionary.h"
+#include "storage/table/toast_store.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
+namespace {
+
+// Get the starting storage address of specific column of the tuple stored at `data`
+auto ColumnDataPtr(const char *data, const Schema *schema, const uint32_t column_idx) -> const char * {
+  assert(schema);
+  const auto &col = schema->GetColumn(column_idx);
+  bool is_inlined = col.IsInlined();
+  // For inline type, data is stored where it is.
+  if (is_inlined) {
+    return (data + col.GetOffset());
+  }
+  // We read the relative offset from the tuple data.
+  int32_t offset = *reinterpret_cast<const int32_t *>(data + col.GetOffset());
+  // And return the beginning address of the real data for the VARCHAR type.
+  return (data + offset);
+}
+
+// Read the value of a column stored at `data_ptr`, from `toast_store` or `dictionary` if it is not stored inline
+auto ReadValue(const char *data_ptr, const Schema *schema, uint32_t column_idx, const ToastStore *toast_store,
+               const Dictionary *dictionary) -> Value {
+  const TypeId column_type = schema->GetColumn(column_idx).GetType();
+  if (column_type == TypeId::VARCHAR && IsToastPointer(data_ptr)) {
+    BUSTUB_ASSERT(toast_store != nullptr, "toast pointer in a tuple without toast store");
+    return toast_store->Fetch(data_ptr);
+  }
+  if (column_type == TypeId::VARCHAR && IsDictionaryCode(data_ptr)) {
+    BUSTUB_ASSERT(dictionary != nullptr, "dictionary code in a tuple without dictionary");
+    return dictionary->Decode(column_idx, *reinterpret_cast<const uint32_t *>(data_ptr) & ~DICTIONARY_FLAG);
+  }
+  return Value::DeserializeFrom(data_ptr, column_type);
+}
+
+// Whether the value of a column stored at `data_ptr` is null, without fetching it if it is out of line
+auto ValueIsNull(const char *data_ptr, const Schema *schema, uint32_t column_idx) -> bool {
+  const TypeId column_type = schema->GetColumn(column_idx).GetType();
+  if (column_type == TypeId::VARCHAR) {
+    return *reinterpret_cast<const uint32_t *>(data_ptr) == BUSTUB_VALUE_NULL;
+  }
+  return Value::DeserializeFrom(data_ptr, column_type).IsNull();
+}
+
+// Whether the bit of a column is set in the null bitmap at `null_bitmap`
+auto BitmapIsNull(const char *null_bitmap, uint32_t column_idx) -> bool {
+  return ((static_cast<uint8_t>(null_bitmap[column_idx / 8]) >> (column_idx % 8)) & 1) != 0;
+}
+
+}  // namespace
+
 // TODO(Amadou): It does not look like nulls are supported. Add a null bitmap?
 Tuple::Tuple(std::vector<Value> values, const Schema *schema) {
   assert(values.size() == schema->GetColumnCount());
@@ -62,10 +114,15 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) {
 
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
-  const TypeId column_type = schema->GetColumn(column_idx).GetType();
-  const char *data_ptr = GetDataPtr(schema, column_idx);
-  // the third parameter "is_inlined" is unused
-  return Value::DeserializeFrom(data_ptr, column_type);
+  return ReadValue(GetDataPtr(schema, column_idx), schema, column_idx, toast_store_, dictionary_);
+}
+
+auto Tuple::IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
+  assert(schema);
+  if (null_bitmap_size_ > 0) {
+    return BitmapIsNull(data_.data() + GetLength(), column_idx);
+  }
+  return ValueIsNull(GetDataPtr(schema, column_idx), schema, column_idx);
 }
 
 auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs)
@@ -79,17 +136,49 @@ auto Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const s
 }
 
 auto Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const -> const char * {
+  return ColumnDataPtr(data_.data(), schema, column_idx);
+}
+
+auto TupleView::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
-  const auto &col = schema->GetColumn(column_idx);
-  bool is_inlined = col.IsInlined();
-  // For inline type, data is stored where it is.
-  if (is_inlined) {
-    return (data_.data() + col.GetOffset());
+  return ReadValue(ColumnData(schema, column_idx), schema, column_idx, toast_store_, dictionary_);
+}
+
+auto TupleView::GetCode(const Schema *schema, uint32_t column_idx) const -> std::optional<uint32_t> {
+  assert(schema);
+  const char *data_ptr = ColumnData(schema, column_idx);
+  if (schema->GetColumn(column_idx).GetType() != TypeId::VARCHAR || !IsDictionaryCode(data_ptr)) {
+    return std::nullopt;
   }
-  // We read the relative offset from the tuple data.
-  int32_t offset = *reinterpret_cast<const int32_t *>(data_.data() + col.GetOffset());
-  // And return the beginning address of the real data for the VARCHAR type.
-  return (data_.data() + offset);
+  return *reinterpret_cast<const uint32_t *>(data_ptr) & ~DICTIONARY_FLAG;
+}
+
+auto TupleView::IsNull(const Schema *schema, uint32_t column_idx) const -> bool {
+  assert(schema);
+  if (null_bitmap_size_ > 0) {
+    return BitmapIsNull(data_ + size_, column_idx);
+  }
+  return ValueIsNull(ColumnData(schema, column_idx), schema, column_idx);
+}
+
+auto TupleView::ColumnData(const Schema *schema, uint32_t column_idx) const -> const char * {
+  if (pax_page_ != nullptr) {
+    return pax_page_->GetColumnData(slot_, column_idx);
+  }
+  return ColumnDataPtr(data_, schema, column_idx);
+}
+
+auto TupleView::ToTuple() const -> Tuple {
+  Tuple tuple(rid_);
+  if (pax_page_ != nullptr) {
+    tuple = pax_page_->GetTuple(rid_).second;
+  } else {
+    tuple.data_.assign(data_, data_ + size_ + null_bitmap_size_);
+    tuple.null_bitmap_size_ = null_bitmap_size_;
+  }
+  tuple.toast_store_ = toast_store_;
+  tuple.dictionary_ = dictionary_;
+  return tuple;
 }
 
 auto Tuple::ToString(const Schema *schema) const -> std::string {
@@ -112,13 +201,13 @@ auto Tuple::ToString(const Schema *schema) const -> std::string {
     }
   }
   os << ")";
-  os << " Tuple size is " << data_.size();
+  os << " Tuple size is " << GetLength();
 
   return os.str();
 }
 
 void Tuple::SerializeTo(char *storage) const {
-  int32_t sz = data_.size();
+  int32_t sz = GetLength();
   memcpy(storage, &sz, sizeof(int32_t));
   memcpy(storage + sizeof(int32_t), data_.data(), sz);
 }
@@ -126,6 +215,7 @@ void Tuple::SerializeTo(char *storage) const {
 void Tuple::DeserializeFrom(const char *storage) {
   uint32_t size = *reinterpret_cast<const uint32_t *>(storage);
   this->data_.resize(size);
+  this->null_bitmap_size_ = 0;
   memcpy(this->data_.data(), storage + sizeof(int32_t), size);
 }
 
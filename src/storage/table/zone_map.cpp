@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/zone_map.h"
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+void ZoneMap::AddPage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> guard(latch_);
+  zones_.emplace(page_id, std::vector<ColumnZone>(schema_->GetColumnCount()));
+}
+
+void ZoneMap::Update(page_id_t page_id, const Tuple &tuple) {
+  uint32_t num_columns = schema_->GetColumnCount();
+  if (num_columns == 0) {
+    return;
+  }
+  // 在latch_外面把值读出来
+  std::vector<Value> values;
+  values.reserve(num_columns);
+  for (uint32_t i = 0; i < num_columns; i++) {
+    values.push_back(tuple.GetValue(schema_, i));
+  }
+
+  std::scoped_lock<std::mutex> guard(latch_);
+  auto iter = zones_.find(page_id);
+  BUSTUB_ASSERT(iter != zones_.end(), "page is not tracked by the zone map");
+  for (uint32_t i = 0; i < num_columns; i++) {
+    auto &zone = iter->second[i];
+    const auto &value = values[i];
+    if (value.IsNull()) {
+      zone.null_count_++;
+      continue;
+    }
+    if (!zone.min_.has_value() || value.CompareLessThan(*zone.min_) == CmpBool::CmpTrue) {
+      zone.min_ = value;
+    }
+    if (!zone.max_.has_value() || value.CompareGreaterThan(*zone.max_) == CmpBool::CmpTrue) {
+      zone.max_ = value;
+    }
+  }
+}
+
+auto ZoneMap::GetZones(page_id_t page_id) const -> std::vector<ColumnZone> {
+  std::scoped_lock<std::mutex> guard(latch_);
+  auto iter = zones_.find(page_id);
+  return iter == zones_.end() ? std::vector<ColumnZone>{} : iter->second;
+}
+
+auto ZoneMap::NextCandidate(page_id_t page_id, const std::vector<ZonePredicate> &predicates) const -> page_id_t {
+  if (schema_->GetColumnCount() == 0 || predicates.empty()) {
+    return page_id;
+  }
+  std::scoped_lock<std::mutex> guard(latch_);
+  for (auto iter = zones_.lower_bound(page_id); iter != zones_.end(); ++iter) {
+    bool may_match = true;
+    for (const auto &predicate : predicates) {
+      if (!MayMatch(iter->second[predicate.col_idx_], predicate)) {
+        may_match = false;
+        break;
+      }
+    }
+    if (may_match) {
+      return iter->first;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+auto ZoneMap::MayMatch(const ColumnZone &zone, const ZonePredicate &predicate) -> bool {
+  // 这一列在页里只有null，任何比较都不成立
+  if (!zone.min_.has_value()) {
+    return false;
+  }
+  const auto &value = predicate.value_;
+  switch (predicate.op_) {
+    case ZoneOp::Equal:
+      return zone.min_->CompareLessThanEquals(value) == CmpBool::CmpTrue &&
+             zone.max_->CompareGreaterThanEquals(value) == CmpBool::CmpTrue;
+    case ZoneOp::LessThan:
+      return zone.min_->CompareLessThan(value) == CmpBool::CmpTrue;
+    case ZoneOp::LessThanOrEqual:
+      return zone.min_->CompareLessThanEquals(value) == CmpBool::CmpTrue;
+    case ZoneOp::GreaterThan:
+      return zone.max_->CompareGreaterThan(value) == CmpBool::CmpTrue;
+    case ZoneOp::GreaterThanOrEqual:
+      return zone.max_->CompareGreaterThanEquals(value) == CmpBool::CmpTrue;
+  }
+  return true;
+}
+
+}  // namespace bustub
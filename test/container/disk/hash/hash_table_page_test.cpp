@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <memory>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -17,13 +18,14 @@
 #include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -56,7 +58,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -113,4 +115,53 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(HashTablePageTest, BucketPageFingerprintTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(5, disk_manager.get());
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page =
+      reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(bpm->NewPage(&bucket_page_id)->GetData());
+  auto fingerprint = [](int key) { return static_cast<uint8_t>(key % 7); };
+
+  // fill the bucket, the keys share a handful of fingerprints
+  int num_keys = 0;
+  while (bucket_page->Insert(num_keys, num_keys, IntComparator(), fingerprint(num_keys))) {
+    num_keys++;
+  }
+  EXPECT_GT(num_keys, 400);
+  EXPECT_TRUE(bucket_page->IsFull());
+  EXPECT_EQ(num_keys, bucket_page->NumReadable());
+
+  // only slots with a matching fingerprint are compared
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(bucket_page->GetValue(i, IntComparator(), &res, fingerprint(i)));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(i, res[0]);
+    EXPECT_EQ(fingerprint(i), bucket_page->FingerprintAt(i));
+    EXPECT_FALSE(bucket_page->GetValue(i, IntComparator(), &res, fingerprint(i) + 1));
+  }
+  EXPECT_FALSE(bucket_page->Insert(1, 1, IntComparator(), fingerprint(1)));
+
+  // a tombstone is reused by the next insert
+  ASSERT_TRUE(bucket_page->Remove(100, 100, IntComparator(), fingerprint(100)));
+  EXPECT_FALSE(bucket_page->IsFull());
+  ASSERT_TRUE(bucket_page->Insert(num_keys, num_keys, IntComparator(), fingerprint(num_keys)));
+  EXPECT_EQ(num_keys, bucket_page->KeyAt(100));
+  std::vector<int> res;
+  EXPECT_TRUE(bucket_page->GetValue(num_keys, IntComparator(), &res, fingerprint(num_keys)));
+
+  for (int i = 0; i <= num_keys; i++) {
+    if (i != 100) {
+      ASSERT_TRUE(bucket_page->Remove(i, i, IntComparator(), fingerprint(i)));
+    }
+  }
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  EXPECT_EQ(0, bucket_page->NumReadable());
+
+  bpm->UnpinPage(bucket_page_id, true);
+}
+
 }  // namespace bustub
@@ -18,103 +18,226 @@
 #include "container/disk/hash/disk_extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
-  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+  {
+    DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+    // insert a few values
+    for (int i = 0; i < 5; i++) {
+      ht.Insert(nullptr, i, i);
+      std::vector<int> res;
+      ht.GetValue(nullptr, i, &res);
+      EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+      EXPECT_EQ(i, res[0]);
+    }
 
-  // insert a few values
-  for (int i = 0; i < 5; i++) {
-    ht.Insert(nullptr, i, i);
+    ht.VerifyIntegrity();
+
+    // check if the inserted values are all there
+    for (int i = 0; i < 5; i++) {
+      std::vector<int> res;
+      ht.GetValue(nullptr, i, &res);
+      EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+      EXPECT_EQ(i, res[0]);
+    }
+
+    ht.VerifyIntegrity();
+
+    // insert one more value for each key
+    for (int i = 0; i < 5; i++) {
+      if (i == 0) {
+        // duplicate values for the same key are not allowed
+        EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
+      } else {
+        EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+      }
+      ht.Insert(nullptr, i, 2 * i);
+      std::vector<int> res;
+      ht.GetValue(nullptr, i, &res);
+      if (i == 0) {
+        // duplicate values for the same key are not allowed
+        EXPECT_EQ(1, res.size());
+        EXPECT_EQ(i, res[0]);
+      } else {
+        EXPECT_EQ(2, res.size());
+        if (res[0] == i) {
+          EXPECT_EQ(2 * i, res[1]);
+        } else {
+          EXPECT_EQ(2 * i, res[0]);
+          EXPECT_EQ(i, res[1]);
+        }
+      }
+    }
+
+    ht.VerifyIntegrity();
+
+    // look for a key that does not exist
     std::vector<int> res;
-    ht.GetValue(nullptr, i, &res);
-    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
-    EXPECT_EQ(i, res[0]);
+    ht.GetValue(nullptr, 20, &res);
+    EXPECT_EQ(0, res.size());
+
+    // delete some values
+    for (int i = 0; i < 5; i++) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+      std::vector<int> res;
+      ht.GetValue(nullptr, i, &res);
+      if (i == 0) {
+        // (0, 0) is the only pair with key 0
+        EXPECT_EQ(0, res.size());
+      } else {
+        EXPECT_EQ(1, res.size());
+        EXPECT_EQ(2 * i, res[0]);
+      }
+    }
+
+    ht.VerifyIntegrity();
+
+    // delete all values
+    for (int i = 0; i < 5; i++) {
+      if (i == 0) {
+        // (0, 0) has been deleted
+        EXPECT_FALSE(ht.Remove(nullptr, i, 2 * i));
+      } else {
+        EXPECT_TRUE(ht.Remove(nullptr, i, 2 * i));
+      }
+    }
+
+    ht.VerifyIntegrity();
+
   }
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
 
+// NOLINTNEXTLINE
+TEST(HashTableTest, GrowShrinkTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // enough pairs for a few dozen buckets
+  int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
   ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 4);
 
-  // check if the inserted values are all there
-  for (int i = 0; i < 5; i++) {
+  for (int i = 0; i < num_keys; i++) {
     std::vector<int> res;
     ht.GetValue(nullptr, i, &res);
-    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
     EXPECT_EQ(i, res[0]);
   }
 
+  // emptied buckets merge and the directory shrinks back
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
   ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 0, &res));
 
-  // insert one more value for each key
-  for (int i = 0; i < 5; i++) {
-    if (i == 0) {
-      // duplicate values for the same key are not allowed
-      EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
-    } else {
-      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
-    }
-    ht.Insert(nullptr, i, 2 * i);
-    std::vector<int> res;
-    ht.GetValue(nullptr, i, &res);
-    if (i == 0) {
-      // duplicate values for the same key are not allowed
-      EXPECT_EQ(1, res.size());
-      EXPECT_EQ(i, res[0]);
-    } else {
-      EXPECT_EQ(2, res.size());
-      if (res[0] == i) {
-        EXPECT_EQ(2 * i, res[1]);
-      } else {
-        EXPECT_EQ(2 * i, res[0]);
-        EXPECT_EQ(i, res[1]);
-      }
+}
+
+// NOLINTNEXTLINE
+TEST(HashTableTest, MultiPageDirectoryTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  HashFunction<int> hash_fn;
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), hash_fn);
+
+  // keys whose hashes agree in the low 10 bits only split apart with a directory of more than
+  // 1024 slots, which takes several directory pages
+  std::vector<int> keys;
+  for (int i = 0; keys.size() < 1200; i++) {
+    if ((static_cast<uint32_t>(hash_fn.GetHash(i)) & 1023) == 0) {
+      keys.push_back(i);
     }
   }
-
+  for (int key = -5000; key < 0; key++) {
+    keys.push_back(key);
+  }
+  for (auto key : keys) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
   ht.VerifyIntegrity();
+  EXPECT_GT(ht.GetGlobalDepth(), 10);
 
-  // look for a key that does not exist
-  std::vector<int> res;
-  ht.GetValue(nullptr, 20, &res);
-  EXPECT_EQ(0, res.size());
-
-  // delete some values
-  for (int i = 0; i < 5; i++) {
-    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  for (auto key : keys) {
     std::vector<int> res;
-    ht.GetValue(nullptr, i, &res);
-    if (i == 0) {
-      // (0, 0) is the only pair with key 0
-      EXPECT_EQ(0, res.size());
-    } else {
-      EXPECT_EQ(1, res.size());
-      EXPECT_EQ(2 * i, res[0]);
-    }
+    ht.GetValue(nullptr, key, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << key;
+    EXPECT_EQ(key, res[0]);
   }
 
+  for (auto key : keys) {
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+  }
   ht.VerifyIntegrity();
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+}
 
-  // delete all values
-  for (int i = 0; i < 5; i++) {
-    if (i == 0) {
-      // (0, 0) has been deleted
-      EXPECT_FALSE(ht.Remove(nullptr, i, 2 * i));
-    } else {
-      EXPECT_TRUE(ht.Remove(nullptr, i, 2 * i));
-    }
+// NOLINTNEXTLINE
+TEST(HashTableTest, ConcurrentInsertLookupTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager.get());
+  DiskExtendibleHashTable<int, int, IntComparator> ht("blah", bpm.get(), IntComparator(), HashFunction<int>());
+
+  // readers look up the first keys while writers split the buckets around them
+  int num_preserved = 2000;
+  for (int i = 0; i < num_preserved; i++) {
+    ht.Insert(nullptr, i, i);
+  }
+
+  int num_writers = 4;
+  int keys_per_writer = 10000;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_writers; tid++) {
+    threads.emplace_back([&, tid] {
+      for (int i = 0; i < keys_per_writer; i++) {
+        int key = num_preserved + i * num_writers + tid;
+        EXPECT_TRUE(ht.Insert(nullptr, key, key));
+      }
+    });
+  }
+  for (int tid = 0; tid < 2; tid++) {
+    threads.emplace_back([&] {
+      for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < num_preserved; i++) {
+          std::vector<int> res;
+          ht.GetValue(nullptr, i, &res);
+          ASSERT_EQ(1, res.size()) << "Failed to find " << i;
+          ASSERT_EQ(i, res[0]);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
   }
 
   ht.VerifyIntegrity();
+  for (int i = 0; i < num_preserved + num_writers * keys_per_writer; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i;
+    EXPECT_EQ(i, res[0]);
+  }
 
-  disk_manager->ShutDown();
-  remove("test.db");
-  delete disk_manager;
-  delete bpm;
 }
 
 }  // namespace bustub
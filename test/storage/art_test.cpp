@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_test.cpp
+//
+// Identification: test/storage/art_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/art.h"
+#include "storage/index/art_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+// fixed-size big-endian keys are prefix-free and sort like the integers
+auto MakeKey(uint64_t key) -> std::string {
+  std::string result(sizeof(key), '\0');
+  for (size_t i = 0; i < sizeof(key); ++i) {
+    result[i] = static_cast<char>(key >> (8 * (sizeof(key) - 1 - i)));
+  }
+  return result;
+}
+
+auto MakeRID(uint64_t key) -> RID { return {static_cast<page_id_t>(key >> 32), static_cast<uint32_t>(key)}; }
+
+}  // namespace
+
+TEST(ARTTests, InsertLookupRemoveTest) {
+  AdaptiveRadixTree tree;
+  // 300 children below one byte forces every node layout from Node4 to Node256
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 1; key <= 300; ++key) {
+    keys.push_back(key);
+    keys.push_back(key << 40);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key)));
+  }
+  for (auto key : keys) {
+    ASSERT_FALSE(tree.Insert(MakeKey(key), MakeRID(key + 1)));
+  }
+
+  RID rid;
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.GetValue(MakeKey(key), &rid));
+    ASSERT_EQ(rid, MakeRID(key));
+  }
+  ASSERT_FALSE(tree.GetValue(MakeKey(1000), &rid));
+
+  for (uint64_t key = 2; key <= 300; key += 2) {
+    ASSERT_TRUE(tree.Remove(MakeKey(key)));
+    ASSERT_FALSE(tree.Remove(MakeKey(key)));
+  }
+  for (uint64_t key = 1; key <= 300; ++key) {
+    ASSERT_EQ(tree.GetValue(MakeKey(key), &rid), key % 2 == 1);
+    ASSERT_TRUE(tree.GetValue(MakeKey(key << 40), &rid));
+  }
+
+  // removed keys can be inserted again
+  ASSERT_TRUE(tree.Insert(MakeKey(2), MakeRID(2)));
+  ASSERT_TRUE(tree.GetValue(MakeKey(2), &rid));
+  ASSERT_EQ(rid, MakeRID(2));
+
+  ASSERT_THROW(tree.Insert(std::string(AdaptiveRadixTree::MAX_KEY_SIZE + 1, 'a'), rid), Exception);
+}
+
+TEST(ARTTests, ScanRangeTest) {
+  AdaptiveRadixTree tree;
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 2000; ++key) {
+    keys.push_back(key * 7);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key)));
+  }
+
+  std::vector<RID> result;
+  tree.ScanRange(MakeKey(100), MakeKey(1000), &result);
+  std::vector<RID> expected;
+  for (uint64_t key = 105; key <= 1000; key += 7) {
+    expected.push_back(MakeRID(key));
+  }
+  ASSERT_EQ(result, expected);
+
+  result.clear();
+  tree.ScanRange(MakeKey(0), MakeKey(UINT64_MAX), &result);
+  ASSERT_EQ(result.size(), keys.size());
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_EQ(result[i], MakeRID(i * 7));
+  }
+
+  result.clear();
+  tree.ScanRange(MakeKey(1), MakeKey(6), &result);
+  ASSERT_TRUE(result.empty());
+}
+
+TEST(ARTTests, ConcurrentInsertLookupTest) {
+  AdaptiveRadixTree tree;
+  const uint64_t num_threads = 4;
+  const uint64_t keys_per_thread = 5000;
+
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&tree, tid] {
+      RID rid;
+      for (uint64_t i = 0; i < keys_per_thread; ++i) {
+        uint64_t key = i * num_threads + tid;
+        ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key)));
+        ASSERT_TRUE(tree.GetValue(MakeKey(key), &rid));
+        ASSERT_EQ(rid, MakeRID(key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<RID> result;
+  tree.ScanRange(MakeKey(0), MakeKey(UINT64_MAX), &result);
+  ASSERT_EQ(result.size(), num_threads * keys_per_thread);
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_EQ(result[i], MakeRID(i));
+  }
+}
+
+TEST(ARTTests, ConcurrentChurnTest) {
+  AdaptiveRadixTree tree;
+  const uint64_t num_threads = 4;
+  const uint64_t keys_per_thread = 200;
+  const int rounds = 50;
+
+  // writers insert and remove their own keys over and over, so leaves are retired while the
+  // scanning thread may still be reading them
+  std::atomic<bool> done{false};
+  std::thread scanner([&tree, &done] {
+    std::vector<RID> result;
+    while (!done.load()) {
+      result.clear();
+      tree.ScanRange(MakeKey(0), MakeKey(UINT64_MAX), &result);
+      ASSERT_LE(result.size(), num_threads * keys_per_thread);
+    }
+  });
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&tree, tid] {
+      for (int round = 0; round < rounds; ++round) {
+        for (uint64_t i = 0; i < keys_per_thread; ++i) {
+          uint64_t key = (i * num_threads + tid) << 20;
+          ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key)));
+        }
+        for (uint64_t i = 0; i < keys_per_thread; ++i) {
+          uint64_t key = (i * num_threads + tid) << 20;
+          ASSERT_TRUE(tree.Remove(MakeKey(key)));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done.store(true);
+  scanner.join();
+
+  std::vector<RID> result;
+  tree.ScanRange(MakeKey(0), MakeKey(UINT64_MAX), &result);
+  ASSERT_TRUE(result.empty());
+}
+
+TEST(ARTTests, IndexTest) {
+  auto schema = ParseCreateStatement("a varchar(16),b integer");
+  ARTIndex index(std::make_unique<IndexMetadata>("foo_art", "foo", schema.get(), std::vector<uint32_t>{0, 1}));
+  const auto *key_schema = index.GetKeySchema();
+
+  auto make_tuple = [&](const std::string &a, int32_t b) {
+    std::vector<Value> values{ValueFactory::GetVarcharValue(a), ValueFactory::GetIntegerValue(b)};
+    return Tuple(values, key_schema);
+  };
+
+  // "ab" sorts before "abc", and both before "b"
+  ASSERT_TRUE(index.InsertEntry(make_tuple("abc", 1), RID(0, 2), nullptr));
+  ASSERT_TRUE(index.InsertEntry(make_tuple("ab", 5), RID(0, 1), nullptr));
+  ASSERT_TRUE(index.InsertEntry(make_tuple("b", -3), RID(0, 3), nullptr));
+  ASSERT_FALSE(index.InsertEntry(make_tuple("ab", 5), RID(0, 4), nullptr));
+
+  std::vector<RID> result;
+  index.ScanKey(make_tuple("ab", 5), &result, nullptr);
+  ASSERT_EQ(result, std::vector<RID>{RID(0, 1)});
+
+  result.clear();
+  index.ScanRange(make_tuple("a", 0), make_tuple("z", 0), &result, nullptr);
+  ASSERT_EQ(result, (std::vector<RID>{RID(0, 1), RID(0, 2), RID(0, 3)}));
+
+  index.DeleteEntry(make_tuple("abc", 1), RID(0, 2), nullptr);
+  result.clear();
+  index.ScanKey(make_tuple("abc", 1), &result, nullptr);
+  ASSERT_TRUE(result.empty());
+}
+
+}  // namespace bustub
@@ -122,7 +122,7 @@ void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, con
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -170,7 +170,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -217,7 +217,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -256,7 +256,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -295,7 +295,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest1) {
+TEST(BPlusTreeConcurrentTest, MixTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -336,7 +336,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
+TEST(BPlusTreeConcurrentTest, MixTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -402,4 +402,169 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
   delete bpm;
 }
 
+TEST(BPlusTreeConcurrentTest, BLinkLookupDuringSplitTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(256, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // small pages so that almost every insert splits a leaf or an internal page
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 3, 4,
+                                                           BPlusTreeLatchMode::BLINK);
+
+  // readers look up the even keys while writers split the pages around them with the odd keys
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t total_keys = 2000;
+  for (int64_t i = 1; i <= total_keys; i++) {
+    (i % 2 == 0 ? perserved_keys : dynamic_keys).push_back(i);
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  auto insert_task = [&](int tid) { InsertHelper(&tree, dynamic_keys, tid); };
+  auto lookup_task = [&](int tid) { LookupHelper(&tree, perserved_keys, tid); };
+
+  std::vector<std::thread> threads;
+  std::vector<std::function<void(int)>> tasks;
+  tasks.emplace_back(insert_task);
+  tasks.emplace_back(lookup_task);
+
+  size_t num_threads = 4;
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(std::thread{tasks[i % tasks.size()], i});
+  }
+  for (size_t i = 0; i < num_threads; i++) {
+    threads[i].join();
+  }
+
+  int64_t current_key = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key++;
+  }
+  ASSERT_EQ(current_key, total_keys + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, CompactionDuringLookupTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(256, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // lazy deletes leave the pages half empty, the background thread merges them while readers run
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 4, 4,
+                                                           BPlusTreeLatchMode::BLINK, BPlusTreeDeleteMode::LAZY);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t total_keys = 4000;
+  for (int64_t i = 1; i <= total_keys; i++) {
+    (i % 2 == 0 ? perserved_keys : dynamic_keys).push_back(i);
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+  InsertHelper(&tree, dynamic_keys, 1);
+  auto before = tree.GetStats();
+
+  tree.StartCompaction(std::chrono::milliseconds(1));
+  std::vector<std::thread> threads;
+  threads.emplace_back(DeleteHelperSplit, &tree, dynamic_keys, 2, 0);
+  threads.emplace_back(DeleteHelperSplit, &tree, dynamic_keys, 2, 1);
+  threads.emplace_back([&] { LookupHelper(&tree, perserved_keys, 2); });
+  threads.emplace_back([&] { LookupHelper(&tree, perserved_keys, 3); });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  tree.StopCompaction();
+  tree.Compact();
+
+  int64_t current_key = 2;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key += 2;
+  }
+  ASSERT_EQ(current_key, total_keys + 2);
+
+  auto after = tree.GetStats();
+  EXPECT_EQ(after.entries_, perserved_keys.size());
+  EXPECT_LT(after.leaf_pages_, before.leaf_pages_);
+  EXPECT_GT(after.retired_pages_, 0U);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+TEST(BPlusTreeConcurrentTest, RootCacheTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(256, disk_manager.get());
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", page_id, bpm, comparator, 50, 50);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 500; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys, 1);
+  page_id_t root_page_id = tree.GetRootPageId();
+
+  {
+    // while the header page is write latched, lookups, scans and inserts that do not split the root
+    // still make progress, since they get the root id from the cache
+    auto header_guard = bpm->FetchPageWrite(page_id);
+    ASSERT_EQ(header_guard.As<BPlusTreeHeaderPage>()->root_page_id_, root_page_id);
+    LookupHelper(&tree, keys, 1);
+    std::vector<int64_t> more_keys;
+    for (int64_t key = 501; key <= 600; key++) {
+      more_keys.push_back(key);
+    }
+    InsertHelper(&tree, more_keys, 1);
+    int64_t current_key = 1;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+      ASSERT_EQ((*iter).first.ToString(), current_key);
+      current_key++;
+    }
+    ASSERT_EQ(current_key, 601);
+    ASSERT_FALSE(tree.IsEmpty());
+  }
+
+  // root splits still go through the header page and keep the cache in sync with it
+  for (int64_t key = 601; key <= 5000; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys, 1);
+  ASSERT_NE(tree.GetRootPageId(), root_page_id);
+  {
+    auto header_guard = bpm->FetchPageRead(page_id);
+    ASSERT_EQ(header_guard.As<BPlusTreeHeaderPage>()->root_page_id_, tree.GetRootPageId());
+  }
+  LookupHelper(&tree, keys, 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -12,18 +12,21 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <string>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
 using bustub::DiskManagerUnlimitedMemory;
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -90,7 +93,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   delete bpm;
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -156,4 +159,290 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   delete transaction;
   delete bpm;
 }
+TEST(BPlusTreeTests, DeleteMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree with small pages, so that removes merge pages all the way up to the root
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 1000; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  auto before = tree.GetStats();
+  ASSERT_EQ(before.entries_, 1000);
+
+  // keep the multiples of 100
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15721));
+  for (auto key : keys) {
+    if (key % 100 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 1000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree.GetValue(index_key, &rids), key % 100 == 0);
+  }
+  int64_t current_key = 100;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key += 100;
+  }
+  ASSERT_EQ(current_key, 1100);
+  current_key = 1000;
+  for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key -= 100;
+  }
+  ASSERT_EQ(current_key, 0);
+
+  // the tree shrank with the deletes, and the retired pages went back to the buffer pool
+  auto after = tree.GetStats();
+  ASSERT_EQ(after.entries_, 10);
+  ASSERT_LT(after.height_, before.height_);
+  ASSERT_LT(after.leaf_pages_, 10);
+  ASSERT_GT(after.retired_pages_, 0);
+  ASSERT_EQ(after.reclaimed_pages_, after.retired_pages_);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, RemoveRIDMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // a non-unique tree with small pages, deleted through RemoveRID as the index does
+  BPlusTree<GenericKey<8>, PostingList, GenericComparator<8>> tree("foo_idx", header_page->GetPageId(), bpm,
+                                                                   comparator, 4, 4);
+  GenericKey<8> index_key;
+  auto *transaction = new Transaction(0);
+
+  // two RIDs per key
+  for (int64_t key = 1; key <= 500; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, PostingList(RID(0, key)), transaction);
+    tree.Insert(index_key, PostingList(RID(1, key)), transaction);
+  }
+  auto before = tree.GetStats();
+  ASSERT_EQ(before.entries_, 500);
+
+  // removing one RID of a key keeps the entry and the pages
+  for (int64_t key = 1; key <= 500; key++) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.RemoveRID(index_key, RID(0, key), transaction));
+    ASSERT_FALSE(tree.RemoveRID(index_key, RID(0, key), transaction));
+  }
+  ASSERT_EQ(tree.GetStats().entries_, 500);
+  ASSERT_EQ(tree.GetStats().retired_pages_, 0);
+
+  // removing the last RID drops the entry and merges the pages right away
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 500; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15721));
+  for (auto key : keys) {
+    if (key % 100 != 0) {
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.RemoveRID(index_key, RID(1, key), transaction));
+    }
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 500; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree.GetRIDs(index_key, &rids), key % 100 == 0);
+  }
+
+  auto after = tree.GetStats();
+  ASSERT_EQ(after.entries_, 5);
+  ASSERT_LT(after.height_, before.height_);
+  ASSERT_LT(after.leaf_pages_, 5);
+  ASSERT_GT(after.retired_pages_, 0);
+  ASSERT_EQ(after.reclaimed_pages_, after.retired_pages_);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, LazyDeleteCompactTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree that leaves underfull pages to the compaction
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 8, 8,
+                                                           BPlusTreeLatchMode::BLINK, BPlusTreeDeleteMode::LAZY);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  for (int64_t key = 1; key <= 5000; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+  auto full = tree.GetStats();
+
+  // removes leave every page in place
+  for (int64_t key = 1; key <= 5000; key++) {
+    if (key % 50 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  auto sparse = tree.GetStats();
+  ASSERT_EQ(sparse.entries_, 100);
+  ASSERT_EQ(sparse.leaf_pages_, full.leaf_pages_);
+  ASSERT_EQ(sparse.height_, full.height_);
+  ASSERT_EQ(sparse.retired_pages_, 0);
+  ASSERT_LT(sparse.leaf_fill_factor_, full.leaf_fill_factor_);
+
+  // an iterator positioned before the compaction is forwarded from the leaves that are merged away
+  auto iter = tree.Begin();
+  ASSERT_EQ((*iter).first.ToString(), 50);
+  auto reverse_iter = tree.RBegin();
+  ASSERT_EQ((*reverse_iter).first.ToString(), 5000);
+
+  ASSERT_GT(tree.Compact(), 0);
+  auto compacted = tree.GetStats();
+  ASSERT_EQ(compacted.entries_, 100);
+  ASSERT_LT(compacted.leaf_pages_, sparse.leaf_pages_ / 4);
+  ASSERT_LT(compacted.height_, sparse.height_);
+  ASSERT_GT(compacted.leaf_fill_factor_, sparse.leaf_fill_factor_);
+  ASSERT_EQ(compacted.reclaimed_pages_, compacted.retired_pages_);
+  // nothing is left to merge
+  ASSERT_EQ(tree.Compact(), 0);
+
+  int64_t current_key = 50;
+  for (; iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key += 50;
+  }
+  ASSERT_EQ(current_key, 5050);
+  current_key = 5000;
+  for (; reverse_iter != tree.End(); ++reverse_iter) {
+    ASSERT_EQ((*reverse_iter).first.ToString(), current_key);
+    current_key -= 50;
+  }
+  ASSERT_EQ(current_key, 0);
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 5000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree.GetValue(index_key, &rids), key % 50 == 0);
+  }
+
+  // the compacted tree still grows
+  for (int64_t key = 1; key <= 5000; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    ASSERT_EQ(tree.Insert(index_key, rid, transaction), key % 50 != 0);
+  }
+  ASSERT_EQ(tree.GetStats().entries_, 5000);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, VarKeyCompactTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a varchar(40)");
+  VarKeyComparator<32> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  using LeafPage = BPlusTreeLeafPage<VarKey<32>, RID, VarKeyComparator<32>>;
+  using InternalPage = BPlusTreeInternalPage<VarKey<32>, page_id_t, VarKeyComparator<32>>;
+  BPlusTree<VarKey<32>, RID, VarKeyComparator<32>> tree("foo_pk", header_page->GetPageId(), bpm, comparator,
+                                                        LeafPage::DEFAULT_MAX_SIZE, InternalPage::DEFAULT_MAX_SIZE,
+                                                        BPlusTreeLatchMode::CRABBING, BPlusTreeDeleteMode::LAZY);
+  VarKey<32> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // merged leaves cover a wider key range and lose most of their common prefix
+  std::vector<std::string> names;
+  for (int i = 0; i < 20000; i++) {
+    names.emplace_back(fmt::format("customer_{:06}", i));
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    Tuple key({ValueFactory::GetVarcharValue(names[i])}, key_schema.get());
+    index_key.SetFromKey(key, *key_schema);
+    rid.Set(0, i);
+    ASSERT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    if (i % 10 != 0) {
+      Tuple key({ValueFactory::GetVarcharValue(names[i])}, key_schema.get());
+      index_key.SetFromKey(key, *key_schema);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  auto sparse = tree.GetStats();
+  ASSERT_GT(tree.Compact(), 0);
+  auto compacted = tree.GetStats();
+  ASSERT_EQ(compacted.entries_, 2000);
+  ASSERT_LT(compacted.leaf_pages_, sparse.leaf_pages_);
+
+  size_t idx = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).second.GetSlotNum(), idx);
+    idx += 10;
+  }
+  ASSERT_EQ(idx, names.size());
+  std::vector<RID> rids;
+  for (size_t i = 0; i < names.size(); i++) {
+    rids.clear();
+    Tuple key({ValueFactory::GetVarcharValue(names[i])}, key_schema.get());
+    index_key.SetFromKey(key, *key_schema);
+    ASSERT_EQ(tree.GetValue(index_key, &rids), i % 10 == 0);
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
 }  // namespace bustub
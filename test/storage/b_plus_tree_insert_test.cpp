@@ -12,12 +12,15 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <random>
+#include <string>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager_memory.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -184,4 +187,375 @@ TEST(BPlusTreeTests, InsertTest3) {
   delete transaction;
   delete bpm;
 }
+
+TEST(BPlusTreeTests, IteratorRangeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 4);
+  GenericKey<8> index_key;
+  GenericKey<8> end_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // insert the even keys in [0, 200) in shuffled order
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 200; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key += 2;
+  }
+  EXPECT_EQ(current_key, 200);
+
+  // [31, 101] only contains even keys from 32 to 100
+  index_key.SetFromInteger(31);
+  end_key.SetFromInteger(101);
+  current_key = 32;
+  for (auto iterator = tree.Begin(index_key, end_key); !iterator.IsEnd(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key += 2;
+  }
+  EXPECT_EQ(current_key, 102);
+
+  current_key = 198;
+  for (auto iterator = tree.RBegin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, -2);
+
+  // reverse scan of [31, 101] starts from the largest key not greater than 101
+  index_key.SetFromInteger(101);
+  end_key.SetFromInteger(31);
+  current_key = 100;
+  for (auto iterator = tree.RBegin(index_key, end_key); !iterator.IsEnd(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key -= 2;
+  }
+  EXPECT_EQ(current_key, 30);
+
+  index_key.SetFromInteger(1000);
+  EXPECT_TRUE(tree.Begin(index_key) == tree.End());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+TEST(BPlusTreeTests, AppendInsertTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 5, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // auto-increment style keys always go to the right-most leaf
+  int64_t scale = 1000;
+  for (int64_t key = 0; key < scale; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  index_key.SetFromInteger(scale - 1);
+  ASSERT_FALSE(tree.Insert(index_key, rid, transaction));
+
+  // a key that does not belong to the right-most leaf must not take the fast path
+  index_key.SetFromInteger(-1);
+  rid.Set(-1, -1);
+  ASSERT_TRUE(tree.Insert(index_key, rid, transaction));
+
+  int64_t current_key = -1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key++;
+  }
+  ASSERT_EQ(current_key, scale);
+
+  std::vector<RID> rids;
+  for (int64_t key = -1; key < scale; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+  }
+
+  // right-edge splits leave full pages behind: 4 keys per leaf instead of 2 with 50/50 splits
+  page_id_t next_page_id;
+  bpm->NewPage(&next_page_id);
+  EXPECT_LT(next_page_id, scale / 4 + scale / 12 + 10);
+  bpm->UnpinPage(next_page_id, false);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, InsertBatchTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // multiples of 3 are inserted one by one first
+  for (int64_t key = 0; key < 300; key += 3) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // the batch covers every key in [0, 300) in shuffled order, plus a duplicate of each even key
+  std::vector<std::pair<GenericKey<8>, RID>> batch;
+  for (int64_t key = 0; key < 300; key++) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    batch.emplace_back(index_key, rid);
+    if (key % 2 == 0) {
+      batch.emplace_back(index_key, rid);
+    }
+  }
+  std::shuffle(batch.begin(), batch.end(), std::mt19937(15445));
+  ASSERT_EQ(tree.InsertBatch(batch, transaction), 200);
+  ASSERT_EQ(tree.InsertBatch(batch, transaction), 0);
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 300; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+  }
+
+  int64_t current_key = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key++;
+  }
+  ASSERT_EQ(current_key, 300);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, PostingListTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree with posting lists as values, so that keys may repeat
+  BPlusTree<GenericKey<8>, PostingList, GenericComparator<8>> tree("foo_idx", header_page->GetPageId(), bpm,
+                                                                     comparator, 4, 4);
+  GenericKey<8> index_key;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // key 0 gets one RID on each of 6000 pages, which takes several overflow pages; keys 1 to 99 get a few
+  // RIDs each, which stay in the leaf
+  std::vector<std::pair<int64_t, RID>> pairs;
+  for (int32_t i = 0; i < 6000; i++) {
+    pairs.emplace_back(0, RID(i, 0));
+  }
+  for (int64_t key = 1; key < 100; key++) {
+    for (uint32_t slot = 0; slot <= key % 5; slot++) {
+      pairs.emplace_back(key, RID(static_cast<page_id_t>(key), slot));
+    }
+  }
+  std::shuffle(pairs.begin(), pairs.end(), std::mt19937(15445));
+  for (const auto &[key, rid] : pairs) {
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, PostingList(rid), transaction));
+  }
+  for (const auto &[key, rid] : pairs) {
+    index_key.SetFromInteger(key);
+    ASSERT_FALSE(tree.Insert(index_key, PostingList(rid), transaction));
+  }
+
+  std::vector<RID> rids;
+  index_key.SetFromInteger(0);
+  ASSERT_TRUE(tree.GetRIDs(index_key, &rids));
+  ASSERT_EQ(rids.size(), 6000);
+  for (int32_t i = 0; i < 6000; i++) {
+    ASSERT_EQ(rids[i], RID(i, 0));
+  }
+  for (int64_t key = 1; key < 100; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetRIDs(index_key, &rids));
+    ASSERT_EQ(rids.size(), key % 5 + 1);
+    for (uint32_t slot = 0; slot < rids.size(); slot++) {
+      ASSERT_EQ(rids[slot], RID(static_cast<page_id_t>(key), slot));
+    }
+  }
+
+  // one entry per distinct key
+  int64_t current_key = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), current_key);
+    current_key++;
+  }
+  ASSERT_EQ(current_key, 100);
+
+  // batches merge into the existing lists too
+  std::vector<std::pair<GenericKey<8>, PostingList>> batch;
+  for (int64_t key = 1; key < 100; key++) {
+    index_key.SetFromInteger(key);
+    batch.emplace_back(index_key, PostingList(RID(static_cast<page_id_t>(key), 10)));
+  }
+  ASSERT_EQ(tree.InsertBatch(batch, transaction), 99);
+
+  // removing RIDs shrinks the overflow chain until the list fits into the leaf again
+  index_key.SetFromInteger(0);
+  for (int32_t i = 2; i < 6000; i++) {
+    ASSERT_TRUE(tree.RemoveRID(index_key, RID(i, 0), transaction));
+  }
+  ASSERT_FALSE(tree.RemoveRID(index_key, RID(2, 0), transaction));
+  rids.clear();
+  ASSERT_TRUE(tree.GetRIDs(index_key, &rids));
+  ASSERT_EQ(rids, (std::vector<RID>{RID(0, 0), RID(1, 0)}));
+  std::vector<PostingList> values;
+  ASSERT_TRUE(tree.GetValue(index_key, &values));
+  ASSERT_EQ(values[0].GetOverflowPageId(), INVALID_PAGE_ID);
+
+  // the key goes away with its last RID
+  ASSERT_TRUE(tree.RemoveRID(index_key, RID(0, 0), transaction));
+  ASSERT_TRUE(tree.RemoveRID(index_key, RID(1, 0), transaction));
+  rids.clear();
+  ASSERT_FALSE(tree.GetRIDs(index_key, &rids));
+  index_key.SetFromInteger(1);
+  ASSERT_TRUE(tree.GetRIDs(index_key, &rids));
+  ASSERT_EQ(rids, (std::vector<RID>{RID(1, 0), RID(1, 1), RID(1, 10)}));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
+TEST(BPlusTreeTests, VarKeyInsertTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a varchar(40)");
+  VarKeyComparator<32> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  // create b+ tree, page capacity is only bounded by free space
+  BPlusTree<VarKey<32>, RID, VarKeyComparator<32>> tree("foo_pk", header_page->GetPageId(), bpm, comparator);
+  VarKey<32> index_key;
+  RID rid;
+  // create transaction
+  auto *transaction = new Transaction(0);
+
+  // string keys sharing a long common prefix, inserted in shuffled order
+  std::vector<std::string> names;
+  for (int i = 0; i < 5000; i++) {
+    names.emplace_back(fmt::format("customer_{:06}", i * 7));
+  }
+  std::vector<std::string> shuffled = names;
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(15445));
+  for (size_t i = 0; i < shuffled.size(); i++) {
+    Tuple key({ValueFactory::GetVarcharValue(shuffled[i])}, key_schema.get());
+    index_key.SetFromKey(key, *key_schema);
+    rid.Set(0, std::stoi(shuffled[i].substr(9)));
+    ASSERT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+  ASSERT_FALSE(tree.Insert(index_key, rid, transaction));
+
+  std::vector<RID> rids;
+  for (const auto &name : names) {
+    rids.clear();
+    Tuple key({ValueFactory::GetVarcharValue(name)}, key_schema.get());
+    index_key.SetFromKey(key, *key_schema);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids));
+    ASSERT_EQ(rids[0].GetSlotNum(), std::stoi(name.substr(9)));
+  }
+  // keys between the inserted ones are not found
+  Tuple missing({ValueFactory::GetVarcharValue("customer_000001")}, key_schema.get());
+  index_key.SetFromKey(missing, *key_schema);
+  rids.clear();
+  ASSERT_FALSE(tree.GetValue(index_key, &rids));
+
+  // iteration returns the keys in string order
+  size_t idx = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_LT(idx, names.size());
+    ASSERT_EQ((*iter).second.GetSlotNum(), std::stoi(names[idx].substr(9)));
+    idx++;
+  }
+  ASSERT_EQ(idx, names.size());
+
+  // leaves bounded on both sides store the common prefix of their fence keys only once
+  using InternalPage = BPlusTreeInternalPage<VarKey<32>, page_id_t, VarKeyComparator<32>>;
+  using LeafPage = BPlusTreeLeafPage<VarKey<32>, RID, VarKeyComparator<32>>;
+  page_id_t child_page_id = tree.GetRootPageId();
+  while (true) {
+    auto guard = bpm->FetchPageRead(child_page_id);
+    if (guard.As<BPlusTreePage>()->IsLeafPage()) {
+      ASSERT_GT(guard.As<LeafPage>()->GetPrefixSize(), 0);
+      break;
+    }
+    ASSERT_GT(guard.As<InternalPage>()->GetSize(), 2);
+    child_page_id = guard.As<InternalPage>()->ValueAt(1);
+  }
+
+  // keys decode back to their values, a 0x00 byte inside a string is escaped
+  for (const auto &name : {names[42], std::string("a\0b", 3)}) {
+    Tuple key({ValueFactory::GetVarcharValue(name)}, key_schema.get());
+    index_key.SetFromKey(key, *key_schema);
+    ASSERT_EQ(index_key.ToValue(key_schema.get(), 0).ToString(), name);
+  }
+
+  // a key longer than the key size is rejected
+  Tuple long_key({ValueFactory::GetVarcharValue(std::string(40, 'x'))}, key_schema.get());
+  ASSERT_THROW(index_key.SetFromKey(long_key, *key_schema), Exception);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete bpm;
+}
+
 }  // namespace bustub
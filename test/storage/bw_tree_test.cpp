@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bw_tree_test.cpp
+//
+// Identification: test/storage/bw_tree_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/bw_tree.h"
+#include "storage/index/bw_tree_index.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+// fixed-size big-endian keys sort like the integers
+auto MakeKey(uint64_t key) -> std::string {
+  std::string result(sizeof(key), '\0');
+  for (size_t i = 0; i < sizeof(key); ++i) {
+    result[i] = static_cast<char>(key >> (8 * (sizeof(key) - 1 - i)));
+  }
+  return result;
+}
+
+auto MakeRID(uint64_t key) -> RID { return {static_cast<page_id_t>(key >> 32), static_cast<uint32_t>(key)}; }
+
+}  // namespace
+
+TEST(BwTreeTests, InsertLookupRemoveTest) {
+  // tiny nodes and short chains, so that the tree grows several levels and consolidates all the time
+  BwTree tree(4, 4, 3);
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 2000; ++key) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(42));
+
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key)));
+  }
+  for (auto key : keys) {
+    ASSERT_FALSE(tree.Insert(MakeKey(key), MakeRID(key + 1)));
+  }
+
+  RID rid;
+  for (auto key : keys) {
+    ASSERT_TRUE(tree.GetValue(MakeKey(key), &rid));
+    ASSERT_EQ(rid, MakeRID(key));
+  }
+  ASSERT_FALSE(tree.GetValue(MakeKey(5000), &rid));
+
+  for (uint64_t key = 0; key < 2000; key += 2) {
+    ASSERT_TRUE(tree.Remove(MakeKey(key)));
+    ASSERT_FALSE(tree.Remove(MakeKey(key)));
+  }
+  for (uint64_t key = 0; key < 2000; ++key) {
+    ASSERT_EQ(tree.GetValue(MakeKey(key), &rid), key % 2 == 1);
+  }
+
+  // removed keys can be inserted again
+  for (uint64_t key = 0; key < 2000; key += 2) {
+    ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key + 1)));
+  }
+  for (uint64_t key = 0; key < 2000; ++key) {
+    ASSERT_TRUE(tree.GetValue(MakeKey(key), &rid));
+    ASSERT_EQ(rid, MakeRID(key % 2 == 0 ? key + 1 : key));
+  }
+}
+
+TEST(BwTreeTests, ConcurrentInsertRemoveTest) {
+  BwTree tree(8, 8, 4);
+  const uint64_t num_threads = 4;
+  const uint64_t keys_per_thread = 5000;
+
+  // every thread inserts interleaved keys, so that all of them contend for the same nodes
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&tree, tid] {
+      RID rid;
+      for (uint64_t i = 0; i < keys_per_thread; ++i) {
+        uint64_t key = i * num_threads + tid;
+        ASSERT_TRUE(tree.Insert(MakeKey(key), MakeRID(key)));
+        ASSERT_TRUE(tree.GetValue(MakeKey(key), &rid));
+        ASSERT_EQ(rid, MakeRID(key));
+      }
+      for (uint64_t i = 0; i < keys_per_thread; i += 2) {
+        uint64_t key = i * num_threads + tid;
+        ASSERT_TRUE(tree.Remove(MakeKey(key)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  RID rid;
+  for (uint64_t key = 0; key < num_threads * keys_per_thread; ++key) {
+    bool removed = (key / num_threads) % 2 == 0;
+    ASSERT_EQ(tree.GetValue(MakeKey(key), &rid), !removed);
+  }
+}
+
+TEST(BwTreeTests, IndexTest) {
+  auto schema = ParseCreateStatement("a varchar(16),b integer");
+  BwTreeIndex index(std::make_unique<IndexMetadata>("foo_bw", "foo", schema.get(), std::vector<uint32_t>{0, 1}));
+  const auto *key_schema = index.GetKeySchema();
+
+  auto make_tuple = [&](const std::string &a, int32_t b) {
+    std::vector<Value> values{ValueFactory::GetVarcharValue(a), ValueFactory::GetIntegerValue(b)};
+    return Tuple(values, key_schema);
+  };
+
+  ASSERT_TRUE(index.InsertEntry(make_tuple("counter", 1), RID(0, 1), nullptr));
+  ASSERT_TRUE(index.InsertEntry(make_tuple("counter", 2), RID(0, 2), nullptr));
+  ASSERT_FALSE(index.InsertEntry(make_tuple("counter", 1), RID(0, 3), nullptr));
+
+  std::vector<RID> result;
+  index.ScanKey(make_tuple("counter", 2), &result, nullptr);
+  ASSERT_EQ(result, std::vector<RID>{RID(0, 2)});
+
+  index.DeleteEntry(make_tuple("counter", 2), RID(0, 2), nullptr);
+  result.clear();
+  index.ScanKey(make_tuple("counter", 2), &result, nullptr);
+  ASSERT_TRUE(result.empty());
+}
+
+}  // namespace bustub
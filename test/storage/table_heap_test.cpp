@@ -0,0 +1,921 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/storage/table_heap_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/page/dictionary_page.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto MakeTuple(const Schema &schema, int32_t v) -> Tuple {
+  return Tuple({ValueFactory::GetIntegerValue(v), ValueFactory::GetVarcharValue(std::string(40, 'a' + v % 26))},
+               &schema);
+}
+
+auto CountPages(BufferPoolManager *bpm, const TableHeap &table) -> size_t {
+  size_t num_pages = 0;
+  for (page_id_t page_id = table.GetFirstPageId(); page_id != INVALID_PAGE_ID; num_pages++) {
+    auto guard = bpm->FetchPageRead(page_id);
+    page_id = guard.As<TablePage>()->GetNextPageId();
+  }
+  return num_pages;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ConcurrentInsertTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  const int num_threads = 8;
+  const int tuples_per_thread = 2000;
+  std::vector<std::thread> threads;
+  std::vector<std::vector<RID>> rids(num_threads);
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = t * tuples_per_thread; i < (t + 1) * tuples_per_thread; i++) {
+        auto rid = table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, i));
+        ASSERT_TRUE(rid.has_value());
+        rids[t].push_back(*rid);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // every tuple is readable through its RID
+  for (int t = 0; t < num_threads; t++) {
+    for (int i = 0; i < tuples_per_thread; i++) {
+      auto [meta, tuple] = table.GetTuple(rids[t][i]);
+      EXPECT_EQ(t * tuples_per_thread + i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    }
+  }
+
+  // a scan sees every tuple once, and page ids increase along the list
+  std::set<int32_t> seen;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (auto iter = table.MakeIterator(); !iter.IsEnd(); ++iter) {
+    EXPECT_GE(iter.GetRID().GetPageId(), prev_page_id);
+    prev_page_id = iter.GetRID().GetPageId();
+    auto [meta, tuple] = iter.GetTuple();
+    EXPECT_TRUE(seen.insert(tuple.GetValue(&schema, 0).GetAs<int32_t>()).second);
+  }
+  EXPECT_EQ(num_threads * tuples_per_thread, seen.size());
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, IteratorSnapshotTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  // live threads fill their own pages, which stay partially filled in the middle of the list
+  const int num_threads = 8;
+  const int num_tuples = 100;
+  std::atomic<int> num_loaded{0};
+  std::atomic<bool> iterator_made{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < num_tuples; i++) {
+        table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, t * num_tuples + i));
+      }
+      num_loaded++;
+      while (!iterator_made) {
+        std::this_thread::yield();
+      }
+      for (int i = 0; i < num_tuples; i++) {
+        table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -1));
+      }
+    });
+  }
+  while (num_loaded != num_threads) {
+    std::this_thread::yield();
+  }
+
+  // tuples inserted after the iterator was made are not scanned, whichever page they land on
+  auto iter = table.MakeIterator();
+  iterator_made = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  size_t count = 0;
+  for (; !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    EXPECT_NE(-1, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    count++;
+  }
+  EXPECT_EQ(num_threads * num_tuples, count);
+
+  count = 0;
+  for (auto eager_iter = table.MakeEagerIterator(); !eager_iter.IsEnd(); ++eager_iter) {
+    count++;
+  }
+  EXPECT_EQ(2 * num_threads * num_tuples, count);
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, EagerIteratorTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  for (int i = 0; i < 10; i++) {
+    table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, i));
+  }
+
+  // the iterator serves a page from its batch, and reads the page again once the batch is used up
+  int count = 0;
+  for (auto iter = table.MakeEagerIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    EXPECT_EQ(iter.GetRID(), tuple.GetRid());
+    EXPECT_EQ(count, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    if (count == 5) {
+      table.UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, 1, true}, RID(iter.GetRID().GetPageId(), 6));
+      for (int i = 10; i < 15; i++) {
+        table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, i));
+      }
+    }
+    // the batch was copied before the delete
+    if (count == 6) {
+      EXPECT_FALSE(meta.is_deleted_);
+    }
+    count++;
+  }
+  EXPECT_EQ(15, count);
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, FilteredIteratorTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  const int num_tuples = 1000;
+  for (int i = 0; i < num_tuples; i++) {
+    auto tuple = MakeTuple(schema, i);
+    auto rid = table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple);
+    // a view reads the same values as the tuple it looks at
+    TupleView view(tuple);
+    EXPECT_EQ(i, view.GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ(tuple.GetValue(&schema, 1).ToString(), view.GetValue(&schema, 1).ToString());
+    if (i % 3 == 0) {
+      table.UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, 1, true}, *rid);
+    }
+  }
+
+  // only rows the filter accepts come out of the iterator, pages with no such row are skipped
+  int count = 0;
+  int32_t prev = -1;
+  auto iter = table.MakeIterator([&schema](const TupleMeta &meta, const TupleView &tuple) {
+    return !meta.is_deleted_ && (tuple.GetValue(&schema, 0).GetAs<int32_t>() < 10 ||
+                                 tuple.GetValue(&schema, 0).GetAs<int32_t>() >= num_tuples - 10);
+  });
+  for (; !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    auto v = tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_NE(0, v % 3);
+    EXPECT_GT(v, prev);
+    EXPECT_EQ(iter.GetRID(), tuple.GetRid());
+    EXPECT_EQ(v, table.GetTuple(iter.GetRID()).second.GetValue(&schema, 0).GetAs<int32_t>());
+    prev = v;
+    count++;
+  }
+  EXPECT_EQ(12, count);
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, BatchInsertTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  const int num_threads = 4;
+  const int num_batches = 10;
+  const int batch_size = 500;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int b = 0; b < num_batches; b++) {
+        std::vector<std::pair<TupleMeta, Tuple>> tuples;
+        int first = (t * num_batches + b) * batch_size;
+        for (int i = first; i < first + batch_size; i++) {
+          tuples.emplace_back(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, i));
+        }
+        auto rids = table.InsertTuples(tuples);
+        ASSERT_EQ(batch_size, rids.size());
+        // a batch fills its pages one after another, in list order
+        for (int i = 0; i < batch_size; i++) {
+          if (i > 0) {
+            ASSERT_GE(rids[i].GetPageId(), rids[i - 1].GetPageId());
+          }
+          auto [meta, tuple] = table.GetTuple(rids[i]);
+          ASSERT_EQ(first + i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<int32_t> seen;
+  for (auto iter = table.MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    EXPECT_TRUE(seen.insert(tuple.GetValue(&schema, 0).GetAs<int32_t>()).second);
+  }
+  EXPECT_EQ(num_threads * num_batches * batch_size, seen.size());
+
+  // spare pages left by the batches are limited in a scan like the pages being filled
+  auto iter = table.MakeIterator();
+  for (int i = 0; i < 500; i++) {
+    table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -1));
+  }
+  size_t count = 0;
+  for (; !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    EXPECT_NE(-1, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+    count++;
+  }
+  EXPECT_EQ(seen.size(), count);
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, CompactionTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+
+  page_id_t page_id;
+  auto guard = bpm->NewPageGuarded(&page_id);
+  auto *page = guard.AsMut<TablePage>();
+  page->Init();
+  std::vector<uint16_t> slots;
+  while (true) {
+    auto slot = page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, slots.size()));
+    if (slot == std::nullopt) {
+      break;
+    }
+    slots.push_back(*slot);
+  }
+  uint32_t free_space = page->GetFreeSpace();
+
+  // a delete that is not completed keeps its space, a completed one gives it back
+  page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, 1, true}, RID(page_id, slots[0]));
+  EXPECT_EQ(free_space, page->GetFreeSpace());
+  for (size_t i = 0; i < slots.size(); i += 2) {
+    page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, RID(page_id, slots[i]));
+  }
+  EXPECT_EQ((slots.size() + 1) / 2, page->GetNumDeadTuples());
+  EXPECT_GT(page->GetFreeSpace(), free_space);
+  EXPECT_THROW(page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, RID(page_id, slots[0])),
+               Exception);
+
+  // inserting compacts the page; the surviving tuples keep their RIDs
+  auto slot = page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -1));
+  ASSERT_TRUE(slot.has_value());
+  EXPECT_EQ(slots.size(), *slot);
+  for (size_t i = 1; i < slots.size(); i += 2) {
+    auto [meta, tuple] = page->GetTuple(RID(page_id, slots[i]));
+    EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  }
+
+  // only reuse_slot gives the slot of a dead tuple to a new tuple
+  slot = page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -2), true);
+  ASSERT_TRUE(slot.has_value());
+  EXPECT_EQ(slots[0], *slot);
+  auto [meta, tuple] = page->GetTuple(RID(page_id, slots[0]));
+  EXPECT_FALSE(meta.is_deleted_);
+  EXPECT_EQ(-2, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ChurnTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  const int num_tuples = 2000;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, i)));
+  }
+  size_t num_pages = CountPages(bpm.get(), table);
+
+  // every round deletes half of the live tuples and inserts as many again
+  int next = num_tuples;
+  for (int round = 0; round < 10; round++) {
+    for (int i = round % 2; i < num_tuples; i += 2) {
+      table.UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[i]);
+      rids[i] = *table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, next++));
+    }
+  }
+  EXPECT_LE(CountPages(bpm.get(), table), num_pages + 2);
+
+  std::set<int32_t> seen;
+  for (auto iter = table.MakeIterator(); !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    if (!meta.is_deleted_) {
+      EXPECT_TRUE(seen.insert(tuple.GetValue(&schema, 0).GetAs<int32_t>()).second);
+    }
+  }
+  EXPECT_EQ(num_tuples, seen.size());
+  for (const auto &rid : rids) {
+    auto [meta, tuple] = table.GetTuple(rid);
+    EXPECT_FALSE(meta.is_deleted_);
+    EXPECT_TRUE(seen.count(tuple.GetValue(&schema, 0).GetAs<int32_t>()) == 1);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, NoReuseDuringScanTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get());
+
+  const int num_tuples = 1000;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, i)));
+  }
+  for (const auto &rid : rids) {
+    table.UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rid);
+  }
+
+  // like INSERT INTO t SELECT * FROM t: what the scan inserts must not show up in the scan
+  {
+    auto iter = table.MakeIterator();
+    int count = 0;
+    for (; !iter.IsEnd(); ++iter) {
+      table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -1));
+      count++;
+    }
+    EXPECT_EQ(num_tuples, count);
+  }
+
+  // once the scan is over, the space of the dead tuples is reused
+  size_t num_pages = CountPages(bpm.get(), table);
+  size_t num_reused = 0;
+  for (int i = 0; i < num_tuples; i++) {
+    auto rid = table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -2));
+    ASSERT_TRUE(rid.has_value());
+    num_reused += std::find(rids.begin(), rids.end(), *rid) != rids.end() ? 1 : 0;
+  }
+  EXPECT_GT(num_reused, 0);
+  EXPECT_LE(CountPages(bpm.get(), table), num_pages + 1);
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, PaxTableTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}, Column{"c", TypeId::BIGINT},
+                 Column{"d", TypeId::BOOLEAN}, Column{"e", TypeId::VARCHAR, 16}});
+  TableHeap table(bpm.get(), TableFormat::PAX, schema);
+  EXPECT_EQ(TableFormat::PAX, table.GetFormat());
+  auto make_tuple = [&schema](int32_t v) {
+    return Tuple({ValueFactory::GetIntegerValue(v), ValueFactory::GetVarcharValue(std::string(v % 50, 'a' + v % 26)),
+                  ValueFactory::GetBigIntValue(int64_t{v} * 1000), ValueFactory::GetBooleanValue(v % 2 == 0),
+                  v % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR) : ValueFactory::GetVarcharValue("e")},
+                 &schema);
+  };
+
+  // tuples come back from the minipages byte for byte, through single and batch inserts
+  const int num_tuples = 3000;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples / 2; i++) {
+    rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i)));
+  }
+  std::vector<std::pair<TupleMeta, Tuple>> tuples;
+  for (int i = num_tuples / 2; i < num_tuples; i++) {
+    tuples.emplace_back(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i));
+  }
+  auto batch_rids = table.InsertTuples(tuples);
+  rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+  for (int i = 0; i < num_tuples; i++) {
+    auto expected = make_tuple(i);
+    auto [meta, tuple] = table.GetTuple(rids[i]);
+    ASSERT_EQ(expected.GetLength(), tuple.GetLength());
+    ASSERT_EQ(0, memcmp(expected.GetData(), tuple.GetData(), tuple.GetLength())) << "tuple " << i;
+    EXPECT_EQ(rids[i], tuple.GetRid());
+  }
+
+  // the pages are PAX pages, not row pages
+  {
+    auto guard = bpm->FetchPageRead(table.GetFirstPageId());
+    EXPECT_EQ(guard.As<TablePaxPage>()->GetNumTuples(), guard.As<TablePaxPage>()->GetCapacity());
+  }
+
+  // deletes and in-place updates
+  for (int i = 0; i < num_tuples; i += 3) {
+    table.UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, rids[i]);
+  }
+  auto updated = Tuple({ValueFactory::GetIntegerValue(-1), ValueFactory::GetVarcharValue(std::string(1, 'Z')),
+                        ValueFactory::GetBigIntValue(1), ValueFactory::GetBooleanValue(false),
+                        ValueFactory::GetVarcharValue("E")},
+                       &schema);
+  table.UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, updated, rids[1]);
+  EXPECT_EQ(updated.ToString(&schema), table.GetTuple(rids[1]).second.ToString(&schema));
+  EXPECT_THROW(table.UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, updated, rids[2]),
+               Exception);
+
+  // a filter reads values from the minipages through views
+  int count = 0;
+  auto iter = table.MakeIterator([&schema](const TupleMeta &meta, const TupleView &tuple) {
+    return !meta.is_deleted_ && tuple.GetValue(&schema, 2).GetAs<int64_t>() % 10000 == 0 &&
+           !tuple.IsNull(&schema, 4);
+  });
+  for (; !iter.IsEnd(); ++iter) {
+    auto [meta, tuple] = iter.GetTuple();
+    auto v = tuple.GetValue(&schema, 0).GetAs<int32_t>();
+    EXPECT_EQ(0, v % 10);
+    EXPECT_NE(0, v % 3);
+    EXPECT_NE(0, v % 7);
+    EXPECT_EQ(make_tuple(v).ToString(&schema), tuple.ToString(&schema));
+    count++;
+  }
+  // multiples of 10 below 3000 that are not multiples of 3 or 7
+  EXPECT_EQ(300 - 100 - 43 + 15, count);
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ZoneMapTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}});
+  TableHeap table(bpm.get(), TableFormat::ROW, schema);
+
+  // a time-ordered table: every page holds a narrow range of a
+  const int num_tuples = 5000;
+  std::vector<RID> rids;
+  for (int i = 0; i < num_tuples; i++) {
+    auto tuple = i % 100 == 0 ? Tuple({ValueFactory::GetNullValueByType(TypeId::INTEGER),
+                                       ValueFactory::GetVarcharValue("null")},
+                                      &schema)
+                              : MakeTuple(schema, i);
+    rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, tuple));
+  }
+  auto zones = table.GetZoneMap().GetZones(rids[1].GetPageId());
+  ASSERT_EQ(2, zones.size());
+  EXPECT_EQ(1, zones[0].min_->GetAs<int32_t>());
+  EXPECT_EQ(1, zones[0].null_count_);
+  EXPECT_TRUE(table.GetZoneMap().GetZones(INVALID_PAGE_ID).empty());
+
+  // in-place updates widen the zone of their page
+  table.UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, MakeTuple(schema, -26),
+                                 rids[1]);
+  EXPECT_EQ(-26, table.GetZoneMap().GetZones(rids[1].GetPageId())[0].min_->GetAs<int32_t>());
+
+  // a recent range only visits the pages that hold it
+  auto scan = [&](int32_t low, int32_t high) {
+    std::vector<ZonePredicate> predicates{{0, ZoneOp::GreaterThanOrEqual, ValueFactory::GetIntegerValue(low)},
+                                          {0, ZoneOp::LessThan, ValueFactory::GetIntegerValue(high)}};
+    auto iter = table.MakeIterator(
+        [&](const TupleMeta &meta, const TupleView &tuple) {
+          auto v = tuple.GetValue(&schema, 0);
+          return !v.IsNull() && v.GetAs<int32_t>() >= low && v.GetAs<int32_t>() < high;
+        },
+        predicates);
+    std::vector<int32_t> values;
+    std::set<page_id_t> pages;
+    for (; !iter.IsEnd(); ++iter) {
+      values.push_back(iter.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+      pages.insert(iter.GetRID().GetPageId());
+    }
+    return std::make_pair(values, pages);
+  };
+  auto [values, pages] = scan(num_tuples - 150, num_tuples);
+  EXPECT_EQ(149, values.size());
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+  EXPECT_LE(pages.size(), 4);
+  size_t num_pages = CountPages(bpm.get(), table);
+  EXPECT_GT(num_pages, 20);
+  page_id_t candidate = table.GetZoneMap().NextCandidate(
+      table.GetFirstPageId(), {{0, ZoneOp::GreaterThanOrEqual, ValueFactory::GetIntegerValue(num_tuples - 150)}});
+  EXPECT_EQ(*pages.begin(), candidate);
+
+  // the updated tuple is found through its widened zone, and nothing is found past the max
+  EXPECT_EQ(std::vector<int32_t>{-26}, scan(-30, 0).first);
+  EXPECT_TRUE(scan(num_tuples, num_tuples + 100).first.empty());
+  EXPECT_EQ(INVALID_PAGE_ID,
+            table.GetZoneMap().NextCandidate(table.GetFirstPageId(),
+                                             {{0, ZoneOp::Equal, ValueFactory::GetIntegerValue(num_tuples)}}));
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ToastTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 20000}});
+  auto long_value = [](int32_t v) { return std::string(10000 + v, 'a' + v % 26); };
+  auto make_tuple = [&](int32_t v) {
+    std::vector<Value> values{ValueFactory::GetIntegerValue(v), ValueFactory::GetVarcharValue(long_value(v))};
+    if (v % 3 == 1) {
+      values[1] = ValueFactory::GetVarcharValue("short");
+    } else if (v % 3 == 2) {
+      values[1] = ValueFactory::GetNullValueByType(TypeId::VARCHAR);
+    }
+    return Tuple(values, &schema);
+  };
+
+  for (auto format : {TableFormat::ROW, TableFormat::PAX}) {
+    TableHeap table(bpm.get(), format, schema);
+    // values larger than a page go out of line, through single and batch inserts
+    const int num_tuples = 120;
+    std::vector<RID> rids;
+    for (int i = 0; i < num_tuples / 2; i++) {
+      rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i)));
+    }
+    std::vector<std::pair<TupleMeta, Tuple>> tuples;
+    for (int i = num_tuples / 2; i < num_tuples; i++) {
+      tuples.emplace_back(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i));
+    }
+    auto batch_rids = table.InsertTuples(tuples);
+    rids.insert(rids.end(), batch_rids.begin(), batch_rids.end());
+
+    // the pages of the table stay dense: only the toast pointers are inline
+    EXPECT_LE(CountPages(bpm.get(), table), 3);
+    for (int i = 0; i < num_tuples; i++) {
+      auto [meta, tuple] = table.GetTuple(rids[i]);
+      EXPECT_LT(tuple.GetLength(), 32);
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      ASSERT_EQ(i % 3 == 2, tuple.IsNull(&schema, 1));
+      if (i % 3 != 2) {
+        EXPECT_EQ(CmpBool::CmpTrue, tuple.GetValue(&schema, 1).CompareEquals(make_tuple(i).GetValue(&schema, 1)));
+      }
+    }
+
+    // a filter on the small column, and the returned tuples read the long values when asked
+    int count = 0;
+    auto iter = table.MakeIterator([&schema](const TupleMeta &meta, const TupleView &tuple) {
+      return tuple.GetValue(&schema, 0).GetAs<int32_t>() % 3 == 0;
+    });
+    for (; !iter.IsEnd(); ++iter) {
+      auto [meta, tuple] = iter.GetTuple();
+      auto v = tuple.GetValue(&schema, 0).GetAs<int32_t>();
+      auto value = tuple.GetValue(&schema, 1);
+      EXPECT_EQ(CmpBool::CmpTrue, value.CompareEquals(ValueFactory::GetVarcharValue(long_value(v))));
+      count++;
+    }
+    EXPECT_EQ(num_tuples / 3, count);
+
+    // a filter that reads the long values through views
+    count = 0;
+    auto long_iter = table.MakeIterator([&schema](const TupleMeta &meta, const TupleView &tuple) {
+      return !tuple.IsNull(&schema, 1) && tuple.GetValue(&schema, 1).GetLength() > 10050;
+    });
+    for (; !long_iter.IsEnd(); ++long_iter) {
+      count++;
+    }
+    EXPECT_EQ(23, count);
+
+    // an in-place update keeps the tuple size with a new long value
+    if (format == TableFormat::ROW) {
+      auto updated = make_tuple(num_tuples * 3);
+      table.UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, updated, rids[0]);
+      auto value = table.GetTuple(rids[0]).second.GetValue(&schema, 1);
+      EXPECT_EQ(CmpBool::CmpTrue, value.CompareEquals(updated.GetValue(&schema, 1)));
+    }
+
+    // tuples copied to another heap get toast chains of that heap, as INSERT INTO ... SELECT does
+    TableHeap copy(bpm.get(), format, schema);
+    for (int i = 1; i < num_tuples; i++) {
+      auto source = table.GetTuple(rids[i]).second;
+      auto copy_rid = *copy.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, source);
+      auto copied = copy.GetTuple(copy_rid).second;
+      ASSERT_EQ(source.GetLength(), copied.GetLength());
+      // the toast pointer differs, everything else is the same
+      EXPECT_EQ(i % 3 != 0, memcmp(source.GetData(), copied.GetData(), source.GetLength()) == 0) << "tuple " << i;
+      ASSERT_EQ(i % 3 == 2, copied.IsNull(&schema, 1));
+      if (i % 3 != 2) {
+        EXPECT_EQ(CmpBool::CmpTrue, copied.GetValue(&schema, 1).CompareEquals(source.GetValue(&schema, 1)));
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, DictionaryTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema(
+      {Column{"id", TypeId::INTEGER}, Column{"status", TypeId::VARCHAR, 16}, Column{"note", TypeId::VARCHAR, 32}});
+  const std::vector<std::string> statuses{"open", "closed", "pending"};
+  auto make_tuple = [&](int32_t v) {
+    auto status = v % 50 == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                              : ValueFactory::GetVarcharValue(statuses[v % statuses.size()]);
+    return Tuple({ValueFactory::GetIntegerValue(v), status, ValueFactory::GetVarcharValue(std::to_string(v))}, &schema);
+  };
+
+  for (auto format : {TableFormat::ROW, TableFormat::PAX}) {
+    TableHeap table(bpm.get(), format, schema, {1});
+    // a value longer than MAX_VALUE_LENGTH gets no code
+    auto long_status = std::string(Dictionary::MAX_VALUE_LENGTH + 10, 'x');
+    auto long_tuple = Tuple({ValueFactory::GetIntegerValue(-1), ValueFactory::GetVarcharValue(long_status),
+                             ValueFactory::GetVarcharValue("long")},
+                            &schema);
+    auto long_rid = *table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, long_tuple);
+    const int num_tuples = 2000;
+    std::vector<RID> rids;
+    for (int i = 0; i < num_tuples; i++) {
+      rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i)));
+    }
+
+    // codes are given in the order values are first stored, and the entries are in the dictionary pages
+    const auto &dictionary = table.GetDictionary();
+    EXPECT_TRUE(dictionary.IsEncoded(1));
+    EXPECT_FALSE(dictionary.IsEncoded(2));
+    EXPECT_EQ(0, dictionary.Lookup(1, ValueFactory::GetVarcharValue("closed")));
+    EXPECT_EQ(1, dictionary.Lookup(1, ValueFactory::GetVarcharValue("pending")));
+    EXPECT_EQ(2, dictionary.Lookup(1, ValueFactory::GetVarcharValue("open")));
+    EXPECT_EQ(std::nullopt, dictionary.Lookup(1, ValueFactory::GetVarcharValue("missing")));
+    EXPECT_EQ(std::nullopt, dictionary.Lookup(1, ValueFactory::GetVarcharValue(long_status)));
+    std::vector<std::string> entries;
+    {
+      auto guard = bpm->FetchPageRead(dictionary.GetFirstPageId());
+      EXPECT_EQ(INVALID_PAGE_ID, guard.As<DictionaryPage>()->GetNextPageId());
+      guard.As<DictionaryPage>()->ForEachEntry([&](uint16_t column_idx, const char *data, uint16_t len) {
+        EXPECT_EQ(1, column_idx);
+        entries.emplace_back(data);
+      });
+    }
+    EXPECT_EQ((std::vector<std::string>{"closed", "pending", "open"}), entries);
+
+    // tuples store 4-byte codes and read back the values
+    for (int i = 0; i < num_tuples; i++) {
+      auto expected = make_tuple(i);
+      auto [meta, tuple] = table.GetTuple(rids[i]);
+      uint32_t status_bytes = i % 50 == 0 ? 0 : statuses[i % statuses.size()].size() + 1;
+      ASSERT_EQ(expected.GetLength() - status_bytes, tuple.GetLength());
+      ASSERT_EQ(i % 50 == 0, tuple.IsNull(&schema, 1));
+      EXPECT_EQ(i, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      for (uint32_t col = i % 50 == 0 ? 2 : 0; col < 3; col++) {
+        EXPECT_EQ(CmpBool::CmpTrue, tuple.GetValue(&schema, col).CompareEquals(expected.GetValue(&schema, col)))
+            << "tuple " << i;
+      }
+    }
+    EXPECT_EQ(long_status, table.GetTuple(long_rid).second.GetValue(&schema, 1).ToString());
+
+    // an equality predicate on the column is checked on the codes: the filter never sees other statuses
+    auto scan = [&](const std::string &status) {
+      size_t seen = 0;
+      std::vector<int32_t> ids;
+      auto iter = table.MakeIterator(
+          [&](const TupleMeta &meta, const TupleView &tuple) {
+            seen++;
+            auto value = tuple.GetValue(&schema, 1);
+            return !value.IsNull() && value.ToString() == status;
+          },
+          {{1, ZoneOp::Equal, ValueFactory::GetVarcharValue(status)}});
+      for (; !iter.IsEnd(); ++iter) {
+        ids.push_back(iter.GetTuple().second.GetValue(&schema, 0).GetAs<int32_t>());
+      }
+      return std::make_pair(seen, ids);
+    };
+    auto [seen, ids] = scan("pending");
+    // 2 mod 3 below 2000, of which the multiples of 50 are null; nulls and the long value have no code and reach
+    // the filter
+    EXPECT_EQ(666 - 13, ids.size());
+    EXPECT_EQ(ids.size() + num_tuples / 50 + 1, seen);
+    EXPECT_TRUE(std::all_of(ids.begin(), ids.end(), [](int32_t id) { return id % 3 == 2 && id % 50 != 0; }));
+    EXPECT_TRUE(scan("missing").second.empty());
+
+    // tuples copied to another heap are encoded with the codes of that heap, or not at all, as INSERT INTO ...
+    // SELECT does
+    TableHeap encoded_copy(bpm.get(), format, schema, {1});
+    TableHeap plain_copy(bpm.get(), format, schema);
+    encoded_copy.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(3));
+    for (int i = 0; i < 100; i++) {
+      auto source = table.GetTuple(rids[i]).second;
+      auto encoded_rid = *encoded_copy.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, source);
+      auto plain_rid = *plain_copy.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, source);
+      auto expected = make_tuple(i);
+      EXPECT_EQ(expected.GetLength(), plain_copy.GetTuple(plain_rid).second.GetLength());
+      for (auto *copy : {&encoded_copy, &plain_copy}) {
+        auto copied = copy->GetTuple(copy == &encoded_copy ? encoded_rid : plain_rid).second;
+        ASSERT_EQ(i % 50 == 0, copied.IsNull(&schema, 1));
+        for (uint32_t col = i % 50 == 0 ? 2 : 0; col < 3; col++) {
+          EXPECT_EQ(CmpBool::CmpTrue, copied.GetValue(&schema, col).CompareEquals(expected.GetValue(&schema, col)))
+              << "tuple " << i;
+        }
+      }
+    }
+    EXPECT_EQ(0, encoded_copy.GetDictionary().Lookup(1, ValueFactory::GetVarcharValue("open")));
+    EXPECT_EQ(1, encoded_copy.GetDictionary().Lookup(1, ValueFactory::GetVarcharValue("closed")));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, NullBitmapTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  // 9 columns take a null bitmap of 2 bytes
+  std::vector<Column> columns;
+  for (int i = 0; i < 8; i++) {
+    columns.emplace_back("c" + std::to_string(i), TypeId::INTEGER);
+  }
+  columns.emplace_back("s", TypeId::VARCHAR, 16);
+  Schema schema(columns);
+  TableHeap table(bpm.get(), TableFormat::ROW, schema);
+
+  // column i of row r is null if bit i of r is set
+  auto make_row = [&schema](uint32_t r) {
+    std::vector<Value> values;
+    for (uint32_t col = 0; col < 8; col++) {
+      values.push_back(((r >> col) & 1) != 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                             : ValueFactory::GetIntegerValue(col));
+    }
+    values.push_back(((r >> 8) & 1) != 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                                         : ValueFactory::GetVarcharValue("x"));
+    return Tuple(values, &schema);
+  };
+  std::vector<RID> rids;
+  for (uint32_t r = 0; r < 512; r++) {
+    rids.push_back(*table.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_row(r)));
+  }
+  for (uint32_t r = 0; r < 512; r++) {
+    auto [meta, tuple] = table.GetTuple(rids[r]);
+    auto expected = make_row(r);
+    ASSERT_EQ(expected.GetLength(), tuple.GetLength());
+    ASSERT_EQ(0, memcmp(expected.GetData(), tuple.GetData(), tuple.GetLength())) << "row " << r;
+    for (uint32_t col = 0; col < schema.GetColumnCount(); col++) {
+      EXPECT_EQ(((r >> col) & 1) != 0, tuple.IsNull(&schema, col)) << "row " << r << " column " << col;
+      EXPECT_EQ(((r >> col) & 1) != 0, tuple.GetValue(&schema, col).IsNull()) << "row " << r << " column " << col;
+    }
+  }
+
+  // the bitmap follows the data in the page, views of the page read it in place
+  {
+    auto guard = bpm->FetchPageRead(rids[5].GetPageId());
+    const auto *page = guard.As<TablePage>();
+    EXPECT_EQ(2, page->GetNullBitmapSize());
+    auto [meta, view] = page->GetTupleView(rids[5]);
+    EXPECT_EQ(make_row(5).GetLength(), view.GetLength());
+    EXPECT_TRUE(view.IsNull(&schema, 0));
+    EXPECT_FALSE(view.IsNull(&schema, 1));
+    EXPECT_TRUE(view.IsNull(&schema, 2));
+    EXPECT_FALSE(view.IsNull(&schema, 8));
+    EXPECT_TRUE(view.ToTuple().IsNull(&schema, 2));
+    EXPECT_EQ(TablePage::SpaceFor(make_row(5)) + 2, TablePage::SpaceFor(view.ToTuple()));
+  }
+
+  // IsNull reads the bit of the column, not the value
+  auto row = make_row(0);
+  std::vector<char> bytes(row.GetData(), row.GetData() + row.GetLength());
+  bytes.push_back(0x08);
+  bytes.push_back(0x01);
+  TupleView view(bytes.data(), row.GetLength(), RID(), 2);
+  EXPECT_TRUE(view.IsNull(&schema, 3));
+  EXPECT_TRUE(view.IsNull(&schema, 8));
+  EXPECT_FALSE(view.GetValue(&schema, 3).IsNull());
+
+  // an in-place update writes the bitmap of the new values
+  table.UpdateTupleInPlaceUnsafe(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_row(2), rids[1]);
+  auto updated = table.GetTuple(rids[1]).second;
+  EXPECT_FALSE(updated.IsNull(&schema, 0));
+  EXPECT_TRUE(updated.IsNull(&schema, 1));
+
+  // a heap without schema stores a tuple read from this heap without its bitmap
+  TableHeap plain(bpm.get());
+  auto rid = plain.InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, updated);
+  auto copied = plain.GetTuple(*rid).second;
+  EXPECT_EQ(TablePage::SpaceFor(make_row(2)), TablePage::SpaceFor(copied));
+  EXPECT_TRUE(copied.IsNull(&schema, 1));
+  EXPECT_FALSE(copied.IsNull(&schema, 0));
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, PageVersionTest) {
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::INTEGER}});
+  auto make_tuple = [&](int32_t v) {
+    return Tuple({ValueFactory::GetIntegerValue(v), ValueFactory::GetIntegerValue(-v)}, &schema);
+  };
+
+  // version 2 slots fit many more narrow tuples into a page; version 1 pages keep working
+  std::vector<size_t> num_tuples;
+  for (auto version : {TABLE_PAGE_VERSION_1, TABLE_PAGE_VERSION_2}) {
+    page_id_t page_id;
+    auto guard = bpm->NewPageGuarded(&page_id);
+    auto *page = guard.AsMut<TablePage>();
+    page->Init(version);
+    EXPECT_EQ(version, page->GetVersion());
+    std::vector<uint16_t> slots;
+    while (page->GetFreeSpace() >= TablePage::SpaceFor(make_tuple(0))) {
+      auto slot = page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(slots.size()));
+      ASSERT_TRUE(slot.has_value());
+      slots.push_back(*slot);
+    }
+    EXPECT_EQ(std::nullopt, page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(-1)));
+    num_tuples.push_back(slots.size());
+
+    // transaction ids are kept even though the page is full
+    page->UpdateTupleMeta(TupleMeta{3, 5, true}, RID(page_id, slots[1]));
+    auto meta = page->GetTupleMeta(RID(page_id, slots[1]));
+    EXPECT_EQ(3, meta.insert_txn_id_);
+    EXPECT_EQ(5, meta.delete_txn_id_);
+    EXPECT_TRUE(meta.is_deleted_);
+    for (size_t i = 0; i < slots.size(); i++) {
+      auto [meta, tuple] = page->GetTuple(RID(page_id, slots[i]));
+      EXPECT_EQ(i == 1, meta.is_deleted_);
+      EXPECT_EQ(-static_cast<int32_t>(i), tuple.GetValue(&schema, 1).GetAs<int32_t>());
+    }
+  }
+  EXPECT_GT(num_tuples[1], num_tuples[0] * 11 / 10);
+
+  // a version 2 page holds the ids of up to 6 transactions in its table, and frees the ids no slot refers to
+  page_id_t page_id;
+  auto guard = bpm->NewPageGuarded(&page_id);
+  auto *page = guard.AsMut<TablePage>();
+  page->Init();
+  std::vector<uint16_t> slots;
+  for (int i = 0; i < 10; i++) {
+    slots.push_back(*page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i)));
+  }
+  for (txn_id_t txn_id = 1; txn_id <= 6; txn_id++) {
+    page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, txn_id, true}, RID(page_id, slots[txn_id]));
+  }
+  // an insert by a 7th transaction finds the page full
+  EXPECT_EQ(std::nullopt, page->InsertTuple(TupleMeta{7, INVALID_TXN_ID, false}, make_tuple(10)));
+  page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, RID(page_id, slots[1]));
+  page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, 7, true}, RID(page_id, slots[7]));
+  for (txn_id_t txn_id = 2; txn_id <= 7; txn_id++) {
+    EXPECT_EQ(txn_id, page->GetTupleMeta(RID(page_id, slots[txn_id])).delete_txn_id_);
+  }
+
+  // with a full table, meta updates spill the ids in front of the tuple data, even on a full page
+  for (uint16_t i = page->GetNumTuples(); page->GetFreeSpace() >= TablePage::SpaceFor(make_tuple(i)); i++) {
+    slots.push_back(*page->InsertTuple(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, make_tuple(i)));
+  }
+  uint32_t free_space = page->GetFreeSpace();
+  auto spilled_meta = [](size_t i) {
+    return TupleMeta{i % 2 == 0 ? static_cast<txn_id_t>(100 + i) : INVALID_TXN_ID, static_cast<txn_id_t>(1000 + i),
+                     true};
+  };
+  for (size_t i = 8; i < slots.size(); i++) {
+    if (i % 3 == 0) {
+      page->UpdateTupleInPlaceUnsafe(spilled_meta(i), make_tuple(-static_cast<int32_t>(i)), RID(page_id, slots[i]));
+    } else {
+      page->UpdateTupleMeta(spilled_meta(i), RID(page_id, slots[i]));
+    }
+  }
+  auto check = [&](bool spilled) {
+    for (size_t i = 8; i < slots.size(); i++) {
+      auto [meta, tuple] = page->GetTuple(RID(page_id, slots[i]));
+      auto expected = spilled ? spilled_meta(i) : TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false};
+      ASSERT_EQ(expected.insert_txn_id_, meta.insert_txn_id_);
+      ASSERT_EQ(expected.delete_txn_id_, meta.delete_txn_id_);
+      ASSERT_EQ(expected.is_deleted_, meta.is_deleted_);
+      int32_t value = i % 3 == 0 ? i : -static_cast<int32_t>(i);
+      ASSERT_EQ(value, tuple.GetValue(&schema, 1).GetAs<int32_t>());
+    }
+  };
+  check(true);
+  // finishing the transactions of a few tuples lets the space of dead ones be reclaimed
+  page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, true}, RID(page_id, slots[2]));
+  page->Compact();
+  check(true);
+  for (size_t i = 8; i < slots.size(); i++) {
+    page->UpdateTupleMeta(TupleMeta{INVALID_TXN_ID, INVALID_TXN_ID, false}, RID(page_id, slots[i]));
+  }
+  check(false);
+  // the space of the spilled ids is kept for spilling again, only the dead tuple gave space back
+  page->Compact();
+  EXPECT_GT(page->GetFreeSpace(), free_space);
+}
+
+}  // namespace bustub
@@ -110,6 +110,26 @@ auto KeyWillVanish(size_t key) -> bool { return key % 7 == 0; }
 // These keys will be overwritten to a new value
 auto KeyWillChange(size_t key) -> bool { return key % 5 == 0; }
 
+// In the split workload, the i-th preloaded key is stored at i * SPLIT_KEY_STRIDE, and writers keep
+// inserting fresh keys into the gaps in between, so that leaves all over the tree split all the time.
+static const size_t SPLIT_KEY_STRIDE = 1024;
+
+namespace {
+using bustub::BUSTUB_PAGE_SIZE;
+
+// The default fan-outs of the tree; LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE expand in terms of KeyType and ValueType.
+template <typename KeyType, typename ValueType>
+constexpr auto DefaultLeafMaxSize() -> int {
+  return LEAF_PAGE_SIZE;
+}
+
+template <typename KeyType>
+constexpr auto DefaultInternalMaxSize() -> int {
+  using ValueType = bustub::page_id_t;
+  return INTERNAL_PAGE_SIZE;
+}
+}  // namespace
+
 // NOLINTNEXTLINE
 auto main(int argc, char **argv) -> int {
   using bustub::AccessType;
@@ -119,6 +139,9 @@ auto main(int argc, char **argv) -> int {
 
   argparse::ArgumentParser program("bustub-btree-bench");
   program.add_argument("--duration").help("run btree bench for n milliseconds");
+  program.add_argument("--latch-mode").help("how readers synchronize with writers: crabbing (default) or blink");
+  program.add_argument("--workload")
+      .help("update (default): writers remove and re-insert keys; split: writers insert new keys everywhere");
 
   try {
     program.parse_args(argc, argv);
@@ -133,11 +156,35 @@ auto main(int argc, char **argv) -> int {
     duration_ms = std::stoi(program.get("--duration"));
   }
 
+  auto latch_mode = bustub::BPlusTreeLatchMode::CRABBING;
+  if (program.present("--latch-mode")) {
+    auto mode = program.get("--latch-mode");
+    if (mode == "blink") {
+      latch_mode = bustub::BPlusTreeLatchMode::BLINK;
+    } else if (mode != "crabbing") {
+      std::cerr << "unknown latch mode: " << mode << std::endl;
+      return 1;
+    }
+  }
+
+  bool split_workload = false;
+  if (program.present("--workload")) {
+    auto workload = program.get("--workload");
+    if (workload == "split") {
+      split_workload = true;
+    } else if (workload != "update") {
+      std::cerr << "unknown workload: " << workload << std::endl;
+      return 1;
+    }
+  }
+
   auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
   auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
 
-  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}\n", TOTAL_KEYS, duration_ms,
-             LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, lru_k_size={}, bpm_size={}, latch_mode={}, workload={}\n",
+             TOTAL_KEYS, duration_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE,
+             latch_mode == bustub::BPlusTreeLatchMode::BLINK ? "blink" : "crabbing",
+             split_workload ? "split" : "update");
 
   auto key_schema = bustub::ParseCreateStatement("a bigint");
   bustub::GenericComparator<8> comparator(key_schema.get());
@@ -145,15 +192,16 @@ auto main(int argc, char **argv) -> int {
   page_id_t page_id;
   auto header_page = bpm->NewPageGuarded(&page_id);
 
-  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index("foo_pk", page_id,
-                                                                                            bpm.get(), comparator);
+  bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>> index(
+      "foo_pk", page_id, bpm.get(), comparator, DefaultLeafMaxSize<bustub::GenericKey<8>, bustub::RID>(),
+      DefaultInternalMaxSize<bustub::GenericKey<8>>(), latch_mode);
 
   for (size_t key = 0; key < TOTAL_KEYS; key++) {
     bustub::GenericKey<8> index_key;
     bustub::RID rid;
     uint32_t value = key;
     rid.Set(value, value);
-    index_key.SetFromInteger(key);
+    index_key.SetFromInteger(split_workload ? key * SPLIT_KEY_STRIDE : key);
     index.Insert(index_key, rid, nullptr);
   }
 
@@ -165,7 +213,7 @@ auto main(int argc, char **argv) -> int {
   std::vector<std::thread> threads;
 
   for (size_t thread_id = 0; thread_id < BUSTUB_READ_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics, split_workload] {
       BTreeMetrics metrics(fmt::format("read  {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
@@ -183,9 +231,20 @@ auto main(int argc, char **argv) -> int {
         size_t cnt = 0;
         for (auto key = base_key; key < key_end && cnt < KEY_MODIFY_RANGE; key++, cnt++) {
           rids.clear();
-          index_key.SetFromInteger(key);
+          index_key.SetFromInteger(split_workload ? key * SPLIT_KEY_STRIDE : key);
           index.GetValue(index_key, &rids);
 
+          if (split_workload) {
+            // preloaded keys are never touched by writers, they must survive every split
+            if (rids.size() != 1 || static_cast<size_t>(rids[0].GetPageId()) != key) {
+              std::string msg = fmt::format("key lost during split: {}", key);
+              throw std::runtime_error(msg);
+            }
+            metrics.Tick();
+            metrics.Report();
+            continue;
+          }
+
           if (!KeyWillVanish(key) && rids.empty()) {
             std::string msg = fmt::format("key not found: {}", key);
             throw std::runtime_error(msg);
@@ -211,7 +270,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_WRITE_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics, split_workload] {
       BTreeMetrics metrics(fmt::format("write {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
@@ -226,6 +285,21 @@ auto main(int argc, char **argv) -> int {
 
       bool do_insert = false;
 
+      if (split_workload) {
+        std::uniform_int_distribution<size_t> gap_dis(1, SPLIT_KEY_STRIDE - 1);
+        while (!metrics.ShouldFinish()) {
+          auto key = dis(gen);
+          uint32_t value = key;
+          rid.Set(value, value);
+          index_key.SetFromInteger(key * SPLIT_KEY_STRIDE + gap_dis(gen));
+          index.Insert(index_key, rid, nullptr);
+          metrics.Tick();
+          metrics.Report();
+        }
+        total_metrics.ReportWrite(metrics.cnt_);
+        return;
+      }
+
       while (!metrics.ShouldFinish()) {
         auto base_key = dis(gen);
         size_t cnt = 0;
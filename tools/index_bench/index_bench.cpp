@@ -0,0 +1,347 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cpp_random_distributions/zipfian_int_distribution.h>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/exception.h"
+#include "common/rid.h"
+#include "container/disk/hash/disk_extendible_hash_table.h"
+#include "fmt/format.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/bw_tree.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const size_t BUSTUB_READ_THREAD = 2;
+static const size_t BUSTUB_WRITE_THREAD = 4;
+static const size_t LRU_K_SIZE = 4;
+static const size_t BUSTUB_BPM_SIZE = 1024;
+static const size_t TOTAL_KEYS = 100000;
+// In the session workload, every writer removes the key it inserted SESSION_WINDOW inserts ago
+static const size_t SESSION_WINDOW = 1000;
+
+struct IndexTotalMetrics {
+  uint64_t write_cnt_{0};
+  uint64_t read_cnt_{0};
+  uint64_t start_time_{0};
+  std::mutex mutex_;
+
+  void Begin() { start_time_ = ClockMs(); }
+
+  void ReportWrite(uint64_t cnt) {
+    std::unique_lock<std::mutex> l(mutex_);
+    write_cnt_ += cnt;
+  }
+
+  void ReportRead(uint64_t cnt) {
+    std::unique_lock<std::mutex> l(mutex_);
+    read_cnt_ += cnt;
+  }
+
+  void Report() {
+    auto now = ClockMs();
+    auto elsped = now - start_time_;
+    auto write_per_sec = write_cnt_ / static_cast<double>(elsped) * 1000;
+    auto read_per_sec = read_cnt_ / static_cast<double>(elsped) * 1000;
+
+    fmt::print("<<< BEGIN\n");
+    fmt::print("write: {}\n", write_per_sec);
+    fmt::print("read: {}\n", read_per_sec);
+    fmt::print(">>> END\n");
+  }
+};
+
+struct IndexMetrics {
+  uint64_t start_time_{0};
+  uint64_t last_report_at_{0};
+  uint64_t last_cnt_{0};
+  uint64_t cnt_{0};
+  std::string reporter_;
+  uint64_t duration_ms_;
+
+  explicit IndexMetrics(std::string reporter, uint64_t duration_ms)
+      : reporter_(std::move(reporter)), duration_ms_(duration_ms) {}
+
+  void Tick() { cnt_ += 1; }
+
+  void Begin() { start_time_ = ClockMs(); }
+
+  void Report() {
+    auto now = ClockMs();
+    auto elsped = now - start_time_;
+    if (elsped - last_report_at_ > 1000) {
+      fmt::print(stderr, "[{:5.2f}] {}: total_cnt={:<10} throughput={:<10.3f} avg_throughput={:<10.3f}\n",
+                 elsped / 1000.0, reporter_, cnt_,
+                 (cnt_ - last_cnt_) / static_cast<double>(elsped - last_report_at_) * 1000,
+                 cnt_ / static_cast<double>(elsped) * 1000);
+      last_report_at_ = elsped;
+      last_cnt_ = cnt_;
+    }
+  }
+
+  auto ShouldFinish() -> bool {
+    auto now = ClockMs();
+    return now - start_time_ > duration_ms_;
+  }
+};
+
+namespace bustub {
+
+/** The indexes under test behind the same integer-key interface */
+class BenchIndex {
+ public:
+  virtual ~BenchIndex() = default;
+  virtual auto Insert(uint64_t key, const RID &rid) -> bool = 0;
+  virtual auto Remove(uint64_t key, const RID &rid) -> bool = 0;
+  virtual auto GetValue(uint64_t key, RID *rid) -> bool = 0;
+};
+
+class BPlusTreeBenchIndex : public BenchIndex {
+ public:
+  BPlusTreeBenchIndex() : key_schema_(ParseCreateStatement("a bigint")), comparator_(key_schema_.get()) {
+    disk_manager_ = std::make_unique<DiskManagerUnlimitedMemory>();
+    bpm_ = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager_.get(), LRU_K_SIZE);
+    page_id_t page_id;
+    auto header_page = bpm_->NewPageGuarded(&page_id);
+    tree_ = std::make_unique<BPlusTree<GenericKey<8>, RID, GenericComparator<8>>>("foo_pk", page_id, bpm_.get(),
+                                                                                    comparator_);
+  }
+
+  auto Insert(uint64_t key, const RID &rid) -> bool override {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    return tree_->Insert(index_key, rid, nullptr);
+  }
+
+  auto Remove(uint64_t key, const RID &rid) -> bool override {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    tree_->Remove(index_key, nullptr);
+    return true;
+  }
+
+  auto GetValue(uint64_t key, RID *rid) -> bool override {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    std::vector<RID> result;
+    tree_->GetValue(index_key, &result, nullptr);
+    if (result.empty()) {
+      return false;
+    }
+    *rid = result[0];
+    return true;
+  }
+
+ private:
+  std::unique_ptr<Schema> key_schema_;
+  GenericComparator<8> comparator_;
+  std::unique_ptr<DiskManagerUnlimitedMemory> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<BPlusTree<GenericKey<8>, RID, GenericComparator<8>>> tree_;
+};
+
+class BwTreeBenchIndex : public BenchIndex {
+ public:
+  auto Insert(uint64_t key, const RID &rid) -> bool override { return tree_.Insert(Encode(key), rid); }
+
+  auto Remove(uint64_t key, const RID &rid) -> bool override { return tree_.Remove(Encode(key)); }
+
+  auto GetValue(uint64_t key, RID *rid) -> bool override { return tree_.GetValue(Encode(key), rid); }
+
+ private:
+  // big-endian, so that the byte order of the keys is their integer order
+  static auto Encode(uint64_t key) -> std::string {
+    std::string result(sizeof(key), '\0');
+    for (size_t i = 0; i < sizeof(key); ++i) {
+      result[i] = static_cast<char>(key >> (8 * (sizeof(key) - 1 - i)));
+    }
+    return result;
+  }
+
+  BwTree tree_;
+};
+
+class ExtendibleHashBenchIndex : public BenchIndex {
+ public:
+  ExtendibleHashBenchIndex() : key_schema_(ParseCreateStatement("a bigint")), comparator_(key_schema_.get()) {
+    disk_manager_ = std::make_unique<DiskManagerUnlimitedMemory>();
+    bpm_ = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager_.get(), LRU_K_SIZE);
+    table_ = std::make_unique<DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>>(
+        "foo_pk", bpm_.get(), comparator_, HashFunction<GenericKey<8>>());
+  }
+
+  auto Insert(uint64_t key, const RID &rid) -> bool override {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    return table_->Insert(nullptr, index_key, rid);
+  }
+
+  auto Remove(uint64_t key, const RID &rid) -> bool override {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    return table_->Remove(nullptr, index_key, rid);
+  }
+
+  auto GetValue(uint64_t key, RID *rid) -> bool override {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    std::vector<RID> result;
+    table_->GetValue(nullptr, index_key, &result);
+    if (result.empty()) {
+      return false;
+    }
+    *rid = result[0];
+    return true;
+  }
+
+ private:
+  std::unique_ptr<Schema> key_schema_;
+  GenericComparator<8> comparator_;
+  std::unique_ptr<DiskManagerUnlimitedMemory> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<DiskExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>> table_;
+};
+
+}  // namespace bustub
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-index-bench");
+  program.add_argument("--duration").help("run index bench for n milliseconds");
+  program.add_argument("--index").help("index under test: bplustree (default), bwtree or hash");
+  program.add_argument("--workload")
+      .help("append (default): writers insert new keys; session: writers also remove their old keys");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 10000;
+  if (program.present("--duration")) {
+    duration_ms = std::stoi(program.get("--duration"));
+  }
+
+  std::string index_name = "bplustree";
+  if (program.present("--index")) {
+    index_name = program.get("--index");
+  }
+
+  bool session_workload = false;
+  if (program.present("--workload")) {
+    auto workload = program.get("--workload");
+    if (workload == "session") {
+      session_workload = true;
+    } else if (workload != "append") {
+      std::cerr << "unknown workload: " << workload << std::endl;
+      return 1;
+    }
+  }
+
+  std::unique_ptr<bustub::BenchIndex> index;
+  if (index_name == "bplustree") {
+    index = std::make_unique<bustub::BPlusTreeBenchIndex>();
+  } else if (index_name == "bwtree") {
+    index = std::make_unique<bustub::BwTreeBenchIndex>();
+  } else if (index_name == "hash") {
+    index = std::make_unique<bustub::ExtendibleHashBenchIndex>();
+  } else {
+    std::cerr << "unknown index: " << index_name << std::endl;
+    return 1;
+  }
+
+  fmt::print(stderr, "[info] total_keys={}, duration_ms={}, index={}, workload={}\n", TOTAL_KEYS, duration_ms,
+             index_name, session_workload ? "session" : "append");
+
+  for (size_t key = 0; key < TOTAL_KEYS; key++) {
+    bustub::RID rid(key, key);
+    index->Insert(key, rid);
+  }
+
+  fmt::print(stderr, "[info] benchmark start\n");
+
+  IndexTotalMetrics total_metrics;
+  total_metrics.Begin();
+
+  std::vector<std::thread> threads;
+
+  // readers hit a few hot keys most of the time
+  for (size_t thread_id = 0; thread_id < BUSTUB_READ_THREAD; thread_id++) {
+    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics] {
+      IndexMetrics metrics(fmt::format("read  {:>2}", thread_id), duration_ms);
+      metrics.Begin();
+
+      std::random_device r;
+      std::default_random_engine gen(r());
+      zipfian_int_distribution<size_t> dist(0, TOTAL_KEYS - 1, 0.99);
+      bustub::RID rid;
+
+      while (!metrics.ShouldFinish()) {
+        auto key = dist(gen);
+        if (!index->GetValue(key, &rid) || rid.GetPageId() != static_cast<bustub::page_id_t>(key)) {
+          std::string msg = fmt::format("key not found: {}", key);
+          throw std::runtime_error(msg);
+        }
+        metrics.Tick();
+        metrics.Report();
+      }
+
+      total_metrics.ReportRead(metrics.cnt_);
+    }));
+  }
+
+  // all writers append interleaved keys, so every insert goes to the same right-most node. In the
+  // session workload the index keeps its size, like a table of sessions that expire
+  for (size_t thread_id = 0; thread_id < BUSTUB_WRITE_THREAD; thread_id++) {
+    threads.emplace_back(std::thread([thread_id, &index, duration_ms, &total_metrics, session_workload] {
+      IndexMetrics metrics(fmt::format("write {:>2}", thread_id), duration_ms);
+      metrics.Begin();
+
+      for (size_t i = 0; !metrics.ShouldFinish(); i++) {
+        size_t key = TOTAL_KEYS + i * BUSTUB_WRITE_THREAD + thread_id;
+        bustub::RID rid(key, key);
+        if (!index->Insert(key, rid)) {
+          std::string msg = fmt::format("duplicate key: {}", key);
+          throw std::runtime_error(msg);
+        }
+        if (session_workload && i >= SESSION_WINDOW) {
+          size_t old_key = key - SESSION_WINDOW * BUSTUB_WRITE_THREAD;
+          index->Remove(old_key, bustub::RID(old_key, old_key));
+        }
+        metrics.Tick();
+        metrics.Report();
+      }
+
+      total_metrics.ReportWrite(metrics.cnt_);
+    }));
+  }
+
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  total_metrics.Report();
+
+  return 0;
+}
@@ -75,6 +75,11 @@ auto ProcessExtraOptions(const std::string &sql, bustub::BustubInstance &instanc
           fmt::print("IndexScan not found\n");
           return false;
         }
+      } else if (opt == "ensure:index_only_scan") {
+        if (!bustub::StringUtil::Contains(result.str(), "index_only=true")) {
+          fmt::print("index-only IndexScan not found\n");
+          return false;
+        }
       } else if (opt == "ensure:hash_join") {
         if (bustub::StringUtil::Split(result.str(), "HashJoin").size() != 2 &&
             !bustub::StringUtil::Contains(result.str(), "Filter")) {
@@ -247,10 +252,21 @@ auto main(int argc, char **argv) -> int {  // NOLINT
 
           std::stringstream result;
           auto writer = bustub::SimpleStreamWriter(result, true);
-          bustub->ExecuteSql(statement.sql_, writer, check_options);
+          // the execution engine turns an ExecutionException into a failed statement instead of rethrowing it
+          auto is_successful = bustub->ExecuteSql(statement.sql_, writer, check_options);
           if (verbose) {
             fmt::print("----\n{}\n", result.str());
           }
+          if (!is_successful) {
+            if (!statement.is_error_) {
+              fmt::print("unexpected error: statement failed\n");
+              return 1;
+            }
+            if (verbose) {
+              fmt::print("statement failed\n");
+            }
+            continue;
+          }
           if (statement.is_error_) {
             fmt::print("statement should error\n");
             return 1;